@@ -0,0 +1,133 @@
+#pragma once
+
+#include <aloe/core/Handles.h>
+
+#include <volk.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace aloe {
+class ResourceManager;
+
+// An aloe asset pack is a single file of named buffers and pre-mipped images, laid out so that it can be memory mapped
+// and each asset copied straight from the mapping into staging memory:
+//
+//   AssetPackHeader | AssetPackEntry[entry_count] (sorted by name) | names (NUL terminated) | asset data
+//
+// Every asset starts at a multiple of `asset_pack_alignment`, and every mip of an image at a multiple of
+// `asset_pack_mip_alignment`, which satisfies the buffer offset requirements of buffer to image copies.
+constexpr static uint32_t asset_pack_magic = 0x4B504C41;// "ALPK"
+constexpr static uint32_t asset_pack_version = 1;
+constexpr static uint64_t asset_pack_alignment = 256;
+constexpr static uint64_t asset_pack_mip_alignment = 16;
+constexpr static uint32_t asset_pack_max_mips = 16;
+
+enum class AssetKind : uint32_t {
+    Buffer,
+    Image,
+};
+
+struct AssetPackHeader {
+    uint32_t magic = asset_pack_magic;
+    uint32_t version = asset_pack_version;
+    uint32_t entry_count = 0;
+    uint32_t reserved = 0;
+    uint64_t names_offset = 0;
+    uint64_t names_size = 0;
+    uint64_t file_size = 0;
+};
+
+struct AssetPackEntry {
+    uint64_t name_offset = 0;// Within the name table
+    uint32_t name_size = 0;  // Excluding the NUL terminator
+    AssetKind kind = AssetKind::Buffer;
+    uint64_t data_offset = 0;// Within the file
+    uint64_t data_size = 0;
+
+    // Images only, mip `i` holds every array layer tightly packed and starts `mip_offsets[i]` bytes into the data
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkExtent3D extent = {};
+    uint32_t mip_levels = 0;
+    uint32_t array_layers = 0;
+    VkImageCreateFlags flags = 0;
+    VkImageType type = VK_IMAGE_TYPE_2D;
+    uint64_t mip_offsets[asset_pack_max_mips] = {};
+};
+
+static_assert( std::is_trivially_copyable_v<AssetPackHeader> && std::is_trivially_copyable_v<AssetPackEntry> );
+
+// A read-only, memory mapped asset pack. Assets are uploaded by copying from the mapping into staging memory, so
+// loading costs one copy instead of a read into a temporary followed by the upload.
+class AssetPack {
+    const uint8_t* mapping_ = nullptr;
+    size_t size_ = 0;
+    std::span<const AssetPackEntry> entries_ = {};
+
+    AssetPack( const uint8_t* mapping, size_t size );
+
+public:
+    // Maps `path` and validates its layout, returns nullptr (after logging) if it is not a valid asset pack. The layout
+    // is native endian, packs are built for the machines which load them.
+    static std::unique_ptr<AssetPack> open( const std::filesystem::path& path );
+    ~AssetPack();
+
+    AssetPack( AssetPack& ) = delete;
+    AssetPack& operator=( const AssetPack& other ) = delete;
+
+    AssetPack( AssetPack&& ) = delete;
+    AssetPack& operator=( AssetPack&& other ) = delete;
+
+    std::span<const AssetPackEntry> entries() const { return entries_; }
+    const AssetPackEntry* find( std::string_view asset_name ) const;
+    std::string_view name( const AssetPackEntry& entry ) const;
+    std::span<const uint8_t> data( const AssetPackEntry& entry ) const;
+
+    // Creates a device local buffer (or image, with every mip of the asset uploaded) from the asset `asset_name`.
+    // `debug_name` must outlive the resource, as with `BufferDesc::name`.
+    BufferHandle load_buffer( ResourceManager& resource_manager,
+                              std::string_view asset_name,
+                              VkBufferUsageFlags usage,
+                              const char* debug_name = {} ) const;
+    ImageHandle load_image( ResourceManager& resource_manager,
+                            std::string_view asset_name,
+                            VkImageUsageFlags usage,
+                            const char* debug_name = {} ) const;
+};
+
+struct AssetImageDesc {
+    VkImageType type = VK_IMAGE_TYPE_2D;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    VkExtent3D extent = {};
+    uint32_t array_layers = 1;
+    VkImageCreateFlags flags = 0;
+};
+
+// Builds an asset pack, assets are held in memory until `write`.
+class AssetPackWriter {
+    struct PendingAsset {
+        std::string name;
+        AssetPackEntry entry;
+        std::vector<std::vector<uint8_t>> parts;// The buffer, or one part per mip
+    };
+
+    std::vector<PendingAsset> assets_;
+
+public:
+    bool add_buffer( std::string_view asset_name, std::span<const uint8_t> data );
+    // `mips` are ordered from the most detailed, each holding every array layer of that mip tightly packed (so exactly
+    // `mip_size` bytes, which must be known for the format)
+    bool add_image( std::string_view asset_name,
+                    const AssetImageDesc& desc,
+                    std::span<const std::vector<uint8_t>> mips );
+
+    bool write( const std::filesystem::path& path ) const;
+};
+
+}// namespace aloe
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <filesystem>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #define VK_ENABLE_BETA_EXTENSIONS
@@ -23,6 +25,17 @@ struct DeviceSettings {
 
     bool enable_validation = true;
     bool headless = false;
+    // Every buffer gets a 64-bit device address (`ResourceManager::get_buffer_address`), which shaders can dereference
+    // as a typed pointer without going through a descriptor. Buffers with an address are never moved by
+    // defragmentation, as the address may be stored in other GPU data.
+    bool buffer_device_address = false;
+    // Use `VK_EXT_host_image_copy` where the device supports it, so image uploads and readbacks are copied by the CPU
+    // straight into (or out of) optimally tiled images, without a staging buffer or a command submission.
+    bool host_image_copy = true;
+    // Back the bindless table with `VK_EXT_descriptor_buffer` where the device supports it, so descriptors are written
+    // straight into a mapped buffer and bound with a buffer offset, instead of through a descriptor pool and set. The
+    // pool and set are still used if the table does not fit in the device's descriptor buffer range.
+    bool descriptor_buffer = true;
 
     std::vector<const char*> device_extensions{
         VK_KHR_SWAPCHAIN_EXTENSION_NAME,          VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME,
@@ -60,17 +73,28 @@ private:
 
         std::vector<VkQueueFamilyProperties> queue_families;
 
+        bool supports_host_image_copy = false;
+        // Whether host image copies may write to / read from `VK_IMAGE_LAYOUT_GENERAL`, where images rest
+        bool host_copy_to_general = false;
+        bool host_copy_from_general = false;
+        bool supports_descriptor_buffer = false;
         bool viable_device = true;
     };
 
     static DebugInformation debug_info_;
 
     bool enable_validation_ = false;
+    bool buffer_device_address_ = false;
+    bool host_image_copy_ = false;
+    bool host_image_readback_ = false;
+    bool descriptor_buffer_ = false;
     VkInstance instance_ = VK_NULL_HANDLE;
     VkDebugUtilsMessengerEXT debug_messenger_ = VK_NULL_HANDLE;
     std::vector<PhysicalDevice> physical_devices_;
     VkDevice device_ = VK_NULL_HANDLE;
     std::vector<Queue> queues_;
+    // Queues must be externally synchronized, and resources may be uploaded from several threads at once
+    mutable std::mutex queue_mutex_;
     VmaAllocator allocator_ = VK_NULL_HANDLE;
 
     std::shared_ptr<PipelineManager> pipeline_manager_ = nullptr;
@@ -91,16 +115,32 @@ public:
     VkInstance instance() const { return instance_; }
     VkPhysicalDevice physical_device() const { return physical_devices_.front().physical_device; }
     VkPhysicalDeviceLimits get_physical_device_limits() { return physical_devices_.front().props.limits; }
+    const VkPhysicalDeviceFeatures& get_physical_device_features() const { return physical_devices_.front().features; }
     VkDevice device() const { return device_; }
     VmaAllocator allocator() const { return allocator_; }
     bool validation_enabled() const { return enable_validation_; }
+    bool buffer_device_address_enabled() const { return buffer_device_address_; }
+    bool host_image_copy_enabled() const { return host_image_copy_; }
+    // Whether images created for host copies can also be read back on the host, rather than through staging
+    bool host_image_readback_enabled() const { return host_image_readback_; }
+    bool descriptor_buffer_enabled() const { return descriptor_buffer_; }
     std::vector<Queue> find_queues( VkQueueFlagBits capability ) const;
 
-    std::shared_ptr<PipelineManager> make_pipeline_manager( const std::vector<std::string>& root_paths );
+    // `pipeline_cache_path` persists compiled pipelines between runs, see `PipelineManager::save_pipeline_cache`, and
+    // `shader_cache_directory` the SPIR-V compiled for them
+    std::shared_ptr<PipelineManager> make_pipeline_manager( const std::vector<std::string>& root_paths,
+                                                            const std::filesystem::path& pipeline_cache_path = {},
+                                                            const std::filesystem::path& shader_cache_directory = {} );
     std::shared_ptr<ResourceManager> make_resource_manager();
     std::shared_ptr<Swapchain> make_swapchain( const SwapchainSettings& settings );
     std::shared_ptr<TaskGraph> make_task_graph();
     void immediate_submit( const Queue& queue, const std::function<void( VkCommandBuffer )>& work_fn );
+    // Thread safe wrappers of `vkQueueSubmit` & `vkQueuePresentKHR`. `wait_idle` submits a fence to the queue (or to
+    // every queue) and waits on it outside the queue lock, so one thread waiting never stalls another's submits.
+    VkResult submit( const Queue& queue, const VkSubmitInfo& submit_info, VkFence fence ) const;
+    VkResult present( VkQueue queue, const VkPresentInfoKHR& present_info ) const;
+    VkResult wait_idle( const Queue& queue ) const;
+    VkResult wait_idle() const;
 
     static const DebugInformation& debug_info() { return debug_info_; }
 
@@ -109,6 +149,7 @@ private:
     static VkResult pick_physical_device( Device& device, const DeviceSettings& settings );
     static VkResult create_logical_device( Device& device, const DeviceSettings& settings );
     static void gather_queues( Device& device );
+    VkResult submit_fence( VkQueue queue, VkFence fence ) const;
     static VkResult create_allocator( Device& device );
     static VkBool32 debug_callback( VkDebugUtilsMessageSeverityFlagBitsEXT message_severity,
                                     VkDebugUtilsMessageTypeFlagsEXT message_type,
@@ -28,6 +28,46 @@ struct ImageHandle : ResourceId {
     auto operator<=>( const ImageHandle& other ) const = default;
 };
 
+// A sampler in the bindless sampler heap (`sampler id << 32 | descriptor slot`). Samplers need no usage tracking, so
+// the handle is written directly into `aloe::SamplerHandle` uniforms.
+struct SamplerHandle {
+    uint64_t raw = 0;
+
+    auto operator<=>( const SamplerHandle& other ) const = default;
+};
+
+// A custom VMA pool made by `ResourceManager::create_memory_pool`, resources are placed in it with
+// `BufferDesc::memory_pool`/`ImageDesc::memory_pool`.
+struct MemoryPoolHandle {
+    uint64_t raw = 0;
+
+    auto operator<=>( const MemoryPoolHandle& other ) const = default;
+};
+
+// The layout of an `aloe::BufferHandle` as seen by shaders (see aloe.slang.h). Buffers sub-allocated from a pool share
+// the descriptor slot of the pool, so the byte range of the buffer within that descriptor travels with the handle.
+struct GpuBufferHandle {
+    uint64_t id = 0;    // resource id << 32 | descriptor slot
+    uint32_t offset = 0;// byte offset of the buffer within the bound descriptor
+    uint32_t size = 0;  // size of the buffer in bytes
+
+    auto operator<=>( const GpuBufferHandle& other ) const = default;
+};
+
+// Maps a handle type to the type which is written into a shaders uniform block.
+template<typename T>
+struct ShaderType {
+    using type = T;
+};
+
+template<>
+struct ShaderType<BufferHandle> {
+    using type = GpuBufferHandle;
+};
+
+template<typename T>
+using shader_type_t = typename ShaderType<T>::type;
+
 struct PipelineHandle {
     uint64_t id = 0;
 
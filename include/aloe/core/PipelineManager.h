@@ -1,11 +1,20 @@
 #pragma once
 
 #include <aloe/core/Handles.h>
+#include <aloe/util/log.h>
 
 #include <volk.h>
 
 #include <algorithm>
+#include <atomic>
 #include <expected>
+#include <filesystem>
+#include <future>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -24,6 +33,7 @@ namespace aloe {
 class Device;
 class ResourceManager;
 class BoundPipelineScope;
+class ThreadPool;
 
 struct ShaderCompileInfo {
     std::string name;
@@ -45,22 +55,19 @@ struct GraphicsPipelineInfo {
     auto operator<=>( const GraphicsPipelineInfo& other ) const = default;
 };
 
+using PipelineInfo = std::variant<GraphicsPipelineInfo, ComputePipelineInfo>;
+
 struct SlangFilesystem;
 
 class PipelineManager {
     friend class Device;
     friend class BoundPipelineScope;
     friend class TaskGraph;
-    // Represents a shader file on disk, that has been linked to its dependencies, but has not yet been
-    // compiled for a particular entry point, you need an `entry_point` name to turn this into a
-    // `CompiledShaderState` object.
+    // Represents a shader file on disk, and how it is linked to its dependencies, so pipelines can be recompiled when
+    // any of the files they were built from change.
     struct ShaderState {
         std::string name;
 
-        /// Slang State Tracking
-        Slang::ComPtr<SlangCompileRequest> compile_request = nullptr;
-        Slang::ComPtr<slang::IModule> module = nullptr;
-
         /// Shader Dependency Tracking
         // Which other shader(s) does this shader depend on
         std::vector<ShaderState*> dependencies{};
@@ -70,6 +77,29 @@ class PipelineManager {
         const std::vector<ShaderState*>& get_dependents() const;
     };
 
+    // A shader file compiled by Slang, that has not yet been compiled for a particular entry point. Only lives as long
+    // as the compile which made it, in the `SlangContext` which made it.
+    struct SlangModule {
+        Slang::ComPtr<SlangCompileRequest> compile_request = nullptr;
+        Slang::ComPtr<slang::IModule> module = nullptr;
+    };
+
+    // Slang sessions (and the global sessions they are made from) are not thread safe, so each compile borrows one of
+    // these for its duration.
+    struct SlangContext {
+        Slang::ComPtr<slang::IGlobalSession> global_session = nullptr;
+        Slang::ComPtr<slang::ISession> session = nullptr;
+        // `defines_generation` when `session` was created, it is rebuilt once they differ
+        uint64_t session_generation = 0;
+
+        // The defines of the build borrowing the context, taken once as it starts so its session and shader cache keys
+        // are always made from the same defines
+        std::map<std::string, std::string> defines = {};
+        uint64_t defines_generation = 0;
+        // The contents of every file Slang loaded for the shader being compiled, as it read them
+        std::unordered_map<std::string, std::string> loaded_files = {};
+    };
+
     // Represents a shader that has been compiled for a given entry point (& stage)
     struct CompiledShaderState {
         struct Uniform {
@@ -86,6 +116,12 @@ class PipelineManager {
         VkShaderModule shader_module = VK_NULL_HANDLE;
         std::vector<uint32_t> spirv;
         std::vector<Uniform> uniforms;
+        // Every file the shader was built from, including its own source
+        std::vector<std::string> dependency_files;
+        // Written to the shader cache once the pipeline is installed, so builds which are dropped never store anything.
+        // Empty on a hit, or if the shader can not be cached.
+        std::filesystem::path cache_path;
+        std::string cache_entry;
 
         auto operator<=>( const CompiledShaderState& other ) const = default;
     };
@@ -104,6 +140,12 @@ class PipelineManager {
             std::memcpy( data_.data() + element.offset, &element.data.value(), sizeof( T ) );
         }
 
+        // Copies the `size` bytes at `offset` from `other`, which must be at least as large
+        void copy( const UniformBlock& other, uint32_t offset, uint32_t size ) {
+            assert( offset + size <= data_.size() && offset + size <= other.data_.size() );
+            std::memcpy( data_.data() + offset, other.data_.data() + offset, size );
+        }
+
         const void* data() const { return data_.data(); }
         std::size_t size() const { return data_.size(); }
 
@@ -116,7 +158,7 @@ class PipelineManager {
     struct PipelineState {
         uint32_t id;
         uint32_t version;
-        std::variant<GraphicsPipelineInfo, ComputePipelineInfo> info;
+        PipelineInfo info;
 
         std::vector<CompiledShaderState> compiled_shaders = {};
 
@@ -132,20 +174,56 @@ class PipelineManager {
         auto operator<=>( const PipelineState& other ) const = default;
     };
 
+    // A pipeline being rebuilt in the background, `request` orders it against other rebuilds of the same pipeline
+    struct PendingCompile {
+        uint32_t id;
+        uint64_t request;
+        std::future<std::expected<PipelineState, std::string>> build;
+    };
+
     Device& device_;
     ResourceManager& resource_manager_;
     std::vector<std::string> root_paths_;
+    // Guards `defines_` and `defines_generation_`, which every build (including those in the background) copies into
+    // its `SlangContext` as it starts
+    mutable std::shared_mutex defines_mutex_;
     std::unordered_map<std::string, std::string> defines_;
 
+    // Shared by every pipeline we create, so drivers can skip recompiling shaders they have already seen. Seeded from
+    // (and saved back to) `pipeline_cache_path_`, unless it is empty.
+    std::filesystem::path pipeline_cache_path_;
+    VkPipelineCache pipeline_cache_ = VK_NULL_HANDLE;
+
+    // Compiled SPIR-V and its reflection, keyed by the shader, entry point, defines and Slang version, and checked
+    // against the contents of every file it was built from. Hits skip Slang entirely. Disabled if empty.
+    std::filesystem::path shader_cache_directory_;
+    std::atomic<uint32_t> shader_cache_hits_ = 0;
+
     std::shared_ptr<SlangFilesystem> filesystem_ = nullptr;
+    // Identifies the Slang version, so cached shaders are never used with another
+    std::string slang_build_tag_;
+
+    // Slang contexts not in use by a compile, for live compilation of shaders. There are at most as many as compiles
+    // which have run at once.
+    std::mutex slang_contexts_mutex_;
+    std::vector<std::unique_ptr<SlangContext>> slang_contexts_;
+    // Bumped whenever the defines change, so every context rebuilds its session with them
+    uint64_t defines_generation_ = 0;
+
+    // Builds pipelines for `compile_pipelines`, and recompiles in the background, started on first use
+    std::unique_ptr<ThreadPool> compile_workers_ = nullptr;
 
-    // Slang global session, for live compilation of shaders
-    Slang::ComPtr<slang::IGlobalSession> global_session_ = nullptr;
-    Slang::ComPtr<slang::ISession> session_ = nullptr;
+    bool async_compilation_ = false;
+    std::vector<PendingCompile> pending_compiles_;
+    // The newest request for each pipeline with a compile in flight, older ones are dropped when they finish
+    std::unordered_map<uint32_t, uint64_t> latest_compile_requests_;
+    uint64_t compile_requests_ = 0;
 
     std::vector<PipelineState> pipelines_{};
     std::vector<std::unique_ptr<ShaderState>> shaders_{};
 
+    // Whether the bindless table is backed by a descriptor buffer, rather than `global_descriptor_set_`
+    bool descriptor_buffer_ = false;
     VkDescriptorPool global_descriptor_pool_ = VK_NULL_HANDLE;
     VkDescriptorSetLayout global_descriptor_set_layout = VK_NULL_HANDLE;
     VkDescriptorSet global_descriptor_set_ = VK_NULL_HANDLE;
@@ -162,14 +240,29 @@ public:
     // Primary method for interaction with the API
     std::expected<PipelineHandle, std::string> compile_pipeline( const ComputePipelineInfo& pipeline_info );
     std::expected<PipelineHandle, std::string> compile_pipeline( const GraphicsPipelineInfo& pipeline_info );
+    // Compile many pipelines at once, spread over a thread per core. Results are in the order of `pipeline_infos`.
+    std::vector<std::expected<PipelineHandle, std::string>>
+    compile_pipelines( std::span<const PipelineInfo> pipeline_infos );
+
+    // Recompiles caused by `set_define` and `set_virtual_file` are built in the background, and each pipeline keeps
+    // its previous version until `process_pending_compiles` swaps the new one in. Disabling waits for any in flight.
+    void set_async_compilation( bool enabled );
+    // Swaps in every finished background compile (waiting for the rest too, if `wait`), returning their results.
+    // Pipelines which failed to compile keep their previous version, and the error is logged. The versions replaced
+    // are destroyed, so no submitted work may still be using them.
+    std::vector<std::expected<PipelineHandle, std::string>> process_pending_compiles( bool wait = false );
 
     // Update the define(s) for all shaders being compiled
     void set_define( const std::string& name, const std::string& value );
     // Create a new virtual file which shaders can depend on
     void set_virtual_file( const std::string& path, const std::string& contents );
+    // Write the pipeline cache to disk, this also happens on destruction. Returns false if there is no cache path or
+    // the write failed.
+    bool save_pipeline_cache() const;
 
     // Getters so unit tests can verify the validity of the code
     uint64_t get_pipeline_version( PipelineHandle ) const;
+    uint32_t get_shader_cache_hits() const;
     const std::vector<uint32_t>& get_pipeline_spirv( PipelineHandle ) const;
 
     template<typename T>
@@ -178,7 +271,7 @@ public:
         for ( const auto& shader : pipelines_.at( h.id ).compiled_shaders ) {
             for ( const auto& uniform : shader.uniforms ) {
                 if ( uniform.name == name ) {
-                    assert( uniform.size == sizeof( T ) );
+                    assert( uniform.size == sizeof( shader_type_t<T> ) );
                     return ShaderUniform<T>( h, uniform.offset );
                 }
             }
@@ -204,6 +297,20 @@ public:
         auto& pipeline = pipelines_.at( uniform.pipeline.id );
         assert( pipeline.uniforms != std::nullopt );
 
+        // Buffers also carry their range, which the shader side handle stores in 32 bits
+        [[maybe_unused]] BufferRange range{};
+        if constexpr ( std::is_same_v<T, BufferHandle> ) {
+            range = resource_manager_.get_buffer_range( *uniform.data );
+            if ( range.offset > std::numeric_limits<uint32_t>::max() ||
+                 range.size > std::numeric_limits<uint32_t>::max() ) {
+                log_write( LogLevel::Error,
+                           "Buffer range (offset {}, size {}) does not fit in a shader buffer handle",
+                           range.offset,
+                           range.size );
+                return false;
+            }
+        }
+
         // If we have an old resource bound, we need to remove its reference
         const auto& old = pipeline.uniforms->get( uniform );
         pipeline.remove_resource( old >> 32 );
@@ -213,8 +320,18 @@ public:
         if ( slot == std::nullopt ) return false;
 
         // Write the encoded `slot+id` to the uniform block
-        auto fake_uniform = ShaderUniform<T>( uniform.pipeline, uniform.offset );
-        pipeline.uniforms->set( fake_uniform.set_value( *slot ) );
+        if constexpr ( std::is_same_v<T, BufferHandle> ) {
+            // Sub-allocated buffers share the descriptor of their pool, and are told apart by their range
+            auto gpu_uniform = ShaderUniform<GpuBufferHandle>( uniform.pipeline, uniform.offset );
+            pipeline.uniforms->set( gpu_uniform.set_value( {
+                .id = *slot,
+                .offset = static_cast<uint32_t>( range.offset ),
+                .size = static_cast<uint32_t>( range.size ),
+            } ) );
+        } else {
+            auto fake_uniform = ShaderUniform<T>( uniform.pipeline, uniform.offset );
+            pipeline.uniforms->set( fake_uniform.set_value( *slot ) );
+        }
         pipeline.bound_resources.emplace_back( usage );
 
         return true;
@@ -223,7 +340,11 @@ public:
     void bind_slots() const;
 
 protected:
-    PipelineManager( Device& device, ResourceManager& resource_manager, std::vector<std::string> root_paths );
+    PipelineManager( Device& device,
+                     ResourceManager& resource_manager,
+                     std::vector<std::string> root_paths,
+                     std::filesystem::path pipeline_cache_path = {},
+                     std::filesystem::path shader_cache_directory = {} );
 
     // Validates resources included in bound uniforms, sets push constant state, and binds the pipeline
     bool bind_pipeline( PipelineHandle handle, VkCommandBuffer buffer ) const;
@@ -249,20 +370,51 @@ private:
         }
     }
 
+    // Contexts are handed out to one compile at a time, `acquire_slang_context` returns nullptr if a new one is needed
+    // and can not be created.
+    std::unique_ptr<SlangContext> acquire_slang_context();
+    void release_slang_context( std::unique_ptr<SlangContext> context );
     // We need to rebuild our session when we change defines (as we ensure that all shaders are compiled with the same set of defines)
-    Slang::ComPtr<slang::ISession> get_session();
+    Slang::ComPtr<slang::ISession> get_session( SlangContext& context );
     ShaderState& get_shader_state( const ShaderCompileInfo& path );
 
+    // Builds everything a pipeline needs into a new state, without touching any state shared with other compiles, so
+    // pipelines can be built on any thread. `install_pipeline` then swaps the result into `state` on the owning thread,
+    // failing the compile (and dropping the build) if the dependencies of its shaders can not be recorded.
+    std::expected<PipelineState, std::string> build_pipeline( const PipelineInfo& info );
+    std::expected<PipelineState, std::string> build_pipeline( SlangContext& context, const ComputePipelineInfo& info );
+    std::expected<PipelineState, std::string> build_pipeline( SlangContext& context, const GraphicsPipelineInfo& info );
+    std::expected<PipelineHandle, std::string> install_pipeline( PipelineState& state,
+                                                                 std::expected<PipelineState, std::string> build );
+    ThreadPool& compile_workers();
+    void queue_compile( uint32_t id, const PipelineInfo& info );
+
     // Shader processing, if string is returned - an error state has been set.
-    std::optional<std::string> compile_module( const ShaderCompileInfo& info );
-    std::optional<std::string> compile_spirv( const ShaderCompileInfo& info, std::vector<uint32_t>& spirv );
-    std::optional<std::string> update_shader_dependency_graph( const ShaderCompileInfo& info );
+    std::optional<std::string> compile_module( SlangContext& context,
+                                               const ShaderCompileInfo& info,
+                                               SlangModule& module );
+    std::optional<std::string> compile_spirv( SlangContext& context,
+                                              const ShaderCompileInfo& info,
+                                              const SlangModule& module,
+                                              std::vector<uint32_t>& spirv );
+    std::optional<std::string> update_shader_dependency_graph( const ShaderCompileInfo& info,
+                                                               const std::vector<std::string>& dependency_files );
 
     void recompile_dependents( const std::vector<std::string>& shader_paths );
-    void reflect_module( const ShaderCompileInfo& info, CompiledShaderState& state );
+    void reflect_module( const ShaderCompileInfo& info, const SlangModule& module, CompiledShaderState& state );
 
     void create_global_descriptor_layout();
-    std::expected<CompiledShaderState, std::string> get_compiled_shader( const ShaderCompileInfo& info );
+    void create_pipeline_cache();
+
+    // Keyed by the defines of the build using `context`. On a hit, `load_cached_shader` fills in `state` and returns
+    // true. `make_cache_entry` serialises a shader built through Slang, hashing the files as Slang loaded them, or
+    // returns an empty entry if any of them were not loaded by this build. `store_cached_shader` writes the entry.
+    std::filesystem::path get_shader_cache_path( const SlangContext& context, const ShaderCompileInfo& info ) const;
+    bool load_cached_shader( const SlangContext& context, const ShaderCompileInfo& info, CompiledShaderState& state );
+    std::string make_cache_entry( const SlangContext& context, const CompiledShaderState& state ) const;
+    void store_cached_shader( CompiledShaderState& state ) const;
+    std::expected<CompiledShaderState, std::string> get_compiled_shader( SlangContext& context,
+                                                                         const ShaderCompileInfo& info );
     std::expected<UniformBlock, std::string> get_uniform_block( const std::vector<CompiledShaderState>& shaders );
     std::expected<VkPipelineLayout, std::string> get_pipeline_layout( const std::vector<CompiledShaderState>& shaders );
 };
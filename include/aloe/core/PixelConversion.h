@@ -0,0 +1,70 @@
+#pragma once
+
+#include <volk.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace aloe {
+class ThreadPool;
+
+// Layouts source images arrive in, tightly packed. Integer channels are unsigned normalized.
+enum class PixelLayout : uint32_t {
+    RGB8,
+    RGBA8,
+    RGB16,
+    RGBA16,
+    RGB32F,
+    RGBA32F,
+};
+
+// Bytes per texel of `layout`
+uint32_t pixel_size( PixelLayout layout );
+
+enum class MipFilter : uint32_t {
+    // Averages each 2x2 quad, cheap but soft and prone to aliasing
+    Box,
+    // Kaiser windowed sinc spanning 3 texels of the smaller mip either side, keeps more detail
+    Kaiser,
+};
+
+// Converts texels between layouts and filters mip chains on the CPU, working on linear RGBA floats in between. Hot
+// loops use SSSE3, SSE4.1, AVX2 and F16C where the CPU has them (results match the scalar path bit for bit, except
+// for NaN payloads), and images large enough to pay for it are split across `workers`.
+//
+// Functions taking a source and destination return false (after logging) if their sizes do not match.
+class PixelConverter {
+    ThreadPool* workers_ = nullptr;
+    bool simd_ = true;
+
+public:
+    // `simd = false` forces the scalar path on every CPU, e.g. to compare against it
+    explicit PixelConverter( ThreadPool* workers = nullptr, bool simd = true );
+
+    bool rgb8_to_rgba8( std::span<const uint8_t> rgb, std::span<uint8_t> rgba ) const;
+
+    // Rounds to the nearest half, values beyond its range become infinities
+    bool float_to_half( std::span<const float> values, std::span<uint16_t> halves ) const;
+    bool half_to_float( std::span<const uint16_t> halves, std::span<float> values ) const;
+
+    // Converts the colour channels of RGBA floats from the sRGB transfer function to linear and back, alpha is linear
+    // in both and left untouched.
+    void srgb_to_linear( std::span<float> rgba ) const;
+    void linear_to_srgb( std::span<float> rgba ) const;
+
+    void premultiply_alpha( std::span<float> rgba ) const;
+
+    // Unpacks texels of `layout` into RGBA floats, a missing alpha channel is 1. `srgb` sources are linearized (8 bit
+    // sources through a table).
+    bool to_rgba32f( std::span<const uint8_t> texels, PixelLayout layout, bool srgb, std::span<float> rgba ) const;
+    // Packs RGBA floats into `format`, one of `VK_FORMAT_R8G8B8A8_UNORM`, `_SRGB` (encoded with the sRGB transfer
+    // function), `VK_FORMAT_R16G16B16A16_SFLOAT` or `VK_FORMAT_R32G32B32A32_SFLOAT`. Normalized formats are clamped.
+    bool from_rgba32f( std::span<const float> rgba, VkFormat format, std::span<uint8_t> texels ) const;
+
+    // The next mip of an image of RGBA floats, half the size (down to 1) in each dimension. Texels past the edges
+    // repeat the edge texel.
+    std::vector<float> downsample( std::span<const float> rgba, VkExtent2D extent, MipFilter filter ) const;
+};
+
+}// namespace aloe
@@ -1,16 +1,27 @@
 #pragma once
 
 #include <aloe/core/Handles.h>
+#include <aloe/core/PixelConversion.h>
+#include <aloe/util/hash.h>
+#include <aloe/util/sharded_map.h>
+#include <aloe/util/thread_pool.h>
 
 #include <vma/vma.h>
 #include <volk.h>
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace aloe {
@@ -22,18 +33,239 @@ struct BufferDesc {
     VkBufferUsageFlags usage = 0;
     VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_AUTO;
     VmaAllocationCreateFlags memory_flags = 0;
+    // Properties the memory type must have, e.g. `VK_MEMORY_PROPERTY_HOST_COHERENT_BIT` so writes through a mapping
+    // need no flush
+    VkMemoryPropertyFlags required_memory_properties = 0;
+    // If set, the buffer is allocated from this pool, whose memory type takes precedence over `memory_usage` (and
+    // `required_memory_properties`)
+    MemoryPoolHandle memory_pool = {};
     const char* name = {};
+    // The subsystem owning the buffer (e.g. "Terrain", "Shadows"), memory is accounted per name and per category
+    const char* category = {};
+
+    // If set, the buffer is sub-allocated from a pool made with `ResourceManager::create_buffer_pool` instead of
+    // receiving its own `VkBuffer`; `usage` and the memory properties are inherited from the pool.
+    BufferHandle parent = {};
+};
+
+// The range of a `VkBuffer` which a `BufferHandle` refers to.
+struct BufferRange {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+};
+
+// `size` bytes starting `offset` bytes into `buffer`, read into `out_data` by `ResourceManager::read_from_buffers`.
+struct BufferReadback {
+    BufferHandle buffer = {};
+    void* out_data = nullptr;
+    VkDeviceSize size = 0;
+    VkDeviceSize offset = 0;
 };
 
 struct ImageDesc {
+    VkImageType type = VK_IMAGE_TYPE_2D;
     VkExtent3D extent = {};
     VkFormat format = VK_FORMAT_UNDEFINED;
     VkImageUsageFlags usage = 0;
     VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL;
     VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_AUTO;
     VmaAllocationCreateFlags memory_flags = 0;
+    // If set, the image is allocated from this pool, whose memory type takes precedence over `memory_usage`
+    MemoryPoolHandle memory_pool = {};
     uint32_t mip_levels = 1;
+    // Cube maps are 2D images with `VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT` and a multiple of 6 layers
+    uint32_t array_layers = 1;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+    VkImageCreateFlags flags = 0;
+    // If set, `upload_to_image` takes 8 bit RGBA texels and block compresses their first `compress_channels` (1 to 4)
+    // channels on the CPU, generating the mip chain as it goes. `format` is either the BC format to encode to, or an
+    // RGBA8 format which is replaced on creation by the one picked for the channel count (see `compressed_format`).
+    // Images in BC formats can only be created on devices with the `textureCompressionBC` feature.
+    uint32_t compress_channels = 0;
+    const char* name = {};
+    const char* category = {};
+};
+
+// Bytes of every array layer of `mip` of an image of `desc`, tightly packed, or 0 if the size of its format is not
+// known
+VkDeviceSize mip_size( const ImageDesc& desc, uint32_t mip );
+
+// How `import_to_image` interprets source texels before converting them to the format of the image
+struct ImageImportDesc {
+    PixelLayout layout = PixelLayout::RGBA8;
+    // The colour channels are sRGB encoded, and are linearized before filtering
+    bool srgb = false;
+    bool premultiply_alpha = false;
+    MipFilter mip_filter = MipFilter::Box;
+};
+
+// A box of texels within one mip of an image, and where those texels lie in host memory.
+struct ImageRegion {
+    VkOffset3D offset = {};
+    VkExtent3D extent = {};
+    uint32_t mip_level = 0;
+    uint32_t base_array_layer = 0;
+    uint32_t layer_count = 1;
+    // Bytes from the start of the host data to the first texel of the region
+    VkDeviceSize data_offset = 0;
+    // Texels per row and rows per layer of the host data, 0 means tightly packed to `extent`
+    uint32_t row_length = 0;
+    uint32_t image_height = 0;
+};
+
+struct SamplerDesc {
+    VkFilter mag_filter = VK_FILTER_LINEAR;
+    VkFilter min_filter = VK_FILTER_LINEAR;
+    VkSamplerMipmapMode mipmap_mode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    VkSamplerAddressMode address_mode_u = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    VkSamplerAddressMode address_mode_v = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    VkSamplerAddressMode address_mode_w = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    float mip_lod_bias = 0.0f;
+    // Anisotropic filtering is enabled for values above 1, if the device supports it
+    float max_anisotropy = 1.0f;
+    // Depth comparison (e.g. for shadow maps) is enabled for anything other than `VK_COMPARE_OP_NEVER`
+    VkCompareOp compare_op = VK_COMPARE_OP_NEVER;
+    float min_lod = 0.0f;
+    float max_lod = VK_LOD_CLAMP_NONE;
+    VkBorderColor border_color = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+
+    auto operator<=>( const SamplerDesc& ) const = default;
+};
+
+// VMA 3 removed its buddy allocator, so there is no buddy option: `Default` is VMA's TLSF (two-level segregated fit)
+// allocator, which also serves allocations outside of any pool.
+enum class MemoryPoolAlgorithm {
+    // TLSF, for resources freed in any order
+    Default,
+    // Bump allocation, for resources freed in (reverse) allocation order such as per-level or ring buffer data
+    Linear,
+};
+
+struct MemoryPoolDesc {
+    // The memory type of the pool is chosen for resources with these usages and memory properties, only one of the
+    // buffer or image usage should be set.
+    VkBufferUsageFlags buffer_usage = 0;
+    VkImageUsageFlags image_usage = 0;
+    VkFormat image_format = VK_FORMAT_R8G8B8A8_UNORM;
+    VmaMemoryUsage memory_usage = VMA_MEMORY_USAGE_AUTO;
+    VmaAllocationCreateFlags memory_flags = 0;
+
+    // 0 uses VMA's preferred block size
+    VkDeviceSize block_size = 0;
+    // Blocks created up front and never released, and the cap on blocks (0 is unlimited), which bounds the memory the
+    // pool can ever use to `block_size * max_block_count`
+    size_t min_block_count = 0;
+    size_t max_block_count = 0;
+    MemoryPoolAlgorithm algorithm = MemoryPoolAlgorithm::Default;
+    const char* name = {};
+};
+
+struct LinearAllocatorDesc {
+    // Capacity of each frame slot, allocations which do not fit in the remainder of the slot fail
+    VkDeviceSize size_per_frame = 4 * 1024 * 1024;
+    // Number of frame slots; a slot is reset `frames_in_flight` frames after it was last used
+    uint32_t frames_in_flight = 2;
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    const char* name = "Linear Allocator";
+};
+
+// A transient allocation, valid until the frame it was made in retires.
+struct LinearAllocation {
+    void* data = nullptr;// Persistently mapped pointer to the start of the allocation
+    BufferHandle buffer = {};
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    // Can be written directly to a `aloe::BufferHandle` uniform, already offset to the allocation
+    GpuBufferHandle gpu_handle = {};
+    // Device address of the allocation, 0 unless `DeviceSettings::buffer_device_address` is set
+    VkDeviceAddress address = 0;
+};
+
+struct HeapStatistics {
+    VkMemoryHeapFlags flags = 0;
+    // Estimated bytes the process may use from this heap, and the bytes it currently uses (from `VK_EXT_memory_budget`)
+    VkDeviceSize budget = 0;
+    VkDeviceSize usage = 0;
+    // Bytes in `VkDeviceMemory` blocks allocated by VMA, and the bytes of those blocks handed out to resources
+    VkDeviceSize block_bytes = 0;
+    VkDeviceSize allocation_bytes = 0;
+    uint32_t block_count = 0;
+    uint32_t allocation_count = 0;
+};
+
+struct MemoryPoolStatistics {
+    MemoryPoolHandle pool = {};
     const char* name = {};
+    uint32_t memory_type = 0;
+    VkDeviceSize block_bytes = 0;
+    VkDeviceSize allocation_bytes = 0;
+    uint32_t block_count = 0;
+    uint32_t allocation_count = 0;
+};
+
+struct MemoryStatistics {
+    // Frame index the statistics were gathered on
+    uint64_t frame_index = 0;
+    std::vector<HeapStatistics> heaps = {};
+    // Custom pools are also included in the statistics of the heap they allocate from
+    std::vector<MemoryPoolStatistics> pools = {};
+};
+
+// Memory held by the resources sharing a name or a category (see `ResourceManager::memory_accounts`)
+struct MemoryAccount {
+    std::string key = {};
+    // Bytes held by live resources, and the most they have held at once
+    VkDeviceSize bytes = 0;
+    VkDeviceSize peak_bytes = 0;
+    uint32_t live_resources = 0;
+    // Resources created over the lifetime of the `ResourceManager`
+    uint64_t total_resources = 0;
+};
+
+struct MemoryAccounts {
+    std::vector<MemoryAccount> names = {};
+    std::vector<MemoryAccount> categories = {};
+};
+
+struct StreamingSettings {
+    // Bytes the backing images of streamed images may use before the least recently requested mips are evicted
+    VkDeviceSize budget = 256 * 1024 * 1024;
+    // Threads which run `StreamedImageDesc::load_mip`
+    uint32_t worker_threads = 2;
+    // Entries in the feedback buffer, and so the number of streamed images which can be alive at once
+    uint32_t max_streamed_images = 4096;
+    // Mip loads which may be in flight at once
+    uint32_t max_pending_loads = 16;
+};
+
+struct StreamedImageDesc {
+    // The full mip chain, `TRANSFER_SRC` and `TRANSFER_DST` usage are added as mips are copied between backing images
+    ImageDesc image = {};
+    // The least detailed mips, which are loaded by `create_streamed_image` and are never evicted
+    uint32_t resident_mips = 1;
+    // Returns the tightly packed texels of every array layer of `mip`, or nothing if it could not be loaded. Called
+    // from the streaming worker threads, so must be safe to call concurrently.
+    std::function<std::vector<uint8_t>( uint32_t mip )> load_mip = {};
+};
+
+struct StreamingStatistics {
+    VkDeviceSize budget = 0;
+    VkDeviceSize resident_bytes = 0;
+    uint32_t streamed_images = 0;
+    uint32_t pending_loads = 0;
+    uint64_t mips_streamed_in = 0;
+    uint64_t mips_evicted = 0;
+};
+
+struct DefragmentationResult {
+    uint32_t passes = 0;
+    uint32_t moved_allocations = 0;
+    VkDeviceSize bytes_moved = 0;
+    VkDeviceSize bytes_freed = 0;
+    uint32_t blocks_freed = 0;
+    // Set once there is nothing left to move, further calls will be no-ops until memory fragments again
+    bool complete = false;
 };
 
 class ResourceManager {
@@ -54,22 +286,35 @@ class ResourceManager {
         std::optional<std::pair<uint32_t, uint32_t>>
         allocate_slot( const std::variant<VkDescriptorBufferInfo, VkDescriptorImageInfo>& resource );
 
-        // Frees a slot and stages a null descriptor write
+        // Frees a slot, dropping any write still staged for it
         void free_slot( uint32_t slot );
 
-        // Version tracking
+        // Stages a write pointing an allocated slot at a new resource, keeping its version (handles remain valid)
+        void update_slot( uint32_t slot, const std::variant<VkDescriptorBufferInfo, VkDescriptorImageInfo>& resource );
+
+        // Version tracking, lock free
         uint32_t get_slot_version( uint32_t slot ) const;
         bool validate_slot( uint32_t slot, uint32_t version ) const;
 
-        // Apply all pending writes to a descriptor set
+        // Points the allocator at its binding within a mapped descriptor buffer, which `bind_slots` then writes to
+        void set_descriptor_buffer( uint8_t* binding_data, size_t descriptor_size );
+
+        // Apply all pending writes to a descriptor set, or to the descriptor buffer if one has been set
         void bind_slots( VkDevice device, VkDescriptorSet set );
 
     private:
+        void stage_write( uint32_t slot, const std::variant<VkDescriptorBufferInfo, VkDescriptorImageInfo>& resource );
+        void write_descriptors( VkDevice device );
+
         const VkDescriptorType type_;
         const uint32_t max_slots_;
+        uint8_t* binding_data_ = nullptr;
+        size_t descriptor_size_ = 0;
 
+        // Guards `free_slots_` and `pending_writes_`, slots are allocated and freed from any thread
+        std::mutex mutex_;
         std::vector<uint32_t> free_slots_;
-        std::vector<uint32_t> versions_;
+        std::vector<std::atomic<uint32_t>> versions_;
         std::vector<PendingWrite> pending_writes_;
     };
 
@@ -85,18 +330,196 @@ class ResourceManager {
         VmaAllocation allocation = VK_NULL_HANDLE;
         ResourceDescT desc = {};
 
+        // Sub-allocated buffers alias the `resource` & `allocation` of their pool, and occupy `offset` onwards.
+        VkDeviceSize offset = 0;
+        VmaVirtualAllocation sub_allocation = VK_NULL_HANDLE;
+        // Device address of `resource` (not including `offset`), 0 if buffer device addresses are not enabled
+        VkDeviceAddress address = 0;
+        // Resources made by `create_buffers`/`create_images` share `allocation`, and are bound at this offset within it
+        VkDeviceSize allocation_offset = 0;
+        // Bytes counted against the name & category of the resource in the memory accounts
+        VkDeviceSize accounted_bytes = 0;
+        // The layout an image rests in between submissions, `VK_IMAGE_LAYOUT_UNDEFINED` until it has been written to.
+        // Set by the manager's uploads, and by `set_image_layout` for images transitioned elsewhere.
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
         std::map<ResourceUsage, BoundResource> bound_resources = {};
     };
 
+    // One persistently mapped, host-visible buffer per frame slot; allocations bump `head`.
+    struct LinearFrame {
+        BufferHandle buffer = {};
+        uint8_t* mapped = nullptr;
+        uint64_t bound_id = 0;
+        VkDeviceAddress address = 0;
+        std::atomic<VkDeviceSize> head = 0;
+    };
+
+    // Persistently mapped buffer holding the bindless table when `VK_EXT_descriptor_buffer` is enabled
+    struct DescriptorHeap {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        VkDeviceAddress address = 0;
+        VkBufferUsageFlags usage = 0;
+    };
+
+    struct MemoryPool {
+        VmaPool pool = VK_NULL_HANDLE;
+        uint32_t memory_type = 0;
+        MemoryPoolDesc desc = {};
+    };
+
+    // A resource of a `create_buffers`/`create_images` batch, and where it was placed
+    struct BatchMember {
+        size_t index = 0;
+        VkMemoryRequirements requirements = {};
+        uint32_t memory_type = 0;
+        VmaAllocationCreateFlags flags = 0;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+    };
+
+    // A resource which is being moved by a defragmentation pass, and the resource replacing it
+    struct MovedResource {
+        uint64_t id = 0;
+        VkDeviceSize size = 0;
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkImage image = VK_NULL_HANDLE;
+    };
+
+    // An image with a partially resident mip chain, backed by the image in `images_` which holds only the mips from
+    // `first_resident_mip` onwards.
+    struct StreamedImage {
+        ImageDesc desc = {};// Description of the full mip chain
+        std::function<std::vector<uint8_t>( uint32_t mip )> load_mip = {};
+        uint32_t index = 0;// Entry in the feedback buffer
+        uint32_t max_first_mip = 0;
+        uint32_t first_resident_mip = 0;
+        uint32_t requested_mip = 0;
+        uint64_t last_requested_frame = 0;
+        VkDeviceSize resident_bytes = 0;
+        // Set while the backing image is being replaced without `streaming_mutex_` held, a `free_image` meanwhile is
+        // deferred until the replacement is done
+        bool resizing = false;
+        bool free_pending = false;
+
+        // Mips which have been loaded but are not resident yet, and the mips which are being loaded
+        std::map<uint32_t, std::vector<uint8_t>> loaded_mips = {};
+        std::vector<bool> loading = {};
+    };
+
+    // Identifies the contents of a resource made by `create_shared_buffer`/`create_shared_image`, the category is kept
+    // in the key so memory is never accounted against another subsystem
+    struct SharedKey {
+        Hash128 desc = {};
+        Hash128 data = {};
+        std::string category = {};
+
+        auto operator<=>( const SharedKey& other ) const = default;
+    };
+
+    struct SharedResource {
+        SharedKey key = {};
+        uint32_t references = 0;
+    };
+
+    // A change of the resident mips of a streamed image, taken from its `StreamedImage` under `streaming_mutex_` so the
+    // replacement can be created and copied to without the lock
+    struct StreamedResize {
+        ImageHandle handle = {};
+        ImageDesc desc = {};// Description of the replacement, which holds the mips from `first_mip` onwards
+        uint32_t first_mip = 0;
+        uint32_t old_first_mip = 0;
+        // The backing image being replaced, `VK_NULL_HANDLE` for the first backing image of a streamed image
+        VkImage old_resource = VK_NULL_HANDLE;
+        ImageDesc old_desc = {};
+        VkImageLayout old_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        // The layout the replacement is left in, that of the usages bound to the image
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        // Mips which were not resident before, uploaded to the replacement
+        std::map<uint32_t, std::vector<uint8_t>> uploads = {};
+
+        VkImage resource = VK_NULL_HANDLE;
+        VmaAllocation allocation = VK_NULL_HANDLE;
+    };
+
+    // A mip handed back by a streaming worker
+    struct LoadedMip {
+        ImageHandle handle = {};
+        uint32_t mip = 0;
+        std::vector<uint8_t> data = {};
+    };
+
     Device& device_;
     VmaAllocator allocator_;
 
-    uint32_t current_resource_id_ = 1;
+    std::atomic<uint32_t> current_resource_id_ = 1;
     DescriptorSlotAllocator storage_buffer_allocator_;
     DescriptorSlotAllocator storage_image_allocator_;
-
-    std::unordered_map<BufferHandle, AllocatedResource<VkBuffer, BufferDesc>> buffers_;
-    std::unordered_map<ImageHandle, AllocatedResource<VkImage, ImageDesc>> images_;
+    DescriptorSlotAllocator sampled_image_allocator_;
+    DescriptorSlotAllocator sampler_allocator_;
+    DescriptorHeap descriptor_heap_ = {};
+
+    // Looked up on every bind, sharded so resources can be created & freed on other threads without stalling lookups
+    ShardedMap<BufferHandle, AllocatedResource<VkBuffer, BufferDesc>> buffers_;
+    ShardedMap<ImageHandle, AllocatedResource<VkImage, ImageDesc>> images_;
+
+    // Guards the bookkeeping resources share, which is only touched when creating or freeing them: `buffer_pools_`,
+    // `memory_pools_`, `shared_allocations_` & `samplers_`
+    mutable std::mutex allocation_mutex_;
+    std::unordered_map<BufferHandle, VmaVirtualBlock> buffer_pools_;
+    // Samplers are immutable and live as long as the `ResourceManager`, identical descriptions share a sampler
+    std::map<SamplerDesc, std::pair<VkSampler, SamplerHandle>> samplers_;
+    std::map<MemoryPoolHandle, MemoryPool> memory_pools_;
+    // Allocations shared by several resources, and the number of resources still bound to them
+    std::unordered_map<VmaAllocation, uint32_t> shared_allocations_;
+
+    uint64_t frame_index_ = 0;
+
+    MemoryStatistics memory_statistics_ = {};
+    float budget_warning_threshold_ = 0.9f;
+    std::vector<bool> heaps_over_threshold_ = {};
+    VkDeviceSize linear_frame_size_ = 0;
+    uint32_t linear_frame_count_ = 0;
+    std::unique_ptr<LinearFrame[]> linear_frames_ = nullptr;
+
+    // Guards `name_accounts_` & `category_accounts_`, which are updated as resources are created and freed
+    mutable std::mutex accounts_mutex_;
+    std::unordered_map<std::string, MemoryAccount> name_accounts_;
+    std::unordered_map<std::string, MemoryAccount> category_accounts_;
+
+    // Guards `shared_ids_` & `shared_resources_`, the resource id holding each shared content and the references held
+    // to each shared resource
+    std::mutex shared_mutex_;
+    std::map<SharedKey, uint64_t> shared_ids_;
+    std::unordered_map<uint64_t, SharedResource> shared_resources_;
+
+    // Guards the `bound_resources` of every resource, a shared resource or sub-allocation pool is bound by each holder
+    std::mutex bindings_mutex_;
+
+    // Guards `mip_warnings_`, the reasons uploads could not generate mips which have already been logged
+    std::mutex mip_warnings_mutex_;
+    std::unordered_set<std::string> mip_warnings_;
+
+    // Convert and encode texels of image uploads and imports on the CPU, started by the first of them
+    std::once_flag image_workers_started_;
+    std::unique_ptr<ThreadPool> image_workers_ = nullptr;
+
+    // Guards the streaming bookkeeping below, as streamed images may be created, bound and freed on other threads than
+    // the one calling `update_streaming`
+    mutable std::mutex streaming_mutex_;
+    StreamingSettings streaming_settings_ = {};
+    StreamingStatistics streaming_statistics_ = {};
+    std::unordered_map<ImageHandle, StreamedImage> streamed_images_;
+    std::vector<uint32_t> free_streaming_indices_;
+    // Persistently mapped `{ requested mip, resident mip }` pairs, one per streamed image
+    BufferHandle streaming_buffer_ = {};
+    uint32_t* streaming_feedback_ = nullptr;
+    // Guards `loaded_mips_`, which the workers append to without waiting on `streaming_mutex_`
+    std::mutex loaded_mips_mutex_;
+    std::vector<LoadedMip> loaded_mips_;
+    // Declared last, so the workers are stopped before anything they write to is destroyed
+    std::unique_ptr<ThreadPool> streaming_workers_ = nullptr;
 
 public:
     ~ResourceManager();
@@ -107,23 +530,185 @@ public:
     ResourceManager( ResourceManager&& ) = delete;
     ResourceManager& operator=( ResourceManager&& other ) = delete;
 
+    // Resources can be created, looked up, bound and freed from any thread. Calls naming the same resource (binding,
+    // uploading to or freeing it) must still be externally synchronized, and streaming, defragmentation and
+    // `next_frame` must stay on a single thread.
     BufferHandle create_buffer( const BufferDesc& desc );
     ImageHandle create_image( const ImageDesc& desc );
 
+    // Creates many resources at once, packing those with compatible memory requirements into a few large allocations.
+    // Handles are returned in the order of `descs`, and are null for any description which failed. Batched resources
+    // can be freed individually, but are never moved by defragmentation. Images which are attachments or linearly
+    // tiled are created individually, so they can still receive dedicated allocations.
+    std::vector<BufferHandle> create_buffers( std::span<const BufferDesc> descs );
+    std::vector<ImageHandle> create_images( std::span<const ImageDesc> descs );
+
+    // Creates a resource holding `size` bytes of `data` (uploaded as by `stage_to_buffer`/`upload_to_image`), or
+    // returns the one already created from identical bytes and an identical description (ignoring `name`), so content
+    // which is referenced many times is only stored and uploaded once. Contents are identified by their category and
+    // 128 bit hashes of the bytes and description, no copy of the bytes is kept: two different contents sharing both
+    // hashes is far less likely than the memory holding them failing. Shared resources are reference counted: each call
+    // must be matched by a `free_buffer` or `free_image`, the last of which destroys the resource.
+    //
+    // Every holder gets the same handle, so they alias one resource: they must not write to it after creation, and
+    // binding it (`bind_resource`) updates the descriptor slot seen by every holder. Like other handles, a shared
+    // handle must not be bound from several threads at once, holders on different threads must serialise their binds.
+    BufferHandle create_shared_buffer( const BufferDesc& desc, const void* data, VkDeviceSize size );
+    ImageHandle create_shared_image( const ImageDesc& desc, const void* data, VkDeviceSize size );
+
+    // Creates a large backing buffer which buffers can be sub-allocated from (see `BufferDesc::parent`), all
+    // sub-allocations share a single allocation and descriptor slot.
+    BufferHandle create_buffer_pool( const BufferDesc& desc );
+
+    // Creates a custom VMA pool with its own blocks, so a category of resources (e.g. render targets, streamed
+    // textures) is kept apart from the rest and its memory can be capped with `max_block_count`.
+    MemoryPoolHandle create_memory_pool( const MemoryPoolDesc& desc );
+    // Pools can only be freed once every resource allocated from them has been freed.
+    bool free_memory_pool( MemoryPoolHandle handle );
+
+    // (Re)creates the per-frame linear allocator used by `allocate_transient`. Frame slots are host coherent, so
+    // writes through `LinearAllocation::data` need no flush, and hold at most 4GiB as allocations are addressed by the
+    // 32 bit offset & size of a `GpuBufferHandle`.
+    bool create_linear_allocator( const LinearAllocatorDesc& desc );
+
+    // Bumps the current frame slot of the linear allocator, safe to call from multiple threads. Returns `nullopt` if
+    // the slot has no space left.
+    std::optional<LinearAllocation> allocate_transient( VkDeviceSize size, VkDeviceSize alignment = 16 );
+
+    // Advances to the next frame slot, resetting it. The work which last used that slot (`frames_in_flight` frames ago)
+    // must have completed, `TaskGraph::execute` calls this once the frame it submitted has finished.
+    void next_frame();
+    uint64_t frame_index() const { return frame_index_; }
+
+    // Per-heap budget and allocator statistics, refreshed by `next_frame` (or `update_memory_statistics`).
+    const MemoryStatistics& memory_statistics() const { return memory_statistics_; }
+    void update_memory_statistics();
+
+    // Memory held by live resources per `name` and per `category` of their descriptions, each sorted by descending
+    // bytes. Resources count the bytes of their memory requirements, except sub-allocated buffers which are part of
+    // their pool and count none themselves. Resources still alive when the `ResourceManager` is destroyed are reported
+    // as leaks, by name and category.
+    MemoryAccounts memory_accounts() const;
+    // Logs `memory_accounts`, one line per category and name
+    void dump_memory_accounts() const;
+
+    // Logs a warning whenever the usage of a heap crosses `fraction` of its budget, 0.9 by default.
+    void set_budget_warning_threshold( float fraction );
+
+    // Compacts VMA's memory blocks in small passes until `time_budget` is spent or nothing is left to move. Moved
+    // resources keep their handles and descriptor slots, the slots are rewritten on the next `bind_slots`. Must not be
+    // called while submitted work is using the resources (e.g. call it between `TaskGraph::execute` calls).
+    // Persistently mapped buffers and buffers with a device address are never moved, and images are only moved if they
+    // are colour images with `TRANSFER_SRC` and `TRANSFER_DST` usage which have been written to. They are copied out of
+    // the layout recorded for them (see `set_image_layout`), which their replacement is left in. Attachments, and
+    // depth and stencil images, stay put as render passes transition them without recording their layout.
+    DefragmentationResult defragment( std::chrono::microseconds time_budget );
+
+    // Starts the streaming workers and creates the feedback buffer. Streamed images only keep their least detailed mips
+    // resident, more detailed mips are loaded in the background once requested (by `request_image_mip`, or by shaders
+    // through `aloe::request_streamed_mip`) and the least recently requested are evicted while over the budget.
+    // Streamed images may be created, requested, bound and freed on any thread, alongside `update_streaming`.
+    bool enable_streaming( const StreamingSettings& settings = {} );
+    void set_streaming_budget( VkDeviceSize budget );
+
+    // The handle, and the descriptor slots of its views, stay valid while the backing image is swapped for one with
+    // more or fewer mips. Views only cover resident mips, so shaders see the most detailed resident mip as mip 0.
+    ImageHandle create_streamed_image( const StreamedImageDesc& desc );
+    // Requests that mips from `mip` onwards become resident, and marks the image as used this frame
+    void request_image_mip( ImageHandle handle, uint32_t mip );
+    // The most detailed mip which is resident, `nullopt` if `handle` is not a streamed image
+    std::optional<uint32_t> resident_mip( ImageHandle handle ) const;
+    // The entry of the image in `streaming_buffer`, passed to `aloe::request_streamed_mip` by shaders
+    std::optional<uint32_t> streaming_index( ImageHandle handle ) const;
+    BufferHandle streaming_buffer() const { return streaming_buffer_; }
+
+    // Reads the requests written by shaders, swaps in loaded mips, starts new loads and evicts mips while over budget.
+    // Called by `next_frame`. Like `defragment`, it must not be called while submitted work is using streamed images.
+    // Mips are copied out of the layout the image rests in (see `set_image_layout`), and the replacement is left in
+    // the layout its bound usages declare, so their descriptors stay valid. The copies are waited on without holding
+    // the streaming lock, so streamed images can still be created, requested and bound meanwhile.
+    void update_streaming();
+    StreamingStatistics streaming_statistics() const;
+
+    // Returns the sampler for `desc`, creating it on first use.
+    SamplerHandle create_sampler( const SamplerDesc& desc );
+
     // Makes a resource binding for `usage` and returns the slot for the resource.
     std::optional<uint64_t> bind_resource( ResourceUsage usage );
 
-    // Returns the number of bytes written
-    VkDeviceSize upload_to_buffer( BufferHandle handle, const void* data, VkDeviceSize size );
-    VkDeviceSize read_from_buffer( BufferHandle handle, void* out_data, VkDeviceSize bytes_to_read );
-
+    // Returns the number of bytes written (or read), starting `offset` bytes into the buffer. Buffers written to must
+    // have host access, buffers without it are read through a staging buffer, so they can stay in device local memory.
+    VkDeviceSize upload_to_buffer( BufferHandle handle, const void* data, VkDeviceSize size, VkDeviceSize offset = 0 );
+    // As `upload_to_buffer`, but buffers without host access (e.g. device local ones) are written through a staging
+    // buffer and a transfer submission, which is waited on. The buffer must not be in use by the GPU.
+    VkDeviceSize stage_to_buffer( BufferHandle handle, const void* data, VkDeviceSize size, VkDeviceSize offset = 0 );
+    VkDeviceSize read_from_buffer( BufferHandle handle,
+                                   void* out_data,
+                                   VkDeviceSize bytes_to_read,
+                                   VkDeviceSize offset = 0 );
+    // Reads every range in one go, ranges of buffers without host access share a single staging buffer and
+    // submission. Returns the total number of bytes read, empty ranges and ranges of invalid buffers read nothing.
+    VkDeviceSize read_from_buffers( std::span<const BufferReadback> reads );
+
+    // Uploads `data` to mip level 0. Images with `mip_levels > 1` and `VK_IMAGE_USAGE_TRANSFER_SRC_BIT` usage have the
+    // rest of their mip chain generated from it. Images with `compress_channels` take RGBA8 texels for every layer of
+    // mip 0, which are encoded (along with the rest of the mip chain) across worker threads before being uploaded.
+    //
+    // When the device has `VK_EXT_host_image_copy` and lists `VK_IMAGE_LAYOUT_GENERAL` for host copies, images with
+    // transfer usage are also created with host transfer usage, and uploads & readbacks of their full mips are copied
+    // by the CPU without staging. The image must not be in use by the GPU, as with the staged path which waits for its
+    // own submission; readbacks wait for the queues which could have written to it.
     VkDeviceSize upload_to_image( ImageHandle handle, const void* data, VkDeviceSize size );
     VkDeviceSize read_from_image( ImageHandle handle, void* out_data, VkDeviceSize bytes_to_read );
+    // Converts source texels (every layer of mip 0, laid out as `import` describes) into the format of the image, and
+    // uploads them along with the rest of the mip chain filtered from them in linear space, all on the CPU across
+    // worker threads. The image must be a single sampled 2D image of `VK_FORMAT_R8G8B8A8_UNORM`, `_SRGB`,
+    // `VK_FORMAT_R16G16B16A16_SFLOAT`, `VK_FORMAT_R32G32B32A32_SFLOAT` or a format the block encoder produces. Returns
+    // `size`, or 0 if it does not match the layout.
+    VkDeviceSize import_to_image( ImageHandle handle,
+                                  const void* data,
+                                  VkDeviceSize size,
+                                  const ImageImportDesc& import );
+    // Copies `regions` of `data` (`size` bytes) into an image which has already been uploaded to, leaving the rest of
+    // its contents intact; every region is copied by a single command. Returns `size`, or 0 if any region does not
+    // fit in the image or the data. Formats must be colour formats with a known texel size, offsets into the data be
+    // multiples of 4, and regions of 3D images a single layer. Staged copies must also be aligned to the transfer
+    // queue's `minImageTransferGranularity`. The image is expected to rest in `VK_IMAGE_LAYOUT_GENERAL`.
+    VkDeviceSize upload_image_regions( ImageHandle handle,
+                                       const void* data,
+                                       VkDeviceSize size,
+                                       std::span<const ImageRegion> regions );
+    // Reads `regions` of an image into `out_data` (`size` bytes), bytes outside of the regions are left untouched
+    VkDeviceSize read_image_regions( ImageHandle handle,
+                                     void* out_data,
+                                     VkDeviceSize size,
+                                     std::span<const ImageRegion> regions );
+    // Uploads a pre-generated mip chain in one copy, mip `i` (every array layer, tightly packed) starts at
+    // `mip_offsets[i]` within `data`. Offsets must be multiples of 4 and of the texel size, and every mip must lie
+    // within `size` bytes, so the format must have a known size.
+    VkDeviceSize upload_mips_to_image( ImageHandle handle,
+                                       const void* data,
+                                       VkDeviceSize size,
+                                       std::span<const VkDeviceSize> mip_offsets );
+
+    // Regenerates mip levels 1..N by successively downsampling level 0 (e.g. after a shader has written to it). The
+    // image must be in `VK_IMAGE_LAYOUT_GENERAL` and have `VK_IMAGE_USAGE_TRANSFER_SRC_BIT` usage.
+    bool generate_mips( ImageHandle handle );
 
     VkBuffer get_buffer( BufferHandle handle ) const;
+    BufferRange get_buffer_range( BufferHandle handle ) const;
+    // The address shaders can dereference as a pointer to the start of the buffer (including the offset of
+    // sub-allocated buffers). Requires `DeviceSettings::buffer_device_address`, returns 0 otherwise.
+    VkDeviceAddress get_buffer_address( BufferHandle handle ) const;
     VkImage get_image( ImageHandle handle ) const;
     VkImageView get_image_view( const ResourceUsage& usage ) const;
 
+    // Records the layout an image has been left in by work submitted outside the manager (e.g. a barrier moving it to
+    // `VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL`), which the manager's own copies of it start from.
+    void set_image_layout( ImageHandle handle, VkImageLayout layout );
+    // The layout recorded for the image, `VK_IMAGE_LAYOUT_UNDEFINED` if it has not been written to (or is not live)
+    VkImageLayout image_layout( ImageHandle handle ) const;
+
     void free_buffer( BufferHandle handle );
     void free_image( ImageHandle handle );
 
@@ -134,15 +719,117 @@ private:
     const AllocatedResource<VkBuffer, BufferDesc>* find_buffer( BufferHandle handle ) const;
     const AllocatedResource<VkImage, ImageDesc>* find_image( ImageHandle handle ) const;
 
+    BufferHandle create_sub_buffer( const BufferDesc& desc );
+
+    // Uploads to a buffer without host access through a staging buffer
+    VkDeviceSize upload_through_staging( const AllocatedResource<VkBuffer, BufferDesc>& buffer,
+                                         const void* data,
+                                         VkDeviceSize size,
+                                         VkDeviceSize offset );
+    bool validate_image_regions( const AllocatedResource<VkImage, ImageDesc>& image,
+                                 VkDeviceSize size,
+                                 std::span<const ImageRegion> regions ) const;
+
+    // `VK_NULL_HANDLE` for the default pools, or `nullopt` (after logging) if `handle` does not refer to a live pool
+    std::optional<VmaPool> get_memory_pool( MemoryPoolHandle handle, const char* resource_name ) const;
+
+    // Adds a reference to the shared resource holding `key`, returning its id, or `nullopt` if there is none
+    std::optional<uint64_t> acquire_shared( const SharedKey& key );
+    // Makes `id` the shared resource holding `key` unless another thread got there first, and returns the id of the
+    // resource which holds it (with a reference added)
+    uint64_t publish_shared( const SharedKey& key, uint64_t id );
+    // Drops a reference to a shared resource, returning true while other references remain and it must stay alive
+    bool release_shared( uint64_t id );
+
+    // Adds `resources` resources holding `bytes` bytes (either of which may be negative) to the accounts of `name` and
+    // `category`
+    void update_accounts( const char* name, const char* category, int64_t bytes, int32_t resources );
+    // Logs every resource which has not been freed, grouped by name & category
+    void report_leaks() const;
+
+    // Publishes a created resource under the resource id `id`
+    BufferHandle add_buffer( uint32_t id, AllocatedResource<VkBuffer, BufferDesc> buffer );
+    ImageHandle add_image( uint32_t id, AllocatedResource<VkImage, ImageDesc> image );
+    bool is_shared_allocation( VmaAllocation allocation ) const;
+    void destroy_buffer( const AllocatedResource<VkBuffer, BufferDesc>& buffer );
+    void destroy_image( const AllocatedResource<VkImage, ImageDesc>& image );
+
+    // Packs `members` into shared allocations by memory type, members which could not be allocated are left with a
+    // null `allocation`.
+    void allocate_batch( std::vector<BatchMember>& members );
+    // Drops a reference to a shared allocation, freeing it once no resources are bound to it
+    void release_shared_allocation( VmaAllocation allocation );
+
     std::optional<uint64_t> bind_buffer( BufferHandle handle, const ResourceUsage& usage );
     std::optional<uint64_t> bind_image( ImageHandle handle, const ResourceUsage& usage );
 
-    VkImageView create_view( ImageHandle handle, const ResourceUsage& usage ) const;
+    // `first_resident_mip` is the most detailed resident mip of a streamed image (see `resident_mip`), as the mips of
+    // `usage` count from the full chain
+    VkImageView create_view( ImageHandle handle,
+                             const ResourceUsage& usage,
+                             std::optional<uint32_t> first_resident_mip ) const;
+
+    // Records a blit chain filling mip levels 1..N from level 0, which must be in `base_layout`. Leaves every level in
+    // `VK_IMAGE_LAYOUT_GENERAL`. Must be recorded on a queue with graphics support.
+    void record_mip_chain( const AllocatedResource<VkImage, ImageDesc>& image,
+                           VkCommandBuffer cmd,
+                           VkImageLayout base_layout ) const;
+    // Why the mips of `image` can not be generated by blits, or nullopt if they can
+    std::optional<std::string> mip_generation_error( const AllocatedResource<VkImage, ImageDesc>& image ) const;
+    bool validate_image_desc( const ImageDesc& desc ) const;
+    // `VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT` if images of `desc` should be created for host image copies, else 0
+    VkImageUsageFlags host_transfer_usage( const ImageDesc& desc ) const;
+    // Copies `regions` into `image` from the CPU, discarding its previous contents and leaving it in
+    // `VK_IMAGE_LAYOUT_GENERAL`
+    bool host_copy_to_image( const AllocatedResource<VkImage, ImageDesc>& image,
+                             std::span<const VkMemoryToImageCopyEXT> regions ) const;
+    // The workers image uploads are converted & encoded across, starting them if needed
+    ThreadPool* image_workers();
+    // Encodes RGBA8 texels into the block format of an image with `compress_channels`, and uploads its mip chain
+    VkDeviceSize compress_to_image( ImageHandle handle,
+                                    const AllocatedResource<VkImage, ImageDesc>& image,
+                                    const void* data,
+                                    VkDeviceSize size );
+
+    // The heap an image view is bound into for `usage`, or nullptr if the usage is not accessed through descriptors
+    // (e.g. attachments & transfers)
+    DescriptorSlotAllocator* get_image_slot_allocator( const ResourceUsage& usage );
+
+    // Creates the replacement resources for one defragmentation pass and records the copies into them, moves which
+    // can not be performed are marked as ignored.
+    std::vector<MovedResource> begin_defragmentation_moves( VmaDefragmentationPassMoveInfo& pass, VkCommandBuffer cmd );
+    // Swaps moved resources over to their replacements once the copies have completed
+    void end_defragmentation_moves( const std::vector<MovedResource>& moved );
+    // Recreates the views of an image whose `VkImage` has been replaced, rewriting their descriptor slots
+    void recreate_image_views( ImageHandle handle, std::optional<uint32_t> first_resident_mip );
+
+    // Replaces the backing image of a streamed image with one holding the mips from `first_mip` onwards, copying over
+    // the mips both share and uploading the rest from `loaded_mips`. Takes `streaming_mutex_` itself, and releases it
+    // while the copies run. Returns false if the image could not be resized (or was freed meanwhile).
+    bool resize_streamed_image( ImageHandle handle, uint32_t first_mip );
+    // Evicts the most detailed mip of the least recently requested images until under budget, taking the lock itself
+    void evict_streamed_mips();
+    // Creates the replacement image of `resize` and waits for the copies into it, without `streaming_mutex_` held
+    bool record_streamed_resize( StreamedResize& resize );
+
+    // The streaming helpers below expect `streaming_mutex_` to be held (or the image to not have been published yet).
+    // Takes the mips `streamed` is resized to from it, and marks it as resizing
+    StreamedResize begin_streamed_resize( ImageHandle handle, StreamedImage& streamed, uint32_t first_mip );
+    // Swaps in the replacement if it was `recorded`, otherwise hands the loaded mips back for a later attempt
+    void end_streamed_resize( StreamedImage& streamed, StreamedResize& resize, bool recorded );
+    // Requests that mips from `mip` onwards become resident, see `request_image_mip`
+    void request_streamed_mip( StreamedImage& streamed, uint32_t mip );
+    void dispatch_mip_loads();
 
 protected:// Internal API(s) for "friend"s to invoke.
     // Returns `true` if the resource(s) described by `usage` is valid
     bool validate_access( ResourceUsage usage );
 
+    // Creates the descriptor buffer laid out by `layout`, which must have been created with
+    // `VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT`, and points the slot allocators into it. Returns
+    // false (leaving the slot allocators writing to descriptor sets) if the layout does not fit in one.
+    bool create_descriptor_buffer( VkDescriptorSetLayout layout );
+    // Writes staged descriptors to `descriptor_set`, or to the descriptor buffer if there is one
     void bind_descriptors( VkDescriptorSet descriptor_set );
 };
 
@@ -37,6 +37,7 @@ private:
     Device::Queue queue_ = {};
     VkCommandPool command_pool_ = VK_NULL_HANDLE;
     VkCommandBuffer command_buffer_ = VK_NULL_HANDLE;
+    VkFence fence_ = VK_NULL_HANDLE;// Signalled when the submitted frame retires, waited on outside the queue lock
 public:
     ~TaskGraph();
 
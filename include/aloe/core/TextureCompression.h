@@ -0,0 +1,54 @@
+#pragma once
+
+#include <volk.h>
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace aloe {
+class ThreadPool;
+
+// Block compressed formats the CPU encoder can produce, each stores a 4x4 block of texels in 8 or 16 bytes.
+enum class BlockFormat : uint32_t {
+    BC1,// RGB, 8 bytes per block
+    BC3,// RGBA, BC1 colour with a separate alpha block, 16 bytes per block
+    BC4,// R, 8 bytes per block
+    BC5,// RG, two BC4 blocks, 16 bytes per block
+    BC7,// RGBA, 16 bytes per block (mode 6 only, a single subset with 4 bit indices)
+};
+
+// The format storing `channels` channels of 8 bit data: BC4 for 1, BC5 for 2, BC1 for 3 and BC7 for 4. There are
+// no sRGB variants of BC4 or BC5, so `srgb` only applies to 3 and 4 channels. Returns `VK_FORMAT_UNDEFINED` for any
+// other channel count.
+VkFormat compressed_format( uint32_t channels, bool srgb );
+
+// The block format of `format`, or `nullopt` if the encoder can not produce it
+std::optional<BlockFormat> block_format( VkFormat format );
+
+// Bytes of a `width` x `height` texel image in `format`, partial blocks at the edges are rounded up to whole blocks
+uint64_t compressed_size( BlockFormat format, uint32_t width, uint32_t height );
+
+// Encodes tightly packed 8 bit RGBA texels into blocks, channels the format does not store are ignored. Edge blocks of
+// images which are not a multiple of 4 texels in size are padded by repeating the last row and column. Rows of blocks
+// are split across `workers` if given, otherwise everything is encoded on the calling thread. Returns an empty vector
+// (after logging) if `texels` does not hold `width * height` texels.
+std::vector<uint8_t> compress_rgba8( std::span<const uint8_t> texels,
+                                     uint32_t width,
+                                     uint32_t height,
+                                     BlockFormat format,
+                                     ThreadPool* workers = nullptr );
+
+// Encodes `array_layers` layers of 8 bit RGBA texels (mip 0) and `mip_levels - 1` further mips, each box filtered
+// from the one before, laid out as `ResourceManager::upload_mips_to_image` expects. The start of each mip is written
+// to `mip_offsets`.
+std::vector<uint8_t> compress_rgba8_mips( std::span<const uint8_t> texels,
+                                          VkExtent2D extent,
+                                          uint32_t array_layers,
+                                          uint32_t mip_levels,
+                                          BlockFormat format,
+                                          std::vector<VkDeviceSize>& mip_offsets,
+                                          ThreadPool* workers = nullptr );
+
+}// namespace aloe
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <format>
 #include <string>
@@ -14,10 +16,32 @@ constexpr static int get_binding_slot( VkDescriptorType type ) {
     switch ( type ) {
         case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER: return 0;
         case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE: return 1;
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE: return 2;
+        case VK_DESCRIPTOR_TYPE_SAMPLER: return 3;
         default: return -1;
     }
 }
 
+// Every descriptor type in the global bindless descriptor set, one binding each
+constexpr static std::array bindless_descriptor_types = {
+    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+    VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+    VK_DESCRIPTOR_TYPE_SAMPLER,
+};
+
+// Number of descriptors in each bindless binding, shared by the descriptor layout and the slot allocators
+constexpr static uint32_t get_binding_count( VkDescriptorType type, const VkPhysicalDeviceLimits& limits ) {
+    switch ( type ) {
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER: return limits.maxDescriptorSetStorageBuffers;
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE: return limits.maxDescriptorSetStorageImages;
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE: return limits.maxDescriptorSetSampledImages;
+        // Samplers are deduplicated, so only a handful are ever live
+        case VK_DESCRIPTOR_TYPE_SAMPLER: return std::min( limits.maxDescriptorSetSamplers, 4096u );
+        default: return 0;
+    }
+}
+
 inline std::string aloe_shader_template() {
     return R"(
 module aloe;
@@ -25,24 +49,86 @@ module aloe;
 [[vk::binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0)]]
 public RWByteAddressBuffer g_buffers[];
 
+// Every storage image lives in the same binding, aliased by image dimension; the view bound to a slot decides which of
+// these declarations may be used to access it.
 [[vk::binding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0)]]
 public RWTexture2D g_storage_images[];
+[[vk::binding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0)]]
+public RWTexture2DArray g_storage_image_arrays[];
+[[vk::binding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0)]]
+public RWTexture3D g_storage_volumes[];
+
+// Sampled images are aliased the same way, sampled through the separate sampler heap.
+[[vk::binding(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0)]]
+public Texture2D g_textures[];
+[[vk::binding(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0)]]
+public Texture2DArray g_texture_arrays[];
+[[vk::binding(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0)]]
+public TextureCube g_texture_cubes[];
+[[vk::binding(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 0)]]
+public Texture3D g_texture_volumes[];
+
+[[vk::binding(VK_DESCRIPTOR_TYPE_SAMPLER, 0)]]
+public SamplerState g_samplers[];
 
 namespace aloe {
 
 // bottom 32 bits of the id we write to the descriptor is the slot index
 constexpr static int64_t SLOT_INDEX_MASK = (1 << 32) - 1;
 
+// Mirrors `aloe::GpuBufferHandle`, sub-allocated buffers share the descriptor of their pool, so `load`/`store` apply
+// the offset of the buffer within that descriptor.
 public struct BufferHandle {
     private uint64_t id;
+    private uint offset;
+    private uint size;
+
     public RWByteAddressBuffer get() { return g_buffers[int(id & SLOT_INDEX_MASK)]; }
+    public uint get_offset() { return offset; }
+    public uint get_size() { return size; }
+
+    public T load<T>(uint address) { return get().Load<T>(offset + address); }
+    public void store<T>(uint address, T value) { get().Store<T>(offset + address, value); }
 };
 
 public struct ImageHandle {
     private uint64_t id;
     public RWTexture2D get() { return g_storage_images[int(id & SLOT_INDEX_MASK)]; }
+    // For `VK_IMAGE_VIEW_TYPE_2D_ARRAY` views (including array views of cube maps)
+    public RWTexture2DArray get_array() { return g_storage_image_arrays[int(id & SLOT_INDEX_MASK)]; }
+    // For `VK_IMAGE_VIEW_TYPE_3D` views
+    public RWTexture3D get_volume() { return g_storage_volumes[int(id & SLOT_INDEX_MASK)]; }
+};
+
+// Mirrors `aloe::SamplerHandle`, made by `ResourceManager::create_sampler`.
+public struct SamplerHandle {
+    private uint64_t id;
+    public SamplerState get() { return g_samplers[int(id & SLOT_INDEX_MASK)]; }
+};
+
+// An image bound with a `*SampledRead` usage, set from an `aloe::ImageHandle`.
+public struct TextureHandle {
+    private uint64_t id;
+    public Texture2D get() { return g_textures[int(id & SLOT_INDEX_MASK)]; }
+    public Texture2DArray get_array() { return g_texture_arrays[int(id & SLOT_INDEX_MASK)]; }
+    public TextureCube get_cube() { return g_texture_cubes[int(id & SLOT_INDEX_MASK)]; }
+    public Texture3D get_volume() { return g_texture_volumes[int(id & SLOT_INDEX_MASK)]; }
+
+    // Implicit lod sampling needs derivatives, so is only available in fragment shaders
+    public float4 sample(SamplerHandle sampler_handle, float2 uv) { return get().Sample(sampler_handle.get(), uv); }
+    public float4 sample_level(SamplerHandle sampler_handle, float2 uv, float lod) {
+        return get().SampleLevel(sampler_handle.get(), uv, lod);
+    }
 };
 
+// Texture streaming feedback, `streaming` is `ResourceManager::streaming_buffer` and `index` the
+// `ResourceManager::streaming_index` of the image. Each image has a { requested mip, resident mip } pair of uints.
+public void request_streamed_mip(BufferHandle streaming, uint index, uint mip) {
+    uint previous;
+    streaming.get().InterlockedMin(streaming.get_offset() + index * 8, mip, previous);
+}
+public uint streamed_resident_mip(BufferHandle streaming, uint index) { return streaming.load<uint>(index * 8 + 4); }
+
 }
 
 )";
@@ -51,17 +137,24 @@ public struct ImageHandle {
 inline static std::string get_aloe_module() {
     auto source = aloe_shader_template();
 
+    // Replaces every occurrence, as several declarations can alias the same binding
     auto replace = [&]( std::string_view name, std::string_view value ) {
         auto pos = source.find( name );
         assert( pos != std::string::npos );
 
-        source.replace( pos, name.length(), value );
+        while ( pos != std::string::npos ) {
+            source.replace( pos, name.length(), value );
+            pos = source.find( name, pos + value.length() );
+        }
     };
 
     replace( "VK_DESCRIPTOR_TYPE_STORAGE_BUFFER",
              std::to_string( get_binding_slot( VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ) ) );
     replace( "VK_DESCRIPTOR_TYPE_STORAGE_IMAGE",
              std::to_string( get_binding_slot( VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ) ) );
+    replace( "VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE",
+             std::to_string( get_binding_slot( VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ) ) );
+    replace( "VK_DESCRIPTOR_TYPE_SAMPLER", std::to_string( get_binding_slot( VK_DESCRIPTOR_TYPE_SAMPLER ) ) );
 
     return source;
 }
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+namespace aloe {
+
+struct Hash128 {
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    auto operator<=>( const Hash128& other ) const = default;
+};
+
+namespace detail {
+constexpr uint64_t fmix64( uint64_t k ) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ull;
+    k ^= k >> 33;
+    return k;
+}
+
+inline uint64_t load64( const uint8_t* bytes ) {
+    uint64_t value = 0;
+    std::memcpy( &value, bytes, sizeof( value ) );
+    return value;
+}
+}// namespace detail
+
+// MurmurHash3 (x64, 128 bit) of `size` bytes: fast enough to run over every byte of an upload (a few GB/s), with few
+// enough collisions that equal hashes can stand in for equal contents. Matches the reference implementation on little
+// endian machines.
+inline Hash128 hash128( const void* data, size_t size, uint64_t seed = 0 ) {
+    constexpr uint64_t c1 = 0x87c37b91114253d5ull;
+    constexpr uint64_t c2 = 0x4cf5ad432745937full;
+
+    const auto* bytes = static_cast<const uint8_t*>( data );
+    const size_t block_count = size / 16;
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    for ( size_t i = 0; i < block_count; ++i ) {
+        uint64_t k1 = detail::load64( bytes + i * 16 );
+        uint64_t k2 = detail::load64( bytes + i * 16 + 8 );
+
+        k1 *= c1;
+        k1 = std::rotl( k1, 31 );
+        k1 *= c2;
+        h1 ^= k1;
+        h1 = std::rotl( h1, 27 );
+        h1 += h2;
+        h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= c2;
+        k2 = std::rotl( k2, 33 );
+        k2 *= c1;
+        h2 ^= k2;
+        h2 = std::rotl( h2, 31 );
+        h2 += h1;
+        h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    // The last 0-15 bytes, the first 8 into `k1` and the rest into `k2`
+    const uint8_t* tail = bytes + block_count * 16;
+    const size_t remaining = size & 15;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    for ( size_t i = remaining; i > 8; --i ) { k2 ^= uint64_t{ tail[i - 1] } << ( ( i - 9 ) * 8 ); }
+    for ( size_t i = std::min<size_t>( remaining, 8 ); i > 0; --i ) {
+        k1 ^= uint64_t{ tail[i - 1] } << ( ( i - 1 ) * 8 );
+    }
+
+    if ( remaining > 8 ) {
+        k2 *= c2;
+        k2 = std::rotl( k2, 33 );
+        k2 *= c1;
+        h2 ^= k2;
+    }
+    if ( remaining > 0 ) {
+        k1 *= c1;
+        k1 = std::rotl( k1, 31 );
+        k1 *= c2;
+        h1 ^= k1;
+    }
+
+    h1 ^= size;
+    h2 ^= size;
+    h1 += h2;
+    h2 += h1;
+    h1 = detail::fmix64( h1 );
+    h2 = detail::fmix64( h2 );
+    h1 += h2;
+    h2 += h1;
+    return { h1, h2 };
+}
+
+}// namespace aloe
+
+template<>
+struct std::hash<aloe::Hash128> {
+    size_t operator()( const aloe::Hash128& hash ) const noexcept { return hash.low ^ hash.high; }
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace aloe {
+
+// A hash map split into independently locked shards, so threads touching different keys rarely meet on a lock, and
+// lookups of the same shard only share it. Values are never moved once inserted (`std::unordered_map` nodes are
+// stable), so pointers returned by `find` stay valid until that key is erased; guarding the value itself against
+// concurrent use is left to the caller.
+template<typename Key, typename Value, size_t ShardCount = 16>
+class ShardedMap {
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, Value> map;
+    };
+
+    std::array<Shard, ShardCount> shards_;
+
+    Shard& shard( const Key& key ) { return shards_[std::hash<Key>{}( key ) % ShardCount]; }
+    const Shard& shard( const Key& key ) const { return shards_[std::hash<Key>{}( key ) % ShardCount]; }
+
+public:
+    Value* find( const Key& key ) {
+        auto& s = shard( key );
+        std::shared_lock lock( s.mutex );
+        const auto iter = s.map.find( key );
+        return iter == s.map.end() ? nullptr : &iter->second;
+    }
+
+    const Value* find( const Key& key ) const {
+        const auto& s = shard( key );
+        std::shared_lock lock( s.mutex );
+        const auto iter = s.map.find( key );
+        return iter == s.map.end() ? nullptr : &iter->second;
+    }
+
+    bool contains( const Key& key ) const { return find( key ) != nullptr; }
+
+    Value& emplace( const Key& key, Value value ) {
+        auto& s = shard( key );
+        std::scoped_lock lock( s.mutex );
+        return s.map.try_emplace( key, std::move( value ) ).first->second;
+    }
+
+    bool erase( const Key& key ) {
+        auto& s = shard( key );
+        std::scoped_lock lock( s.mutex );
+        return s.map.erase( key ) > 0;
+    }
+
+    // Visits every entry, one shard at a time. `fn` must not insert into or erase from this map.
+    template<typename Fn>
+    void for_each( Fn&& fn ) {
+        for ( auto& s : shards_ ) {
+            std::scoped_lock lock( s.mutex );
+            for ( auto& [key, value] : s.map ) { fn( key, value ); }
+        }
+    }
+
+    template<typename Fn>
+    void for_each( Fn&& fn ) const {
+        for ( const auto& s : shards_ ) {
+            std::shared_lock lock( s.mutex );
+            for ( const auto& [key, value] : s.map ) { fn( key, value ); }
+        }
+    }
+
+    template<typename Pred>
+    size_t erase_if( Pred&& pred ) {
+        size_t erased = 0;
+        for ( auto& s : shards_ ) {
+            std::scoped_lock lock( s.mutex );
+            erased += std::erase_if( s.map, [&]( const auto& pair ) { return pred( pair.first, pair.second ); } );
+        }
+        return erased;
+    }
+
+    size_t size() const {
+        size_t count = 0;
+        for ( const auto& s : shards_ ) {
+            std::shared_lock lock( s.mutex );
+            count += s.map.size();
+        }
+        return count;
+    }
+};
+
+}// namespace aloe
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace aloe {
+
+// A fixed set of worker threads consuming a FIFO queue of jobs. Jobs which have not started when the pool is destroyed
+// are dropped, their futures report `std::future_errc::broken_promise`.
+class ThreadPool {
+    std::mutex mutex_;
+    std::condition_variable_any condition_;
+    std::deque<std::function<void()>> jobs_;
+    std::vector<std::jthread> workers_;
+
+public:
+    explicit ThreadPool( uint32_t thread_count ) {
+        thread_count = std::max( thread_count, 1u );
+        workers_.reserve( thread_count );
+        for ( uint32_t i = 0; i < thread_count; ++i ) {
+            workers_.emplace_back( [this]( std::stop_token stop_token ) { run( stop_token ); } );
+        }
+    }
+
+    ~ThreadPool() {
+        for ( auto& worker : workers_ ) { worker.request_stop(); }
+        condition_.notify_all();
+        workers_.clear();// joins
+    }
+
+    ThreadPool( ThreadPool& ) = delete;
+    ThreadPool& operator=( const ThreadPool& other ) = delete;
+
+    ThreadPool( ThreadPool&& ) = delete;
+    ThreadPool& operator=( ThreadPool&& other ) = delete;
+
+    template<typename Fn>
+    std::future<std::invoke_result_t<Fn>> submit( Fn&& fn ) {
+        // `std::function` must be copyable, so the task is shared rather than moved into the job
+        auto task = std::make_shared<std::packaged_task<std::invoke_result_t<Fn>()>>( std::forward<Fn>( fn ) );
+        auto future = task->get_future();
+        {
+            std::scoped_lock lock( mutex_ );
+            jobs_.emplace_back( [task]() { ( *task )(); } );
+        }
+        condition_.notify_one();
+        return future;
+    }
+
+    size_t thread_count() const { return workers_.size(); }
+
+private:
+    void run( std::stop_token stop_token ) {
+        while ( true ) {
+            std::function<void()> job;
+            {
+                std::unique_lock lock( mutex_ );
+                if ( !condition_.wait( lock, stop_token, [&]() { return !jobs_.empty(); } ) ) return;
+
+                job = std::move( jobs_.front() );
+                jobs_.pop_front();
+            }
+            job();
+        }
+    }
+};
+
+}// namespace aloe
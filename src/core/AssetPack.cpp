@@ -0,0 +1,350 @@
+#include <aloe/core/AssetPack.h>
+#include <aloe/core/ResourceManager.h>
+#include <aloe/util/log.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+
+namespace aloe {
+
+static uint64_t align_up( uint64_t value, uint64_t alignment ) {
+    return ( value + alignment - 1 ) / alignment * alignment;
+}
+
+// Whether `size` bytes at `offset` lie within `[0, limit)`, without overflowing
+static bool in_bounds( uint64_t offset, uint64_t size, uint64_t limit ) {
+    return offset <= limit && size <= limit - offset;
+}
+
+// The parts of an image's description which are stored in its entry
+static ImageDesc entry_image_desc( const AssetPackEntry& entry ) {
+    return {
+        .type = entry.type,
+        .extent = entry.extent,
+        .format = entry.format,
+        .mip_levels = entry.mip_levels,
+        .array_layers = entry.array_layers,
+        .flags = entry.flags,
+    };
+}
+
+static bool validate_layout( const uint8_t* mapping, size_t size, const std::filesystem::path& path ) {
+    auto report_error = [&]( std::string_view error_msg ) {
+        log_write( LogLevel::Error, "Invalid asset pack {}: {}", path.string(), error_msg );
+        return false;
+    };
+
+    if ( size < sizeof( AssetPackHeader ) ) { return report_error( "file is too small" ); }
+
+    const auto* header = reinterpret_cast<const AssetPackHeader*>( mapping );
+    if ( header->magic != asset_pack_magic ) { return report_error( "not an asset pack" ); }
+    if ( header->version != asset_pack_version ) { return report_error( "unsupported version" ); }
+    if ( header->file_size != size ) { return report_error( "file is truncated" ); }
+
+    const auto entries_size = uint64_t{ header->entry_count } * sizeof( AssetPackEntry );
+    if ( !in_bounds( sizeof( AssetPackHeader ), entries_size, size ) ||
+         header->names_offset < sizeof( AssetPackHeader ) + entries_size ||
+         !in_bounds( header->names_offset, header->names_size, size ) ) {
+        return report_error( "entry or name table out of bounds" );
+    }
+
+    const auto* entries = reinterpret_cast<const AssetPackEntry*>( mapping + sizeof( AssetPackHeader ) );
+    const auto* names = reinterpret_cast<const char*>( mapping + header->names_offset );
+    std::string_view previous_name;
+    for ( uint32_t i = 0; i < header->entry_count; ++i ) {
+        const auto& entry = entries[i];
+        if ( !in_bounds( entry.name_offset, uint64_t{ entry.name_size } + 1, header->names_size ) ||
+             names[entry.name_offset + entry.name_size] != '\0' ) {
+            return report_error( "name out of bounds" );
+        }
+
+        // Entries are sorted, so lookups can binary search them
+        const std::string_view name( names + entry.name_offset, entry.name_size );
+        if ( i > 0 && name <= previous_name ) { return report_error( "entries are not sorted by name" ); }
+        previous_name = name;
+
+        if ( !in_bounds( entry.data_offset, entry.data_size, size ) ) { return report_error( "data out of bounds" ); }
+        if ( entry.data_offset % asset_pack_alignment != 0 ) { return report_error( "data is misaligned" ); }
+
+        if ( entry.kind == AssetKind::Image ) {
+            if ( entry.mip_levels == 0 || entry.mip_levels > asset_pack_max_mips || entry.array_layers == 0 ) {
+                return report_error( "image has no mips or layers" );
+            }
+            for ( uint32_t mip = 0; mip < entry.mip_levels; ++mip ) {
+                const auto offset = entry.mip_offsets[mip];
+                const auto bytes = mip_size( entry_image_desc( entry ), mip );
+                if ( bytes == 0 || !in_bounds( offset, bytes, entry.data_size ) ||
+                     offset % asset_pack_mip_alignment != 0 ) {
+                    return report_error( "mip out of bounds or misaligned" );
+                }
+            }
+        } else if ( entry.kind != AssetKind::Buffer ) {
+            return report_error( "unknown asset kind" );
+        }
+    }
+
+    return true;
+}
+
+AssetPack::AssetPack( const uint8_t* mapping, size_t size ) : mapping_( mapping ), size_( size ) {
+    const auto* header = reinterpret_cast<const AssetPackHeader*>( mapping_ );
+    entries_ = { reinterpret_cast<const AssetPackEntry*>( mapping_ + sizeof( AssetPackHeader ) ), header->entry_count };
+}
+
+AssetPack::~AssetPack() { munmap( const_cast<uint8_t*>( mapping_ ), size_ ); }
+
+std::unique_ptr<AssetPack> AssetPack::open( const std::filesystem::path& path ) {
+    const int fd = ::open( path.c_str(), O_RDONLY );
+    if ( fd < 0 ) {
+        log_write( LogLevel::Error, "Failed to open asset pack {}", path.string() );
+        return nullptr;
+    }
+
+    struct stat file_stat {};
+    if ( fstat( fd, &file_stat ) != 0 || file_stat.st_size <= 0 ) {
+        log_write( LogLevel::Error, "Failed to read the size of asset pack {}", path.string() );
+        close( fd );
+        return nullptr;
+    }
+
+    // The mapping keeps the file alive once the descriptor is closed
+    const auto size = static_cast<size_t>( file_stat.st_size );
+    void* mapping = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if ( mapping == MAP_FAILED ) {
+        log_write( LogLevel::Error, "Failed to map asset pack {}", path.string() );
+        return nullptr;
+    }
+
+    // Assets are mostly loaded front to back, so let the kernel read ahead aggressively
+    madvise( mapping, size, MADV_SEQUENTIAL );
+
+    if ( !validate_layout( static_cast<const uint8_t*>( mapping ), size, path ) ) {
+        munmap( mapping, size );
+        return nullptr;
+    }
+
+    return std::unique_ptr<AssetPack>( new AssetPack( static_cast<const uint8_t*>( mapping ), size ) );
+}
+
+const AssetPackEntry* AssetPack::find( std::string_view asset_name ) const {
+    const auto iter = std::ranges::lower_bound( entries_, asset_name, {}, [&]( const AssetPackEntry& entry ) {
+        return name( entry );
+    } );
+    if ( iter == entries_.end() || name( *iter ) != asset_name ) { return nullptr; }
+    return &*iter;
+}
+
+std::string_view AssetPack::name( const AssetPackEntry& entry ) const {
+    const auto* header = reinterpret_cast<const AssetPackHeader*>( mapping_ );
+    return { reinterpret_cast<const char*>( mapping_ + header->names_offset + entry.name_offset ), entry.name_size };
+}
+
+std::span<const uint8_t> AssetPack::data( const AssetPackEntry& entry ) const {
+    return { mapping_ + entry.data_offset, entry.data_size };
+}
+
+BufferHandle AssetPack::load_buffer( ResourceManager& resource_manager,
+                                     std::string_view asset_name,
+                                     VkBufferUsageFlags usage,
+                                     const char* debug_name ) const {
+    const auto* entry = find( asset_name );
+    if ( !entry || entry->kind != AssetKind::Buffer ) {
+        log_write( LogLevel::Error, "Asset pack has no buffer called {}", asset_name );
+        return {};
+    }
+
+    const auto buffer = resource_manager.create_buffer( {
+        .size = entry->data_size,
+        .usage = usage,
+        .name = debug_name,
+    } );
+    if ( buffer == BufferHandle{} ) { return {}; }
+
+    // Copied straight from the mapping into staging memory
+    const auto bytes = data( *entry );
+    if ( resource_manager.stage_to_buffer( buffer, bytes.data(), bytes.size() ) != bytes.size() ) {
+        resource_manager.free_buffer( buffer );
+        return {};
+    }
+
+    return buffer;
+}
+
+ImageHandle AssetPack::load_image( ResourceManager& resource_manager,
+                                   std::string_view asset_name,
+                                   VkImageUsageFlags usage,
+                                   const char* debug_name ) const {
+    const auto* entry = find( asset_name );
+    if ( !entry || entry->kind != AssetKind::Image ) {
+        log_write( LogLevel::Error, "Asset pack has no image called {}", asset_name );
+        return {};
+    }
+
+    auto desc = entry_image_desc( *entry );
+    desc.usage = usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    desc.name = debug_name;
+    const auto image = resource_manager.create_image( desc );
+    if ( image == ImageHandle{} ) { return {}; }
+
+    const auto bytes = data( *entry );
+    const auto mip_offsets = std::span<const VkDeviceSize>( entry->mip_offsets, entry->mip_levels );
+    if ( resource_manager.upload_mips_to_image( image, bytes.data(), bytes.size(), mip_offsets ) != bytes.size() ) {
+        resource_manager.free_image( image );
+        return {};
+    }
+
+    return image;
+}
+
+bool AssetPackWriter::add_buffer( std::string_view asset_name, std::span<const uint8_t> data ) {
+    if ( asset_name.empty() || data.empty() ) {
+        log_write( LogLevel::Error, "Asset pack buffers need a name and data" );
+        return false;
+    }
+    if ( std::ranges::find( assets_, asset_name, &PendingAsset::name ) != assets_.end() ) {
+        log_write( LogLevel::Error, "Asset pack already contains an asset called {}", asset_name );
+        return false;
+    }
+
+    assets_.push_back( {
+        .name = std::string( asset_name ),
+        .entry = { .kind = AssetKind::Buffer, .data_size = data.size() },
+        .parts = { std::vector<uint8_t>( data.begin(), data.end() ) },
+    } );
+    return true;
+}
+
+bool AssetPackWriter::add_image( std::string_view asset_name,
+                                 const AssetImageDesc& desc,
+                                 std::span<const std::vector<uint8_t>> mips ) {
+    const bool has_empty_mip = std::ranges::any_of( mips, []( const auto& mip ) { return mip.empty(); } );
+    if ( asset_name.empty() || mips.empty() || mips.size() > asset_pack_max_mips || desc.array_layers == 0 ||
+         has_empty_mip ) {
+        log_write( LogLevel::Error,
+                   "Asset pack image {} needs between 1 and {} non-empty mips",
+                   asset_name,
+                   asset_pack_max_mips );
+        return false;
+    }
+    if ( std::ranges::find( assets_, asset_name, &PendingAsset::name ) != assets_.end() ) {
+        log_write( LogLevel::Error, "Asset pack already contains an asset called {}", asset_name );
+        return false;
+    }
+
+    AssetPackEntry entry{
+        .kind = AssetKind::Image,
+        .format = desc.format,
+        .extent = desc.extent,
+        .mip_levels = static_cast<uint32_t>( mips.size() ),
+        .array_layers = desc.array_layers,
+        .flags = desc.flags,
+        .type = desc.type,
+    };
+
+    // Packs are checked for this when opened, so catch it while the mips are at hand
+    for ( uint32_t mip = 0; mip < entry.mip_levels; ++mip ) {
+        const auto expected_size = mip_size( entry_image_desc( entry ), mip );
+        if ( mips[mip].size() != expected_size ) {
+            log_write( LogLevel::Error,
+                       "Mip {} of asset pack image {} is {} bytes, but an image of its format and extent needs {}",
+                       mip,
+                       asset_name,
+                       mips[mip].size(),
+                       expected_size );
+            return false;
+        }
+    }
+
+    uint64_t offset = 0;
+    for ( size_t mip = 0; mip < mips.size(); ++mip ) {
+        offset = align_up( offset, asset_pack_mip_alignment );
+        entry.mip_offsets[mip] = offset;
+        offset += mips[mip].size();
+    }
+    entry.data_size = offset;
+
+    assets_.push_back( {
+        .name = std::string( asset_name ),
+        .entry = entry,
+        .parts = std::vector<std::vector<uint8_t>>( mips.begin(), mips.end() ),
+    } );
+    return true;
+}
+
+bool AssetPackWriter::write( const std::filesystem::path& path ) const {
+    // Sorted by name, so readers can binary search the entry table
+    std::vector<const PendingAsset*> sorted;
+    for ( const auto& asset : assets_ ) { sorted.push_back( &asset ); }
+    std::ranges::sort( sorted, {}, []( const PendingAsset* asset ) -> std::string_view { return asset->name; } );
+
+    std::vector<AssetPackEntry> entries;
+    std::string names;
+    for ( const auto* asset : sorted ) {
+        auto entry = asset->entry;
+        entry.name_offset = names.size();
+        entry.name_size = static_cast<uint32_t>( asset->name.size() );
+        names += asset->name;
+        names.push_back( '\0' );
+        entries.push_back( entry );
+    }
+
+    AssetPackHeader header{
+        .entry_count = static_cast<uint32_t>( entries.size() ),
+        .names_offset = sizeof( AssetPackHeader ) + entries.size() * sizeof( AssetPackEntry ),
+        .names_size = names.size(),
+    };
+
+    auto offset = align_up( header.names_offset + header.names_size, asset_pack_alignment );
+    for ( auto& entry : entries ) {
+        entry.data_offset = offset;
+        offset = align_up( offset + entry.data_size, asset_pack_alignment );
+    }
+    header.file_size = offset;
+
+    std::ofstream file( path, std::ios::binary | std::ios::trunc );
+    if ( !file ) {
+        log_write( LogLevel::Error, "Failed to open {} for writing", path.string() );
+        return false;
+    }
+
+    uint64_t position = 0;
+    auto write_bytes = [&]( const void* bytes, uint64_t size ) {
+        file.write( static_cast<const char*>( bytes ), static_cast<std::streamsize>( size ) );
+        position += size;
+    };
+    auto pad_to = [&]( uint64_t target ) {
+        constexpr std::array<char, asset_pack_alignment> zeroes{};
+        while ( position < target ) {
+            write_bytes( zeroes.data(), std::min<uint64_t>( zeroes.size(), target - position ) );
+        }
+    };
+
+    write_bytes( &header, sizeof( header ) );
+    write_bytes( entries.data(), entries.size() * sizeof( AssetPackEntry ) );
+    write_bytes( names.data(), names.size() );
+
+    for ( size_t i = 0; i < entries.size(); ++i ) {
+        const auto& entry = entries[i];
+        const auto& parts = sorted[i]->parts;
+        for ( size_t part = 0; part < parts.size(); ++part ) {
+            pad_to( entry.data_offset + ( entry.kind == AssetKind::Image ? entry.mip_offsets[part] : 0 ) );
+            write_bytes( parts[part].data(), parts[part].size() );
+        }
+    }
+    pad_to( header.file_size );
+
+    if ( !file ) {
+        log_write( LogLevel::Error, "Failed to write asset pack {}", path.string() );
+        return false;
+    }
+    return true;
+}
+
+}// namespace aloe
@@ -9,6 +9,7 @@
 #include <GLFW/glfw3.h>
 #include <vma/vma.h>
 
+#include <algorithm>
 #include <cassert>
 #include <numeric>
 #include <ranges>
@@ -17,7 +18,9 @@ namespace aloe {
 
 Device::DebugInformation Device::debug_info_ = {};
 
-Device::Device( DeviceSettings settings ) : enable_validation_( settings.enable_validation ) {
+Device::Device( DeviceSettings settings )
+    : enable_validation_( settings.enable_validation )
+    , buffer_device_address_( settings.buffer_device_address ) {
     // Reset our debug info
     Device::debug_info_ = {};
 
@@ -33,6 +36,12 @@ Device::Device( DeviceSettings settings ) : enable_validation_( settings.enable_
     result = pick_physical_device( *this, settings );
     if ( result != VK_SUCCESS ) { throw std::runtime_error( "Failed to find a physical device" ); }
 
+    const auto& chosen_device = physical_devices_.front();
+    host_image_copy_ = settings.host_image_copy && chosen_device.supports_host_image_copy &&
+        chosen_device.host_copy_to_general;
+    host_image_readback_ = host_image_copy_ && chosen_device.host_copy_from_general;
+    descriptor_buffer_ = settings.descriptor_buffer && chosen_device.supports_descriptor_buffer;
+
     result = create_logical_device( *this, settings );
     if ( result != VK_SUCCESS ) { throw std::runtime_error( "Failed to make a logical device" ); }
 
@@ -47,11 +56,13 @@ std::vector<Device::Queue> Device::find_queues( VkQueueFlagBits capability ) con
         std::ranges::to<std::vector>();
 }
 
-std::shared_ptr<PipelineManager> Device::make_pipeline_manager( const std::vector<std::string>& root_paths ) {
+std::shared_ptr<PipelineManager> Device::make_pipeline_manager( const std::vector<std::string>& root_paths,
+                                                                const std::filesystem::path& pipeline_cache_path,
+                                                                const std::filesystem::path& shader_cache_directory ) {
     assert( pipeline_manager_ == nullptr );
     assert( resource_manager_ != nullptr && "Must construct resource manager before pipeline manager" );
-    pipeline_manager_ =
-        std::shared_ptr<PipelineManager>( new PipelineManager( *this, *resource_manager_, root_paths ) );
+    pipeline_manager_ = std::shared_ptr<PipelineManager>(
+        new PipelineManager( *this, *resource_manager_, root_paths, pipeline_cache_path, shader_cache_directory ) );
     return pipeline_manager_;
 }
 
@@ -224,6 +235,59 @@ VkResult Device::pick_physical_device( Device& device, const DeviceSettings& set
                 wrapper.viable_device = false;
             }
         }
+
+        // Optional, `VK_EXT_host_image_copy` also depends on `VK_KHR_format_feature_flags2` before Vulkan 1.3
+        auto has_extension = [&]( const char* extension ) {
+            return std::ranges::find( extensions, std::string{ extension } ) != extensions.end();
+        };
+        const bool host_image_copy_extensions = has_extension( VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME ) &&
+            has_extension( VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME );
+        const bool descriptor_buffer_extension = has_extension( VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME );
+
+        // Only chain feature structs of extensions the device exposes
+        VkPhysicalDeviceHostImageCopyFeaturesEXT host_image_copy{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT,
+        };
+        VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptor_buffer{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT,
+            .pNext = host_image_copy_extensions ? &host_image_copy : nullptr,
+        };
+        VkPhysicalDeviceFeatures2 features{
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = descriptor_buffer_extension ? static_cast<void*>( &descriptor_buffer ) : descriptor_buffer.pNext,
+        };
+        vkGetPhysicalDeviceFeatures2( physical_device, &features );
+
+        wrapper.supports_host_image_copy = host_image_copy_extensions && host_image_copy.hostImageCopy == VK_TRUE;
+        wrapper.supports_descriptor_buffer =
+            descriptor_buffer_extension && descriptor_buffer.descriptorBuffer == VK_TRUE;
+        if ( wrapper.supports_host_image_copy ) {
+            // Images rest in `VK_IMAGE_LAYOUT_GENERAL`, so host copies are only usable if the device lists it
+            VkPhysicalDeviceHostImageCopyPropertiesEXT host_copy_properties{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT,
+            };
+            VkPhysicalDeviceProperties2 properties{
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                .pNext = &host_copy_properties,
+            };
+            vkGetPhysicalDeviceProperties2( physical_device, &properties );
+
+            std::vector<VkImageLayout> src_layouts( host_copy_properties.copySrcLayoutCount );
+            std::vector<VkImageLayout> dst_layouts( host_copy_properties.copyDstLayoutCount );
+            host_copy_properties.pCopySrcLayouts = src_layouts.data();
+            host_copy_properties.pCopyDstLayouts = dst_layouts.data();
+            vkGetPhysicalDeviceProperties2( physical_device, &properties );
+
+            wrapper.host_copy_to_general = std::ranges::contains( dst_layouts, VK_IMAGE_LAYOUT_GENERAL );
+            wrapper.host_copy_from_general = std::ranges::contains( src_layouts, VK_IMAGE_LAYOUT_GENERAL );
+            log_write( LogLevel::Info,
+                       "- Host Image Copy: to GENERAL {}, from GENERAL {}",
+                       wrapper.host_copy_to_general,
+                       wrapper.host_copy_from_general );
+        } else {
+            log_write( LogLevel::Info, "- Host Image Copy: false" );
+        }
+        log_write( LogLevel::Info, "- Descriptor Buffer: {}", wrapper.supports_descriptor_buffer );
     }
 
     // todo: Eventually we can sort physical devices by capabilities here, but for now I only ever run single-gpu
@@ -260,10 +324,30 @@ VkResult Device::create_logical_device( Device& device, const DeviceSettings& se
         .synchronization2 = VK_TRUE,
     };
 
+    VkPhysicalDeviceHostImageCopyFeaturesEXT host_image_copy{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT,
+        .pNext = &sync2,
+        .hostImageCopy = VK_TRUE,
+    };
+
+    VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptor_buffer{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT,
+        .pNext = device.host_image_copy_ ? static_cast<void*>( &host_image_copy ) : &sync2,
+        .descriptorBuffer = VK_TRUE,
+    };
+
+    auto extensions = settings.device_extensions;
+    if ( device.host_image_copy_ ) {
+        extensions.push_back( VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME );
+        extensions.push_back( VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME );
+    }
+    if ( device.descriptor_buffer_ ) { extensions.push_back( VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME ); }
+
     VkPhysicalDeviceVulkan12Features vk12_features{
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
-        .pNext = &sync2,
+        .pNext = device.descriptor_buffer_ ? static_cast<void*>( &descriptor_buffer ) : descriptor_buffer.pNext,
         .descriptorIndexing = VK_TRUE,
+        .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
         .descriptorBindingStorageImageUpdateAfterBind = VK_TRUE,
         .descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE,
         .descriptorBindingPartiallyBound = VK_TRUE,
@@ -273,6 +357,9 @@ VkResult Device::create_logical_device( Device& device, const DeviceSettings& se
     };
 
     VkPhysicalDeviceFeatures basic_features{
+        .samplerAnisotropy = physical_device.features.samplerAnisotropy,
+        // Images are only created in BC formats if the device supports them, see `ResourceManager::create_image`
+        .textureCompressionBC = physical_device.features.textureCompressionBC,
         .shaderStorageImageReadWithoutFormat = VK_TRUE,
         .shaderStorageImageWriteWithoutFormat = VK_TRUE,
         .shaderInt64 = VK_TRUE,
@@ -283,8 +370,8 @@ VkResult Device::create_logical_device( Device& device, const DeviceSettings& se
         .pNext = &vk12_features,
         .queueCreateInfoCount = static_cast<uint32_t>( queue_infos.size() ),
         .pQueueCreateInfos = queue_infos.data(),
-        .enabledExtensionCount = static_cast<uint32_t>( settings.device_extensions.size() ),
-        .ppEnabledExtensionNames = settings.device_extensions.data(),
+        .enabledExtensionCount = static_cast<uint32_t>( extensions.size() ),
+        .ppEnabledExtensionNames = extensions.data(),
         .pEnabledFeatures = &basic_features,
     };
 
@@ -318,9 +405,16 @@ VkResult Device::create_allocator( Device& device ) {
         .device = device.device(),
         .pVulkanFunctions = nullptr,
         .instance = device.instance(),
-        .vulkanApiVersion = VK_API_VERSION_1_0,
+        .vulkanApiVersion = VK_API_VERSION_1_2,
     };
 
+    // `VK_EXT_memory_budget` is a required device extension, so VMA can always query the live budget
+    allocator_info.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    // Descriptor buffers are written with the device addresses of the buffers they describe
+    if ( device.buffer_device_address_ || device.descriptor_buffer_ ) {
+        allocator_info.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+    }
+
     VmaVulkanFunctions vulkanFunctions = {};
     vmaImportVulkanFunctionsFromVolk( &allocator_info, &vulkanFunctions );
     allocator_info.pVulkanFunctions = &vulkanFunctions;
@@ -369,7 +463,7 @@ void Device::immediate_submit( const Queue& queue, const std::function<void( VkC
     VkFence fence;
     vkCreateFence( device_, &fence_info, nullptr, &fence );
 
-    vkQueueSubmit( queue.queue, 1, &submit_info, fence );
+    submit( queue, submit_info, fence );
     vkWaitForFences( device_, 1, &fence, VK_TRUE, UINT64_MAX );
 
     // Cleanup
@@ -438,4 +532,64 @@ Device::~Device() {
 }
 
 
-}// namespace aloe
\ No newline at end of file
+VkResult Device::submit( const Queue& queue, const VkSubmitInfo& submit_info, VkFence fence ) const {
+    std::scoped_lock lock( queue_mutex_ );
+    return vkQueueSubmit( queue.queue, 1, &submit_info, fence );
+}
+
+VkResult Device::present( VkQueue queue, const VkPresentInfoKHR& present_info ) const {
+    std::scoped_lock lock( queue_mutex_ );
+    return vkQueuePresentKHR( queue, &present_info );
+}
+
+VkResult Device::wait_idle( const Queue& queue ) const {
+    const VkFenceCreateInfo fence_info{ .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+    VkFence fence = VK_NULL_HANDLE;
+    if ( const auto result = vkCreateFence( device_, &fence_info, nullptr, &fence ); result != VK_SUCCESS ) {
+        return result;
+    }
+
+    // An empty submit signals its fence once all work previously submitted to the queue completes, so only the
+    // submit needs the queue lock and other threads can keep submitting while we wait.
+    auto result = submit_fence( queue.queue, fence );
+    if ( result == VK_SUCCESS ) { result = vkWaitForFences( device_, 1, &fence, VK_TRUE, UINT64_MAX ); }
+
+    vkDestroyFence( device_, fence, nullptr );
+    return result;
+}
+
+VkResult Device::wait_idle() const {
+    const VkFenceCreateInfo fence_info{ .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+    std::vector<VkFence> fences;
+    fences.reserve( queues_.size() );
+
+    auto result = VK_SUCCESS;
+    for ( const auto& queue : queues_ ) {
+        VkFence fence = VK_NULL_HANDLE;
+        result = vkCreateFence( device_, &fence_info, nullptr, &fence );
+        if ( result != VK_SUCCESS ) break;
+
+        fences.push_back( fence );
+        result = submit_fence( queue.queue, fence );
+        if ( result != VK_SUCCESS ) break;
+    }
+
+    if ( result == VK_SUCCESS && !fences.empty() ) {
+        result = vkWaitForFences( device_, static_cast<uint32_t>( fences.size() ), fences.data(), VK_TRUE, UINT64_MAX );
+    }
+
+    // A failed submit leaves earlier fences pending, so fall back to the device wait before destroying them
+    if ( result != VK_SUCCESS ) {
+        std::scoped_lock lock( queue_mutex_ );
+        vkDeviceWaitIdle( device_ );
+    }
+    for ( const auto fence : fences ) { vkDestroyFence( device_, fence, nullptr ); }
+    return result;
+}
+
+VkResult Device::submit_fence( VkQueue queue, VkFence fence ) const {
+    std::scoped_lock lock( queue_mutex_ );
+    return vkQueueSubmit( queue, 0, nullptr, fence );
+}
+
+}// namespace aloe
@@ -3,18 +3,189 @@
 #include <aloe/core/ResourceManager.h>
 #include <aloe/core/aloe.slang.h>
 #include <aloe/util/algorithms.h>
+#include <aloe/util/hash.h>
 #include <aloe/util/log.h>
+#include <aloe/util/thread_pool.h>
 #include <aloe/util/vulkan_util.h>
 
 #include <slang.h>
 
+#include <array>
+#include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <map>
 #include <ranges>
+#include <shared_mutex>
 #include <sstream>
+#include <thread>
 
 namespace aloe {
 
+// "ALPC", little endian
+constexpr static uint32_t pipeline_cache_magic = 0x43504c41;
+constexpr static uint32_t pipeline_cache_version = 1;
+// "ALSC", little endian
+constexpr static uint32_t shader_cache_magic = 0x43534c41;
+// Part of every shader cache key, bump it when the session options (or anything else which changes the SPIR-V we
+// generate) change.
+constexpr static uint32_t shader_cache_version = 1;
+
+// Packs trivially copyable values and length prefixed strings into bytes
+struct BinaryWriter {
+    std::string bytes;
+
+    template<typename T>
+        requires( std::is_trivially_copyable_v<T> )
+    void write( const T& value ) {
+        bytes.append( reinterpret_cast<const char*>( &value ), sizeof( T ) );
+    }
+
+    void write_string( std::string_view text ) {
+        write( static_cast<uint32_t>( text.size() ) );
+        bytes.append( text );
+    }
+};
+
+// Reads back what a `BinaryWriter` wrote. Once a read runs past the end `valid` is cleared, and every read after it
+// returns zeroes.
+struct BinaryReader {
+    std::string_view bytes;
+    bool valid = true;
+
+    template<typename T>
+        requires( std::is_trivially_copyable_v<T> )
+    T read() {
+        T value{};
+        if ( !consume( sizeof( T ) ) ) { return value; }
+        std::memcpy( &value, bytes.data() - sizeof( T ), sizeof( T ) );
+        return value;
+    }
+
+    std::string read_string() {
+        const auto size = read<uint32_t>();
+        return consume( size ) ? std::string( bytes.data() - size, size ) : std::string{};
+    }
+
+    bool consume( size_t size ) {
+        valid = valid && bytes.size() >= size;
+        bytes = valid ? bytes.substr( size ) : std::string_view{};
+        return valid;
+    }
+};
+
+// Writes `bytes` beside `path` and renames them over it, so a crash mid-write never leaves a truncated file behind
+static bool write_file_atomically( const std::filesystem::path& path, std::string_view bytes ) {
+    std::error_code error;
+    if ( path.has_parent_path() ) { std::filesystem::create_directories( path.parent_path(), error ); }
+
+    // Unique to the thread, as pipelines compiled at once may share a shader, and so a cache entry
+    auto temp_path = path;
+    temp_path += std::format( ".{}.tmp", std::hash<std::thread::id>{}( std::this_thread::get_id() ) );
+    {
+        std::ofstream file( temp_path, std::ios::binary | std::ios::trunc );
+        file.write( bytes.data(), static_cast<std::streamsize>( bytes.size() ) );
+        if ( !file ) {
+            log_write( LogLevel::Error, "Failed to write {}", temp_path.string() );
+            return false;
+        }
+    }
+
+    std::filesystem::rename( temp_path, path, error );
+    if ( error ) {
+        log_write( LogLevel::Error, "Failed to write {}, error: {}", path.string(), error.message() );
+        std::filesystem::remove( temp_path, error );
+        return false;
+    }
+    return true;
+}
+
+// The files `module` was built from (including its own source), as the names we track shaders by
+static std::vector<std::string> get_dependency_files( slang::IModule* module ) {
+    std::vector<std::string> files;
+    for ( auto i = 0; i < module->getDependencyFileCount(); ++i ) {
+        auto file = std::string{ module->getDependencyFilePath( i ) };
+        if ( const auto dot_pos = file.find( '.' ); dot_pos != std::string_view::npos ) {
+            if ( const auto colon_pos = file.find( ':', dot_pos ); colon_pos != std::string_view::npos ) {
+                file.erase( colon_pos );
+            }
+        }
+        files.emplace_back( std::move( file ) );
+    }
+    return files;
+}
+
+// Prefixes the driver's cache data on disk. Drivers are meant to reject data from another device or driver, but not
+// all do so robustly, so we check it ourselves before handing it over.
+struct PipelineCacheHeader {
+    uint32_t magic = pipeline_cache_magic;
+    uint32_t version = pipeline_cache_version;
+    uint32_t vendor_id = 0;
+    uint32_t device_id = 0;
+    uint32_t driver_version = 0;
+    uint32_t reserved = 0;
+    std::array<uint8_t, VK_UUID_SIZE> driver_uuid{};
+    std::array<uint8_t, VK_UUID_SIZE> cache_uuid{};
+    uint64_t data_size = 0;
+    Hash128 data_hash{};
+};
+
+// The header cache data created on `device` must carry, less the size and hash of the data
+static PipelineCacheHeader make_pipeline_cache_header( const Device& device ) {
+    VkPhysicalDeviceIDProperties id_props{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES };
+    VkPhysicalDeviceProperties2 props{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &id_props };
+    vkGetPhysicalDeviceProperties2( device.physical_device(), &props );
+
+    PipelineCacheHeader header{
+        .vendor_id = props.properties.vendorID,
+        .device_id = props.properties.deviceID,
+        .driver_version = props.properties.driverVersion,
+    };
+    std::ranges::copy( id_props.driverUUID, header.driver_uuid.begin() );
+    std::ranges::copy( props.properties.pipelineCacheUUID, header.cache_uuid.begin() );
+    return header;
+}
+
+// The cache data stored at `path`, or nothing if there is no file or it was written by another device or driver
+static std::vector<uint8_t> read_pipeline_cache( const std::filesystem::path& path,
+                                                 const PipelineCacheHeader& expected ) {
+    std::ifstream file( path, std::ios::binary );
+    if ( !file ) { return {}; }
+
+    auto report_error = [&]( std::string_view error_msg ) {
+        log_write( LogLevel::Warn, "Ignoring pipeline cache {}: {}", path.string(), error_msg );
+        return std::vector<uint8_t>{};
+    };
+
+    PipelineCacheHeader header;
+    if ( !file.read( reinterpret_cast<char*>( &header ), sizeof( header ) ) ) {
+        return report_error( "file is too small" );
+    }
+    if ( header.magic != pipeline_cache_magic ) { return report_error( "not a pipeline cache" ); }
+    if ( header.version != pipeline_cache_version ) { return report_error( "unsupported version" ); }
+    if ( header.vendor_id != expected.vendor_id || header.device_id != expected.device_id ||
+         header.cache_uuid != expected.cache_uuid ) {
+        return report_error( "written by another device" );
+    }
+    if ( header.driver_version != expected.driver_version || header.driver_uuid != expected.driver_uuid ) {
+        return report_error( "written by another driver" );
+    }
+
+    // Checked against the file before allocating, so a corrupt size cannot ask for an absurd amount of memory
+    std::error_code error;
+    if ( header.data_size != std::filesystem::file_size( path, error ) - sizeof( header ) || error ) {
+        return report_error( "file is truncated" );
+    }
+
+    std::vector<uint8_t> data( header.data_size );
+    if ( !file.read( reinterpret_cast<char*>( data.data() ), static_cast<std::streamsize>( data.size() ) ) ) {
+        return report_error( "file is truncated" );
+    }
+    if ( hash128( data.data(), data.size() ) != header.data_hash ) { return report_error( "data is corrupt" ); }
+    return data;
+}
+
 struct SlangFilesystem : ISlangFileSystem {
     explicit SlangFilesystem( std::vector<std::string> root_paths ) : root_paths_( std::move( root_paths ) ) {
         files_["aloe.slang"] = get_aloe_module();
@@ -22,7 +193,19 @@ struct SlangFilesystem : ISlangFileSystem {
     virtual ~SlangFilesystem() = default;
 
     // Add a file to the in-memory storage
-    void set_file( std::string path, std::string content ) { files_[std::move( path )] = std::move( content ); }
+    void set_file( std::string path, std::string content ) {
+        std::unique_lock lock( files_mutex_ );
+        files_[std::move( path )] = std::move( content );
+    }
+
+    // While alive, every file loaded on this thread is recorded into `loaded_files` as it was read. Each build runs on
+    // a single thread, so this tells it exactly what Slang compiled, even if files are changed while it runs.
+    struct Recording {
+        explicit Recording( std::unordered_map<std::string, std::string>& loaded_files ) {
+            recording_ = &loaded_files;
+        }
+        ~Recording() { recording_ = nullptr; }
+    };
 
     // Implementation of the loadFile method from ISlangFileSystem
     SlangResult loadFile( const char* path, ISlangBlob** outBlob ) override {
@@ -30,25 +213,36 @@ struct SlangFilesystem : ISlangFileSystem {
         std::string_view module_path = path;
         if ( module_path.ends_with( "-module" ) ) { module_path.remove_suffix( 7 ); }
 
-        const auto it = files_.find( std::string( module_path ) );
-        if ( it != files_.end() ) {
-            // File found in memory; create a blob from the in-memory file content
-            return create_blob( it->second, outBlob );
+        auto contents = read_file( module_path );
+        if ( !contents ) { return SLANG_E_NOT_FOUND; }
+
+        if ( recording_ != nullptr ) { recording_->try_emplace( normalise_path( module_path ), *contents ); }
+        return create_blob( std::move( *contents ), outBlob );
+    }
+
+    // The key a file is recorded under, so the paths Slang loads and reports as dependencies can be matched up
+    static std::string normalise_path( std::string_view path ) {
+        return std::filesystem::path( path ).lexically_normal().generic_string();
+    }
+
+    // The contents of `path`, from memory if it has been set as a virtual file, otherwise from the first root path
+    // which holds it
+    std::optional<std::string> read_file( std::string_view path ) const {
+        {
+            std::shared_lock lock( files_mutex_ );
+            const auto it = files_.find( std::string( path ) );
+            if ( it != files_.end() ) { return it->second; }
         }
 
-        // File not found in memory; attempt to read from the standard file system
         for ( const auto& root_path : root_paths_ ) {
-            const auto full_path = std::filesystem::path{ root_path } / module_path;
+            const auto full_path = std::filesystem::path{ root_path } / path;
             if ( std::filesystem::exists( full_path ) ) {
                 std::ifstream file( full_path, std::ios::binary );
-
-                // Read the file content into a vector
-                const std::string buffer( ( std::istreambuf_iterator( file ) ), std::istreambuf_iterator<char>() );
-                return create_blob( buffer, outBlob );
+                return std::string( ( std::istreambuf_iterator( file ) ), std::istreambuf_iterator<char>() );
             }
         }
 
-        return SLANG_E_NOT_FOUND;
+        return std::nullopt;
     }
 
     uint32_t addRef() override { return 1; }
@@ -92,7 +286,11 @@ private:
     }
 
     std::vector<std::string> root_paths_;
+    // Files are set on the owning thread, while compiles in the background read them
+    mutable std::shared_mutex files_mutex_;
     std::unordered_map<std::string, std::string> files_;
+
+    static inline thread_local std::unordered_map<std::string, std::string>* recording_ = nullptr;
 };
 
 const std::vector<PipelineManager::ShaderState*>& PipelineManager::ShaderState::get_dependents() const {
@@ -102,6 +300,8 @@ const std::vector<PipelineManager::ShaderState*>& PipelineManager::ShaderState::
 void PipelineManager::PipelineState::free_state( Device& device ) {
     if ( pipeline != VK_NULL_HANDLE ) { vkDestroyPipeline( device.device(), pipeline, nullptr ); }
     if ( layout != VK_NULL_HANDLE ) { vkDestroyPipelineLayout( device.device(), layout, nullptr ); }
+    pipeline = VK_NULL_HANDLE;
+    layout = VK_NULL_HANDLE;
 
     for ( auto& shader : compiled_shaders ) {
         if ( shader.shader_module != VK_NULL_HANDLE ) {
@@ -141,21 +341,40 @@ void PipelineManager::PipelineState::remove_resource( uint32_t resource_id ) {
 
 PipelineManager::PipelineManager( Device& device,
                                   ResourceManager& resource_manager,
-                                  std::vector<std::string> root_paths )
+                                  std::vector<std::string> root_paths,
+                                  std::filesystem::path pipeline_cache_path,
+                                  std::filesystem::path shader_cache_directory )
     : device_( device )
     , resource_manager_( resource_manager )
-    , root_paths_( std::move( root_paths ) ) {
-    if ( SLANG_FAILED( slang::createGlobalSession( global_session_.writeRef() ) ) ) {
+    , root_paths_( std::move( root_paths ) )
+    , pipeline_cache_path_( std::move( pipeline_cache_path ) )
+    , shader_cache_directory_( std::move( shader_cache_directory ) ) {
+    auto context = std::make_unique<SlangContext>();
+    if ( SLANG_FAILED( slang::createGlobalSession( context->global_session.writeRef() ) ) ) {
         throw std::runtime_error( "Failed to create Slang global session." );
     }
+    slang_build_tag_ = context->global_session->getBuildTagString();
+    slang_contexts_.emplace_back( std::move( context ) );
 
     filesystem_ = std::make_shared<SlangFilesystem>( root_paths_ );
     create_global_descriptor_layout();
+    create_pipeline_cache();
 }
 
 PipelineManager::~PipelineManager() {
+    // Background compiles use everything below, so they have to finish first
+    for ( auto& pending : pending_compiles_ ) {
+        auto build = pending.build.get();
+        if ( build ) { build->free_state( device_ ); }
+    }
+
     for ( auto& pipeline : pipelines_ ) { pipeline.free_state( device_ ); }
 
+    if ( pipeline_cache_ != VK_NULL_HANDLE ) {
+        if ( !pipeline_cache_path_.empty() ) { save_pipeline_cache(); }
+        vkDestroyPipelineCache( device_.device(), pipeline_cache_, nullptr );
+    }
+
     if ( global_descriptor_set_ != VK_NULL_HANDLE ) {
         vkFreeDescriptorSets( device_.device(), global_descriptor_pool_, 1, &global_descriptor_set_ );
     }
@@ -172,24 +391,97 @@ PipelineManager::~PipelineManager() {
 std::expected<PipelineHandle, std::string>
 PipelineManager::compile_pipeline( const ComputePipelineInfo& compute_pipeline ) {
     auto& state = get_pipeline_state( compute_pipeline );
-    state.free_state( device_ );// if we are re-compiling, ensure we free our prior (i.a) state
+    return install_pipeline( state, build_pipeline( compute_pipeline ) );
+}
+
+std::expected<PipelineHandle, std::string>
+PipelineManager::compile_pipeline( const GraphicsPipelineInfo& graphics_pipeline ) {
+    auto& state = get_pipeline_state( graphics_pipeline );
+    return install_pipeline( state, build_pipeline( graphics_pipeline ) );
+}
+
+std::vector<std::expected<PipelineHandle, std::string>>
+PipelineManager::compile_pipelines( std::span<const PipelineInfo> pipeline_infos ) {
+    // Find every state up front, as `pipelines_` can not grow while pipelines are being built
+    std::vector<uint32_t> ids;
+    for ( const auto& info : pipeline_infos ) {
+        const auto& state = std::visit(
+            [&]( const auto& pipeline_info ) -> PipelineState& { return get_pipeline_state( pipeline_info ); },
+            info );
+        ids.emplace_back( state.id );
+    }
+
+    // Pipelines asked for more than once are only built once
+    auto unique_ids = ids;
+    std::ranges::sort( unique_ids );
+    unique_ids.erase( std::ranges::unique( unique_ids ).begin(), unique_ids.end() );
+
+    // A single pipeline is not worth the round trip through a worker
+    const bool parallel = unique_ids.size() > 1;
+    std::vector<std::future<std::expected<PipelineState, std::string>>> builds;
+    if ( parallel ) {
+        for ( const auto id : unique_ids ) {
+            builds.emplace_back(
+                compile_workers().submit( [this, info = pipelines_[id].info]() { return build_pipeline( info ); } ) );
+        }
+    }
+
+    // Installed in order on this thread, as that touches state shared by every pipeline
+    std::unordered_map<uint32_t, std::expected<PipelineHandle, std::string>> results;
+    for ( size_t i = 0; i < unique_ids.size(); ++i ) {
+        const auto id = unique_ids[i];
+        auto build = parallel ? builds[i].get() : build_pipeline( pipelines_[id].info );
+        results.emplace( id, install_pipeline( pipelines_[id], std::move( build ) ) );
+    }
+
+    return ids | std::views::transform( [&]( uint32_t id ) { return results.at( id ); } ) |
+        std::ranges::to<std::vector>();
+}
+
+std::expected<PipelineManager::PipelineState, std::string> PipelineManager::build_pipeline( const PipelineInfo& info ) {
+    auto context = acquire_slang_context();
+    if ( context == nullptr ) { return std::unexpected( "Failed to create Slang global session." ); }
+
+    // Taken once, so defines set while the pipeline is being built can not leave its shaders and cache keys disagreeing
+    {
+        std::shared_lock lock( defines_mutex_ );
+        context->defines = std::map<std::string, std::string>( defines_.begin(), defines_.end() );
+        context->defines_generation = defines_generation_;
+    }
+
+    auto build = std::visit( [&]( const auto& pipeline_info ) { return build_pipeline( *context, pipeline_info ); },
+                             info );
+    release_slang_context( std::move( context ) );
+    return build;
+}
+
+std::expected<PipelineManager::PipelineState, std::string>
+PipelineManager::build_pipeline( SlangContext& context, const ComputePipelineInfo& compute_pipeline ) {
+    PipelineState state{ .info = compute_pipeline };
+    const auto fail = [&]( std::string error ) {
+        state.free_state( device_ );
+        return std::unexpected( std::move( error ) );
+    };
 
     // Compile our shader for the pipeline
-    const auto compiled_shader = get_compiled_shader( compute_pipeline.compute_shader );
-    if ( !compiled_shader ) { return std::unexpected( compiled_shader.error() ); }
+    const auto compiled_shader = get_compiled_shader( context, compute_pipeline.compute_shader );
+    if ( !compiled_shader ) { return fail( compiled_shader.error() ); }
     state.compiled_shaders = { *compiled_shader };
 
     // Reflect and ensure that our uniform blocks (push constants) do not overlap.
     auto uniform_block = get_uniform_block( state.compiled_shaders );
-    if ( !uniform_block ) { return std::unexpected( uniform_block.error() ); }
+    if ( !uniform_block ) { return fail( uniform_block.error() ); }
     state.uniforms = std::move( *uniform_block );
 
     const auto pipeline_layout = get_pipeline_layout( state.compiled_shaders );
-    if ( !pipeline_layout ) { return std::unexpected( pipeline_layout.error() ); }
+    if ( !pipeline_layout ) { return fail( pipeline_layout.error() ); }
     state.layout = *pipeline_layout;
 
     VkComputePipelineCreateInfo create_info{
         .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .flags = descriptor_buffer_
+            ? VkPipelineCreateFlags{ VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT }
+            : VkPipelineCreateFlags{ 0 },
         .stage = {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
             .stage = VK_SHADER_STAGE_COMPUTE_BIT,
@@ -200,38 +492,77 @@ PipelineManager::compile_pipeline( const ComputePipelineInfo& compute_pipeline )
     };
 
     const auto result =
-        vkCreateComputePipelines( device_.device(), VK_NULL_HANDLE, 1, &create_info, nullptr, &state.pipeline );
+        vkCreateComputePipelines( device_.device(), pipeline_cache_, 1, &create_info, nullptr, &state.pipeline );
     if ( result != VK_SUCCESS ) {
-        return std::unexpected( std::format( "Failed to make compute pipeline, error: {}", result ) );
+        return fail( std::format( "Failed to make compute pipeline, error: {}", result ) );
     }
 
-    state.version++;
-    return PipelineHandle{ state.id };
+    return state;
 }
 
-std::expected<PipelineHandle, std::string>
-PipelineManager::compile_pipeline( const GraphicsPipelineInfo& graphics_pipeline ) {
-    auto& state = get_pipeline_state( graphics_pipeline );
-    state.free_state( device_ );// if we are re-compiling, ensure we free our prior (i.a) state
+std::expected<PipelineManager::PipelineState, std::string>
+PipelineManager::build_pipeline( SlangContext& context, const GraphicsPipelineInfo& graphics_pipeline ) {
+    PipelineState state{ .info = graphics_pipeline };
+    const auto fail = [&]( std::string error ) {
+        state.free_state( device_ );
+        return std::unexpected( std::move( error ) );
+    };
 
     // Compile our shader for the pipeline
     for ( const auto& shader : { graphics_pipeline.vertex_shader, graphics_pipeline.fragment_shader } ) {
-        const auto compiled_shader = get_compiled_shader( shader );
-        if ( !compiled_shader ) { return std::unexpected( compiled_shader.error() ); }
+        const auto compiled_shader = get_compiled_shader( context, shader );
+        if ( !compiled_shader ) { return fail( compiled_shader.error() ); }
         state.compiled_shaders.emplace_back( *compiled_shader );
     }
 
     // Reflect and ensure that our uniform blocks (push constants) do not overlap.
     auto uniform_block = get_uniform_block( state.compiled_shaders );
-    if ( !uniform_block ) { return std::unexpected( uniform_block.error() ); }
+    if ( !uniform_block ) { return fail( uniform_block.error() ); }
     state.uniforms = std::move( *uniform_block );
 
     const auto pipeline_layout = get_pipeline_layout( state.compiled_shaders );
-    if ( !pipeline_layout ) { return std::unexpected( pipeline_layout.error() ); }
+    if ( !pipeline_layout ) { return fail( pipeline_layout.error() ); }
     state.layout = *pipeline_layout;
 
     // todo: implement proper graphics pipeline creation
 
+    return state;
+}
+
+std::expected<PipelineHandle, std::string>
+PipelineManager::install_pipeline( PipelineState& state, std::expected<PipelineState, std::string> build ) {
+    // Anything still compiling in the background for this pipeline is now out of date
+    latest_compile_requests_.erase( state.id );
+    // A failed recompile keeps the previous version, which is only freed once there is a new one to replace it
+    if ( !build ) { return std::unexpected( std::move( build.error() ) ); }
+
+    for ( const auto& shader : build->compiled_shaders ) {
+        if ( const auto error = update_shader_dependency_graph( { .name = shader.name }, shader.dependency_files ) ) {
+            build->free_state( device_ );
+            return std::unexpected( "Failed to iterate dependencies, error: " + *error );
+        }
+    }
+
+    // Values set on the previous version (including bindless handles) carry over to every uniform which is laid out
+    // the same in the new one, so a recompile does not reset them
+    if ( state.uniforms && build->uniforms ) {
+        for ( const auto& shader : build->compiled_shaders ) {
+            for ( const auto& uniform : shader.uniforms ) {
+                const auto declares = [&]( const auto& old ) { return std::ranges::contains( old.uniforms, uniform ); };
+                if ( !std::ranges::any_of( state.compiled_shaders, declares ) ) { continue; }
+
+                build->uniforms->copy( *state.uniforms, uniform.offset, uniform.size );
+            }
+        }
+    }
+
+    state.free_state( device_ );
+    state.compiled_shaders = std::move( build->compiled_shaders );
+    for ( auto& shader : state.compiled_shaders ) { store_cached_shader( shader ); }
+    state.uniforms = std::move( build->uniforms );
+    state.layout = build->layout;
+    state.pipeline = build->pipeline;
+
     state.version++;
     return PipelineHandle{ state.id };
 }
@@ -249,6 +580,10 @@ bool PipelineManager::is_graphics_pipeline( PipelineHandle handle ) const {
     return state ? std::holds_alternative<GraphicsPipelineInfo>( state->info ) : false;
 }
 
+uint32_t PipelineManager::get_shader_cache_hits() const {
+    return shader_cache_hits_;
+}
+
 uint64_t PipelineManager::get_pipeline_version( PipelineHandle handle ) const {
     const auto* state = get_pipeline_state( handle );
     return state ? state->version : 0;
@@ -274,16 +609,69 @@ bool PipelineManager::bind_pipeline( PipelineHandle handle, VkCommandBuffer buff
     const auto pc_stage = is_graphics ? VK_SHADER_STAGE_ALL_GRAPHICS : VK_SHADER_STAGE_COMPUTE_BIT;
 
     // todo: we should only bind the descriptor set once per "frame" or "task".
-    vkCmdBindDescriptorSets( buffer, bind_point, state->layout, 0, 1, &global_descriptor_set_, 0, nullptr );
+    if ( descriptor_buffer_ ) {
+        const auto& heap = resource_manager_.descriptor_heap_;
+        const VkDescriptorBufferBindingInfoEXT binding_info{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT,
+            .address = heap.address,
+            .usage = heap.usage,
+        };
+        const uint32_t buffer_index = 0;
+        const VkDeviceSize offset = 0;
+        vkCmdBindDescriptorBuffersEXT( buffer, 1, &binding_info );
+        vkCmdSetDescriptorBufferOffsetsEXT( buffer, bind_point, state->layout, 0, 1, &buffer_index, &offset );
+    } else {
+        vkCmdBindDescriptorSets( buffer, bind_point, state->layout, 0, 1, &global_descriptor_set_, 0, nullptr );
+    }
     vkCmdPushConstants( buffer, state->layout, pc_stage, 0, state->uniforms->size(), state->uniforms->data() );
     vkCmdBindPipeline( buffer, bind_point, state->pipeline );
 
     return true;
 }
 
+void PipelineManager::set_async_compilation( bool enabled ) {
+    async_compilation_ = enabled;
+    if ( !enabled ) { process_pending_compiles( true ); }
+}
+
+std::vector<std::expected<PipelineHandle, std::string>> PipelineManager::process_pending_compiles( bool wait ) {
+    std::vector<std::expected<PipelineHandle, std::string>> results;
+    std::erase_if( pending_compiles_, [&]( PendingCompile& pending ) {
+        if ( !wait && pending.build.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready ) {
+            return false;
+        }
+
+        auto build = pending.build.get();
+        const auto latest = latest_compile_requests_.find( pending.id );
+        if ( latest == latest_compile_requests_.end() || latest->second != pending.request ) {
+            // Superseded by a newer compile (queued or already installed) of the same pipeline
+            if ( build ) { build->free_state( device_ ); }
+            return true;
+        }
+
+        if ( !build ) {
+            latest_compile_requests_.erase( latest );
+            log_write( LogLevel::Error,
+                       "Failed to recompile pipeline {}, keeping the previous version: {}",
+                       pending.id,
+                       build.error() );
+            results.emplace_back( std::unexpected( std::move( build.error() ) ) );
+            return true;
+        }
+
+        results.emplace_back( install_pipeline( pipelines_[pending.id], std::move( build ) ) );
+        return true;
+    } );
+
+    return results;
+}
+
 void PipelineManager::set_define( const std::string& name, const std::string& value ) {
-    defines_[name] = value;
-    session_ = nullptr;
+    {
+        std::unique_lock lock( defines_mutex_ );
+        defines_[name] = value;
+        defines_generation_++;
+    }
 
     // Recompile all shaders that have an entry point
     recompile_dependents( shaders_ | std::views::transform( []( const auto& shader ) { return shader->name; } ) |
@@ -300,19 +688,64 @@ void PipelineManager::bind_slots() const {
     resource_manager_.bind_descriptors( global_descriptor_set_ );
 }
 
-Slang::ComPtr<slang::ISession> PipelineManager::get_session() {
-    // Rebuild the session if we have been asked, or it has not yet been set.
-    if ( session_ == nullptr ) {
+std::unique_ptr<PipelineManager::SlangContext> PipelineManager::acquire_slang_context() {
+    {
+        std::scoped_lock lock( slang_contexts_mutex_ );
+        if ( !slang_contexts_.empty() ) {
+            auto context = std::move( slang_contexts_.back() );
+            slang_contexts_.pop_back();
+            return context;
+        }
+    }
+
+    // Every context is busy, creating a global session takes a while but only happens once per concurrent compile
+    auto context = std::make_unique<SlangContext>();
+    if ( SLANG_FAILED( slang::createGlobalSession( context->global_session.writeRef() ) ) ) {
+        log_write( LogLevel::Error, "Failed to create Slang global session." );
+        return nullptr;
+    }
+    return context;
+}
+
+void PipelineManager::release_slang_context( std::unique_ptr<SlangContext> context ) {
+    std::scoped_lock lock( slang_contexts_mutex_ );
+    slang_contexts_.emplace_back( std::move( context ) );
+}
+
+ThreadPool& PipelineManager::compile_workers() {
+    if ( compile_workers_ == nullptr ) {
+        compile_workers_ = std::make_unique<ThreadPool>( std::thread::hardware_concurrency() );
+    }
+    return *compile_workers_;
+}
+
+void PipelineManager::queue_compile( uint32_t id, const PipelineInfo& info ) {
+    const auto request = ++compile_requests_;
+    latest_compile_requests_[id] = request;
+    pending_compiles_.emplace_back( PendingCompile{
+        .id = id,
+        .request = request,
+        .build = compile_workers().submit( [this, info]() { return build_pipeline( info ); } ),
+    } );
+}
+
+Slang::ComPtr<slang::ISession> PipelineManager::get_session( SlangContext& context ) {
+    // Rebuild the session if the defines have changed, or it has not yet been set.
+    if ( context.session == nullptr || context.session_generation != context.defines_generation ) {
+        context.session = nullptr;
+        context.session_generation = context.defines_generation;
+
         const auto root_paths = root_paths_ | std::views::transform( []( const auto& path ) { return path.c_str(); } ) |
             std::ranges::to<std::vector>();
-        const auto defines = defines_ | std::views::transform( []( const auto& pair ) -> slang::PreprocessorMacroDesc {
-                                 return { pair.first.c_str(), pair.second.c_str() };
-                             } ) |
+        const auto defines = context.defines |
+            std::views::transform( []( const auto& pair ) -> slang::PreprocessorMacroDesc {
+                return { pair.first.c_str(), pair.second.c_str() };
+            } ) |
             std::ranges::to<std::vector>();
 
         auto target_desc = slang::TargetDesc{};
         target_desc.format = SlangCompileTarget::SLANG_SPIRV;
-        target_desc.profile = global_session_->findProfile( "spirv_1_5" );
+        target_desc.profile = context.global_session->findProfile( "spirv_1_5" );
         target_desc.flags = SLANG_TARGET_FLAG_GENERATE_SPIRV_DIRECTLY;
 
         std::vector<slang::CompilerOptionEntry> options;
@@ -331,13 +764,13 @@ Slang::ComPtr<slang::ISession> PipelineManager::get_session() {
         session_desc.compilerOptionEntries = options.data();
         session_desc.compilerOptionEntryCount = options.size();
 
-        if ( SLANG_FAILED( global_session_->createSession( session_desc, session_.writeRef() ) ) ) {
+        if ( SLANG_FAILED( context.global_session->createSession( session_desc, context.session.writeRef() ) ) ) {
             log_write( LogLevel::Error, "Failed to create Slang session." );
             return nullptr;
         }
     }
 
-    return session_;
+    return context.session;
 }
 
 PipelineManager::ShaderState& PipelineManager::get_shader_state( const ShaderCompileInfo& info ) {
@@ -347,56 +780,50 @@ PipelineManager::ShaderState& PipelineManager::get_shader_state( const ShaderCom
     return **iter;
 }
 
-std::optional<std::string> PipelineManager::compile_module( const ShaderCompileInfo& info ) {
-    auto& shader = get_shader_state( info );
-    shader.module = nullptr;
-
-    const auto session = get_session();
+std::optional<std::string>
+PipelineManager::compile_module( SlangContext& context, const ShaderCompileInfo& info, SlangModule& module ) {
+    const auto session = get_session( context );
     if ( session == nullptr ) { return "Failed to get session"; }
 
-    if ( SLANG_FAILED( session->createCompileRequest( shader.compile_request.writeRef() ) ) ) {
+    if ( SLANG_FAILED( session->createCompileRequest( module.compile_request.writeRef() ) ) ) {
         return "Failed to create compile request";
     }
 
     // Compile our source file
-    const auto tu_index = shader.compile_request->addTranslationUnit( SLANG_SOURCE_LANGUAGE_SLANG, info.name.c_str() );
-    shader.compile_request->addTranslationUnitSourceFile( tu_index, info.name.c_str() );
+    const auto tu_index = module.compile_request->addTranslationUnit( SLANG_SOURCE_LANGUAGE_SLANG, info.name.c_str() );
+    module.compile_request->addTranslationUnitSourceFile( tu_index, info.name.c_str() );
 
-    if ( SLANG_FAILED( shader.compile_request->compile() ) ) {
-        const auto diagnostics = std::string{ shader.compile_request->getDiagnosticOutput() };
+    if ( SLANG_FAILED( module.compile_request->compile() ) ) {
+        const auto diagnostics = std::string{ module.compile_request->getDiagnosticOutput() };
         return "Failed to compile shader (" + info.name + ": " + diagnostics;
     }
 
     // Compile the module for our shader
-    if ( SLANG_FAILED( shader.compile_request->getModule( tu_index, shader.module.writeRef() ) ) ) {
-        const auto diagnostics = std::string{ shader.compile_request->getDiagnosticOutput() };
+    if ( SLANG_FAILED( module.compile_request->getModule( tu_index, module.module.writeRef() ) ) ) {
+        const auto diagnostics = std::string{ module.compile_request->getDiagnosticOutput() };
         return "Failed to get module for compilation request (" + info.name + "), error: " + diagnostics;
     }
 
-    // Update the shaders compilation information
-    if ( const auto error = update_shader_dependency_graph( info ) ) {
-        return "Failed to iterate dependencies, error: " + *error;
-    }
-
     return std::nullopt;
 }
 
-std::optional<std::string> PipelineManager::compile_spirv( const ShaderCompileInfo& info,
+std::optional<std::string> PipelineManager::compile_spirv( SlangContext& context,
+                                                           const ShaderCompileInfo& info,
+                                                           const SlangModule& module,
                                                            std::vector<uint32_t>& spirv ) {
-    const auto& shader = get_shader_state( info );
-    assert( shader.module != nullptr );
+    assert( module.module != nullptr );
 
-    const auto session = get_session();
+    const auto session = get_session( context );
     if ( session == nullptr ) { return "Failed to get session"; }
 
     Slang::ComPtr<slang::IEntryPoint> entry_point = nullptr;
-    if ( SLANG_FAILED( ( shader.module->findEntryPointByName( info.entry_point.c_str(), entry_point.writeRef() ) ) ) ) {
+    if ( SLANG_FAILED( ( module.module->findEntryPointByName( info.entry_point.c_str(), entry_point.writeRef() ) ) ) ) {
         return std::format( "Could not find entry point {}", info.entry_point );
     }
 
     Slang::ComPtr<slang::IBlob> diagnostics;
     Slang::ComPtr<slang::IComponentType> composite_program = nullptr;
-    slang::IComponentType* components[] = { shader.module, entry_point.get() };
+    slang::IComponentType* components[] = { module.module, entry_point.get() };
     if ( SLANG_FAILED( session->createCompositeComponentType( components,
                                                               2,
                                                               composite_program.writeRef(),
@@ -427,22 +854,16 @@ std::optional<std::string> PipelineManager::compile_spirv( const ShaderCompileIn
     return std::nullopt;
 }
 
-std::optional<std::string> PipelineManager::update_shader_dependency_graph( const ShaderCompileInfo& info ) {
+std::optional<std::string>
+PipelineManager::update_shader_dependency_graph( const ShaderCompileInfo& info,
+                                                 const std::vector<std::string>& dependency_files ) {
     auto& shader = get_shader_state( info );
-    assert( shader.module != nullptr );
 
     // Fix any links pointing to our current shader as a dependent, as they may have been changed
     std::ranges::for_each( shader.dependencies, [&]( ShaderState* d ) { std::erase( d->dependents, &shader ); } );
     shader.dependencies.clear();
 
-    for ( auto i = 0; i < shader.module->getDependencyFileCount(); ++i ) {
-        auto file = std::string{ shader.module->getDependencyFilePath( i ) };
-        if ( const auto dot_pos = file.find( '.' ); dot_pos != std::string_view::npos ) {
-            if ( const auto colon_pos = file.find( ':', dot_pos ); colon_pos != std::string_view::npos ) {
-                file.erase( colon_pos );
-            }
-        }
-
+    for ( const auto& file : dependency_files ) {
         auto& dependency_shader = get_shader_state( { .name = file } );
         if ( &dependency_shader == &shader ) { continue; }
 
@@ -464,12 +885,21 @@ void PipelineManager::recompile_dependents( const std::vector<std::string>& shad
                              } );
                          } );
 
-    for ( const auto& pipeline : all_pipelines ) {
-        std::visit( [&]( const auto& pipeline_info ) { compile_pipeline( pipeline_info ); }, pipeline.info );
+    // Built in the background, each pipeline keeps its current version until `process_pending_compiles`
+    if ( async_compilation_ ) {
+        for ( const auto& pipeline : all_pipelines ) { queue_compile( pipeline.id, pipeline.info ); }
+        return;
     }
+
+    // Rebuilt together, so they are spread over the compile workers
+    const auto pipeline_infos =
+        all_pipelines | std::views::transform( &PipelineState::info ) | std::ranges::to<std::vector>();
+    compile_pipelines( pipeline_infos );
 }
 
-void PipelineManager::reflect_module( const ShaderCompileInfo& info, CompiledShaderState& state ) {
+void PipelineManager::reflect_module( const ShaderCompileInfo& info,
+                                      const SlangModule& module,
+                                      CompiledShaderState& state ) {
     constexpr auto from_slang_stage = []( SlangStage stage ) -> VkShaderStageFlags {
         switch ( stage ) {
             case SlangStage::SLANG_STAGE_VERTEX: return VK_SHADER_STAGE_VERTEX_BIT;
@@ -484,9 +914,7 @@ void PipelineManager::reflect_module( const ShaderCompileInfo& info, CompiledSha
         return VK_SHADER_STAGE_ALL;
     };
 
-    const auto& shader = get_shader_state( info );
-
-    auto* reflection = reinterpret_cast<slang::ShaderReflection*>( shader.compile_request->getReflection() );
+    auto* reflection = reinterpret_cast<slang::ShaderReflection*>( module.compile_request->getReflection() );
     auto* entry_point_reflection = reflection->findEntryPointByName( info.entry_point.c_str() );
 
     state.stage = from_slang_stage( entry_point_reflection->getStage() );
@@ -509,50 +937,29 @@ void PipelineManager::reflect_module( const ShaderCompileInfo& info, CompiledSha
 void PipelineManager::create_global_descriptor_layout() {
     const auto limits = device_.get_physical_device_limits();
 
-    // Make the descriptor pool.
-    {
-
-        std::vector<VkDescriptorPoolSize> pools;
-        // Eventually we will extend this to support images etc.
-        pools.emplace_back( VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, limits.maxDescriptorSetStorageBuffers );
-        pools.emplace_back( VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, limits.maxDescriptorSetStorageImages );
-
-        VkDescriptorPoolCreateInfo descriptor_pool_create_info{
-            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-            .flags =
-                VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT | VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
-            .maxSets = 1,
-            .poolSizeCount = static_cast<uint32_t>( pools.size() ),
-            .pPoolSizes = pools.data(),
-        };
-
-        const auto result =
-            vkCreateDescriptorPool( device_.device(), &descriptor_pool_create_info, nullptr, &global_descriptor_pool_ );
-        if ( result != VK_SUCCESS ) { throw std::runtime_error{ "failed to create descriptor pool" }; }
-    }
-
-    // Make the descriptor set layout
-    {
+    // Make the descriptor set layout, descriptor buffers can always be written while in use, so only the pool backed
+    // set needs update after bind
+    auto create_set_layout = [&]( bool descriptor_buffer ) {
         std::vector<VkDescriptorSetLayoutBinding> layout_bindings;
         std::vector<VkDescriptorBindingFlags> binding_flags;
 
-        layout_bindings.emplace_back( get_binding_slot( VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ),
-                                      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                                      limits.maxDescriptorSetStorageBuffers,
-                                      VK_SHADER_STAGE_ALL,
-                                      nullptr );
-
-        layout_bindings.emplace_back( get_binding_slot( VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ),
-                                      VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                                      limits.maxDescriptorSetStorageImages,
-                                      VK_SHADER_STAGE_ALL,
-                                      nullptr );
+        for ( const auto type : bindless_descriptor_types ) {
+            layout_bindings.emplace_back( get_binding_slot( type ),
+                                          type,
+                                          get_binding_count( type, limits ),
+                                          VK_SHADER_STAGE_ALL,
+                                          nullptr );
+        }
 
+        VkDescriptorBindingFlags flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+        VkDescriptorSetLayoutCreateFlags layout_flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+        if ( !descriptor_buffer ) {
+            flags |= VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+            layout_flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        }
 
         binding_flags.resize( layout_bindings.size() );
-        std::ranges::fill( binding_flags,
-                           VkDescriptorBindingFlags{ VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
-                                                     VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT } );
+        std::ranges::fill( binding_flags, flags );
 
         VkDescriptorSetLayoutBindingFlagsCreateInfo layout_binding_flags_create_info{
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
@@ -563,7 +970,7 @@ void PipelineManager::create_global_descriptor_layout() {
         VkDescriptorSetLayoutCreateInfo set_layout_create_info{
             .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
             .pNext = &layout_binding_flags_create_info,
-            .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+            .flags = layout_flags,
             .bindingCount = static_cast<uint32_t>( layout_bindings.size() ),
             .pBindings = layout_bindings.data(),
         };
@@ -573,8 +980,45 @@ void PipelineManager::create_global_descriptor_layout() {
                                                          nullptr,
                                                          &global_descriptor_set_layout );
         if ( result != VK_SUCCESS ) { throw std::runtime_error{ "failed to create descriptor set layout" }; }
+    };
+
+    // Prefer a descriptor buffer, but the whole table has to fit in one, otherwise it is backed by a pool and set
+    if ( device_.descriptor_buffer_enabled() ) {
+        create_set_layout( true );
+        if ( resource_manager_.create_descriptor_buffer( global_descriptor_set_layout ) ) {
+            descriptor_buffer_ = true;
+            return;
+        }
+
+        log_write( LogLevel::Warn, "Falling back to a descriptor pool and set for the bindless table" );
+        vkDestroyDescriptorSetLayout( device_.device(), global_descriptor_set_layout, nullptr );
+        global_descriptor_set_layout = VK_NULL_HANDLE;
     }
 
+    // Make the descriptor pool.
+    {
+
+        std::vector<VkDescriptorPoolSize> pools;
+        for ( const auto type : bindless_descriptor_types ) {
+            pools.emplace_back( type, get_binding_count( type, limits ) );
+        }
+
+        VkDescriptorPoolCreateInfo descriptor_pool_create_info{
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .flags =
+                VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT | VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+            .maxSets = 1,
+            .poolSizeCount = static_cast<uint32_t>( pools.size() ),
+            .pPoolSizes = pools.data(),
+        };
+
+        const auto result =
+            vkCreateDescriptorPool( device_.device(), &descriptor_pool_create_info, nullptr, &global_descriptor_pool_ );
+        if ( result != VK_SUCCESS ) { throw std::runtime_error{ "failed to create descriptor pool" }; }
+    }
+
+    create_set_layout( false );
+
     // Make the descriptor set
     {
         VkDescriptorSetAllocateInfo descriptor_set_allocate_info{
@@ -590,18 +1034,183 @@ void PipelineManager::create_global_descriptor_layout() {
     }
 }
 
+void PipelineManager::create_pipeline_cache() {
+    const auto initial_data = pipeline_cache_path_.empty()
+        ? std::vector<uint8_t>{}
+        : read_pipeline_cache( pipeline_cache_path_, make_pipeline_cache_header( device_ ) );
+
+    VkPipelineCacheCreateInfo create_info{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = initial_data.size(),
+        .pInitialData = initial_data.data(),
+    };
+    auto result = vkCreatePipelineCache( device_.device(), &create_info, nullptr, &pipeline_cache_ );
+    if ( result != VK_SUCCESS && !initial_data.empty() ) {
+        log_write( LogLevel::Warn, "Driver rejected pipeline cache {}, starting empty", pipeline_cache_path_.string() );
+        create_info.initialDataSize = 0;
+        create_info.pInitialData = nullptr;
+        result = vkCreatePipelineCache( device_.device(), &create_info, nullptr, &pipeline_cache_ );
+    }
+
+    // Pipelines can still be created without a cache, they are just slower to build
+    if ( result != VK_SUCCESS ) {
+        log_write( LogLevel::Error, "Failed to create pipeline cache, error: {}", result );
+        pipeline_cache_ = VK_NULL_HANDLE;
+    }
+}
+
+bool PipelineManager::save_pipeline_cache() const {
+    if ( pipeline_cache_ == VK_NULL_HANDLE || pipeline_cache_path_.empty() ) { return false; }
+
+    size_t size = 0;
+    std::vector<uint8_t> data;
+    auto result = vkGetPipelineCacheData( device_.device(), pipeline_cache_, &size, nullptr );
+    if ( result == VK_SUCCESS ) {
+        data.resize( size );
+        result = vkGetPipelineCacheData( device_.device(), pipeline_cache_, &size, data.data() );
+        data.resize( size );
+    }
+    if ( result != VK_SUCCESS ) {
+        log_write( LogLevel::Error, "Failed to read pipeline cache data, error: {}", result );
+        return false;
+    }
+
+    auto header = make_pipeline_cache_header( device_ );
+    header.data_size = data.size();
+    header.data_hash = hash128( data.data(), data.size() );
+
+    BinaryWriter writer;
+    writer.write( header );
+    writer.bytes.append( reinterpret_cast<const char*>( data.data() ), data.size() );
+    return write_file_atomically( pipeline_cache_path_, writer.bytes );
+}
+
+std::filesystem::path PipelineManager::get_shader_cache_path( const SlangContext& context,
+                                                              const ShaderCompileInfo& info ) const {
+    auto key = std::format( "{}\n{}\n{}\n{}\n",
+                            shader_cache_version,
+                            slang_build_tag_,
+                            info.name,
+                            info.entry_point );
+    // Sorted, so the key does not depend on the order defines were set in
+    for ( const auto& [name, value] : context.defines ) { key += std::format( "{}={}\n", name, value ); }
+
+    const auto hash = hash128( key.data(), key.size() );
+    return shader_cache_directory_ / std::format( "{:016x}{:016x}.bin", hash.high, hash.low );
+}
+
+bool PipelineManager::load_cached_shader( const SlangContext& context,
+                                          const ShaderCompileInfo& info,
+                                          CompiledShaderState& state ) {
+    if ( shader_cache_directory_.empty() ) { return false; }
+
+    std::ifstream file( get_shader_cache_path( context, info ), std::ios::binary );
+    if ( !file ) { return false; }
+    const std::string bytes( ( std::istreambuf_iterator( file ) ), std::istreambuf_iterator<char>() );
+
+    BinaryReader reader{ bytes };
+    if ( reader.read<uint32_t>() != shader_cache_magic ) { return false; }
+    const auto stage = reader.read<VkShaderStageFlags>();
+
+    // The entry is stale if any of the files it was built from have changed since
+    std::vector<std::string> dependencies;
+    const auto dependency_count = reader.read<uint32_t>();
+    for ( uint32_t i = 0; i < dependency_count && reader.valid; ++i ) {
+        const auto& dependency = dependencies.emplace_back( reader.read_string() );
+        const auto hash = reader.read<Hash128>();
+        const auto contents = filesystem_->read_file( dependency );
+        if ( !contents || hash128( contents->data(), contents->size() ) != hash ) { return false; }
+    }
+
+    std::vector<CompiledShaderState::Uniform> uniforms;
+    const auto uniform_count = reader.read<uint32_t>();
+    for ( uint32_t i = 0; i < uniform_count && reader.valid; ++i ) {
+        auto& uniform = uniforms.emplace_back();
+        uniform.offset = reader.read<uint32_t>();
+        uniform.size = reader.read<uint32_t>();
+        uniform.name = reader.read_string();
+        uniform.type_name = reader.read_string();
+    }
+
+    const auto word_count = reader.read<uint32_t>();
+    if ( !reader.valid || reader.bytes.size() != uint64_t{ word_count } * sizeof( uint32_t ) ) { return false; }
+
+    state.stage = stage;
+    state.uniforms = std::move( uniforms );
+    state.dependency_files = std::move( dependencies );
+    state.spirv.resize( word_count );
+    std::memcpy( state.spirv.data(), reader.bytes.data(), reader.bytes.size() );
+
+    shader_cache_hits_++;
+    return true;
+}
+
+std::string PipelineManager::make_cache_entry( const SlangContext& context, const CompiledShaderState& state ) const {
+    BinaryWriter writer;
+    writer.write( shader_cache_magic );
+    writer.write( state.stage );
+
+    writer.write( static_cast<uint32_t>( state.dependency_files.size() ) );
+    for ( const auto& dependency : state.dependency_files ) {
+        // Hashed as Slang read it. A file this build did not load may have changed since, so the shader is left
+        // uncached.
+        const auto contents = context.loaded_files.find( SlangFilesystem::normalise_path( dependency ) );
+        if ( contents == context.loaded_files.end() ) { return {}; }
+
+        writer.write_string( dependency );
+        writer.write( hash128( contents->second.data(), contents->second.size() ) );
+    }
+
+    writer.write( static_cast<uint32_t>( state.uniforms.size() ) );
+    for ( const auto& uniform : state.uniforms ) {
+        writer.write( uniform.offset );
+        writer.write( uniform.size );
+        writer.write_string( uniform.name );
+        writer.write_string( uniform.type_name );
+    }
+
+    writer.write( static_cast<uint32_t>( state.spirv.size() ) );
+    writer.bytes.append( reinterpret_cast<const char*>( state.spirv.data() ), state.spirv.size() * sizeof( uint32_t ) );
+    return std::move( writer.bytes );
+}
+
+void PipelineManager::store_cached_shader( CompiledShaderState& state ) const {
+    if ( state.cache_entry.empty() ) { return; }
+
+    write_file_atomically( state.cache_path, state.cache_entry );
+    state.cache_entry = {};
+    state.cache_path = {};
+}
+
 std::expected<PipelineManager::CompiledShaderState, std::string>
-PipelineManager::get_compiled_shader( const ShaderCompileInfo& info ) {
+PipelineManager::get_compiled_shader( SlangContext& context, const ShaderCompileInfo& info ) {
     CompiledShaderState compiled_shader = {};
     compiled_shader.name = info.name;
 
-    if ( const auto module_error = compile_module( info ) ) { return std::unexpected( *module_error ); }
-    if ( const auto spirv_error = compile_spirv( info, compiled_shader.spirv ) ) {
-        return std::unexpected( *spirv_error );
-    }
+    // A hit skips Slang entirely
+    if ( !load_cached_shader( context, info, compiled_shader ) ) {
+        context.loaded_files.clear();
+        SlangFilesystem::Recording recording( context.loaded_files );
+
+        SlangModule module;
+        if ( const auto module_error = compile_module( context, info, module ) ) {
+            return std::unexpected( *module_error );
+        }
+        if ( const auto spirv_error = compile_spirv( context, info, module, compiled_shader.spirv ) ) {
+            return std::unexpected( *spirv_error );
+        }
 
-    // Populate our uniforms
-    reflect_module( info, compiled_shader );
+        // Populate our uniforms and the files we need to be rebuilt for
+        reflect_module( info, module, compiled_shader );
+        compiled_shader.dependency_files = get_dependency_files( module.module );
+        if ( !std::ranges::contains( compiled_shader.dependency_files, info.name ) ) {
+            compiled_shader.dependency_files.insert( compiled_shader.dependency_files.begin(), info.name );
+        }
+        if ( !shader_cache_directory_.empty() ) {
+            compiled_shader.cache_path = get_shader_cache_path( context, info );
+            compiled_shader.cache_entry = make_cache_entry( context, compiled_shader );
+        }
+    }
 
     // Compile our `VkShaderModule`
     VkShaderModuleCreateInfo create_info{
@@ -0,0 +1,632 @@
+#include <aloe/core/PixelConversion.h>
+#include <aloe/util/log.h>
+#include <aloe/util/thread_pool.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <numbers>
+
+namespace aloe {
+
+// Texels per job below which handing work to another thread costs more than it saves
+constexpr static size_t parallel_grain = 64 * 1024;
+
+// Texels converted at a time by conversions which go through an intermediate layout, so it stays in cache
+constexpr static size_t slice_texels = 4096;
+
+// Calls `fn( begin, end )` over `[0, count)`, split into jobs of at least `grain` items across `workers` if given
+template<typename Fn>
+static void parallel_for( ThreadPool* workers, size_t count, size_t grain, const Fn& fn ) {
+    const size_t job_count = workers ? std::min( workers->thread_count(), count / grain ) : 0;
+    if ( job_count <= 1 ) {
+        fn( size_t{ 0 }, count );
+        return;
+    }
+
+    std::vector<std::future<void>> jobs;
+    jobs.reserve( job_count );
+    for ( size_t job = 0; job < job_count; ++job ) {
+        const size_t begin = count * job / job_count;
+        const size_t end = count * ( job + 1 ) / job_count;
+        jobs.push_back( workers->submit( [&fn, begin, end]() { fn( begin, end ); } ) );
+    }
+    for ( auto& job : jobs ) { job.get(); }
+}
+
+static bool sizes_match( size_t source, size_t destination, const char* conversion ) {
+    if ( source == destination ) { return true; }
+    log_write( LogLevel::Error,
+               "Can not {}, the source holds {} values but the destination {}",
+               conversion,
+               source,
+               destination );
+    return false;
+}
+
+struct CpuFeatures {
+    bool ssse3 = false;
+    bool sse41 = false;
+    bool avx2 = false;
+    bool f16c = false;
+};
+
+static const CpuFeatures& cpu_features() {
+    static const CpuFeatures features = []() {
+        CpuFeatures detected;
+#if defined( __x86_64__ ) || defined( __i386__ )
+        detected.ssse3 = __builtin_cpu_supports( "ssse3" );
+        detected.sse41 = __builtin_cpu_supports( "sse4.1" );
+        detected.avx2 = __builtin_cpu_supports( "avx2" );
+        // F16C is only used on 256 bit registers, which needs AVX
+        detected.f16c = __builtin_cpu_supports( "f16c" ) && __builtin_cpu_supports( "avx" );
+#endif
+        return detected;
+    }();
+    return features;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Scalar conversions of single values, which the SIMD paths must match
+
+static float srgb_to_linear_value( float value ) {
+    return value <= 0.04045f ? value / 12.92f : std::pow( ( value + 0.055f ) / 1.055f, 2.4f );
+}
+
+static float linear_to_srgb_value( float value ) {
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow( value, 1.0f / 2.4f ) - 0.055f;
+}
+
+// Rounds to nearest even, by aligning the mantissa with float addition for subnormal halves
+static uint16_t float_to_half_value( float value ) {
+    constexpr uint32_t infinity = 255u << 23;
+    constexpr uint32_t half_overflow = ( 127u + 16u ) << 23;
+    constexpr uint32_t half_min_normal = 113u << 23;
+    constexpr float subnormal_magic = std::bit_cast<float>( ( ( 127u - 15u ) + ( 23u - 10u ) + 1u ) << 23 );
+
+    uint32_t bits = std::bit_cast<uint32_t>( value );
+    const uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint32_t half = 0;
+    if ( bits >= half_overflow ) {
+        half = bits > infinity ? 0x7e00u : 0x7c00u;
+    } else if ( bits < half_min_normal ) {
+        half = std::bit_cast<uint32_t>( std::bit_cast<float>( bits ) + subnormal_magic ) -
+            std::bit_cast<uint32_t>( subnormal_magic );
+    } else {
+        const uint32_t mantissa_odd = ( bits >> 13 ) & 1u;
+        bits += ( ( 15u - 127u ) << 23 ) + 0xfffu + mantissa_odd;
+        half = bits >> 13;
+    }
+    return static_cast<uint16_t>( half | ( sign >> 16 ) );
+}
+
+static float half_to_float_value( uint16_t half ) {
+    constexpr uint32_t exponent_mask = 0x7c00u << 13;
+    uint32_t bits = ( half & 0x7fffu ) << 13;
+    const uint32_t exponent = bits & exponent_mask;
+    bits += ( 127u - 15u ) << 23;
+    if ( exponent == exponent_mask ) {
+        bits += ( 128u - 16u ) << 23;// Infinity or NaN
+    } else if ( exponent == 0 ) {
+        bits += 1u << 23;// Zero or subnormal, renormalized
+        bits = std::bit_cast<uint32_t>( std::bit_cast<float>( bits ) - std::bit_cast<float>( 113u << 23 ) );
+    }
+    return std::bit_cast<float>( bits | ( ( half & 0x8000u ) << 16 ) );
+}
+
+// Clamps to [0, 1] (NaN becomes 0) and rounds to 8 bits
+static uint8_t float_to_unorm8( float value ) {
+    const float clamped = !( value > 0.0f ) ? 0.0f : std::min( value, 1.0f );
+    return static_cast<uint8_t>( clamped * 255.0f + 0.5f );
+}
+
+// 8 bit values as floats, the first 256 entries decoded from sRGB and the next 256 linear
+static const std::array<float, 512>& unorm8_table() {
+    static const std::array<float, 512> table = []() {
+        std::array<float, 512> values{};
+        for ( uint32_t i = 0; i < 256; ++i ) {
+            values[i] = srgb_to_linear_value( static_cast<float>( i ) * ( 1.0f / 255.0f ) );
+            values[256 + i] = static_cast<float>( i ) * ( 1.0f / 255.0f );
+        }
+        return values;
+    }();
+    return table;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Range conversions, each with a scalar loop that SIMD variants fall back to for the texels they leave over
+
+static void rgb8_to_rgba8_scalar( const uint8_t* rgb, uint8_t* rgba, size_t count ) {
+    for ( size_t i = 0; i < count; ++i ) {
+        rgba[i * 4 + 0] = rgb[i * 3 + 0];
+        rgba[i * 4 + 1] = rgb[i * 3 + 1];
+        rgba[i * 4 + 2] = rgb[i * 3 + 2];
+        rgba[i * 4 + 3] = 255;
+    }
+}
+
+static void unorm8_to_float_scalar( const uint8_t* rgba8, float* rgba, size_t count, bool srgb ) {
+    const auto& table = unorm8_table();
+    for ( size_t i = 0; i < count * 4; ++i ) {
+        const uint8_t value = rgba8[i];
+        rgba[i] = srgb ? table[value + ( i % 4 == 3 ? 256 : 0 )] : static_cast<float>( value ) * ( 1.0f / 255.0f );
+    }
+}
+
+static void unorm16_to_float_scalar( const uint8_t* rgba16, float* rgba, size_t count ) {
+    for ( size_t i = 0; i < count * 4; ++i ) {
+        uint16_t value = 0;
+        std::memcpy( &value, rgba16 + i * 2, sizeof( value ) );
+        rgba[i] = static_cast<float>( value ) * ( 1.0f / 65535.0f );
+    }
+}
+
+static void float_to_unorm8_scalar( const float* rgba, uint8_t* rgba8, size_t count ) {
+    for ( size_t i = 0; i < count * 4; ++i ) { rgba8[i] = float_to_unorm8( rgba[i] ); }
+}
+
+static void float_to_half_scalar( const float* values, uint8_t* halves, size_t count ) {
+    for ( size_t i = 0; i < count; ++i ) {
+        const auto half = float_to_half_value( values[i] );
+        std::memcpy( halves + i * 2, &half, sizeof( half ) );
+    }
+}
+
+static void half_to_float_scalar( const uint8_t* halves, float* values, size_t count ) {
+    for ( size_t i = 0; i < count; ++i ) {
+        uint16_t half = 0;
+        std::memcpy( &half, halves + i * 2, sizeof( half ) );
+        values[i] = half_to_float_value( half );
+    }
+}
+
+static void premultiply_alpha_scalar( float* rgba, size_t count ) {
+    for ( size_t i = 0; i < count; ++i ) {
+        for ( size_t c = 0; c < 3; ++c ) { rgba[i * 4 + c] *= rgba[i * 4 + 3]; }
+    }
+}
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+__attribute__( ( target( "ssse3" ) ) ) static void rgb8_to_rgba8_ssse3( const uint8_t* rgb,
+                                                                        uint8_t* rgba,
+                                                                        size_t count ) {
+    const __m128i shuffle = _mm_setr_epi8( 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1 );
+    const __m128i alpha = _mm_set1_epi32( static_cast<int32_t>( 0xff000000u ) );
+
+    // Each 16 byte load covers 4 texels and a third, so the loop stops short of reading past the end
+    size_t i = 0;
+    for ( ; i + 6 <= count; i += 4 ) {
+        const __m128i texels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( rgb + i * 3 ) );
+        const __m128i expanded = _mm_or_si128( _mm_shuffle_epi8( texels, shuffle ), alpha );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( rgba + i * 4 ), expanded );
+    }
+    rgb8_to_rgba8_scalar( rgb + i * 3, rgba + i * 4, count - i );
+}
+
+// Two texels at a time, sRGB values are gathered from `unorm8_table`
+__attribute__( ( target( "avx2" ) ) ) static void unorm8_to_float_avx2( const uint8_t* rgba8,
+                                                                        float* rgba,
+                                                                        size_t count,
+                                                                        bool srgb ) {
+    const auto* table = unorm8_table().data();
+    const __m256i alpha_offset = _mm256_setr_epi32( 0, 0, 0, 256, 0, 0, 0, 256 );
+    const __m256 scale = _mm256_set1_ps( 1.0f / 255.0f );
+
+    size_t i = 0;
+    for ( ; i + 2 <= count; i += 2 ) {
+        const __m128i texels = _mm_loadl_epi64( reinterpret_cast<const __m128i*>( rgba8 + i * 4 ) );
+        const __m256i values = _mm256_cvtepu8_epi32( texels );
+        const __m256 converted = srgb ? _mm256_i32gather_ps( table, _mm256_add_epi32( values, alpha_offset ), 4 )
+                                      : _mm256_mul_ps( _mm256_cvtepi32_ps( values ), scale );
+        _mm256_storeu_ps( rgba + i * 4, converted );
+    }
+    unorm8_to_float_scalar( rgba8 + i * 4, rgba + i * 4, count - i, srgb );
+}
+
+__attribute__( ( target( "avx2" ) ) ) static void unorm16_to_float_avx2( const uint8_t* rgba16,
+                                                                         float* rgba,
+                                                                         size_t count ) {
+    const __m256 scale = _mm256_set1_ps( 1.0f / 65535.0f );
+
+    size_t i = 0;
+    for ( ; i + 2 <= count; i += 2 ) {
+        const __m256i values =
+            _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i*>( rgba16 + i * 8 ) ) );
+        _mm256_storeu_ps( rgba + i * 4, _mm256_mul_ps( _mm256_cvtepi32_ps( values ), scale ) );
+    }
+    unorm16_to_float_scalar( rgba16 + i * 8, rgba + i * 4, count - i );
+}
+
+__attribute__( ( target( "sse4.1" ) ) ) static void float_to_unorm8_sse41( const float* rgba,
+                                                                           uint8_t* rgba8,
+                                                                           size_t count ) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps( 1.0f );
+    const __m128 scale = _mm_set1_ps( 255.0f );
+    const __m128 half = _mm_set1_ps( 0.5f );
+
+    for ( size_t i = 0; i < count; ++i ) {
+        // `max( value, 0 )` returns 0 for NaN, as the scalar path does
+        const __m128 clamped = _mm_min_ps( _mm_max_ps( _mm_loadu_ps( rgba + i * 4 ), zero ), one );
+        __m128i packed = _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( clamped, scale ), half ) );
+        packed = _mm_packus_epi32( packed, packed );
+        packed = _mm_packus_epi16( packed, packed );
+
+        const auto texel = _mm_cvtsi128_si32( packed );
+        std::memcpy( rgba8 + i * 4, &texel, sizeof( texel ) );
+    }
+}
+
+__attribute__( ( target( "sse4.1" ) ) ) static void premultiply_alpha_sse41( float* rgba, size_t count ) {
+    for ( size_t i = 0; i < count; ++i ) {
+        const __m128 texel = _mm_loadu_ps( rgba + i * 4 );
+        const __m128 alpha = _mm_shuffle_ps( texel, texel, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+        _mm_storeu_ps( rgba + i * 4, _mm_blend_ps( _mm_mul_ps( texel, alpha ), texel, 0b1000 ) );
+    }
+}
+
+__attribute__( ( target( "avx,f16c" ) ) ) static void float_to_half_f16c( const float* values,
+                                                                          uint8_t* halves,
+                                                                          size_t count ) {
+    size_t i = 0;
+    for ( ; i + 8 <= count; i += 8 ) {
+        const __m128i packed = _mm256_cvtps_ph( _mm256_loadu_ps( values + i ), _MM_FROUND_TO_NEAREST_INT );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( halves + i * 2 ), packed );
+    }
+    float_to_half_scalar( values + i, halves + i * 2, count - i );
+}
+
+__attribute__( ( target( "avx,f16c" ) ) ) static void half_to_float_f16c( const uint8_t* halves,
+                                                                          float* values,
+                                                                          size_t count ) {
+    size_t i = 0;
+    for ( ; i + 8 <= count; i += 8 ) {
+        const __m128i packed = _mm_loadu_si128( reinterpret_cast<const __m128i*>( halves + i * 2 ) );
+        _mm256_storeu_ps( values + i, _mm256_cvtph_ps( packed ) );
+    }
+    half_to_float_scalar( halves + i * 2, values + i, count - i );
+}
+#endif
+
+// Dispatch to the widest variant the CPU supports, when SIMD is allowed
+
+static void rgb8_to_rgba8_range( const uint8_t* rgb, uint8_t* rgba, size_t count, bool simd ) {
+#if defined( __x86_64__ ) || defined( __i386__ )
+    if ( simd && cpu_features().ssse3 ) { return rgb8_to_rgba8_ssse3( rgb, rgba, count ); }
+#endif
+    rgb8_to_rgba8_scalar( rgb, rgba, count );
+}
+
+static void unorm8_to_float_range( const uint8_t* rgba8, float* rgba, size_t count, bool srgb, bool simd ) {
+#if defined( __x86_64__ ) || defined( __i386__ )
+    if ( simd && cpu_features().avx2 ) { return unorm8_to_float_avx2( rgba8, rgba, count, srgb ); }
+#endif
+    unorm8_to_float_scalar( rgba8, rgba, count, srgb );
+}
+
+static void unorm16_to_float_range( const uint8_t* rgba16, float* rgba, size_t count, bool simd ) {
+#if defined( __x86_64__ ) || defined( __i386__ )
+    if ( simd && cpu_features().avx2 ) { return unorm16_to_float_avx2( rgba16, rgba, count ); }
+#endif
+    unorm16_to_float_scalar( rgba16, rgba, count );
+}
+
+static void float_to_unorm8_range( const float* rgba, uint8_t* rgba8, size_t count, bool simd ) {
+#if defined( __x86_64__ ) || defined( __i386__ )
+    if ( simd && cpu_features().sse41 ) { return float_to_unorm8_sse41( rgba, rgba8, count ); }
+#endif
+    float_to_unorm8_scalar( rgba, rgba8, count );
+}
+
+static void float_to_half_range( const float* values, uint8_t* halves, size_t count, bool simd ) {
+#if defined( __x86_64__ ) || defined( __i386__ )
+    if ( simd && cpu_features().f16c ) { return float_to_half_f16c( values, halves, count ); }
+#endif
+    float_to_half_scalar( values, halves, count );
+}
+
+static void half_to_float_range( const uint8_t* halves, float* values, size_t count, bool simd ) {
+#if defined( __x86_64__ ) || defined( __i386__ )
+    if ( simd && cpu_features().f16c ) { return half_to_float_f16c( halves, values, count ); }
+#endif
+    half_to_float_scalar( halves, values, count );
+}
+
+static void premultiply_alpha_range( float* rgba, size_t count, bool simd ) {
+#if defined( __x86_64__ ) || defined( __i386__ )
+    if ( simd && cpu_features().sse41 ) { return premultiply_alpha_sse41( rgba, count ); }
+#endif
+    premultiply_alpha_scalar( rgba, count );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Mip filtering, separable so each pass only filters along one axis
+
+// The source texels (from `first`, clamped to the edge) and weights which make up one destination texel
+struct FilterTaps {
+    int32_t first = 0;
+    std::vector<float> weights = {};
+};
+
+static double bessel_i0( double x ) {
+    double sum = 1.0;
+    double term = 1.0;
+    for ( int32_t k = 1; k < 32; ++k ) {
+        term *= ( x / ( 2.0 * k ) ) * ( x / ( 2.0 * k ) );
+        sum += term;
+    }
+    return sum;
+}
+
+static std::vector<FilterTaps> filter_taps( uint32_t source, uint32_t destination, MipFilter filter ) {
+    std::vector<FilterTaps> taps( destination );
+    if ( source == destination ) {
+        for ( uint32_t i = 0; i < destination; ++i ) { taps[i] = { static_cast<int32_t>( i ), { 1.0f } }; }
+        return taps;
+    }
+
+    if ( filter == MipFilter::Box ) {
+        for ( uint32_t i = 0; i < destination; ++i ) { taps[i] = { static_cast<int32_t>( i * 2 ), { 0.5f, 0.5f } }; }
+        return taps;
+    }
+
+    // Lobes of the sinc either side of the centre, and the shape of the window over them
+    constexpr double lobes = 3.0;
+    constexpr double alpha = 4.0;
+    const double scale = static_cast<double>( source ) / destination;
+    const double radius = lobes * scale;
+
+    for ( uint32_t i = 0; i < destination; ++i ) {
+        const double centre = ( i + 0.5 ) * scale;
+        const auto first = static_cast<int32_t>( std::ceil( centre - radius - 0.5 ) );
+        const auto last = static_cast<int32_t>( std::floor( centre + radius - 0.5 ) );
+
+        double total = 0.0;
+        std::vector<double> weights;
+        for ( int32_t j = first; j <= last; ++j ) {
+            const double t = ( j + 0.5 - centre ) / scale;
+            const double sinc = t == 0.0 ? 1.0 : std::sin( std::numbers::pi * t ) / ( std::numbers::pi * t );
+            const double x = t / lobes;
+            const double window = std::abs( x ) >= 1.0 ? 0.0 : bessel_i0( alpha * std::sqrt( 1.0 - x * x ) );
+            weights.push_back( sinc * window );
+            total += sinc * window;
+        }
+
+        taps[i].first = first;
+        for ( const auto weight : weights ) { taps[i].weights.push_back( static_cast<float>( weight / total ) ); }
+    }
+    return taps;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+uint32_t pixel_size( PixelLayout layout ) {
+    switch ( layout ) {
+        case PixelLayout::RGB8: return 3;
+        case PixelLayout::RGBA8: return 4;
+        case PixelLayout::RGB16: return 6;
+        case PixelLayout::RGBA16: return 8;
+        case PixelLayout::RGB32F: return 12;
+        case PixelLayout::RGBA32F: return 16;
+    }
+    return 0;
+}
+
+PixelConverter::PixelConverter( ThreadPool* workers, bool simd ) : workers_( workers ), simd_( simd ) {}
+
+bool PixelConverter::rgb8_to_rgba8( std::span<const uint8_t> rgb, std::span<uint8_t> rgba ) const {
+    if ( rgb.size() % 3 != 0 || !sizes_match( rgb.size() / 3 * 4, rgba.size(), "expand RGB8 to RGBA8" ) ) {
+        return false;
+    }
+
+    parallel_for( workers_, rgb.size() / 3, parallel_grain, [&]( size_t begin, size_t end ) {
+        rgb8_to_rgba8_range( rgb.data() + begin * 3, rgba.data() + begin * 4, end - begin, simd_ );
+    } );
+    return true;
+}
+
+bool PixelConverter::float_to_half( std::span<const float> values, std::span<uint16_t> halves ) const {
+    if ( !sizes_match( values.size(), halves.size(), "pack floats to halves" ) ) { return false; }
+
+    auto* bytes = reinterpret_cast<uint8_t*>( halves.data() );
+    parallel_for( workers_, values.size(), parallel_grain * 4, [&]( size_t begin, size_t end ) {
+        float_to_half_range( values.data() + begin, bytes + begin * 2, end - begin, simd_ );
+    } );
+    return true;
+}
+
+bool PixelConverter::half_to_float( std::span<const uint16_t> halves, std::span<float> values ) const {
+    if ( !sizes_match( halves.size(), values.size(), "unpack halves to floats" ) ) { return false; }
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>( halves.data() );
+    parallel_for( workers_, halves.size(), parallel_grain * 4, [&]( size_t begin, size_t end ) {
+        half_to_float_range( bytes + begin * 2, values.data() + begin, end - begin, simd_ );
+    } );
+    return true;
+}
+
+void PixelConverter::srgb_to_linear( std::span<float> rgba ) const {
+    parallel_for( workers_, rgba.size() / 4, parallel_grain, [&]( size_t begin, size_t end ) {
+        for ( size_t i = begin; i < end; ++i ) {
+            for ( size_t c = 0; c < 3; ++c ) { rgba[i * 4 + c] = srgb_to_linear_value( rgba[i * 4 + c] ); }
+        }
+    } );
+}
+
+void PixelConverter::linear_to_srgb( std::span<float> rgba ) const {
+    parallel_for( workers_, rgba.size() / 4, parallel_grain, [&]( size_t begin, size_t end ) {
+        for ( size_t i = begin; i < end; ++i ) {
+            for ( size_t c = 0; c < 3; ++c ) { rgba[i * 4 + c] = linear_to_srgb_value( rgba[i * 4 + c] ); }
+        }
+    } );
+}
+
+void PixelConverter::premultiply_alpha( std::span<float> rgba ) const {
+    parallel_for( workers_, rgba.size() / 4, parallel_grain, [&]( size_t begin, size_t end ) {
+        premultiply_alpha_range( rgba.data() + begin * 4, end - begin, simd_ );
+    } );
+}
+
+bool PixelConverter::to_rgba32f( std::span<const uint8_t> texels,
+                                 PixelLayout layout,
+                                 bool srgb,
+                                 std::span<float> rgba ) const {
+    const auto texel_bytes = pixel_size( layout );
+    if ( texels.size() % texel_bytes != 0 ||
+         !sizes_match( texels.size() / texel_bytes * 4, rgba.size(), "unpack texels to RGBA floats" ) ) {
+        return false;
+    }
+
+    parallel_for( workers_, texels.size() / texel_bytes, parallel_grain, [&]( size_t begin, size_t end ) {
+        const auto* source = texels.data() + begin * texel_bytes;
+        auto* destination = rgba.data() + begin * 4;
+        const auto count = end - begin;
+
+        switch ( layout ) {
+            case PixelLayout::RGB8: {
+                std::array<uint8_t, slice_texels * 4> expanded;
+                for ( size_t i = 0; i < count; i += slice_texels ) {
+                    const auto slice = std::min( slice_texels, count - i );
+                    rgb8_to_rgba8_range( source + i * 3, expanded.data(), slice, simd_ );
+                    unorm8_to_float_range( expanded.data(), destination + i * 4, slice, srgb, simd_ );
+                }
+                return;
+            }
+            case PixelLayout::RGBA8: unorm8_to_float_range( source, destination, count, srgb, simd_ ); return;
+            case PixelLayout::RGB16:
+                for ( size_t i = 0; i < count; ++i ) {
+                    for ( size_t c = 0; c < 3; ++c ) {
+                        uint16_t value = 0;
+                        std::memcpy( &value, source + i * 6 + c * 2, sizeof( value ) );
+                        destination[i * 4 + c] = static_cast<float>( value ) * ( 1.0f / 65535.0f );
+                    }
+                    destination[i * 4 + 3] = 1.0f;
+                }
+                break;
+            case PixelLayout::RGBA16: unorm16_to_float_range( source, destination, count, simd_ ); break;
+            case PixelLayout::RGB32F:
+                for ( size_t i = 0; i < count; ++i ) {
+                    std::memcpy( destination + i * 4, source + i * 12, 12 );
+                    destination[i * 4 + 3] = 1.0f;
+                }
+                break;
+            case PixelLayout::RGBA32F: std::memcpy( destination, source, count * 16 ); break;
+        }
+
+        // 8 bit sources were linearized through the table
+        if ( srgb ) {
+            for ( size_t i = 0; i < count; ++i ) {
+                for ( size_t c = 0; c < 3; ++c ) {
+                    destination[i * 4 + c] = srgb_to_linear_value( destination[i * 4 + c] );
+                }
+            }
+        }
+    } );
+    return true;
+}
+
+bool PixelConverter::from_rgba32f( std::span<const float> rgba, VkFormat format, std::span<uint8_t> texels ) const {
+    const size_t count = rgba.size() / 4;
+    switch ( format ) {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB: {
+            if ( !sizes_match( count * 4, texels.size(), "pack RGBA floats to RGBA8" ) ) { return false; }
+
+            const bool srgb = format == VK_FORMAT_R8G8B8A8_SRGB;
+            parallel_for( workers_, count, parallel_grain, [&]( size_t begin, size_t end ) {
+                if ( !srgb ) {
+                    float_to_unorm8_range( rgba.data() + begin * 4, texels.data() + begin * 4, end - begin, simd_ );
+                    return;
+                }
+
+                // Encoded a slice at a time, leaving the source untouched
+                std::array<float, slice_texels * 4> encoded;
+                for ( size_t i = begin; i < end; i += slice_texels ) {
+                    const auto slice = std::min( slice_texels, end - i );
+                    for ( size_t j = 0; j < slice * 4; ++j ) {
+                        const auto value = rgba[i * 4 + j];
+                        encoded[j] = j % 4 == 3 ? value : linear_to_srgb_value( value );
+                    }
+                    float_to_unorm8_range( encoded.data(), texels.data() + i * 4, slice, simd_ );
+                }
+            } );
+            return true;
+        }
+        case VK_FORMAT_R16G16B16A16_SFLOAT: {
+            if ( !sizes_match( rgba.size() * 2, texels.size(), "pack RGBA floats to halves" ) ) { return false; }
+
+            parallel_for( workers_, rgba.size(), parallel_grain * 4, [&]( size_t begin, size_t end ) {
+                float_to_half_range( rgba.data() + begin, texels.data() + begin * 2, end - begin, simd_ );
+            } );
+            return true;
+        }
+        case VK_FORMAT_R32G32B32A32_SFLOAT: {
+            if ( !sizes_match( rgba.size() * 4, texels.size(), "copy RGBA floats" ) ) { return false; }
+
+            std::memcpy( texels.data(), rgba.data(), texels.size() );
+            return true;
+        }
+        default:
+            log_write( LogLevel::Error, "Can not pack RGBA floats into format {}", static_cast<uint32_t>( format ) );
+            return false;
+    }
+}
+
+std::vector<float> PixelConverter::downsample( std::span<const float> rgba,
+                                               VkExtent2D extent,
+                                               MipFilter filter ) const {
+    if ( !sizes_match( static_cast<size_t>( extent.width ) * extent.height * 4, rgba.size(), "downsample texels" ) ) {
+        return {};
+    }
+
+    const VkExtent2D half = { std::max( 1u, extent.width / 2 ), std::max( 1u, extent.height / 2 ) };
+    const auto columns = filter_taps( extent.width, half.width, filter );
+    const auto rows = filter_taps( extent.height, half.height, filter );
+
+    // Across each row first, into `half.width` x `extent.height` texels
+    std::vector<float> horizontal( static_cast<size_t>( half.width ) * extent.height * 4 );
+    parallel_for( workers_, extent.height, std::max<size_t>( 1, parallel_grain / extent.width ), [&]( size_t begin,
+                                                                                                      size_t end ) {
+        for ( size_t y = begin; y < end; ++y ) {
+            const auto* source = rgba.data() + y * extent.width * 4;
+            auto* destination = horizontal.data() + y * half.width * 4;
+            for ( uint32_t x = 0; x < half.width; ++x ) {
+                float sum[4] = {};
+                for ( size_t k = 0; k < columns[x].weights.size(); ++k ) {
+                    const auto column =
+                        std::clamp<int64_t>( columns[x].first + static_cast<int64_t>( k ), 0, extent.width - 1 );
+                    for ( size_t c = 0; c < 4; ++c ) { sum[c] += columns[x].weights[k] * source[column * 4 + c]; }
+                }
+                std::copy_n( sum, 4, destination + x * 4 );
+            }
+        }
+    } );
+
+    // Then down each column, a whole row of texels at a time
+    std::vector<float> downsampled( static_cast<size_t>( half.width ) * half.height * 4 );
+    const size_t row_size = static_cast<size_t>( half.width ) * 4;
+    parallel_for( workers_, half.height, std::max<size_t>( 1, parallel_grain / half.width ), [&]( size_t begin,
+                                                                                                   size_t end ) {
+        for ( size_t y = begin; y < end; ++y ) {
+            auto* destination = downsampled.data() + y * row_size;
+            for ( size_t k = 0; k < rows[y].weights.size(); ++k ) {
+                const auto row = std::clamp<int64_t>( rows[y].first + static_cast<int64_t>( k ), 0, extent.height - 1 );
+                const auto* source = horizontal.data() + row * row_size;
+                for ( size_t i = 0; i < row_size; ++i ) { destination[i] += rows[y].weights[k] * source[i]; }
+            }
+        }
+    } );
+
+    return downsampled;
+}
+
+}// namespace aloe
@@ -1,22 +1,379 @@
 #include <aloe/core/Device.h>
 #include <aloe/core/ResourceManager.h>
+#include <aloe/core/TextureCompression.h>
 #include <aloe/util/log.h>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <limits>
 #include <numeric>
+#include <tuple>
 
 #include "aloe/core/aloe.slang.h"
 
 namespace aloe {
 
+// Sub-allocations are addressed through byte address buffers in shaders, which can load up to 16 bytes at once.
+constexpr static VkDeviceSize sub_allocation_alignment = 16;
+
+// Slot recorded for image views which are not bound into a descriptor heap (e.g. attachments).
+constexpr static uint32_t no_descriptor_slot = std::numeric_limits<uint32_t>::max();
+
+// Upper bound on the allocations made by `create_buffers`/`create_images`, so a batch lands in a few VMA blocks.
+constexpr static VkDeviceSize batch_allocation_size = 64 * 1024 * 1024;
+
+// Bounds the work (and so the stall) of a single defragmentation pass.
+constexpr static uint32_t defragmentation_moves_per_pass = 32;
+
+// Value of a feedback buffer entry which has not been requested since it was last read.
+constexpr static uint32_t no_streaming_request = std::numeric_limits<uint32_t>::max();
+
+// Accounts of resources described without a name or category
+constexpr static const char* unnamed_account = "(unnamed)";
+constexpr static const char* uncategorized_account = "(uncategorized)";
+
+// Category of the short lived buffers uploads and readbacks are copied through
+constexpr static const char* staging_category = "Staging";
+
+static VkBufferCreateInfo buffer_create_info( const BufferDesc& desc, bool device_address ) {
+    return {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = desc.size,
+        // Buffers can always be copied, so defragmentation is able to move them
+        .usage = desc.usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+            ( device_address ? VkBufferUsageFlags{ VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT } : 0u ),
+    };
+}
+
+// Buffers need a device address for shaders to dereference, and to write their descriptors into a descriptor buffer
+static bool needs_device_address( const Device& device ) {
+    return device.buffer_device_address_enabled() || device.descriptor_buffer_enabled();
+}
+
+static VkImageCreateInfo image_create_info( const ImageDesc& desc ) {
+    return {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .flags = desc.flags,
+        .imageType = desc.type,
+        .format = desc.format,
+        .extent = desc.extent,
+        .mipLevels = desc.mip_levels,
+        .arrayLayers = desc.array_layers,
+        .samples = desc.samples,
+        .tiling = desc.tiling,
+        .usage = desc.usage,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+}
+
+static VkExtent3D mip_extent( const VkExtent3D& extent, uint32_t mip ) {
+    return { std::max( 1u, extent.width >> mip ),
+             std::max( 1u, extent.height >> mip ),
+             std::max( 1u, extent.depth >> mip ) };
+}
+
+// The aspects which make up texels of `format`
+static VkImageAspectFlags format_aspect( VkFormat format ) {
+    switch ( format ) {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT: return VK_IMAGE_ASPECT_DEPTH_BIT;
+        case VK_FORMAT_S8_UINT: return VK_IMAGE_ASPECT_STENCIL_BIT;
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT: return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        default: return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+// Whether `format` is one of the BC formats, which need the `textureCompressionBC` feature
+static bool is_bc_format( VkFormat format ) {
+    return format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+}
+
+// Bytes per texel of uncompressed colour formats, or 0 if the size of `format` is not known here.
+static VkDeviceSize texel_size( VkFormat format ) {
+    switch ( format ) {
+        case VK_FORMAT_R8_UNORM:
+        case VK_FORMAT_R8_SNORM:
+        case VK_FORMAT_R8_UINT:
+        case VK_FORMAT_R8_SINT:
+        case VK_FORMAT_R8_SRGB: return 1;
+        case VK_FORMAT_R8G8_UNORM:
+        case VK_FORMAT_R8G8_SNORM:
+        case VK_FORMAT_R8G8_UINT:
+        case VK_FORMAT_R8G8_SINT:
+        case VK_FORMAT_R8G8_SRGB:
+        case VK_FORMAT_R16_UNORM:
+        case VK_FORMAT_R16_SNORM:
+        case VK_FORMAT_R16_UINT:
+        case VK_FORMAT_R16_SINT:
+        case VK_FORMAT_R16_SFLOAT: return 2;
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SNORM:
+        case VK_FORMAT_R8G8B8A8_UINT:
+        case VK_FORMAT_R8G8B8A8_SINT:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+        case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+        case VK_FORMAT_R16G16_UNORM:
+        case VK_FORMAT_R16G16_SNORM:
+        case VK_FORMAT_R16G16_UINT:
+        case VK_FORMAT_R16G16_SINT:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R32_UINT:
+        case VK_FORMAT_R32_SINT:
+        case VK_FORMAT_R32_SFLOAT: return 4;
+        case VK_FORMAT_R16G16B16A16_UNORM:
+        case VK_FORMAT_R16G16B16A16_SNORM:
+        case VK_FORMAT_R16G16B16A16_UINT:
+        case VK_FORMAT_R16G16B16A16_SINT:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R32G32_UINT:
+        case VK_FORMAT_R32G32_SINT:
+        case VK_FORMAT_R32G32_SFLOAT: return 8;
+        case VK_FORMAT_R32G32B32A32_UINT:
+        case VK_FORMAT_R32G32B32A32_SINT:
+        case VK_FORMAT_R32G32B32A32_SFLOAT: return 16;
+        default: return 0;
+    }
+}
+
+VkDeviceSize mip_size( const ImageDesc& desc, uint32_t mip ) {
+    const auto extent = mip_extent( desc.extent, mip );
+    if ( const auto block = block_format( desc.format ) ) {
+        return compressed_size( *block, extent.width, extent.height ) * extent.depth * desc.array_layers;
+    }
+    return texel_size( desc.format ) * extent.width * extent.height * extent.depth * desc.array_layers;
+}
+
+// Replaces the RGBA8 format of an image which is compressed on upload with the block format for its channel count
+static ImageDesc resolve_compressed_format( const ImageDesc& desc ) {
+    auto resolved = desc;
+    if ( desc.compress_channels != 0 &&
+         ( desc.format == VK_FORMAT_R8G8B8A8_UNORM || desc.format == VK_FORMAT_R8G8B8A8_SRGB ) ) {
+        resolved.format = compressed_format( desc.compress_channels, desc.format == VK_FORMAT_R8G8B8A8_SRGB );
+    }
+    return resolved;
+}
+
+// The uncompressed format `import_to_image` packs texels into for an image of `format`, the RGBA8 format the block
+// encoder takes for block compressed formats
+static VkFormat import_pack_format( VkFormat format ) {
+    switch ( format ) {
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK: return VK_FORMAT_R8G8B8A8_SRGB;
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK: return VK_FORMAT_R8G8B8A8_UNORM;
+        default: return format;
+    }
+}
+
+// Hashes the parts of a description which decide the resource created, so resources differing only in name can share
+static Hash128 shared_desc_hash( const BufferDesc& desc ) {
+    const std::array<uint64_t, 7> fields = {
+        desc.size,
+        desc.usage,
+        static_cast<uint64_t>( desc.memory_usage ),
+        desc.memory_flags,
+        desc.required_memory_properties,
+        desc.memory_pool.raw,
+        desc.parent.raw,
+    };
+    return hash128( fields.data(), sizeof( fields ) );
+}
+
+static Hash128 shared_desc_hash( const ImageDesc& desc ) {
+    const std::array<uint64_t, 15> fields = {
+        static_cast<uint64_t>( desc.type ),
+        desc.extent.width,
+        desc.extent.height,
+        desc.extent.depth,
+        static_cast<uint64_t>( desc.format ),
+        desc.usage,
+        static_cast<uint64_t>( desc.tiling ),
+        static_cast<uint64_t>( desc.memory_usage ),
+        desc.memory_flags,
+        desc.memory_pool.raw,
+        desc.mip_levels,
+        desc.array_layers,
+        static_cast<uint64_t>( desc.samples ),
+        desc.flags,
+        desc.compress_channels,
+    };
+    return hash128( fields.data(), sizeof( fields ) );
+}
+
+// Texels per row and rows per layer of `region` in host memory
+static std::pair<VkDeviceSize, VkDeviceSize> region_pitch( const ImageRegion& region ) {
+    return { region.row_length != 0 ? region.row_length : region.extent.width,
+             region.image_height != 0 ? region.image_height : region.extent.height };
+}
+
+// Regions are only copied to and from colour images, see `validate_image_regions`
+static VkImageSubresourceLayers region_subresource( const ImageRegion& region ) {
+    return { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+             .mipLevel = region.mip_level,
+             .baseArrayLayer = region.base_array_layer,
+             .layerCount = region.layer_count };
+}
+
+// Whether `queue` can copy every region of an image of `desc`: offsets must be multiples of its
+// `minImageTransferGranularity`, and extents too unless they reach the edge of the mip. Queues with a zero granularity
+// only copy whole mips.
+static bool fits_transfer_granularity( const Device::Queue& queue,
+                                       const ImageDesc& desc,
+                                       std::span<const ImageRegion> regions ) {
+    auto fits = []( uint32_t unit, int32_t offset, uint32_t extent, uint32_t limit ) {
+        const auto end = static_cast<uint64_t>( offset ) + extent;
+        if ( unit == 0 ) { return offset == 0 && end == limit; }
+        return offset % unit == 0 && ( extent % unit == 0 || end == limit );
+    };
+
+    const auto& granularity = queue.properties.minImageTransferGranularity;
+    for ( const auto& region : regions ) {
+        const auto mip = mip_extent( desc.extent, region.mip_level );
+        if ( !fits( granularity.width, region.offset.x, region.extent.width, mip.width ) ||
+             !fits( granularity.height, region.offset.y, region.extent.height, mip.height ) ||
+             !fits( granularity.depth, region.offset.z, region.extent.depth, mip.depth ) ) {
+            log_write( LogLevel::Error,
+                       "Region of {} is not aligned to the transfer granularity ({}, {}, {}) of the queue",
+                       desc.name,
+                       granularity.width,
+                       granularity.height,
+                       granularity.depth );
+            return false;
+        }
+    }
+    return true;
+}
+
+// Moves every mip and layer of a colour image of `desc` from `old_layout` to `new_layout`
+static void image_layout_barrier( VkCommandBuffer cmd,
+                                  VkImage image,
+                                  const ImageDesc& desc,
+                                  VkImageLayout old_layout,
+                                  VkImageLayout new_layout,
+                                  VkPipelineStageFlags src_stage,
+                                  VkAccessFlags src_access,
+                                  VkPipelineStageFlags dst_stage,
+                                  VkAccessFlags dst_access ) {
+    const VkImageMemoryBarrier barrier{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                                        .srcAccessMask = src_access,
+                                        .dstAccessMask = dst_access,
+                                        .oldLayout = old_layout,
+                                        .newLayout = new_layout,
+                                        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                        .image = image,
+                                        .subresourceRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                                              .baseMipLevel = 0,
+                                                              .levelCount = desc.mip_levels,
+                                                              .baseArrayLayer = 0,
+                                                              .layerCount = desc.array_layers } };
+
+    vkCmdPipelineBarrier( cmd, src_stage, dst_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier );
+}
+
+// Orders transfers against every other access of an image resting in `VK_IMAGE_LAYOUT_GENERAL`
+static void general_layout_barrier( VkCommandBuffer cmd,
+                                    VkImage image,
+                                    const ImageDesc& desc,
+                                    VkPipelineStageFlags src_stage,
+                                    VkAccessFlags src_access,
+                                    VkPipelineStageFlags dst_stage,
+                                    VkAccessFlags dst_access ) {
+    image_layout_barrier( cmd,
+                          image,
+                          desc,
+                          VK_IMAGE_LAYOUT_GENERAL,
+                          VK_IMAGE_LAYOUT_GENERAL,
+                          src_stage,
+                          src_access,
+                          dst_stage,
+                          dst_access );
+}
+
+// Makes an image resting in `layout` readable by transfers, returning the layout to copy from. Images in
+// `VK_IMAGE_LAYOUT_GENERAL` are copied in place, anything else is moved to `VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL` and
+// left there, as the images copied from by streaming and defragmentation are destroyed once the copy completes.
+static VkImageLayout prepare_copy_source( VkCommandBuffer cmd,
+                                          VkImage image,
+                                          const ImageDesc& desc,
+                                          VkImageLayout layout ) {
+    const auto copy_layout =
+        layout == VK_IMAGE_LAYOUT_GENERAL ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    image_layout_barrier( cmd,
+                          image,
+                          desc,
+                          layout,
+                          copy_layout,
+                          VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                          VK_ACCESS_MEMORY_WRITE_BIT,
+                          VK_PIPELINE_STAGE_TRANSFER_BIT,
+                          VK_ACCESS_TRANSFER_READ_BIT );
+    return copy_layout;
+}
+
+// The layout the descriptors bound to an image expect it in, or `fallback` if none are bound or they disagree (in
+// which case whoever bound them has to transition the image themselves)
+static VkImageLayout bound_image_layout( const auto& bound_resources, VkImageLayout fallback ) {
+    std::optional<VkImageLayout> layout;
+    for ( const auto& [usage, _] : bound_resources ) {
+        if ( usage.layout == VK_IMAGE_LAYOUT_UNDEFINED ) continue;
+        if ( layout && *layout != usage.layout ) return fallback;
+        layout = usage.layout;
+    }
+    return layout.value_or( fallback );
+}
+
+// Host copies are not ordered against queue submissions, so a host read of an image of `desc` waits for the queues
+// whose work could have written to it
+static void wait_for_image_writes( const Device& device, const ImageDesc& desc ) {
+    VkQueueFlags writers = 0;
+    if ( desc.usage & VK_IMAGE_USAGE_TRANSFER_DST_BIT ) {
+        writers |= VK_QUEUE_TRANSFER_BIT | VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+    }
+    if ( desc.usage & VK_IMAGE_USAGE_STORAGE_BIT ) { writers |= VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT; }
+    if ( desc.usage & ( VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT ) ) {
+        writers |= VK_QUEUE_GRAPHICS_BIT;
+    }
+    if ( writers == 0 ) { return; }
+
+    for ( const auto& queue : device.find_queues( static_cast<VkQueueFlagBits>( writers ) ) ) {
+        device.wait_idle( queue );
+    }
+}
+
+// Allocations carry the id of the resource they back, so defragmentation moves can be mapped back to handles.
+static void* allocation_user_data( uint64_t id ) {
+    return reinterpret_cast<void*>( static_cast<uintptr_t>( id ) );
+}
+
 ResourceManager::ResourceManager( Device& device )
     : device_( device )
     , allocator_( device.allocator() )
     , storage_buffer_allocator_( VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                                 device.get_physical_device_limits().maxDescriptorSetStorageBuffers )
+                                 get_binding_count( VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                                    device.get_physical_device_limits() ) )
     , storage_image_allocator_( VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-                                device.get_physical_device_limits().maxDescriptorSetStorageImages ) {
+                                get_binding_count( VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                                                   device.get_physical_device_limits() ) )
+    , sampled_image_allocator_( VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                                get_binding_count( VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                                                   device.get_physical_device_limits() ) )
+    , sampler_allocator_( VK_DESCRIPTOR_TYPE_SAMPLER,
+                          get_binding_count( VK_DESCRIPTOR_TYPE_SAMPLER, device.get_physical_device_limits() ) ) {
+    update_memory_statistics();
 }
 
 void ResourceManager::DescriptorSlotAllocator::PendingWrite::finalize( VkDescriptorSet set ) {
@@ -30,19 +387,39 @@ void ResourceManager::DescriptorSlotAllocator::PendingWrite::finalize( VkDescrip
 
 ResourceManager::DescriptorSlotAllocator::DescriptorSlotAllocator( VkDescriptorType type, std::size_t max_slots )
     : type_( type )
-    , max_slots_( static_cast<uint32_t>( max_slots ) ) {
+    , max_slots_( static_cast<uint32_t>( max_slots ) )
+    , versions_( max_slots ) {
     free_slots_.resize( max_slots_ );
-    versions_.resize( max_slots_, 0 );
     std::iota( free_slots_.begin(), free_slots_.end(), 0 );
 }
 
 std::optional<std::pair<uint32_t, uint32_t>> ResourceManager::DescriptorSlotAllocator::allocate_slot(
     const std::variant<VkDescriptorBufferInfo, VkDescriptorImageInfo>& resource ) {
+    std::scoped_lock lock( mutex_ );
     if ( free_slots_.empty() ) return std::nullopt;
 
     const uint32_t slot = free_slots_.back();
     free_slots_.pop_back();
-    ++versions_[slot];
+    const uint32_t version = versions_[slot].fetch_add( 1 ) + 1;
+
+    stage_write( slot, resource );
+
+    return std::make_pair( slot, version );
+}
+
+void ResourceManager::DescriptorSlotAllocator::update_slot(
+    uint32_t slot,
+    const std::variant<VkDescriptorBufferInfo, VkDescriptorImageInfo>& resource ) {
+    std::scoped_lock lock( mutex_ );
+    assert( slot < max_slots_ && std::ranges::find( free_slots_, slot ) == free_slots_.end() );
+    stage_write( slot, resource );
+}
+
+void ResourceManager::DescriptorSlotAllocator::stage_write(
+    uint32_t slot,
+    const std::variant<VkDescriptorBufferInfo, VkDescriptorImageInfo>& resource ) {
+    // Only the latest write to a slot is applied, an earlier one may name a resource which has since been destroyed
+    std::erase_if( pending_writes_, [&]( const auto& pending ) { return pending.write.dstArrayElement == slot; } );
 
     auto& pending = pending_writes_.emplace_back();
     pending.resource = resource;
@@ -53,28 +430,68 @@ std::optional<std::pair<uint32_t, uint32_t>> ResourceManager::DescriptorSlotAllo
     write.dstArrayElement = slot;
     write.descriptorType = type_;
     write.dstBinding = get_binding_slot( type_ );
-
-    return std::make_pair( slot, versions_[slot] );
 }
 
 void ResourceManager::DescriptorSlotAllocator::free_slot( uint32_t slot ) {
     if ( slot >= max_slots_ ) return;
+
+    std::scoped_lock lock( mutex_ );
     if ( std::ranges::find( free_slots_, slot ) != free_slots_.end() ) return;
 
+    std::erase_if( pending_writes_, [&]( const auto& pending ) { return pending.write.dstArrayElement == slot; } );
     free_slots_.emplace_back( slot );
 }
 
 uint32_t ResourceManager::DescriptorSlotAllocator::get_slot_version( uint32_t slot ) const {
-    return slot < versions_.size() ? versions_[slot] : 0;
+    return slot < versions_.size() ? versions_[slot].load() : 0;
 }
 
 bool ResourceManager::DescriptorSlotAllocator::validate_slot( uint32_t slot, uint32_t version ) const {
-    return slot < versions_.size() && versions_[slot] == version;
+    return slot < versions_.size() && versions_[slot].load() == version;
+}
+
+void ResourceManager::DescriptorSlotAllocator::set_descriptor_buffer( uint8_t* binding_data, size_t descriptor_size ) {
+    binding_data_ = binding_data;
+    descriptor_size_ = descriptor_size;
+}
+
+void ResourceManager::DescriptorSlotAllocator::write_descriptors( VkDevice device ) {
+    for ( const auto& pending : pending_writes_ ) {
+        VkDescriptorGetInfoEXT get_info{ .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT, .type = type_ };
+
+        VkDescriptorAddressInfoEXT address_info{ .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT };
+        if ( const auto* buffer_info = std::get_if<VkDescriptorBufferInfo>( &pending.resource ) ) {
+            const VkBufferDeviceAddressInfo buffer_address{
+                .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+                .buffer = buffer_info->buffer,
+            };
+            address_info.address = vkGetBufferDeviceAddress( device, &buffer_address ) + buffer_info->offset;
+            address_info.range = buffer_info->range;
+            get_info.data.pStorageBuffer = &address_info;
+        } else {
+            const auto& image_info = std::get<VkDescriptorImageInfo>( pending.resource );
+            switch ( type_ ) {
+                case VK_DESCRIPTOR_TYPE_SAMPLER: get_info.data.pSampler = &image_info.sampler; break;
+                case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE: get_info.data.pStorageImage = &image_info; break;
+                default: get_info.data.pSampledImage = &image_info; break;
+            }
+        }
+
+        auto* descriptor = binding_data_ + static_cast<size_t>( pending.write.dstArrayElement ) * descriptor_size_;
+        vkGetDescriptorEXT( device, &get_info, descriptor_size_, descriptor );
+    }
 }
 
 void ResourceManager::DescriptorSlotAllocator::bind_slots( VkDevice device, VkDescriptorSet set ) {
+    std::scoped_lock lock( mutex_ );
     if ( pending_writes_.empty() ) return;
 
+    if ( binding_data_ != nullptr ) {
+        write_descriptors( device );
+        pending_writes_.clear();
+        return;
+    }
+
     std::vector<VkWriteDescriptorSet> writes;
     for ( auto& pending : pending_writes_ ) {
         pending.finalize( set );
@@ -88,152 +505,1997 @@ void ResourceManager::DescriptorSlotAllocator::bind_slots( VkDevice device, VkDe
 
 
 ResourceManager::~ResourceManager() {
-    std::ranges::for_each( buffers_, [&]( const auto& pair ) {
-        vmaDestroyBuffer( allocator_, pair.second.resource, pair.second.allocation );
+    // Loads still running would otherwise finish into a half destroyed `ResourceManager`
+    streaming_workers_.reset();
+
+    // The buffers the manager made for itself are released first, so whatever is left was leaked by the application
+    for ( uint32_t i = 0; i < linear_frame_count_; ++i ) { free_buffer( linear_frames_[i].buffer ); }
+    linear_frame_count_ = 0;
+    if ( streaming_buffer_ != BufferHandle{} ) { free_buffer( streaming_buffer_ ); }
+    report_leaks();
+
+    buffers_.for_each( [&]( BufferHandle, const auto& buffer ) {
+        // Sub-allocations are released alongside their pool
+        if ( buffer.sub_allocation != VK_NULL_HANDLE ) return;
+        destroy_buffer( buffer );
+    } );
+
+    std::ranges::for_each( buffer_pools_, [&]( const auto& pair ) {
+        vmaClearVirtualBlock( pair.second );
+        vmaDestroyVirtualBlock( pair.second );
     } );
 
-    std::ranges::for_each( images_, [&]( const auto& pair ) {
-        std::ranges::for_each( pair.second.bound_resources, [&]( const auto& bound_resource ) {
+    images_.for_each( [&]( ImageHandle, const auto& image ) {
+        std::ranges::for_each( image.bound_resources, [&]( const auto& bound_resource ) {
             assert( bound_resource.second.view != VK_NULL_HANDLE );
             vkDestroyImageView( device_.device(), bound_resource.second.view, nullptr );
         } );
 
-        vmaDestroyImage( allocator_, pair.second.resource, pair.second.allocation );
+        destroy_image( image );
+    } );
+
+    std::ranges::for_each( samplers_, [&]( const auto& pair ) {
+        vkDestroySampler( device_.device(), pair.second.first, nullptr );
     } );
+
+    if ( descriptor_heap_.buffer != VK_NULL_HANDLE ) {
+        vmaDestroyBuffer( allocator_, descriptor_heap_.buffer, descriptor_heap_.allocation );
+    }
+
+    // Every resource (and so every allocation from a custom pool) has been released above
+    std::ranges::for_each( memory_pools_, [&]( const auto& pair ) { vmaDestroyPool( allocator_, pair.second.pool ); } );
 }
 
 BufferHandle ResourceManager::create_buffer( const BufferDesc& desc ) {
+    if ( desc.parent != BufferHandle{} ) { return create_sub_buffer( desc ); }
+
+    const auto pool = get_memory_pool( desc.memory_pool, desc.name );
+    if ( !pool ) { return {}; }
+
+    // The id is reserved up front, as the allocation is tagged with it before the buffer is published
+    const auto id = current_resource_id_++;
     VmaAllocationCreateInfo alloc_info{
         .flags = desc.memory_flags,
         .usage = desc.memory_usage,
+        .requiredFlags = desc.required_memory_properties,
+        .pool = *pool,
+        .pUserData = allocation_user_data( id ),
     };
 
     AllocatedResource<VkBuffer, BufferDesc> buffer;
-    VkBufferCreateInfo buffer_info{
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .size = desc.size,
-        .usage = desc.usage,
-    };
+    const auto buffer_info = buffer_create_info( desc, needs_device_address( device_ ) );
 
     buffer.desc = desc;
-    const auto result =
-        vmaCreateBuffer( allocator_, &buffer_info, &alloc_info, &buffer.resource, &buffer.allocation, nullptr );
+    VmaAllocationInfo allocation_info{};
+    const auto result = vmaCreateBuffer(
+        allocator_, &buffer_info, &alloc_info, &buffer.resource, &buffer.allocation, &allocation_info );
     if ( result != VK_SUCCESS ) { return {}; }
+    buffer.accounted_bytes = allocation_info.size;
 
-    if ( device_.validation_enabled() && desc.name ) {
-        VkDebugUtilsObjectNameInfoEXT debug_name_info{
-            .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
-            .objectType = VK_OBJECT_TYPE_BUFFER,
-            .objectHandle = reinterpret_cast<uint64_t>( buffer.resource ),
-            .pObjectName = desc.name,
+    return add_buffer( id, std::move( buffer ) );
+}
+
+std::vector<BufferHandle> ResourceManager::create_buffers( std::span<const BufferDesc> descs ) {
+    std::vector<BufferHandle> handles( descs.size() );
+    std::vector<VkBuffer> created( descs.size(), VK_NULL_HANDLE );
+    std::vector<BatchMember> members;
+    members.reserve( descs.size() );
+
+    // VMA can only resolve `VMA_MEMORY_USAGE_AUTO*` with a buffer description, which costs a temporary buffer, so the
+    // memory type is looked up once per distinct combination
+    using MemoryTypeKey =
+        std::tuple<VkBufferUsageFlags, VmaMemoryUsage, VmaAllocationCreateFlags, VkMemoryPropertyFlags, uint32_t>;
+    std::map<MemoryTypeKey, uint32_t> memory_types;
+
+    for ( size_t i = 0; i < descs.size(); ++i ) {
+        const auto& desc = descs[i];
+        // Sub-allocations already share the allocation of their pool, and custom pools decide their own placement
+        if ( desc.parent != BufferHandle{} || desc.memory_pool != MemoryPoolHandle{} ) {
+            handles[i] = create_buffer( desc );
+            continue;
+        }
+
+        const auto buffer_info = buffer_create_info( desc, needs_device_address( device_ ) );
+        if ( vkCreateBuffer( device_.device(), &buffer_info, nullptr, &created[i] ) != VK_SUCCESS ) {
+            log_write( LogLevel::Error, "Failed to create buffer {}", desc.name );
+            continue;
+        }
+
+        BatchMember member{ .index = i, .flags = desc.memory_flags };
+        vkGetBufferMemoryRequirements( device_.device(), created[i], &member.requirements );
+
+        const auto key = std::make_tuple( buffer_info.usage,
+                                          desc.memory_usage,
+                                          desc.memory_flags,
+                                          desc.required_memory_properties,
+                                          member.requirements.memoryTypeBits );
+        if ( const auto iter = memory_types.find( key ); iter != memory_types.end() ) {
+            member.memory_type = iter->second;
+        } else {
+            const VmaAllocationCreateInfo alloc_info{
+                .flags = desc.memory_flags,
+                .usage = desc.memory_usage,
+                .requiredFlags = desc.required_memory_properties,
+                .memoryTypeBits = member.requirements.memoryTypeBits,
+            };
+            if ( vmaFindMemoryTypeIndexForBufferInfo( allocator_, &buffer_info, &alloc_info, &member.memory_type ) !=
+                 VK_SUCCESS ) {
+                log_write( LogLevel::Error, "No memory type is suitable for buffer {}", desc.name );
+                vkDestroyBuffer( device_.device(), created[i], nullptr );
+                continue;
+            }
+            memory_types.emplace( key, member.memory_type );
+        }
+
+        members.push_back( member );
+    }
+
+    allocate_batch( members );
+
+    for ( const auto& member : members ) {
+        const auto& desc = descs[member.index];
+        const auto buffer = created[member.index];
+
+        if ( member.allocation == VK_NULL_HANDLE ||
+             vmaBindBufferMemory2( allocator_, member.allocation, member.offset, buffer, nullptr ) != VK_SUCCESS ) {
+            log_write( LogLevel::Error, "Failed to allocate memory for buffer {}", desc.name );
+            vkDestroyBuffer( device_.device(), buffer, nullptr );
+            if ( member.allocation != VK_NULL_HANDLE ) { release_shared_allocation( member.allocation ); }
+            continue;
+        }
+
+        AllocatedResource<VkBuffer, BufferDesc> resource{
+            .resource = buffer,
+            .allocation = member.allocation,
+            .desc = desc,
+            .allocation_offset = member.offset,
+            .accounted_bytes = member.requirements.size,
         };
-        vkSetDebugUtilsObjectNameEXT( device_.device(), &debug_name_info );
+        handles[member.index] = add_buffer( current_resource_id_++, std::move( resource ) );
     }
 
-    return buffers_.emplace( BufferHandle( current_resource_id_++ ), buffer ).first->first;
+    return handles;
 }
 
-ImageHandle ResourceManager::create_image( const ImageDesc& desc ) {
-    VmaAllocationCreateInfo alloc_info{
-        .flags = desc.memory_flags,
-        .usage = desc.memory_usage,
+BufferHandle ResourceManager::create_shared_buffer( const BufferDesc& desc, const void* data, VkDeviceSize size ) {
+    const SharedKey key = {
+        .desc = shared_desc_hash( desc ),
+        .data = hash128( data, size ),
+        .category = desc.category ? desc.category : "",
     };
+    if ( const auto id = acquire_shared( key ) ) { return BufferHandle{ *id }; }
 
-    AllocatedResource<VkImage, ImageDesc> image;
-    VkImageCreateInfo image_info{
-        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-        .imageType = VK_IMAGE_TYPE_2D,
-        .format = desc.format,
-        .extent = desc.extent,
-        .mipLevels = desc.mip_levels,
-        .arrayLayers = 1,
-        .samples = VK_SAMPLE_COUNT_1_BIT,
-        .tiling = desc.tiling,
-        .usage = desc.usage,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    const auto handle = create_buffer( desc );
+    if ( handle.raw == 0 ) { return {}; }
+    if ( stage_to_buffer( handle, data, size ) != size ) {
+        free_buffer( handle );
+        return {};
+    }
+
+    // Another thread may have created the same contents in the meantime, in which case this copy is dropped
+    const auto id = publish_shared( key, handle.raw );
+    if ( id != handle.raw ) { free_buffer( handle ); }
+    return BufferHandle{ id };
+}
+
+ImageHandle ResourceManager::create_shared_image( const ImageDesc& desc, const void* data, VkDeviceSize size ) {
+    const SharedKey key = {
+        .desc = shared_desc_hash( desc ),
+        .data = hash128( data, size ),
+        .category = desc.category ? desc.category : "",
     };
+    if ( const auto id = acquire_shared( key ) ) { return ImageHandle{ *id }; }
 
-    image.desc = desc;
-    const auto result =
-        vmaCreateImage( allocator_, &image_info, &alloc_info, &image.resource, &image.allocation, nullptr );
-    if ( result != VK_SUCCESS ) { return {}; }
+    const auto handle = create_image( desc );
+    if ( handle.raw == 0 ) { return {}; }
+    if ( upload_to_image( handle, data, size ) != size ) {
+        free_image( handle );
+        return {};
+    }
+
+    const auto id = publish_shared( key, handle.raw );
+    if ( id != handle.raw ) { free_image( handle ); }
+    return ImageHandle{ id };
+}
+
+std::optional<uint64_t> ResourceManager::acquire_shared( const SharedKey& key ) {
+    std::scoped_lock lock( shared_mutex_ );
+    const auto iter = shared_ids_.find( key );
+    if ( iter == shared_ids_.end() ) { return std::nullopt; }
+
+    shared_resources_.at( iter->second ).references++;
+    return iter->second;
+}
+
+uint64_t ResourceManager::publish_shared( const SharedKey& key, uint64_t id ) {
+    std::scoped_lock lock( shared_mutex_ );
+    const auto [iter, inserted] = shared_ids_.try_emplace( key, id );
+    if ( inserted ) { shared_resources_[id] = { .key = key }; }
+
+    shared_resources_.at( iter->second ).references++;
+    return iter->second;
+}
+
+bool ResourceManager::release_shared( uint64_t id ) {
+    std::scoped_lock lock( shared_mutex_ );
+    const auto iter = shared_resources_.find( id );
+    if ( iter == shared_resources_.end() ) { return false; }
+    if ( --iter->second.references > 0 ) { return true; }
+
+    shared_ids_.erase( iter->second.key );
+    shared_resources_.erase( iter );
+    return false;
+}
 
-    if ( device_.validation_enabled() && desc.name ) {
+BufferHandle ResourceManager::add_buffer( uint32_t id, AllocatedResource<VkBuffer, BufferDesc> buffer ) {
+    if ( device_.buffer_device_address_enabled() ) {
+        const VkBufferDeviceAddressInfo address_info{
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .buffer = buffer.resource,
+        };
+        buffer.address = vkGetBufferDeviceAddress( device_.device(), &address_info );
+    }
+
+    if ( device_.validation_enabled() && buffer.desc.name ) {
         VkDebugUtilsObjectNameInfoEXT debug_name_info{
             .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
-            .objectType = VK_OBJECT_TYPE_IMAGE,
-            .objectHandle = reinterpret_cast<uint64_t>( image.resource ),
-            .pObjectName = desc.name,
+            .objectType = VK_OBJECT_TYPE_BUFFER,
+            .objectHandle = reinterpret_cast<uint64_t>( buffer.resource ),
+            .pObjectName = buffer.desc.name,
         };
         vkSetDebugUtilsObjectNameEXT( device_.device(), &debug_name_info );
     }
 
-    return images_.emplace( current_resource_id_++, image ).first->first;
+    update_accounts( buffer.desc.name, buffer.desc.category, static_cast<int64_t>( buffer.accounted_bytes ), 1 );
+
+    const auto handle = BufferHandle( id );
+    buffers_.emplace( handle, std::move( buffer ) );
+    return handle;
 }
 
-VkDeviceSize ResourceManager::upload_to_buffer( BufferHandle handle, const void* data, VkDeviceSize size ) {
-    if ( const auto* resource = find_buffer( handle ) ) {
-        if ( ( resource->desc.memory_flags &
-               ( VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
-                 VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT ) ) == 0 ) {
-            log_write( LogLevel::Error,
-                       "Trying to write to {}, which was not created with "
-                       "`VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT` or "
-                       "`VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT`",
-                       resource->desc.name );
+bool ResourceManager::is_shared_allocation( VmaAllocation allocation ) const {
+    std::scoped_lock lock( allocation_mutex_ );
+    return shared_allocations_.contains( allocation );
+}
 
-            return 0;
+void ResourceManager::destroy_buffer( const AllocatedResource<VkBuffer, BufferDesc>& buffer ) {
+    if ( is_shared_allocation( buffer.allocation ) ) {
+        vkDestroyBuffer( device_.device(), buffer.resource, nullptr );
+        release_shared_allocation( buffer.allocation );
+    } else {
+        vmaDestroyBuffer( allocator_, buffer.resource, buffer.allocation );
+    }
+}
+
+void ResourceManager::allocate_batch( std::vector<BatchMember>& members ) {
+    // Members sharing an allocation must agree on the memory type and the allocation flags (e.g. persistent mapping)
+    std::vector<BatchMember*> order( members.size() );
+    std::ranges::transform( members, order.begin(), []( auto& member ) { return &member; } );
+    std::ranges::stable_sort( order, {}, []( const BatchMember* member ) {
+        return std::make_pair( member->memory_type, member->flags );
+    } );
+
+    auto begin = order.begin();
+    while ( begin != order.end() ) {
+        VkMemoryRequirements requirements{ .memoryTypeBits = 1u << ( *begin )->memory_type };
+
+        // Grow the allocation until it reaches `batch_allocation_size`, oversized resources get an allocation each
+        auto end = begin;
+        for ( ; end != order.end(); ++end ) {
+            auto& member = **end;
+            if ( member.memory_type != ( *begin )->memory_type || member.flags != ( *begin )->flags ) break;
+
+            const auto alignment = member.requirements.alignment;
+            const auto offset = ( requirements.size + alignment - 1 ) & ~( alignment - 1 );
+            if ( end != begin && offset + member.requirements.size > batch_allocation_size ) break;
+
+            member.offset = offset;
+            requirements.size = offset + member.requirements.size;
+            requirements.alignment = std::max( requirements.alignment, alignment );
         }
-        void* dst_pointer = nullptr;
-        vmaMapMemory( allocator_, resource->allocation, &dst_pointer );
-        std::memcpy( dst_pointer, data, size );
-        vmaUnmapMemory( allocator_, resource->allocation );
 
-        return size;
+        // Shared allocations carry no resource id, so defragmentation will never try to move them
+        const VmaAllocationCreateInfo alloc_info{
+            .flags = ( *begin )->flags,
+            .memoryTypeBits = requirements.memoryTypeBits,
+        };
+
+        VmaAllocation allocation = VK_NULL_HANDLE;
+        if ( vmaAllocateMemory( allocator_, &requirements, &alloc_info, &allocation, nullptr ) == VK_SUCCESS ) {
+            std::scoped_lock lock( allocation_mutex_ );
+            shared_allocations_.emplace( allocation, static_cast<uint32_t>( end - begin ) );
+            std::for_each( begin, end, [&]( BatchMember* member ) { member->allocation = allocation; } );
+        }
+
+        begin = end;
     }
-    return 0;
 }
 
-VkDeviceSize ResourceManager::read_from_buffer( BufferHandle handle, void* out_data, VkDeviceSize bytes_to_read ) {
-    if ( const auto* resource = find_buffer( handle ) ) {
-        if ( ( resource->desc.memory_flags &
-               ( VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
-                 VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT ) ) == 0 ) {
+void ResourceManager::release_shared_allocation( VmaAllocation allocation ) {
+    std::scoped_lock lock( allocation_mutex_ );
+    const auto iter = shared_allocations_.find( allocation );
+    assert( iter != shared_allocations_.end() && iter->second > 0 );
+
+    if ( --iter->second == 0 ) {
+        vmaFreeMemory( allocator_, allocation );
+        shared_allocations_.erase( iter );
+    }
+}
+
+BufferHandle ResourceManager::create_buffer_pool( const BufferDesc& desc ) {
+    if ( desc.parent != BufferHandle{} ) {
+        log_write( LogLevel::Error, "Buffer pool {} can not itself be sub-allocated from another pool", desc.name );
+        return {};
+    }
+
+    const auto handle = create_buffer( desc );
+    if ( handle == BufferHandle{} ) { return {}; }
+
+    const VmaVirtualBlockCreateInfo block_info{ .size = desc.size };
+
+    VmaVirtualBlock block = VK_NULL_HANDLE;
+    if ( vmaCreateVirtualBlock( &block_info, &block ) != VK_SUCCESS ) {
+        free_buffer( handle );
+        return {};
+    }
+
+    std::scoped_lock lock( allocation_mutex_ );
+    buffer_pools_.emplace( handle, block );
+    return handle;
+}
+
+BufferHandle ResourceManager::create_sub_buffer( const BufferDesc& desc ) {
+    // Virtual blocks are not thread safe, and the pool must not be freed while it is sub-allocated from
+    std::unique_lock lock( allocation_mutex_ );
+    const auto pool_iter = buffer_pools_.find( desc.parent );
+    if ( pool_iter == buffer_pools_.end() ) {
+        log_write( LogLevel::Error,
+                   "Trying to sub-allocate {} from buffer {}, which is not a buffer pool",
+                   desc.name,
+                   desc.parent.raw );
+        return {};
+    }
+
+    const auto* pool = find_buffer( desc.parent );
+    assert( pool != nullptr );
+
+    const VmaVirtualAllocationCreateInfo sub_allocation_info{
+        .size = desc.size,
+        .alignment = sub_allocation_alignment,
+    };
+
+    AllocatedResource<VkBuffer, BufferDesc> buffer;
+    const auto result =
+        vmaVirtualAllocate( pool_iter->second, &sub_allocation_info, &buffer.sub_allocation, &buffer.offset );
+    if ( result != VK_SUCCESS ) {
+        log_write( LogLevel::Error, "Buffer pool {} has no space left for {}", pool->desc.name, desc.name );
+        return {};
+    }
+
+    buffer.resource = pool->resource;
+    buffer.allocation = pool->allocation;
+    buffer.address = pool->address;
+    buffer.allocation_offset = pool->allocation_offset;
+    buffer.desc = desc;
+    buffer.desc.usage = pool->desc.usage;
+    buffer.desc.memory_usage = pool->desc.memory_usage;
+    buffer.desc.memory_flags = pool->desc.memory_flags;
+    lock.unlock();
+
+    update_accounts( desc.name, desc.category, 0, 1 );
+
+    const auto handle = BufferHandle( current_resource_id_++ );
+    buffers_.emplace( handle, std::move( buffer ) );
+    return handle;
+}
+
+MemoryPoolHandle ResourceManager::create_memory_pool( const MemoryPoolDesc& desc ) {
+    if ( ( desc.buffer_usage == 0 ) == ( desc.image_usage == 0 ) ) {
+        log_write( LogLevel::Error, "Memory pool {} needs exactly one of a buffer or an image usage", desc.name );
+        return {};
+    }
+
+    // Pick the memory type for a representative resource, created the same way as the resources placed in the pool
+    const VmaAllocationCreateInfo alloc_info{ .flags = desc.memory_flags, .usage = desc.memory_usage };
+    uint32_t memory_type = 0;
+    VkResult result = VK_SUCCESS;
+    if ( desc.buffer_usage != 0 ) {
+        const auto buffer_info =
+            buffer_create_info( { .size = 1024, .usage = desc.buffer_usage }, needs_device_address( device_ ) );
+        result = vmaFindMemoryTypeIndexForBufferInfo( allocator_, &buffer_info, &alloc_info, &memory_type );
+    } else {
+        const auto image_info = image_create_info( {
+            .extent = { 1, 1, 1 },
+            .format = desc.image_format,
+            .usage = desc.image_usage,
+        } );
+        result = vmaFindMemoryTypeIndexForImageInfo( allocator_, &image_info, &alloc_info, &memory_type );
+    }
+    if ( result != VK_SUCCESS ) {
+        log_write( LogLevel::Error, "No memory type is suitable for memory pool {}", desc.name );
+        return {};
+    }
+
+    const VmaPoolCreateInfo pool_info{
+        .memoryTypeIndex = memory_type,
+        .flags = desc.algorithm == MemoryPoolAlgorithm::Linear
+            ? VmaPoolCreateFlags{ VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT }
+            : VmaPoolCreateFlags{ 0 },
+        .blockSize = desc.block_size,
+        .minBlockCount = desc.min_block_count,
+        .maxBlockCount = desc.max_block_count,
+    };
+
+    VmaPool pool = VK_NULL_HANDLE;
+    if ( vmaCreatePool( allocator_, &pool_info, &pool ) != VK_SUCCESS ) {
+        log_write( LogLevel::Error, "Failed to create memory pool {}", desc.name );
+        return {};
+    }
+    if ( desc.name ) { vmaSetPoolName( allocator_, pool, desc.name ); }
+
+    const auto handle = MemoryPoolHandle{ current_resource_id_++ };
+    std::scoped_lock lock( allocation_mutex_ );
+    memory_pools_.emplace( handle, MemoryPool{ .pool = pool, .memory_type = memory_type, .desc = desc } );
+    return handle;
+}
+
+bool ResourceManager::free_memory_pool( MemoryPoolHandle handle ) {
+    std::scoped_lock lock( allocation_mutex_ );
+    const auto iter = memory_pools_.find( handle );
+    if ( iter == memory_pools_.end() ) {
+        log_write( LogLevel::Error, "Trying to free memory pool {}, which does not exist", handle.raw );
+        return false;
+    }
+
+    VmaStatistics statistics{};
+    vmaGetPoolStatistics( allocator_, iter->second.pool, &statistics );
+    if ( statistics.allocationCount > 0 ) {
+        log_write( LogLevel::Error,
+                   "Trying to free memory pool {}, which still has {} resources allocated from it",
+                   iter->second.desc.name,
+                   statistics.allocationCount );
+        return false;
+    }
+
+    vmaDestroyPool( allocator_, iter->second.pool );
+    memory_pools_.erase( iter );
+    return true;
+}
+
+std::optional<VmaPool> ResourceManager::get_memory_pool( MemoryPoolHandle handle, const char* resource_name ) const {
+    if ( handle == MemoryPoolHandle{} ) { return VK_NULL_HANDLE; }
+
+    std::scoped_lock lock( allocation_mutex_ );
+    const auto iter = memory_pools_.find( handle );
+    if ( iter == memory_pools_.end() ) {
+        log_write( LogLevel::Error,
+                   "Trying to allocate {} from memory pool {}, which does not exist",
+                   resource_name,
+                   handle.raw );
+        return std::nullopt;
+    }
+    return iter->second.pool;
+}
+
+bool ResourceManager::create_linear_allocator( const LinearAllocatorDesc& desc ) {
+    if ( desc.frames_in_flight == 0 || desc.size_per_frame == 0 ) {
+        log_write( LogLevel::Error, "Linear allocator {} needs at least one non-empty frame slot", desc.name );
+        return false;
+    }
+    // Allocations are handed to shaders as the 32 bit offset & size of a `GpuBufferHandle`
+    if ( desc.size_per_frame > std::numeric_limits<uint32_t>::max() ) {
+        log_write( LogLevel::Error,
+                   "Linear allocator {} can not have {} byte frame slots, they hold at most {} bytes",
+                   desc.name,
+                   desc.size_per_frame,
+                   std::numeric_limits<uint32_t>::max() );
+        return false;
+    }
+
+    // Release the frame slots of the previous allocator, the frames using it must have already completed
+    for ( uint32_t i = 0; i < linear_frame_count_; ++i ) { free_buffer( linear_frames_[i].buffer ); }
+    linear_frames_.reset();
+    linear_frame_count_ = 0;
+    linear_frame_size_ = 0;
+
+    auto frames = std::make_unique<LinearFrame[]>( desc.frames_in_flight );
+    for ( uint32_t i = 0; i < desc.frames_in_flight; ++i ) {
+        auto& frame = frames[i];
+        frame.buffer = create_buffer( {
+            .size = desc.size_per_frame,
+            .usage = desc.usage,
+            .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+            // Callers write straight through `LinearAllocation::data`, and never flush
+            .required_memory_properties = VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            .name = desc.name,
+            .category = "Linear Allocator",
+        } );
+
+        // Bind each frame slot once up front, allocations only ever hand out offsets into it
+        const auto bound_id = frame.buffer != BufferHandle{}
+            ? bind_resource( usage( frame.buffer, ComputeStorageReadWrite ) )
+            : std::nullopt;
+        if ( !bound_id ) {
+            log_write( LogLevel::Error, "Failed to create frame slot {} for linear allocator {}", i, desc.name );
+            for ( uint32_t j = 0; j <= i; ++j ) {
+                if ( frames[j].buffer != BufferHandle{} ) { free_buffer( frames[j].buffer ); }
+            }
+            return false;
+        }
+
+        VmaAllocationInfo allocation_info{};
+        vmaGetAllocationInfo( allocator_, find_buffer( frame.buffer )->allocation, &allocation_info );
+
+        frame.mapped = static_cast<uint8_t*>( allocation_info.pMappedData );
+        frame.bound_id = *bound_id;
+        frame.address = find_buffer( frame.buffer )->address;
+    }
+
+    linear_frames_ = std::move( frames );
+    linear_frame_count_ = desc.frames_in_flight;
+    linear_frame_size_ = desc.size_per_frame;
+    return true;
+}
+
+std::optional<LinearAllocation> ResourceManager::allocate_transient( VkDeviceSize size, VkDeviceSize alignment ) {
+    if ( !linear_frames_ ) {
+        log_write( LogLevel::Error, "Trying to allocate {} transient bytes without a linear allocator", size );
+        return std::nullopt;
+    }
+    assert( alignment != 0 && ( alignment & ( alignment - 1 ) ) == 0 );
+    // Also keeps the offset & size within the 32 bit fields of the `GpuBufferHandle`, as frame slots fit in them
+    if ( size > linear_frame_size_ || alignment > linear_frame_size_ ) {
+        log_write( LogLevel::Error,
+                   "Can not allocate {} transient bytes aligned to {}, frame slots only hold {} bytes",
+                   size,
+                   alignment,
+                   linear_frame_size_ );
+        return std::nullopt;
+    }
+
+    auto& frame = linear_frames_[frame_index_ % linear_frame_count_];
+
+    VkDeviceSize offset = frame.head.load( std::memory_order_relaxed );
+    VkDeviceSize aligned_offset = 0;
+    do {
+        aligned_offset = ( offset + alignment - 1 ) & ~( alignment - 1 );
+        if ( aligned_offset + size > linear_frame_size_ ) { return std::nullopt; }
+    } while ( !frame.head.compare_exchange_weak( offset, aligned_offset + size, std::memory_order_relaxed ) );
+
+    return LinearAllocation{
+        .data = frame.mapped + aligned_offset,
+        .buffer = frame.buffer,
+        .offset = aligned_offset,
+        .size = size,
+        .gpu_handle = {
+            .id = frame.bound_id,
+            .offset = static_cast<uint32_t>( aligned_offset ),
+            .size = static_cast<uint32_t>( size ),
+        },
+        .address = frame.address != 0 ? frame.address + aligned_offset : 0,
+    };
+}
+
+void ResourceManager::next_frame() {
+    if ( streaming_workers_ ) { update_streaming(); }
+
+    frame_index_++;
+
+    if ( linear_frames_ ) { linear_frames_[frame_index_ % linear_frame_count_].head.store( 0 ); }
+
+    // VMA refreshes its cached budget when the frame index changes
+    vmaSetCurrentFrameIndex( allocator_, static_cast<uint32_t>( frame_index_ ) );
+    update_memory_statistics();
+}
+
+void ResourceManager::update_memory_statistics() {
+    const VkPhysicalDeviceMemoryProperties* memory_properties = nullptr;
+    vmaGetMemoryProperties( allocator_, &memory_properties );
+
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+    vmaGetHeapBudgets( allocator_, budgets.data() );
+
+    const auto heap_count = memory_properties->memoryHeapCount;
+    memory_statistics_.frame_index = frame_index_;
+    memory_statistics_.heaps.resize( heap_count );
+    heaps_over_threshold_.resize( heap_count, false );
+
+    for ( uint32_t heap = 0; heap < heap_count; ++heap ) {
+        const auto& budget = budgets[heap];
+        memory_statistics_.heaps[heap] = {
+            .flags = memory_properties->memoryHeaps[heap].flags,
+            .budget = budget.budget,
+            .usage = budget.usage,
+            .block_bytes = budget.statistics.blockBytes,
+            .allocation_bytes = budget.statistics.allocationBytes,
+            .block_count = budget.statistics.blockCount,
+            .allocation_count = budget.statistics.allocationCount,
+        };
+
+        // Only warn when crossing the threshold, not on every frame spent above it
+        const bool over_threshold = budget.budget > 0 &&
+            static_cast<double>( budget.usage ) >= budget_warning_threshold_ * static_cast<double>( budget.budget );
+        if ( over_threshold && !heaps_over_threshold_[heap] ) {
+            log_write( LogLevel::Warn,
+                       "Memory heap {} is using {} MB of its {} MB budget ({:.0f}%)",
+                       heap,
+                       budget.usage / ( 1024 * 1024 ),
+                       budget.budget / ( 1024 * 1024 ),
+                       100.0 * static_cast<double>( budget.usage ) / static_cast<double>( budget.budget ) );
+        }
+        heaps_over_threshold_[heap] = over_threshold;
+    }
+
+    memory_statistics_.pools.clear();
+    std::scoped_lock lock( allocation_mutex_ );
+    for ( const auto& [handle, pool] : memory_pools_ ) {
+        VmaStatistics statistics{};
+        vmaGetPoolStatistics( allocator_, pool.pool, &statistics );
+
+        memory_statistics_.pools.push_back( {
+            .pool = handle,
+            .name = pool.desc.name,
+            .memory_type = pool.memory_type,
+            .block_bytes = statistics.blockBytes,
+            .allocation_bytes = statistics.allocationBytes,
+            .block_count = statistics.blockCount,
+            .allocation_count = statistics.allocationCount,
+        } );
+    }
+}
+
+void ResourceManager::set_budget_warning_threshold( float fraction ) {
+    budget_warning_threshold_ = std::clamp( fraction, 0.0f, 1.0f );
+    // Re-arm the warning for heaps which are already above the new threshold
+    std::ranges::fill( heaps_over_threshold_, false );
+}
+
+MemoryAccounts ResourceManager::memory_accounts() const {
+    MemoryAccounts accounts;
+    {
+        std::scoped_lock lock( accounts_mutex_ );
+        for ( const auto& [key, account] : name_accounts_ ) { accounts.names.push_back( account ); }
+        for ( const auto& [key, account] : category_accounts_ ) { accounts.categories.push_back( account ); }
+    }
+
+    const auto by_bytes = []( const MemoryAccount& a, const MemoryAccount& b ) {
+        return std::tie( b.bytes, a.key ) < std::tie( a.bytes, b.key );
+    };
+    std::ranges::sort( accounts.names, by_bytes );
+    std::ranges::sort( accounts.categories, by_bytes );
+    return accounts;
+}
+
+void ResourceManager::dump_memory_accounts() const {
+    const auto accounts = memory_accounts();
+    const auto dump = [&]( const char* heading, const std::vector<MemoryAccount>& entries ) {
+        log_write( LogLevel::Info, "Memory by {}:", heading );
+        for ( const auto& account : entries ) {
+            log_write( LogLevel::Info,
+                       "  {:<40} {:>10} KB (peak {} KB), {} live of {} created",
+                       account.key,
+                       account.bytes / 1024,
+                       account.peak_bytes / 1024,
+                       account.live_resources,
+                       account.total_resources );
+        }
+    };
+    dump( "category", accounts.categories );
+    dump( "name", accounts.names );
+}
+
+void ResourceManager::update_accounts( const char* name, const char* category, int64_t bytes, int32_t resources ) {
+    const auto update = [&]( std::unordered_map<std::string, MemoryAccount>& accounts, const char* key ) {
+        auto& account = accounts[key];
+        account.key = key;
+        account.bytes += static_cast<VkDeviceSize>( bytes );
+        account.peak_bytes = std::max( account.peak_bytes, account.bytes );
+        account.live_resources += resources;
+        if ( resources > 0 ) { account.total_resources += resources; }
+    };
+
+    std::scoped_lock lock( accounts_mutex_ );
+    update( name_accounts_, name ? name : unnamed_account );
+    update( category_accounts_, category ? category : uncategorized_account );
+}
+
+void ResourceManager::report_leaks() const {
+    // `{ name, category }` -> `{ resources, bytes }`
+    std::map<std::pair<std::string, std::string>, std::pair<uint32_t, VkDeviceSize>> leaks;
+    const auto record = [&]( const auto& resource ) {
+        auto& [resources, bytes] = leaks[{ resource.desc.name ? resource.desc.name : unnamed_account,
+                                           resource.desc.category ? resource.desc.category : uncategorized_account }];
+        resources++;
+        bytes += resource.accounted_bytes;
+    };
+    buffers_.for_each( [&]( BufferHandle, const auto& buffer ) { record( buffer ); } );
+    images_.for_each( [&]( ImageHandle, const auto& image ) { record( image ); } );
+    if ( leaks.empty() ) { return; }
+
+    uint32_t total_resources = 0;
+    VkDeviceSize total_bytes = 0;
+    for ( const auto& [key, leak] : leaks ) {
+        total_resources += leak.first;
+        total_bytes += leak.second;
+    }
+
+    log_write( LogLevel::Warn,
+               "{} resources ({} KB) were not freed before the resource manager was destroyed:",
+               total_resources,
+               total_bytes / 1024 );
+    for ( const auto& [key, leak] : leaks ) {
+        log_write( LogLevel::Warn,
+                   "  {} ({}): {} resources, {} KB",
+                   key.first,
+                   key.second,
+                   leak.first,
+                   leak.second / 1024 );
+    }
+}
+
+DefragmentationResult ResourceManager::defragment( std::chrono::microseconds time_budget ) {
+    DefragmentationResult result;
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto transfer_queues = device_.find_queues( VK_QUEUE_TRANSFER_BIT );
+    if ( transfer_queues.empty() ) {
+        log_write( LogLevel::Error, "No transfer queue available for defragmentation" );
+        return result;
+    }
+
+    const VmaDefragmentationInfo defragmentation_info{
+        .flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT,
+        .maxAllocationsPerPass = defragmentation_moves_per_pass,
+    };
+
+    // The context only lives for this call, so resources can be freely created and freed between calls
+    VmaDefragmentationContext context = VK_NULL_HANDLE;
+    if ( vmaBeginDefragmentation( allocator_, &defragmentation_info, &context ) != VK_SUCCESS ) {
+        log_write( LogLevel::Error, "Failed to begin defragmentation" );
+        return result;
+    }
+
+    do {
+        VmaDefragmentationPassMoveInfo pass{};
+        if ( vmaBeginDefragmentationPass( allocator_, context, &pass ) == VK_SUCCESS ) {
+            result.complete = true;
+            break;
+        }
+
+        std::vector<MovedResource> moved;
+        device_.immediate_submit( transfer_queues[0], [&]( VkCommandBuffer cmd ) {
+            moved = begin_defragmentation_moves( pass, cmd );
+        } );
+        end_defragmentation_moves( moved );
+
+        result.passes++;
+        result.moved_allocations += static_cast<uint32_t>( moved.size() );
+        for ( const auto& resource : moved ) { result.bytes_moved += resource.size; }
+
+        if ( vmaEndDefragmentationPass( allocator_, context, &pass ) == VK_SUCCESS ) {
+            result.complete = true;
+            break;
+        }
+    } while ( std::chrono::steady_clock::now() - start < time_budget );
+
+    VmaDefragmentationStats stats{};
+    vmaEndDefragmentation( allocator_, context, &stats );
+    result.bytes_freed = stats.bytesFreed;
+    result.blocks_freed = stats.deviceMemoryBlocksFreed;
+
+    return result;
+}
+
+std::vector<ResourceManager::MovedResource>
+ResourceManager::begin_defragmentation_moves( VmaDefragmentationPassMoveInfo& pass, VkCommandBuffer cmd ) {
+    std::vector<MovedResource> moved;
+
+    for ( uint32_t i = 0; i < pass.moveCount; ++i ) {
+        auto& move = pass.pMoves[i];
+        move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+
+        VmaAllocationInfo allocation_info{};
+        vmaGetAllocationInfo( allocator_, move.srcAllocation, &allocation_info );
+        const auto id = static_cast<uint64_t>( reinterpret_cast<uintptr_t>( allocation_info.pUserData ) );
+
+        if ( const auto* buffer_ptr = buffers_.find( BufferHandle( id ) ) ) {
+            const auto& buffer = *buffer_ptr;
+
+            // Persistently mapped pointers have been handed out (e.g. by the linear allocator), so must stay put
+            if ( buffer.desc.memory_flags & VMA_ALLOCATION_CREATE_MAPPED_BIT ) continue;
+            // As must buffers with a device address, which may be stored in other buffers (e.g. BVH nodes)
+            if ( buffer.address != 0 ) continue;
+
+            const auto buffer_info = buffer_create_info( buffer.desc, needs_device_address( device_ ) );
+            VkBuffer replacement = VK_NULL_HANDLE;
+            if ( vkCreateBuffer( device_.device(), &buffer_info, nullptr, &replacement ) != VK_SUCCESS ) continue;
+            if ( vmaBindBufferMemory( allocator_, move.dstTmpAllocation, replacement ) != VK_SUCCESS ) {
+                vkDestroyBuffer( device_.device(), replacement, nullptr );
+                continue;
+            }
+
+            const VkBufferCopy region{ .srcOffset = 0, .dstOffset = 0, .size = buffer.desc.size };
+            vkCmdCopyBuffer( cmd, buffer.resource, replacement, 1, &region );
+
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY;
+            moved.push_back( { .id = id, .size = buffer.desc.size, .buffer = replacement } );
+        } else if ( const auto* image_ptr = images_.find( ImageHandle( id ) ) ) {
+            const auto& image = *image_ptr;
+
+            constexpr VkImageUsageFlags transfer_usage =
+                VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+            if ( ( image.desc.usage & transfer_usage ) != transfer_usage ) continue;
+            // Depth and stencil images would need their other aspects copied, and are attachments regardless
+            if ( format_aspect( image.desc.format ) != VK_IMAGE_ASPECT_COLOR_BIT ) continue;
+            // Attachments are transitioned by render passes, which do not report the layout they leave them in
+            constexpr VkImageUsageFlags attachment_usage =
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+            if ( image.desc.usage & attachment_usage ) continue;
+            // Images which were never written to have no layout (or contents) to carry over
+            if ( image.layout == VK_IMAGE_LAYOUT_UNDEFINED ) continue;
+
+            const auto image_info = image_create_info( image.desc );
+            VkImage replacement = VK_NULL_HANDLE;
+            if ( vkCreateImage( device_.device(), &image_info, nullptr, &replacement ) != VK_SUCCESS ) continue;
+            if ( vmaBindImageMemory( allocator_, move.dstTmpAllocation, replacement ) != VK_SUCCESS ) {
+                vkDestroyImage( device_.device(), replacement, nullptr );
+                continue;
+            }
+
+            image_layout_barrier( cmd,
+                                  replacement,
+                                  image.desc,
+                                  VK_IMAGE_LAYOUT_UNDEFINED,
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                  0,
+                                  VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                  VK_ACCESS_TRANSFER_WRITE_BIT );
+
+            std::vector<VkImageCopy> regions;
+            for ( uint32_t mip = 0; mip < image.desc.mip_levels; ++mip ) {
+                const VkImageSubresourceLayers layers{ .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                                       .mipLevel = mip,
+                                                       .baseArrayLayer = 0,
+                                                       .layerCount = image.desc.array_layers };
+                regions.push_back( {
+                    .srcSubresource = layers,
+                    .srcOffset = { 0, 0, 0 },
+                    .dstSubresource = layers,
+                    .dstOffset = { 0, 0, 0 },
+                    .extent = mip_extent( image.desc.extent, mip ),
+                } );
+            }
+
+            const auto source_layout = prepare_copy_source( cmd, image.resource, image.desc, image.layout );
+            vkCmdCopyImage( cmd,
+                            image.resource,
+                            source_layout,
+                            replacement,
+                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            static_cast<uint32_t>( regions.size() ),
+                            regions.data() );
+
+            // Leave the replacement in the layout the image it replaces rested in
+            image_layout_barrier( cmd,
+                                  replacement,
+                                  image.desc,
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  image.layout,
+                                  VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                  VK_ACCESS_TRANSFER_WRITE_BIT,
+                                  VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                  VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT );
+
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY;
+            moved.push_back( { .id = id, .size = allocation_info.size, .image = replacement } );
+        }
+    }
+
+    return moved;
+}
+
+void ResourceManager::end_defragmentation_moves( const std::vector<MovedResource>& moved ) {
+    for ( const auto& move : moved ) {
+        if ( move.buffer != VK_NULL_HANDLE ) {
+            const auto handle = BufferHandle( move.id );
+            auto& buffer = *buffers_.find( handle );
+            vkDestroyBuffer( device_.device(), buffer.resource, nullptr );
+            buffer.resource = move.buffer;
+
+            // Sub-allocations alias the buffer of their pool, and share its descriptor slot(s)
+            buffers_.for_each( [&]( BufferHandle, auto& child ) {
+                if ( child.desc.parent == handle ) { child.resource = move.buffer; }
+            } );
+
+            for ( const auto& [_, bound] : buffer.bound_resources ) {
+                storage_buffer_allocator_.update_slot(
+                    bound.slot,
+                    VkDescriptorBufferInfo{ .buffer = move.buffer, .offset = 0, .range = buffer.desc.size } );
+            }
+        } else {
+            const auto handle = ImageHandle( move.id );
+            auto& image = *images_.find( handle );
+            vkDestroyImage( device_.device(), image.resource, nullptr );
+            image.resource = move.image;
+
+            recreate_image_views( handle, resident_mip( handle ) );
+        }
+    }
+}
+
+void ResourceManager::recreate_image_views( ImageHandle handle, std::optional<uint32_t> first_resident_mip ) {
+    for ( auto& [usage, bound] : images_.find( handle )->bound_resources ) {
+        vkDestroyImageView( device_.device(), bound.view, nullptr );
+        bound.view = create_view( handle, usage, first_resident_mip );
+        if ( auto* slot_allocator = get_image_slot_allocator( usage ) ) {
+            slot_allocator->update_slot(
+                bound.slot, VkDescriptorImageInfo{ .imageView = bound.view, .imageLayout = usage.layout } );
+        }
+    }
+}
+
+bool ResourceManager::enable_streaming( const StreamingSettings& settings ) {
+    if ( streaming_workers_ ) {
+        log_write( LogLevel::Error, "Streaming is already enabled" );
+        return false;
+    }
+    if ( settings.max_streamed_images == 0 || settings.max_pending_loads == 0 ) {
+        log_write( LogLevel::Error, "Streaming needs room for at least one streamed image and one pending load" );
+        return false;
+    }
+
+    streaming_buffer_ = create_buffer( {
+        .size = VkDeviceSize{ settings.max_streamed_images } * 2 * sizeof( uint32_t ),
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .name = "Streaming Feedback Buffer",
+        .category = "Streaming",
+    } );
+    if ( streaming_buffer_ == BufferHandle{} ) {
+        log_write( LogLevel::Error, "Failed to create the streaming feedback buffer" );
+        return false;
+    }
+
+    const auto allocation = find_buffer( streaming_buffer_ )->allocation;
+    VmaAllocationInfo allocation_info{};
+    vmaGetAllocationInfo( allocator_, allocation, &allocation_info );
+    streaming_feedback_ = static_cast<uint32_t*>( allocation_info.pMappedData );
+    std::fill_n( streaming_feedback_, settings.max_streamed_images * 2, no_streaming_request );
+    vmaFlushAllocation( allocator_, allocation, 0, VK_WHOLE_SIZE );
+
+    {
+        std::scoped_lock lock( streaming_mutex_ );
+        // Popped from the back, so the lowest indices are handed out first
+        free_streaming_indices_.resize( settings.max_streamed_images );
+        std::iota( free_streaming_indices_.rbegin(), free_streaming_indices_.rend(), 0u );
+
+        streaming_settings_ = settings;
+        streaming_statistics_.budget = settings.budget;
+    }
+    streaming_workers_ = std::make_unique<ThreadPool>( settings.worker_threads );
+    return true;
+}
+
+void ResourceManager::set_streaming_budget( VkDeviceSize budget ) {
+    std::scoped_lock lock( streaming_mutex_ );
+    streaming_settings_.budget = budget;
+    streaming_statistics_.budget = budget;
+}
+
+ImageHandle ResourceManager::create_streamed_image( const StreamedImageDesc& desc ) {
+    if ( !streaming_workers_ ) {
+        log_write( LogLevel::Error, "Can not create streamed image {}, streaming is not enabled", desc.image.name );
+        return {};
+    }
+    if ( !desc.load_mip || desc.resident_mips == 0 || desc.resident_mips > desc.image.mip_levels ) {
+        log_write( LogLevel::Error,
+                   "Can not create streamed image {}, it needs a loader and between 1 and {} resident mips",
+                   desc.image.name,
+                   desc.image.mip_levels );
+        return {};
+    }
+    if ( desc.image.samples != VK_SAMPLE_COUNT_1_BIT || texel_size( desc.image.format ) == 0 ||
+         desc.image.compress_channels != 0 ) {
+        log_write( LogLevel::Error,
+                   "Can not create streamed image {}, only single sampled, uncompressed colour images can be streamed",
+                   desc.image.name );
+        return {};
+    }
+
+    auto image_desc = desc.image;
+    image_desc.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if ( !validate_image_desc( image_desc ) ) { return {}; }
+
+    // The feedback entry is reserved up front, so the resident mips can be loaded without holding the lock
+    uint32_t index = 0;
+    {
+        std::scoped_lock lock( streaming_mutex_ );
+        if ( free_streaming_indices_.empty() ) {
+            log_write( LogLevel::Error,
+                       "Can not create streamed image {}, the feedback buffer is full",
+                       desc.image.name );
+            return {};
+        }
+        index = free_streaming_indices_.back();
+        free_streaming_indices_.pop_back();
+    }
+
+    const auto first_mip = image_desc.mip_levels - desc.resident_mips;
+    StreamedImage streamed{
+        .desc = image_desc,
+        .load_mip = desc.load_mip,
+        .index = index,
+        .max_first_mip = first_mip,
+        // Nothing is resident until the first backing image is created below
+        .first_resident_mip = image_desc.mip_levels,
+        .requested_mip = first_mip,
+        .last_requested_frame = frame_index_,
+        .loading = std::vector<bool>( image_desc.mip_levels, false ),
+    };
+
+    // The least detailed mips are small, so are loaded up front and the image always has a backing image
+    for ( uint32_t mip = first_mip; mip < image_desc.mip_levels; ++mip ) {
+        auto data = desc.load_mip( mip );
+        if ( data.size() != mip_size( image_desc, mip ) ) {
+            log_write( LogLevel::Error, "Failed to load mip {} of streamed image {}", mip, image_desc.name );
+            std::scoped_lock lock( streaming_mutex_ );
+            free_streaming_indices_.push_back( index );
+            return {};
+        }
+        streamed.loaded_mips.emplace( mip, std::move( data ) );
+    }
+
+    const auto handle = ImageHandle( current_resource_id_++ );
+    images_.emplace( handle, AllocatedResource<VkImage, ImageDesc>{ .desc = image_desc } );
+    update_accounts( image_desc.name, image_desc.category, 0, 1 );
+
+    // Nothing else knows of the image until it is published below, so its first backing image is created unlocked
+    auto resize = begin_streamed_resize( handle, streamed, first_mip );
+    const bool recorded = record_streamed_resize( resize );
+
+    std::scoped_lock lock( streaming_mutex_ );
+    end_streamed_resize( streamed, resize, recorded );
+    if ( !recorded ) {
+        update_accounts( image_desc.name, image_desc.category, 0, -1 );
+        images_.erase( handle );
+        free_streaming_indices_.push_back( index );
+        return {};
+    }
+    vmaFlushAllocation( allocator_, find_buffer( streaming_buffer_ )->allocation, 0, VK_WHOLE_SIZE );
+
+    streaming_statistics_.streamed_images++;
+    streamed_images_.emplace( handle, std::move( streamed ) );
+    return handle;
+}
+
+void ResourceManager::request_image_mip( ImageHandle handle, uint32_t mip ) {
+    std::scoped_lock lock( streaming_mutex_ );
+    const auto iter = streamed_images_.find( handle );
+    if ( iter == streamed_images_.end() ) {
+        log_write( LogLevel::Error, "Can not request mip {} of image {}, it is not a streamed image", mip, handle.raw );
+        return;
+    }
+    request_streamed_mip( iter->second, mip );
+}
+
+void ResourceManager::request_streamed_mip( StreamedImage& streamed, uint32_t mip ) {
+    // The most detailed request within a frame wins, requests from earlier frames are replaced
+    mip = std::min( mip, streamed.max_first_mip );
+    streamed.requested_mip =
+        streamed.last_requested_frame == frame_index_ ? std::min( streamed.requested_mip, mip ) : mip;
+    streamed.last_requested_frame = frame_index_;
+}
+
+std::optional<uint32_t> ResourceManager::resident_mip( ImageHandle handle ) const {
+    std::scoped_lock lock( streaming_mutex_ );
+    const auto iter = streamed_images_.find( handle );
+    if ( iter == streamed_images_.end() ) return std::nullopt;
+    return iter->second.first_resident_mip;
+}
+
+std::optional<uint32_t> ResourceManager::streaming_index( ImageHandle handle ) const {
+    std::scoped_lock lock( streaming_mutex_ );
+    const auto iter = streamed_images_.find( handle );
+    if ( iter == streamed_images_.end() ) return std::nullopt;
+    return iter->second.index;
+}
+
+StreamingStatistics ResourceManager::streaming_statistics() const {
+    std::scoped_lock lock( streaming_mutex_ );
+    return streaming_statistics_;
+}
+
+void ResourceManager::update_streaming() {
+    if ( !streaming_workers_ ) return;
+
+    const auto feedback_allocation = find_buffer( streaming_buffer_ )->allocation;
+    // Images with newly loaded mips to swap in, resized once the lock has been released
+    std::vector<std::pair<ImageHandle, uint32_t>> resizes;
+    {
+        std::scoped_lock lock( streaming_mutex_ );
+        vmaInvalidateAllocation( allocator_, feedback_allocation, 0, VK_WHOLE_SIZE );
+
+        // Requests written by shaders since the last update
+        for ( auto& [handle, streamed] : streamed_images_ ) {
+            auto& requested = streaming_feedback_[streamed.index * 2];
+            if ( requested == no_streaming_request ) continue;
+
+            request_streamed_mip( streamed, requested );
+            requested = no_streaming_request;
+        }
+
+        std::vector<LoadedMip> loaded;
+        {
+            std::scoped_lock loaded_lock( loaded_mips_mutex_ );
+            loaded.swap( loaded_mips_ );
+        }
+
+        for ( auto& load : loaded ) {
+            streaming_statistics_.pending_loads--;
+
+            // The image was freed while the mip was loading
+            const auto iter = streamed_images_.find( load.handle );
+            if ( iter == streamed_images_.end() ) continue;
+
+            auto& streamed = iter->second;
+            streamed.loading[load.mip] = false;
+            if ( load.data.size() != mip_size( streamed.desc, load.mip ) ) {
+                log_write( LogLevel::Error,
+                           "Failed to load mip {} of streamed image {}",
+                           load.mip,
+                           streamed.desc.name );
+                // Stops the load being retried until the mip is requested again
+                streamed.requested_mip = std::max( streamed.requested_mip, load.mip + 1 );
+                continue;
+            }
+            streamed.loaded_mips.insert_or_assign( load.mip, std::move( load.data ) );
+        }
+
+        for ( auto& [handle, streamed] : streamed_images_ ) {
+            // Mips which finished loading after the request moved to a less detailed mip are no longer needed
+            const auto unneeded = [&]( const auto& pair ) { return pair.first < streamed.requested_mip; };
+            std::erase_if( streamed.loaded_mips, unneeded );
+
+            // Only a contiguous run of mips directly above the resident ones can become resident
+            auto first_mip = streamed.first_resident_mip;
+            while ( first_mip > streamed.requested_mip && streamed.loaded_mips.contains( first_mip - 1 ) ) {
+                first_mip--;
+            }
+            if ( first_mip != streamed.first_resident_mip ) { resizes.emplace_back( handle, first_mip ); }
+        }
+    }
+
+    for ( const auto& [handle, first_mip] : resizes ) { resize_streamed_image( handle, first_mip ); }
+    evict_streamed_mips();
+
+    std::scoped_lock lock( streaming_mutex_ );
+    dispatch_mip_loads();
+    vmaFlushAllocation( allocator_, feedback_allocation, 0, VK_WHOLE_SIZE );
+}
+
+void ResourceManager::dispatch_mip_loads() {
+    for ( auto& [handle, streamed] : streamed_images_ ) {
+        // Less detailed mips first, as a mip only becomes resident once every mip below it is
+        for ( auto mip = streamed.first_resident_mip; mip-- > streamed.requested_mip; ) {
+            // Anything loaded while over budget would only be evicted again
+            if ( streaming_statistics_.pending_loads >= streaming_settings_.max_pending_loads ||
+                 streaming_statistics_.resident_bytes >= streaming_settings_.budget ) {
+                return;
+            }
+            if ( streamed.loading[mip] || streamed.loaded_mips.contains( mip ) ) continue;
+
+            streamed.loading[mip] = true;
+            streaming_statistics_.pending_loads++;
+            streaming_workers_->submit( [this, handle, mip, load_mip = streamed.load_mip]() {
+                auto data = load_mip( mip );
+
+                std::scoped_lock lock( loaded_mips_mutex_ );
+                loaded_mips_.push_back( { .handle = handle, .mip = mip, .data = std::move( data ) } );
+            } );
+        }
+    }
+}
+
+void ResourceManager::evict_streamed_mips() {
+    while ( true ) {
+        ImageHandle victim = {};
+        uint32_t first_mip = 0;
+        {
+            std::scoped_lock lock( streaming_mutex_ );
+            if ( streaming_statistics_.resident_bytes <= streaming_settings_.budget ) return;
+
+            // The least recently requested image with mips to spare, images requested this frame are in use
+            const StreamedImage* victim_image = nullptr;
+            for ( const auto& [handle, streamed] : streamed_images_ ) {
+                if ( streamed.first_resident_mip >= streamed.max_first_mip ) continue;
+                if ( streamed.last_requested_frame == frame_index_ ) continue;
+                if ( !victim_image || streamed.last_requested_frame < victim_image->last_requested_frame ) {
+                    victim = handle;
+                    victim_image = &streamed;
+                }
+            }
+            if ( !victim_image ) return;
+
+            // One mip at a time, the most detailed mip holds most of the memory of the image
+            first_mip = victim_image->first_resident_mip + 1;
+        }
+
+        if ( !resize_streamed_image( victim, first_mip ) ) return;
+
+        std::scoped_lock lock( streaming_mutex_ );
+        if ( const auto iter = streamed_images_.find( victim ); iter != streamed_images_.end() ) {
+            iter->second.requested_mip = std::max( iter->second.requested_mip, first_mip );
+        }
+    }
+}
+
+bool ResourceManager::resize_streamed_image( ImageHandle handle, uint32_t first_mip ) {
+    StreamedResize resize;
+    {
+        std::scoped_lock lock( streaming_mutex_ );
+        const auto iter = streamed_images_.find( handle );
+        if ( iter == streamed_images_.end() || iter->second.resizing ) return false;
+        resize = begin_streamed_resize( handle, iter->second, first_mip );
+    }
+
+    // The copies are waited on without the lock, so other streamed images can be created, requested and bound
+    const bool recorded = record_streamed_resize( resize );
+
+    bool free_pending = false;
+    {
+        std::scoped_lock lock( streaming_mutex_ );
+        auto& streamed = streamed_images_.at( handle );
+        end_streamed_resize( streamed, resize, recorded );
+        free_pending = std::exchange( streamed.free_pending, false );
+    }
+
+    // `free_image` was called while the copies were running, and left the image for us to free
+    if ( free_pending ) {
+        free_image( handle );
+        return false;
+    }
+    return recorded;
+}
+
+ResourceManager::StreamedResize
+ResourceManager::begin_streamed_resize( ImageHandle handle, StreamedImage& streamed, uint32_t first_mip ) {
+    const auto& image = *images_.find( handle );
+
+    StreamedResize resize{
+        .handle = handle,
+        .desc = streamed.desc,
+        .first_mip = first_mip,
+        .old_first_mip = streamed.first_resident_mip,
+        .old_resource = image.resource,
+        .old_desc = image.desc,
+        .old_layout = image.layout,
+    };
+    resize.desc.extent = mip_extent( streamed.desc.extent, first_mip );
+    resize.desc.mip_levels = streamed.desc.mip_levels - first_mip;
+
+    // Descriptors are written with the layout of their usage, so the replacement has to be left in it. Images which
+    // are not bound yet keep the layout they rest in, or `GENERAL` like other uploaded images.
+    const auto resting_layout = image.layout == VK_IMAGE_LAYOUT_UNDEFINED ? VK_IMAGE_LAYOUT_GENERAL : image.layout;
+    resize.layout = bound_image_layout( image.bound_resources, resting_layout );
+
+    for ( uint32_t mip = first_mip; mip < resize.old_first_mip; ++mip ) {
+        resize.uploads.insert( streamed.loaded_mips.extract( mip ) );
+    }
+    streamed.resizing = true;
+    return resize;
+}
+
+bool ResourceManager::record_streamed_resize( StreamedResize& resize ) {
+    const auto& desc = resize.desc;
+
+    const auto pool = get_memory_pool( desc.memory_pool, desc.name );
+    if ( !pool ) { return false; }
+
+    const auto transfer_queues = device_.find_queues( VK_QUEUE_TRANSFER_BIT );
+    if ( transfer_queues.empty() ) {
+        log_write( LogLevel::Error, "No transfer queue available to stream {}", desc.name );
+        return false;
+    }
+
+    const VmaAllocationCreateInfo alloc_info{
+        .flags = desc.memory_flags,
+        .usage = desc.memory_usage,
+        .pool = *pool,
+        .pUserData = allocation_user_data( resize.handle.raw ),
+    };
+
+    const auto image_info = image_create_info( desc );
+    VkImage resource = VK_NULL_HANDLE;
+    VmaAllocation allocation = VK_NULL_HANDLE;
+    if ( vmaCreateImage( allocator_, &image_info, &alloc_info, &resource, &allocation, nullptr ) != VK_SUCCESS ) {
+        log_write( LogLevel::Error,
+                   "Failed to create an image for mips {} onwards of {}",
+                   resize.first_mip,
+                   desc.name );
+        return false;
+    }
+
+    // Mips which were not resident before are uploaded from the loaded data
+    std::vector<std::pair<uint32_t, BufferHandle>> uploads;
+    for ( const auto& [mip, data] : resize.uploads ) {
+        const auto staging_buffer = create_buffer( {
+            .size = data.size(),
+            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+            .name = "Streaming Upload Staging Buffer",
+            .category = staging_category,
+        } );
+        if ( staging_buffer == BufferHandle{} ) {
+            log_write( LogLevel::Error, "Failed to create a staging buffer for mip {} of {}", mip, desc.name );
+            for ( const auto& upload : uploads ) { free_buffer( upload.second ); }
+            vmaDestroyImage( allocator_, resource, allocation );
+            return false;
+        }
+
+        upload_to_buffer( staging_buffer, data.data(), data.size() );
+        uploads.emplace_back( mip, staging_buffer );
+    }
+
+    auto layers = [&]( uint32_t mip ) {
+        return VkImageSubresourceLayers{ .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                         .mipLevel = mip,
+                                         .baseArrayLayer = 0,
+                                         .layerCount = desc.array_layers };
+    };
+
+    device_.immediate_submit( transfer_queues[0], [&]( VkCommandBuffer cmd ) {
+        image_layout_barrier( cmd,
+                              resource,
+                              desc,
+                              VK_IMAGE_LAYOUT_UNDEFINED,
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                              0,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT,
+                              VK_ACCESS_TRANSFER_WRITE_BIT );
+
+        // Mips resident in both images are copied across, each image numbers its mips from its most detailed one
+        std::vector<VkImageCopy> regions;
+        if ( resize.old_resource != VK_NULL_HANDLE ) {
+            const auto mip_levels = resize.first_mip + desc.mip_levels;
+            for ( auto mip = std::max( resize.first_mip, resize.old_first_mip ); mip < mip_levels; ++mip ) {
+                regions.push_back( {
+                    .srcSubresource = layers( mip - resize.old_first_mip ),
+                    .srcOffset = { 0, 0, 0 },
+                    .dstSubresource = layers( mip - resize.first_mip ),
+                    .dstOffset = { 0, 0, 0 },
+                    .extent = mip_extent( desc.extent, mip - resize.first_mip ),
+                } );
+            }
+        }
+        if ( !regions.empty() ) {
+            const auto source_layout =
+                prepare_copy_source( cmd, resize.old_resource, resize.old_desc, resize.old_layout );
+            vkCmdCopyImage( cmd,
+                            resize.old_resource,
+                            source_layout,
+                            resource,
+                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            static_cast<uint32_t>( regions.size() ),
+                            regions.data() );
+        }
+
+        for ( const auto& [mip, staging_buffer] : uploads ) {
+            const VkBufferImageCopy region{ .bufferOffset = 0,
+                                            .bufferRowLength = 0,
+                                            .bufferImageHeight = 0,
+                                            .imageSubresource = layers( mip - resize.first_mip ),
+                                            .imageOffset = { 0, 0, 0 },
+                                            .imageExtent = mip_extent( desc.extent, mip - resize.first_mip ) };
+
+            vkCmdCopyBufferToImage(
+                cmd, get_buffer( staging_buffer ), resource, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region );
+        }
+
+        image_layout_barrier( cmd,
+                              resource,
+                              desc,
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              resize.layout,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT,
+                              VK_ACCESS_TRANSFER_WRITE_BIT,
+                              VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                              VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT );
+    } );
+
+    for ( const auto& upload : uploads ) { free_buffer( upload.second ); }
+
+    resize.resource = resource;
+    resize.allocation = allocation;
+    return true;
+}
+
+void ResourceManager::end_streamed_resize( StreamedImage& streamed, StreamedResize& resize, bool recorded ) {
+    streamed.resizing = false;
+    if ( !recorded ) {
+        streamed.loaded_mips.merge( resize.uploads );
+        return;
+    }
+
+    // Swap the backing image in place, so the handle and its descriptor slots are unchanged
+    auto& image = *images_.find( resize.handle );
+    const auto old_allocation = image.allocation;
+    image.resource = resize.resource;
+    image.allocation = resize.allocation;
+    image.desc = resize.desc;
+    image.layout = resize.layout;
+    streamed.first_resident_mip = resize.first_mip;
+    recreate_image_views( resize.handle, resize.first_mip );
+    if ( resize.old_resource != VK_NULL_HANDLE ) {
+        vmaDestroyImage( allocator_, resize.old_resource, old_allocation );
+
+        if ( resize.first_mip < resize.old_first_mip ) {
+            streaming_statistics_.mips_streamed_in += resize.old_first_mip - resize.first_mip;
+        } else {
+            streaming_statistics_.mips_evicted += resize.first_mip - resize.old_first_mip;
+        }
+    }
+
+    VmaAllocationInfo allocation_info{};
+    vmaGetAllocationInfo( allocator_, resize.allocation, &allocation_info );
+    streaming_statistics_.resident_bytes = streaming_statistics_.resident_bytes - streamed.resident_bytes +
+        allocation_info.size;
+    streamed.resident_bytes = allocation_info.size;
+    update_accounts( resize.desc.name,
+                     resize.desc.category,
+                     static_cast<int64_t>( allocation_info.size ) - static_cast<int64_t>( image.accounted_bytes ),
+                     0 );
+    image.accounted_bytes = allocation_info.size;
+
+    std::erase_if( streamed.loaded_mips, [&]( const auto& pair ) { return pair.first >= resize.first_mip; } );
+    streaming_feedback_[streamed.index * 2 + 1] = resize.first_mip;
+}
+
+bool ResourceManager::validate_image_desc( const ImageDesc& desc ) const {
+    auto report_error = [&]( std::string_view error_msg ) {
+        log_write( LogLevel::Error, "Invalid image description for {}: {}", desc.name, error_msg );
+        return false;
+    };
+
+    if ( desc.array_layers == 0 || desc.mip_levels == 0 ) { return report_error( "needs at least one layer and mip" ); }
+    if ( desc.type != VK_IMAGE_TYPE_3D && desc.extent.depth != 1 ) {
+        return report_error( "only 3D images can have a depth other than 1" );
+    }
+    if ( desc.type == VK_IMAGE_TYPE_3D && desc.array_layers != 1 ) {
+        return report_error( "3D images can not be arrays" );
+    }
+
+    if ( desc.flags & VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT ) {
+        if ( desc.type != VK_IMAGE_TYPE_2D || desc.extent.width != desc.extent.height ) {
+            return report_error( "cube maps must be square 2D images" );
+        }
+        if ( desc.array_layers % 6 != 0 ) { return report_error( "cube maps need a multiple of 6 array layers" ); }
+    }
+
+    if ( desc.samples != VK_SAMPLE_COUNT_1_BIT ) {
+        if ( desc.type != VK_IMAGE_TYPE_2D || desc.mip_levels != 1 || desc.tiling != VK_IMAGE_TILING_OPTIMAL ) {
+            return report_error( "multisampled images must be optimally tiled 2D images with a single mip" );
+        }
+    }
+
+    if ( desc.compress_channels != 0 ) {
+        if ( !block_format( desc.format ) ) {
+            return report_error( "compressed images need 1 to 4 channels, and an RGBA8 or supported BC format" );
+        }
+        if ( desc.type != VK_IMAGE_TYPE_2D ) { return report_error( "only 2D images can be compressed" ); }
+    }
+    if ( is_bc_format( desc.format ) && !device_.get_physical_device_features().textureCompressionBC ) {
+        return report_error( "the device does not support BC formats (`textureCompressionBC`)" );
+    }
+
+    // Catches unsupported sample counts, layer counts & extents for this format/usage combination
+    VkImageFormatProperties properties{};
+    const auto result = vkGetPhysicalDeviceImageFormatProperties( device_.physical_device(),
+                                                                  desc.format,
+                                                                  desc.type,
+                                                                  desc.tiling,
+                                                                  desc.usage,
+                                                                  desc.flags,
+                                                                  &properties );
+    if ( result != VK_SUCCESS ) { return report_error( "format does not support this type, usage and flags" ); }
+    if ( ( properties.sampleCounts & desc.samples ) == 0 ) { return report_error( "unsupported sample count" ); }
+    if ( desc.array_layers > properties.maxArrayLayers ) { return report_error( "too many array layers" ); }
+    if ( desc.mip_levels > properties.maxMipLevels ) { return report_error( "too many mip levels" ); }
+    if ( desc.extent.width > properties.maxExtent.width || desc.extent.height > properties.maxExtent.height ||
+         desc.extent.depth > properties.maxExtent.depth ) {
+        return report_error( "extent is too large" );
+    }
+
+    return true;
+}
+
+VkImageUsageFlags ResourceManager::host_transfer_usage( const ImageDesc& desc ) const {
+    constexpr VkImageUsageFlags transfer_usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if ( !device_.host_image_copy_enabled() || ( desc.usage & transfer_usage ) == 0 ||
+         desc.samples != VK_SAMPLE_COUNT_1_BIT ) {
+        return 0;
+    }
+
+    const VkPhysicalDeviceImageFormatInfo2 format_info{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2,
+        .format = desc.format,
+        .type = desc.type,
+        .tiling = desc.tiling,
+        .usage = desc.usage | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT,
+        .flags = desc.flags,
+    };
+    VkHostImageCopyDevicePerformanceQueryEXT performance{
+        .sType = VK_STRUCTURE_TYPE_HOST_IMAGE_COPY_DEVICE_PERFORMANCE_QUERY_EXT,
+    };
+    VkImageFormatProperties2 properties{
+        .sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2,
+        .pNext = &performance,
+    };
+    if ( vkGetPhysicalDeviceImageFormatProperties2( device_.physical_device(), &format_info, &properties ) !=
+         VK_SUCCESS ) {
+        return 0;
+    }
+
+    const auto& limits = properties.imageFormatProperties;
+    if ( desc.array_layers > limits.maxArrayLayers || desc.mip_levels > limits.maxMipLevels ||
+         desc.extent.width > limits.maxExtent.width || desc.extent.height > limits.maxExtent.height ||
+         desc.extent.depth > limits.maxExtent.depth ) {
+        return 0;
+    }
+
+    // Host transfer usage can force a layout the GPU reads more slowly (e.g. uncompressed on discrete GPUs), which
+    // would cost more every frame than the staging copy saves once
+    return performance.optimalDeviceAccess ? VkImageUsageFlags{ VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT } : 0u;
+}
+
+bool ResourceManager::host_copy_to_image( const AllocatedResource<VkImage, ImageDesc>& image,
+                                          std::span<const VkMemoryToImageCopyEXT> regions ) const {
+    const VkHostImageLayoutTransitionInfoEXT transition{
+        .sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT,
+        .image = image.resource,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+        .subresourceRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                              .baseMipLevel = 0,
+                              .levelCount = image.desc.mip_levels,
+                              .baseArrayLayer = 0,
+                              .layerCount = image.desc.array_layers },
+    };
+    if ( vkTransitionImageLayoutEXT( device_.device(), 1, &transition ) != VK_SUCCESS ) {
+        log_write( LogLevel::Error, "Failed to transition {} for a host image copy", image.desc.name );
+        return false;
+    }
+
+    const VkCopyMemoryToImageInfoEXT copy_info{
+        .sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT,
+        .dstImage = image.resource,
+        .dstImageLayout = VK_IMAGE_LAYOUT_GENERAL,
+        .regionCount = static_cast<uint32_t>( regions.size() ),
+        .pRegions = regions.data(),
+    };
+    if ( vkCopyMemoryToImageEXT( device_.device(), &copy_info ) != VK_SUCCESS ) {
+        log_write( LogLevel::Error, "Failed to copy to {} from the host", image.desc.name );
+        return false;
+    }
+
+    return true;
+}
+
+ImageHandle ResourceManager::create_image( const ImageDesc& requested_desc ) {
+    const auto desc = resolve_compressed_format( requested_desc );
+    if ( !validate_image_desc( desc ) ) { return {}; }
+
+    const auto pool = get_memory_pool( desc.memory_pool, desc.name );
+    if ( !pool ) { return {}; }
+
+    const auto id = current_resource_id_++;
+    VmaAllocationCreateInfo alloc_info{
+        .flags = desc.memory_flags,
+        .usage = desc.memory_usage,
+        .pool = *pool,
+        .pUserData = allocation_user_data( id ),
+    };
+
+    AllocatedResource<VkImage, ImageDesc> image;
+    image.desc = desc;
+    image.desc.usage |= host_transfer_usage( desc );
+
+    const auto image_info = image_create_info( image.desc );
+    VmaAllocationInfo allocation_info{};
+    const auto result =
+        vmaCreateImage( allocator_, &image_info, &alloc_info, &image.resource, &image.allocation, &allocation_info );
+    if ( result != VK_SUCCESS ) { return {}; }
+    image.accounted_bytes = allocation_info.size;
+
+    return add_image( id, std::move( image ) );
+}
+
+std::vector<ImageHandle> ResourceManager::create_images( std::span<const ImageDesc> descs ) {
+    constexpr VkImageUsageFlags attachment_usages = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+    std::vector<ImageHandle> handles( descs.size() );
+    std::vector<VkImage> created( descs.size(), VK_NULL_HANDLE );
+    std::vector<ImageDesc> image_descs( descs.size() );
+    std::ranges::transform( descs, image_descs.begin(), resolve_compressed_format );
+    std::vector<BatchMember> members;
+    members.reserve( descs.size() );
+
+    std::map<std::tuple<VkImageUsageFlags, VmaMemoryUsage, VmaAllocationCreateFlags, uint32_t>, uint32_t> memory_types;
+
+    for ( size_t i = 0; i < descs.size(); ++i ) {
+        const auto& desc = image_descs[i];
+        // Attachments benefit from dedicated allocations, linear images can not share memory with optimal ones
+        // (`bufferImageGranularity`), and custom pools decide their own placement, so all take the regular path
+        if ( ( desc.usage & attachment_usages ) || desc.tiling != VK_IMAGE_TILING_OPTIMAL ||
+             desc.memory_pool != MemoryPoolHandle{} ) {
+            handles[i] = create_image( desc );
+            continue;
+        }
+
+        if ( !validate_image_desc( desc ) ) { continue; }
+
+        image_descs[i].usage |= host_transfer_usage( desc );
+
+        const auto image_info = image_create_info( image_descs[i] );
+        if ( vkCreateImage( device_.device(), &image_info, nullptr, &created[i] ) != VK_SUCCESS ) {
+            log_write( LogLevel::Error, "Failed to create image {}", desc.name );
+            continue;
+        }
+
+        BatchMember member{ .index = i, .flags = desc.memory_flags };
+        vkGetImageMemoryRequirements( device_.device(), created[i], &member.requirements );
+
+        const auto key = std::make_tuple(
+            image_info.usage, desc.memory_usage, desc.memory_flags, member.requirements.memoryTypeBits );
+        if ( const auto iter = memory_types.find( key ); iter != memory_types.end() ) {
+            member.memory_type = iter->second;
+        } else {
+            const VmaAllocationCreateInfo alloc_info{
+                .flags = desc.memory_flags,
+                .usage = desc.memory_usage,
+                .memoryTypeBits = member.requirements.memoryTypeBits,
+            };
+            if ( vmaFindMemoryTypeIndexForImageInfo( allocator_, &image_info, &alloc_info, &member.memory_type ) !=
+                 VK_SUCCESS ) {
+                log_write( LogLevel::Error, "No memory type is suitable for image {}", desc.name );
+                vkDestroyImage( device_.device(), created[i], nullptr );
+                continue;
+            }
+            memory_types.emplace( key, member.memory_type );
+        }
+
+        members.push_back( member );
+    }
+
+    allocate_batch( members );
+
+    for ( const auto& member : members ) {
+        const auto& desc = image_descs[member.index];
+        const auto image = created[member.index];
+
+        if ( member.allocation == VK_NULL_HANDLE ||
+             vmaBindImageMemory2( allocator_, member.allocation, member.offset, image, nullptr ) != VK_SUCCESS ) {
+            log_write( LogLevel::Error, "Failed to allocate memory for image {}", desc.name );
+            vkDestroyImage( device_.device(), image, nullptr );
+            if ( member.allocation != VK_NULL_HANDLE ) { release_shared_allocation( member.allocation ); }
+            continue;
+        }
+
+        AllocatedResource<VkImage, ImageDesc> resource{
+            .resource = image,
+            .allocation = member.allocation,
+            .desc = desc,
+            .allocation_offset = member.offset,
+            .accounted_bytes = member.requirements.size,
+        };
+        handles[member.index] = add_image( current_resource_id_++, std::move( resource ) );
+    }
+
+    return handles;
+}
+
+ImageHandle ResourceManager::add_image( uint32_t id, AllocatedResource<VkImage, ImageDesc> image ) {
+    if ( device_.validation_enabled() && image.desc.name ) {
+        VkDebugUtilsObjectNameInfoEXT debug_name_info{
+            .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT,
+            .objectType = VK_OBJECT_TYPE_IMAGE,
+            .objectHandle = reinterpret_cast<uint64_t>( image.resource ),
+            .pObjectName = image.desc.name,
+        };
+        vkSetDebugUtilsObjectNameEXT( device_.device(), &debug_name_info );
+    }
+
+    update_accounts( image.desc.name, image.desc.category, static_cast<int64_t>( image.accounted_bytes ), 1 );
+
+    const auto handle = ImageHandle( id );
+    images_.emplace( handle, std::move( image ) );
+    return handle;
+}
+
+void ResourceManager::destroy_image( const AllocatedResource<VkImage, ImageDesc>& image ) {
+    if ( is_shared_allocation( image.allocation ) ) {
+        vkDestroyImage( device_.device(), image.resource, nullptr );
+        release_shared_allocation( image.allocation );
+    } else {
+        vmaDestroyImage( allocator_, image.resource, image.allocation );
+    }
+}
+
+VkDeviceSize ResourceManager::upload_to_buffer( BufferHandle handle,
+                                                const void* data,
+                                                VkDeviceSize size,
+                                                VkDeviceSize offset ) {
+    if ( const auto* resource = find_buffer( handle ) ) {
+        if ( offset >= resource->desc.size ) {
+            log_write( LogLevel::Error,
+                       "Can not write to {} at offset {}, it is only {} bytes",
+                       resource->desc.name,
+                       offset,
+                       resource->desc.size );
+            return 0;
+        }
+
+        if ( ( resource->desc.memory_flags &
+               ( VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                 VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT ) ) == 0 ) {
+            log_write( LogLevel::Error,
+                       "Trying to write to {}, which was not created with "
+                       "`VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT` or "
+                       "`VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT`",
+                       resource->desc.name );
+            return 0;
+        }
+
+        const auto written_bytes = std::min( resource->desc.size - offset, size );
+
+        void* dst_pointer = nullptr;
+        vmaMapMemory( allocator_, resource->allocation, &dst_pointer );
+        std::memcpy( static_cast<uint8_t*>( dst_pointer ) + resource->allocation_offset + resource->offset + offset,
+                     data,
+                     written_bytes );
+        vmaUnmapMemory( allocator_, resource->allocation );
+
+        return written_bytes;
+    }
+    return 0;
+}
+
+VkDeviceSize ResourceManager::stage_to_buffer( BufferHandle handle,
+                                               const void* data,
+                                               VkDeviceSize size,
+                                               VkDeviceSize offset ) {
+    const auto* resource = find_buffer( handle );
+    if ( !resource ) return 0;
+
+    if ( resource->desc.memory_flags &
+         ( VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT ) ) {
+        return upload_to_buffer( handle, data, size, offset );
+    }
+
+    if ( offset >= resource->desc.size ) {
+        log_write( LogLevel::Error,
+                   "Can not write to {} at offset {}, it is only {} bytes",
+                   resource->desc.name,
+                   offset,
+                   resource->desc.size );
+        return 0;
+    }
+    return upload_through_staging( *resource, data, std::min( resource->desc.size - offset, size ), offset );
+}
+
+VkDeviceSize ResourceManager::upload_through_staging( const AllocatedResource<VkBuffer, BufferDesc>& buffer,
+                                                      const void* data,
+                                                      VkDeviceSize size,
+                                                      VkDeviceSize offset ) {
+    const auto transfer_queues = device_.find_queues( VK_QUEUE_TRANSFER_BIT );
+    if ( transfer_queues.empty() ) {
+        log_write( LogLevel::Error, "No transfer queue available to upload to {}", buffer.desc.name );
+        return 0;
+    }
+
+    const auto staging_buffer = create_buffer( {
+        .size = size,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+        .name = "Buffer Upload Staging Buffer",
+        .category = staging_category,
+    } );
+    if ( staging_buffer == BufferHandle{} ) {
+        log_write( LogLevel::Error, "Failed to create a staging buffer to upload to {}", buffer.desc.name );
+        return 0;
+    }
+
+    upload_to_buffer( staging_buffer, data, size );
+
+    device_.immediate_submit( transfer_queues[0], [&]( VkCommandBuffer cmd ) {
+        const VkBufferCopy region{ .srcOffset = 0, .dstOffset = buffer.offset + offset, .size = size };
+        vkCmdCopyBuffer( cmd, get_buffer( staging_buffer ), buffer.resource, 1, &region );
+    } );
+
+    free_buffer( staging_buffer );
+    return size;
+}
+
+VkDeviceSize ResourceManager::read_from_buffer( BufferHandle handle,
+                                                void* out_data,
+                                                VkDeviceSize bytes_to_read,
+                                                VkDeviceSize offset ) {
+    const BufferReadback read{ .buffer = handle, .out_data = out_data, .size = bytes_to_read, .offset = offset };
+    return read_from_buffers( { &read, 1 } );
+}
+
+VkDeviceSize ResourceManager::read_from_buffers( std::span<const BufferReadback> reads ) {
+    struct StagedRead {
+        const AllocatedResource<VkBuffer, BufferDesc>* buffer;
+        const BufferReadback* read;
+        VkDeviceSize size;
+        VkDeviceSize staging_offset;
+    };
+
+    std::vector<StagedRead> staged_reads;
+    VkDeviceSize staging_size = 0;
+    VkDeviceSize read_bytes = 0;
+
+    for ( const auto& read : reads ) {
+        // Copies (and staging buffers) of no bytes are invalid, and there is nothing to read anyway
+        if ( read.size == 0 ) continue;
+
+        const auto* resource = find_buffer( read.buffer );
+        if ( !resource ) continue;
+
+        if ( read.offset >= resource->desc.size ) {
+            log_write( LogLevel::Error,
+                       "Can not read from {} at offset {}, it is only {} bytes",
+                       resource->desc.name,
+                       read.offset,
+                       resource->desc.size );
+            continue;
+        }
+
+        const auto size = std::min( resource->desc.size - read.offset, read.size );
+        if ( ( resource->desc.memory_flags &
+               ( VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT |
+                 VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT ) ) == 0 ) {
+            staged_reads.push_back(
+                { .buffer = resource, .read = &read, .size = size, .staging_offset = staging_size } );
+            staging_size += size;
+            continue;
+        }
+
+        void* src_pointer = nullptr;
+        vmaMapMemory( allocator_, resource->allocation, &src_pointer );
+        std::memcpy( read.out_data,
+                     static_cast<const uint8_t*>( src_pointer ) + resource->allocation_offset + resource->offset +
+                         read.offset,
+                     size );
+        vmaUnmapMemory( allocator_, resource->allocation );
+        read_bytes += size;
+    }
+
+    if ( staged_reads.empty() ) return read_bytes;
+
+    const auto transfer_queues = device_.find_queues( VK_QUEUE_TRANSFER_BIT );
+    if ( transfer_queues.empty() ) {
+        log_write( LogLevel::Error, "No transfer queue available for buffer readback" );
+        return read_bytes;
+    }
+
+    const auto staging_buffer = create_buffer( {
+        .size = staging_size,
+        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
+        .name = "Buffer Readback Staging Buffer",
+        .category = staging_category,
+    } );
+    if ( staging_buffer == BufferHandle{} ) {
+        log_write( LogLevel::Error, "Failed to create a staging buffer for {} bytes of readback", staging_size );
+        return read_bytes;
+    }
+
+    // Sub-allocated buffers share their pool's `VkBuffer`, so their ranges are copied by a single command
+    std::map<VkBuffer, std::vector<VkBufferCopy>> copies;
+    for ( const auto& staged : staged_reads ) {
+        copies[staged.buffer->resource].push_back( {
+            .srcOffset = staged.buffer->offset + staged.read->offset,
+            .dstOffset = staged.staging_offset,
+            .size = staged.size,
+        } );
+    }
+
+    device_.immediate_submit( transfer_queues[0], [&]( VkCommandBuffer cmd ) {
+        const VkMemoryBarrier barrier{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+        };
+        vkCmdPipelineBarrier( cmd,
+                              VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT,
+                              0,
+                              1,
+                              &barrier,
+                              0,
+                              nullptr,
+                              0,
+                              nullptr );
+
+        const auto dst_buffer = get_buffer( staging_buffer );
+        for ( const auto& [src_buffer, regions] : copies ) {
+            vkCmdCopyBuffer( cmd, src_buffer, dst_buffer, static_cast<uint32_t>( regions.size() ), regions.data() );
+        }
+    } );
+
+    const auto* staging = find_buffer( staging_buffer );
+    void* mapped = nullptr;
+    vmaMapMemory( allocator_, staging->allocation, &mapped );
+    vmaInvalidateAllocation( allocator_, staging->allocation, 0, VK_WHOLE_SIZE );
+    const auto* staged_data = static_cast<const uint8_t*>( mapped ) + staging->allocation_offset + staging->offset;
+
+    for ( const auto& staged : staged_reads ) {
+        std::memcpy( staged.read->out_data, staged_data + staged.staging_offset, staged.size );
+        read_bytes += staged.size;
+    }
+
+    vmaUnmapMemory( allocator_, staging->allocation );
+    free_buffer( staging_buffer );
+    return read_bytes;
+}
+
+VkDeviceSize ResourceManager::upload_to_image( ImageHandle handle, const void* data, VkDeviceSize size ) {
+    if ( const auto* resource = find_image( handle ) ) {
+        if ( resource->desc.samples != VK_SAMPLE_COUNT_1_BIT ) {
             log_write( LogLevel::Error,
-                       "Trying to write to {}, which was not created with "
-                       "`VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT` or "
-                       "`VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT`",
+                       "Can not upload to {}, multisampled images can not be copied to",
                        resource->desc.name );
-
             return 0;
         }
 
-        const auto read_bytes = std::min( resource->desc.size, bytes_to_read );
+        if ( resource->desc.compress_channels != 0 ) { return compress_to_image( handle, *resource, data, size ); }
 
-        void* dst_pointer = nullptr;
-        vmaMapMemory( allocator_, resource->allocation, &dst_pointer );
-        std::memcpy( out_data, dst_pointer, read_bytes );
-        vmaUnmapMemory( allocator_, resource->allocation );
+        bool generate_mip_chain = resource->desc.mip_levels > 1;
+        if ( const auto error = generate_mip_chain ? mip_generation_error( *resource ) : std::nullopt ) {
+            // Every upload to the image would hit the same problem, so it is only worth warning about once
+            std::scoped_lock lock( mip_warnings_mutex_ );
+            if ( mip_warnings_.insert( *error ).second ) { log_write( LogLevel::Warn, "{}", *error ); }
+            generate_mip_chain = false;
+        }
 
-        return read_bytes;
-    }
-    return 0;
-}
+        // Only whole mips of formats with a known size are copied from the host, anything else is left to the staged
+        // copy (and its validation)
+        const auto upload_size = mip_size( resource->desc, 0 );
+        if ( ( resource->desc.usage & VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT ) && upload_size != 0 &&
+             size == upload_size ) {
+            const VkMemoryToImageCopyEXT region{
+                .sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT,
+                .pHostPointer = data,
+                .imageSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                      .mipLevel = 0,
+                                      .baseArrayLayer = 0,
+                                      .layerCount = resource->desc.array_layers },
+                .imageExtent = resource->desc.extent,
+            };
+            if ( !host_copy_to_image( *resource, { &region, 1 } ) ) { return 0; }
+            images_.find( handle )->layout = VK_IMAGE_LAYOUT_GENERAL;
+            if ( generate_mip_chain ) { generate_mips( handle ); }
+            return size;
+        }
 
-VkDeviceSize ResourceManager::upload_to_image( ImageHandle handle, const void* data, VkDeviceSize size ) {
-    if ( const auto* resource = find_image( handle ) ) {
         // Create staging buffer
         BufferHandle staging_buffer =
             create_buffer( { .size = size,
                              .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                              .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-                             .name = "Image Upload Staging Buffer" } );
+                             .name = "Image Upload Staging Buffer",
+                             .category = staging_category } );
 
         // Copy data to staging buffer
         upload_to_buffer( staging_buffer, data, size );
 
-        // Get transfer queue
-        const auto transfer_queues = device_.find_queues( VK_QUEUE_TRANSFER_BIT );
+        // Blits (for the mip chain) need a graphics queue, otherwise any transfer queue will do
+        const auto transfer_queues =
+            device_.find_queues( generate_mip_chain ? VK_QUEUE_GRAPHICS_BIT : VK_QUEUE_TRANSFER_BIT );
         if ( transfer_queues.empty() ) {
             log_write( LogLevel::Error, "No transfer queue available for image upload" );
             free_buffer( staging_buffer );
@@ -254,7 +2516,7 @@ VkDeviceSize ResourceManager::upload_to_image( ImageHandle handle, const void* d
                                                                 .baseMipLevel = 0,
                                                                 .levelCount = resource->desc.mip_levels,
                                                                 .baseArrayLayer = 0,
-                                                                .layerCount = 1 } };
+                                                                .layerCount = resource->desc.array_layers } };
 
             vkCmdPipelineBarrier( cmd,
                                   VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
@@ -274,7 +2536,7 @@ VkDeviceSize ResourceManager::upload_to_image( ImageHandle handle, const void* d
                                       .imageSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
                                                             .mipLevel = 0,
                                                             .baseArrayLayer = 0,
-                                                            .layerCount = 1 },
+                                                            .layerCount = resource->desc.array_layers },
                                       .imageOffset = { 0, 0, 0 },
                                       .imageExtent = resource->desc.extent };
 
@@ -285,6 +2547,11 @@ VkDeviceSize ResourceManager::upload_to_image( ImageHandle handle, const void* d
                                     1,
                                     &region );
 
+            if ( generate_mip_chain ) {
+                record_mip_chain( *resource, cmd, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL );
+                return;
+            }
+
             // Transition to shader read
             barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
             barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
@@ -302,6 +2569,7 @@ VkDeviceSize ResourceManager::upload_to_image( ImageHandle handle, const void* d
                                   1,
                                   &barrier );
         } );
+        images_.find( handle )->layout = VK_IMAGE_LAYOUT_GENERAL;
 
         free_buffer( staging_buffer );
         return size;
@@ -309,14 +2577,714 @@ VkDeviceSize ResourceManager::upload_to_image( ImageHandle handle, const void* d
     return 0;
 }
 
+VkDeviceSize ResourceManager::compress_to_image( ImageHandle handle,
+                                                 const AllocatedResource<VkImage, ImageDesc>& image,
+                                                 const void* data,
+                                                 VkDeviceSize size ) {
+    const auto& desc = image.desc;
+    const auto texels_size = VkDeviceSize{ 4 } * desc.extent.width * desc.extent.height * desc.array_layers;
+    if ( size != texels_size ) {
+        log_write( LogLevel::Error,
+                   "Can not upload {} bytes to {}, which is compressed from {} bytes of RGBA8 texels",
+                   size,
+                   desc.name,
+                   texels_size );
+        return 0;
+    }
+
+    // Block compressed formats can not be blitted, so the mip chain is filtered on the CPU before it is encoded
+    std::vector<VkDeviceSize> mip_offsets;
+    const auto blocks = compress_rgba8_mips( { static_cast<const uint8_t*>( data ), size },
+                                             { desc.extent.width, desc.extent.height },
+                                             desc.array_layers,
+                                             desc.mip_levels,
+                                             *block_format( desc.format ),
+                                             mip_offsets,
+                                             image_workers() );
+    if ( blocks.empty() ) { return 0; }
+
+    return upload_mips_to_image( handle, blocks.data(), blocks.size(), mip_offsets ) != 0 ? size : 0;
+}
+
+VkDeviceSize ResourceManager::import_to_image( ImageHandle handle,
+                                               const void* data,
+                                               VkDeviceSize size,
+                                               const ImageImportDesc& import ) {
+    const auto* resource = find_image( handle );
+    if ( !resource ) return 0;
+
+    const auto& desc = resource->desc;
+    const auto block = block_format( desc.format );
+    const auto pack_format = import_pack_format( desc.format );
+    if ( desc.type != VK_IMAGE_TYPE_2D || desc.samples != VK_SAMPLE_COUNT_1_BIT ||
+         ( pack_format != VK_FORMAT_R8G8B8A8_UNORM && pack_format != VK_FORMAT_R8G8B8A8_SRGB &&
+           pack_format != VK_FORMAT_R16G16B16A16_SFLOAT && pack_format != VK_FORMAT_R32G32B32A32_SFLOAT ) ) {
+        log_write( LogLevel::Error,
+                   "Can not import texels into {}, it must be a single sampled 2D image of an RGBA8, RGBA16F, RGBA32F "
+                   "or block compressed format",
+                   desc.name );
+        return 0;
+    }
+
+    const size_t layer_texels = static_cast<size_t>( desc.extent.width ) * desc.extent.height;
+    const size_t layer_size = layer_texels * pixel_size( import.layout );
+    if ( size != layer_size * desc.array_layers ) {
+        log_write( LogLevel::Error,
+                   "Can not import {} bytes into {}, which takes {} bytes of source texels",
+                   size,
+                   desc.name,
+                   layer_size * desc.array_layers );
+        return 0;
+    }
+
+    // Every layer is unpacked to linear floats, and each mip filtered from the one before
+    const PixelConverter converter( image_workers() );
+    const auto* source = static_cast<const uint8_t*>( data );
+    std::vector<std::vector<float>> layers( desc.array_layers );
+    for ( uint32_t layer = 0; layer < desc.array_layers; ++layer ) {
+        layers[layer].resize( layer_texels * 4 );
+        converter.to_rgba32f( { source + layer * layer_size, layer_size }, import.layout, import.srgb, layers[layer] );
+        if ( import.premultiply_alpha ) { converter.premultiply_alpha( layers[layer] ); }
+    }
+
+    std::vector<uint8_t> packed;
+    std::vector<VkDeviceSize> mip_offsets( desc.mip_levels );
+    for ( uint32_t mip = 0; mip < desc.mip_levels; ++mip ) {
+        const auto extent = mip_extent( desc.extent, mip );
+        mip_offsets[mip] = packed.size();
+
+        for ( auto& texels : layers ) {
+            if ( mip > 0 ) {
+                const auto previous = mip_extent( desc.extent, mip - 1 );
+                texels = converter.downsample( texels, { previous.width, previous.height }, import.mip_filter );
+            }
+
+            const auto offset = packed.size();
+            if ( !block ) {
+                packed.resize( offset + texels.size() / 4 * texel_size( pack_format ) );
+                converter.from_rgba32f( texels, pack_format, std::span( packed ).subspan( offset ) );
+                continue;
+            }
+
+            std::vector<uint8_t> rgba8( texels.size() );
+            converter.from_rgba32f( texels, pack_format, rgba8 );
+            const auto blocks = compress_rgba8( rgba8, extent.width, extent.height, *block, image_workers() );
+            packed.insert( packed.end(), blocks.begin(), blocks.end() );
+        }
+    }
+
+    return upload_mips_to_image( handle, packed.data(), packed.size(), mip_offsets ) != 0 ? size : 0;
+}
+
+ThreadPool* ResourceManager::image_workers() {
+    std::call_once( image_workers_started_,
+                    [&]() { image_workers_ = std::make_unique<ThreadPool>( std::thread::hardware_concurrency() ); } );
+    return image_workers_.get();
+}
+
+VkDeviceSize ResourceManager::upload_mips_to_image( ImageHandle handle,
+                                                    const void* data,
+                                                    VkDeviceSize size,
+                                                    std::span<const VkDeviceSize> mip_offsets ) {
+    const auto* resource = find_image( handle );
+    if ( !resource ) return 0;
+
+    if ( resource->desc.samples != VK_SAMPLE_COUNT_1_BIT || mip_offsets.empty() ||
+         mip_offsets.size() > resource->desc.mip_levels ) {
+        log_write( LogLevel::Error,
+                   "Can not upload {} mips to {}, which has {} mips",
+                   mip_offsets.size(),
+                   resource->desc.name,
+                   resource->desc.mip_levels );
+        return 0;
+    }
+
+    // Whichever path copies them, every mip has to lie entirely within `data`
+    for ( uint32_t mip = 0; mip < mip_offsets.size(); ++mip ) {
+        const auto offset = mip_offsets[mip];
+        const auto bytes = mip_size( resource->desc, mip );
+        if ( offset % 4 != 0 || bytes == 0 || offset > size || bytes > size - offset ) {
+            log_write( LogLevel::Error,
+                       "Mip {} of {} ({} bytes at offset {}) must be 4 byte aligned and within the {} bytes of data",
+                       mip,
+                       resource->desc.name,
+                       bytes,
+                       offset,
+                       size );
+            return 0;
+        }
+    }
+
+    // Straight from `data` into the image
+    if ( resource->desc.usage & VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT ) {
+        std::vector<VkMemoryToImageCopyEXT> regions;
+        for ( uint32_t mip = 0; mip < mip_offsets.size(); ++mip ) {
+            regions.push_back( {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT,
+                .pHostPointer = static_cast<const uint8_t*>( data ) + mip_offsets[mip],
+                .imageSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                      .mipLevel = mip,
+                                      .baseArrayLayer = 0,
+                                      .layerCount = resource->desc.array_layers },
+                .imageExtent = mip_extent( resource->desc.extent, mip ),
+            } );
+        }
+        if ( !host_copy_to_image( *resource, regions ) ) { return 0; }
+        images_.find( handle )->layout = VK_IMAGE_LAYOUT_GENERAL;
+        return size;
+    }
+
+    const auto transfer_queues = device_.find_queues( VK_QUEUE_TRANSFER_BIT );
+    if ( transfer_queues.empty() ) {
+        log_write( LogLevel::Error, "No transfer queue available for image upload" );
+        return 0;
+    }
+
+    // The whole chain goes through one staging buffer, so callers with a mapped file pay for a single copy
+    const auto staging_buffer = create_buffer( {
+        .size = size,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+        .name = "Image Upload Staging Buffer",
+        .category = staging_category,
+    } );
+    if ( staging_buffer == BufferHandle{} ) {
+        log_write( LogLevel::Error, "Failed to create a staging buffer to upload to {}", resource->desc.name );
+        return 0;
+    }
+
+    upload_to_buffer( staging_buffer, data, size );
+
+    std::vector<VkBufferImageCopy> regions;
+    for ( uint32_t mip = 0; mip < mip_offsets.size(); ++mip ) {
+        regions.push_back( { .bufferOffset = mip_offsets[mip],
+                             .bufferRowLength = 0,
+                             .bufferImageHeight = 0,
+                             .imageSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                                   .mipLevel = mip,
+                                                   .baseArrayLayer = 0,
+                                                   .layerCount = resource->desc.array_layers },
+                             .imageOffset = { 0, 0, 0 },
+                             .imageExtent = mip_extent( resource->desc.extent, mip ) } );
+    }
+
+    device_.immediate_submit( transfer_queues[0], [&]( VkCommandBuffer cmd ) {
+        VkImageMemoryBarrier barrier{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                                      .srcAccessMask = 0,
+                                      .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                                      .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                                      .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                      .image = resource->resource,
+                                      .subresourceRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                                            .baseMipLevel = 0,
+                                                            .levelCount = resource->desc.mip_levels,
+                                                            .baseArrayLayer = 0,
+                                                            .layerCount = resource->desc.array_layers } };
+
+        vkCmdPipelineBarrier( cmd,
+                              VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT,
+                              0,
+                              0,
+                              nullptr,
+                              0,
+                              nullptr,
+                              1,
+                              &barrier );
+
+        vkCmdCopyBufferToImage( cmd,
+                                get_buffer( staging_buffer ),
+                                resource->resource,
+                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                static_cast<uint32_t>( regions.size() ),
+                                regions.data() );
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        vkCmdPipelineBarrier( cmd,
+                              VK_PIPELINE_STAGE_TRANSFER_BIT,
+                              VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                              0,
+                              0,
+                              nullptr,
+                              0,
+                              nullptr,
+                              1,
+                              &barrier );
+    } );
+    images_.find( handle )->layout = VK_IMAGE_LAYOUT_GENERAL;
+
+    free_buffer( staging_buffer );
+    return size;
+}
+
+bool ResourceManager::validate_image_regions( const AllocatedResource<VkImage, ImageDesc>& image,
+                                              VkDeviceSize size,
+                                              std::span<const ImageRegion> regions ) const {
+    auto report_error = [&]( std::string_view error_msg ) {
+        log_write( LogLevel::Error, "Invalid image regions for {}: {}", image.desc.name, error_msg );
+        return false;
+    };
+
+    if ( format_aspect( image.desc.format ) != VK_IMAGE_ASPECT_COLOR_BIT ) {
+        return report_error( "depth and stencil images can not be copied by region" );
+    }
+    const auto texel = texel_size( image.desc.format );
+    if ( texel == 0 ) { return report_error( "the texel size of its format is not known" ); }
+    if ( image.desc.samples != VK_SAMPLE_COUNT_1_BIT ) {
+        return report_error( "multisampled images can not be copied" );
+    }
+    if ( regions.empty() ) { return report_error( "no regions were given" ); }
+
+    auto fits = []( int32_t offset, uint32_t extent, uint32_t limit ) {
+        return offset >= 0 && extent > 0 && static_cast<uint64_t>( offset ) + extent <= limit;
+    };
+
+    for ( const auto& region : regions ) {
+        if ( region.mip_level >= image.desc.mip_levels || region.layer_count == 0 ||
+             region.base_array_layer + region.layer_count > image.desc.array_layers ) {
+            return report_error( "mip level or array layers out of range" );
+        }
+        if ( image.desc.type == VK_IMAGE_TYPE_3D && ( region.base_array_layer != 0 || region.layer_count != 1 ) ) {
+            return report_error( "3D images have a single layer, depth is given by the region's extent" );
+        }
+
+        const auto mip = mip_extent( image.desc.extent, region.mip_level );
+        if ( !fits( region.offset.x, region.extent.width, mip.width ) ||
+             !fits( region.offset.y, region.extent.height, mip.height ) ||
+             !fits( region.offset.z, region.extent.depth, mip.depth ) ) {
+            return report_error( "region lies outside of the mip" );
+        }
+
+        const auto [row_length, image_height] = region_pitch( region );
+        if ( row_length < region.extent.width || image_height < region.extent.height ) {
+            return report_error( "row length or image height is smaller than the region" );
+        }
+        if ( region.data_offset % 4 != 0 || region.data_offset % texel != 0 ) {
+            return report_error( "data offsets must be multiples of 4 and of the texel size" );
+        }
+
+        // From the first texel of the region to the end of its last row
+        const auto slices = VkDeviceSize{ region.extent.depth } * region.layer_count;
+        const auto region_bytes = texel *
+            ( ( slices - 1 ) * row_length * image_height + ( region.extent.height - 1 ) * row_length +
+              region.extent.width );
+        if ( region.data_offset > size || region_bytes > size - region.data_offset ) {
+            return report_error( "region lies outside of the data" );
+        }
+    }
+
+    return true;
+}
+
+VkDeviceSize ResourceManager::upload_image_regions( ImageHandle handle,
+                                                    const void* data,
+                                                    VkDeviceSize size,
+                                                    std::span<const ImageRegion> regions ) {
+    const auto* resource = find_image( handle );
+    if ( !resource || !validate_image_regions( *resource, size, regions ) ) return 0;
+
+    if ( resource->desc.usage & VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT ) {
+        std::vector<VkMemoryToImageCopyEXT> copies;
+        for ( const auto& region : regions ) {
+            copies.push_back( {
+                .sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT,
+                .pHostPointer = static_cast<const uint8_t*>( data ) + region.data_offset,
+                .memoryRowLength = region.row_length,
+                .memoryImageHeight = region.image_height,
+                .imageSubresource = region_subresource( region ),
+                .imageOffset = region.offset,
+                .imageExtent = region.extent,
+            } );
+        }
+
+        const VkCopyMemoryToImageInfoEXT copy_info{
+            .sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT,
+            .dstImage = resource->resource,
+            .dstImageLayout = VK_IMAGE_LAYOUT_GENERAL,
+            .regionCount = static_cast<uint32_t>( copies.size() ),
+            .pRegions = copies.data(),
+        };
+        if ( vkCopyMemoryToImageEXT( device_.device(), &copy_info ) != VK_SUCCESS ) {
+            log_write( LogLevel::Error, "Failed to copy to {} from the host", resource->desc.name );
+            return 0;
+        }
+        return size;
+    }
+
+    const auto transfer_queues = device_.find_queues( VK_QUEUE_TRANSFER_BIT );
+    if ( transfer_queues.empty() ) {
+        log_write( LogLevel::Error, "No transfer queue available for image upload" );
+        return 0;
+    }
+    if ( !fits_transfer_granularity( transfer_queues[0], resource->desc, regions ) ) return 0;
+
+    const auto staging_buffer = create_buffer( {
+        .size = size,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+        .name = "Image Region Staging Buffer",
+        .category = staging_category,
+    } );
+    if ( staging_buffer == BufferHandle{} ) {
+        log_write( LogLevel::Error, "Failed to create a staging buffer to upload to {}", resource->desc.name );
+        return 0;
+    }
+
+    upload_to_buffer( staging_buffer, data, size );
+
+    std::vector<VkBufferImageCopy> copies;
+    for ( const auto& region : regions ) {
+        copies.push_back( { .bufferOffset = region.data_offset,
+                            .bufferRowLength = region.row_length,
+                            .bufferImageHeight = region.image_height,
+                            .imageSubresource = region_subresource( region ),
+                            .imageOffset = region.offset,
+                            .imageExtent = region.extent } );
+    }
+
+    device_.immediate_submit( transfer_queues[0], [&]( VkCommandBuffer cmd ) {
+        general_layout_barrier( cmd,
+                                resource->resource,
+                                resource->desc,
+                                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                VK_ACCESS_MEMORY_WRITE_BIT,
+                                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                VK_ACCESS_TRANSFER_WRITE_BIT );
+
+        // Every region in one command
+        vkCmdCopyBufferToImage( cmd,
+                                get_buffer( staging_buffer ),
+                                resource->resource,
+                                VK_IMAGE_LAYOUT_GENERAL,
+                                static_cast<uint32_t>( copies.size() ),
+                                copies.data() );
+
+        general_layout_barrier( cmd,
+                                resource->resource,
+                                resource->desc,
+                                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                VK_ACCESS_TRANSFER_WRITE_BIT,
+                                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT );
+    } );
+
+    free_buffer( staging_buffer );
+    return size;
+}
+
+VkDeviceSize ResourceManager::read_image_regions( ImageHandle handle,
+                                                  void* out_data,
+                                                  VkDeviceSize size,
+                                                  std::span<const ImageRegion> regions ) {
+    const auto* resource = find_image( handle );
+    if ( !resource || !validate_image_regions( *resource, size, regions ) ) return 0;
+
+    if ( ( resource->desc.usage & VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT ) && device_.host_image_readback_enabled() ) {
+        wait_for_image_writes( device_, resource->desc );
+
+        std::vector<VkImageToMemoryCopyEXT> copies;
+        for ( const auto& region : regions ) {
+            copies.push_back( {
+                .sType = VK_STRUCTURE_TYPE_IMAGE_TO_MEMORY_COPY_EXT,
+                .pHostPointer = static_cast<uint8_t*>( out_data ) + region.data_offset,
+                .memoryRowLength = region.row_length,
+                .memoryImageHeight = region.image_height,
+                .imageSubresource = region_subresource( region ),
+                .imageOffset = region.offset,
+                .imageExtent = region.extent,
+            } );
+        }
+
+        const VkCopyImageToMemoryInfoEXT copy_info{
+            .sType = VK_STRUCTURE_TYPE_COPY_IMAGE_TO_MEMORY_INFO_EXT,
+            .srcImage = resource->resource,
+            .srcImageLayout = VK_IMAGE_LAYOUT_GENERAL,
+            .regionCount = static_cast<uint32_t>( copies.size() ),
+            .pRegions = copies.data(),
+        };
+        if ( vkCopyImageToMemoryEXT( device_.device(), &copy_info ) != VK_SUCCESS ) {
+            log_write( LogLevel::Error, "Failed to copy from {} to the host", resource->desc.name );
+            return 0;
+        }
+        return size;
+    }
+
+    const auto transfer_queues = device_.find_queues( VK_QUEUE_TRANSFER_BIT );
+    if ( transfer_queues.empty() ) {
+        log_write( LogLevel::Error, "No transfer queue available for image download" );
+        return 0;
+    }
+    if ( !fits_transfer_granularity( transfer_queues[0], resource->desc, regions ) ) return 0;
+
+    const auto staging_buffer = create_buffer( {
+        .size = size,
+        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
+        .name = "Image Region Readback Buffer",
+        .category = staging_category,
+    } );
+    if ( staging_buffer == BufferHandle{} ) {
+        log_write( LogLevel::Error, "Failed to create a staging buffer to read from {}", resource->desc.name );
+        return 0;
+    }
+
+    std::vector<VkBufferImageCopy> copies;
+    for ( const auto& region : regions ) {
+        copies.push_back( { .bufferOffset = region.data_offset,
+                            .bufferRowLength = region.row_length,
+                            .bufferImageHeight = region.image_height,
+                            .imageSubresource = region_subresource( region ),
+                            .imageOffset = region.offset,
+                            .imageExtent = region.extent } );
+    }
+
+    device_.immediate_submit( transfer_queues[0], [&]( VkCommandBuffer cmd ) {
+        general_layout_barrier( cmd,
+                                resource->resource,
+                                resource->desc,
+                                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                VK_ACCESS_MEMORY_WRITE_BIT,
+                                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                VK_ACCESS_TRANSFER_READ_BIT );
+
+        vkCmdCopyImageToBuffer( cmd,
+                                resource->resource,
+                                VK_IMAGE_LAYOUT_GENERAL,
+                                get_buffer( staging_buffer ),
+                                static_cast<uint32_t>( copies.size() ),
+                                copies.data() );
+    } );
+
+    // Only the rows of each region are copied out, so the bytes between them are left as the caller had them
+    const auto* staging = find_buffer( staging_buffer );
+    void* mapped = nullptr;
+    vmaMapMemory( allocator_, staging->allocation, &mapped );
+    vmaInvalidateAllocation( allocator_, staging->allocation, 0, VK_WHOLE_SIZE );
+    const auto* staged = static_cast<const uint8_t*>( mapped ) + staging->allocation_offset + staging->offset;
+
+    const auto texel = texel_size( resource->desc.format );
+    for ( const auto& region : regions ) {
+        const auto [row_length, image_height] = region_pitch( region );
+        const auto slices = VkDeviceSize{ region.extent.depth } * region.layer_count;
+        for ( VkDeviceSize slice = 0; slice < slices; ++slice ) {
+            for ( VkDeviceSize row = 0; row < region.extent.height; ++row ) {
+                const auto offset = region.data_offset + texel * ( ( slice * image_height + row ) * row_length );
+                std::memcpy( static_cast<uint8_t*>( out_data ) + offset,
+                             staged + offset,
+                             texel * region.extent.width );
+            }
+        }
+    }
+
+    vmaUnmapMemory( allocator_, staging->allocation );
+    free_buffer( staging_buffer );
+    return size;
+}
+
+bool ResourceManager::generate_mips( ImageHandle handle ) {
+    const auto* resource = find_image( handle );
+    if ( !resource ) return false;
+    if ( resource->desc.mip_levels <= 1 ) return true;
+    if ( const auto error = mip_generation_error( *resource ) ) {
+        log_write( LogLevel::Warn, "{}", *error );
+        return false;
+    }
+
+    const auto graphics_queues = device_.find_queues( VK_QUEUE_GRAPHICS_BIT );
+    if ( graphics_queues.empty() ) {
+        log_write( LogLevel::Error, "No graphics queue available for mip generation" );
+        return false;
+    }
+
+    device_.immediate_submit( graphics_queues[0], [&]( VkCommandBuffer cmd ) {
+        record_mip_chain( *resource, cmd, VK_IMAGE_LAYOUT_GENERAL );
+    } );
+
+    return true;
+}
+
+std::optional<std::string>
+ResourceManager::mip_generation_error( const AllocatedResource<VkImage, ImageDesc>& image ) const {
+    if ( ( image.desc.usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT ) == 0 ) {
+        return std::format( "Can not generate mips for {}, which was not created with `{}`",
+                            image.desc.name,
+                            "VK_IMAGE_USAGE_TRANSFER_SRC_BIT" );
+    }
+
+    VkFormatProperties format_properties{};
+    vkGetPhysicalDeviceFormatProperties( device_.physical_device(), image.desc.format, &format_properties );
+    const auto features = image.desc.tiling == VK_IMAGE_TILING_LINEAR ? format_properties.linearTilingFeatures
+                                                                       : format_properties.optimalTilingFeatures;
+
+    constexpr VkFormatFeatureFlags blit_features = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+    if ( ( features & blit_features ) != blit_features ) {
+        return std::format( "Can not generate mips for {}, its format does not support blits", image.desc.name );
+    }
+
+    return std::nullopt;
+}
+
+void ResourceManager::record_mip_chain( const AllocatedResource<VkImage, ImageDesc>& image,
+                                        VkCommandBuffer cmd,
+                                        VkImageLayout base_layout ) const {
+    const auto& desc = image.desc;
+
+    // Fall back to point sampling for formats which can not be linearly filtered (e.g. integer formats)
+    VkFormatProperties format_properties{};
+    vkGetPhysicalDeviceFormatProperties( device_.physical_device(), desc.format, &format_properties );
+    const auto features = desc.tiling == VK_IMAGE_TILING_LINEAR ? format_properties.linearTilingFeatures
+                                                                 : format_properties.optimalTilingFeatures;
+    const auto filter =
+        ( features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT ) ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+
+    auto mip_extent = [&]( uint32_t mip ) {
+        return VkOffset3D{ static_cast<int32_t>( std::max( 1u, desc.extent.width >> mip ) ),
+                           static_cast<int32_t>( std::max( 1u, desc.extent.height >> mip ) ),
+                           static_cast<int32_t>( std::max( 1u, desc.extent.depth >> mip ) ) };
+    };
+
+    auto barrier = [&]( uint32_t base_mip,
+                        uint32_t mip_count,
+                        VkImageLayout old_layout,
+                        VkImageLayout new_layout,
+                        VkAccessFlags src_access,
+                        VkAccessFlags dst_access,
+                        VkPipelineStageFlags dst_stage ) {
+        const VkImageMemoryBarrier image_barrier{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                                                  .srcAccessMask = src_access,
+                                                  .dstAccessMask = dst_access,
+                                                  .oldLayout = old_layout,
+                                                  .newLayout = new_layout,
+                                                  .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                                  .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                                  .image = image.resource,
+                                                  .subresourceRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                                                        .baseMipLevel = base_mip,
+                                                                        .levelCount = mip_count,
+                                                                        .baseArrayLayer = 0,
+                                                                        .layerCount = desc.array_layers } };
+
+        vkCmdPipelineBarrier( cmd,
+                              VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                              dst_stage,
+                              0,
+                              0,
+                              nullptr,
+                              0,
+                              nullptr,
+                              1,
+                              &image_barrier );
+    };
+
+    // Level 0 becomes the first blit source, the remaining levels are overwritten so their contents can be discarded
+    barrier( 0,
+             1,
+             base_layout,
+             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+             VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+             VK_ACCESS_TRANSFER_READ_BIT,
+             VK_PIPELINE_STAGE_TRANSFER_BIT );
+    barrier( 1,
+             desc.mip_levels - 1,
+             VK_IMAGE_LAYOUT_UNDEFINED,
+             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+             0,
+             VK_ACCESS_TRANSFER_WRITE_BIT,
+             VK_PIPELINE_STAGE_TRANSFER_BIT );
+
+    for ( uint32_t mip = 1; mip < desc.mip_levels; ++mip ) {
+        const VkImageBlit blit{
+            .srcSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                .mipLevel = mip - 1,
+                                .baseArrayLayer = 0,
+                                .layerCount = desc.array_layers },
+            .srcOffsets = { { 0, 0, 0 }, mip_extent( mip - 1 ) },
+            .dstSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                .mipLevel = mip,
+                                .baseArrayLayer = 0,
+                                .layerCount = desc.array_layers },
+            .dstOffsets = { { 0, 0, 0 }, mip_extent( mip ) },
+        };
+
+        vkCmdBlitImage( cmd,
+                        image.resource,
+                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                        image.resource,
+                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                        1,
+                        &blit,
+                        filter );
+
+        // This level is the source of the next blit
+        barrier( mip,
+                 1,
+                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                 VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                 VK_ACCESS_TRANSFER_WRITE_BIT,
+                 VK_ACCESS_TRANSFER_READ_BIT,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT );
+    }
+
+    // Images rest in `GENERAL`, matching the plain upload path
+    barrier( 0,
+             desc.mip_levels,
+             VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+             VK_IMAGE_LAYOUT_GENERAL,
+             VK_ACCESS_TRANSFER_WRITE_BIT,
+             VK_ACCESS_SHADER_READ_BIT,
+             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT );
+}
+
 VkDeviceSize ResourceManager::read_from_image( ImageHandle handle, void* out_data, VkDeviceSize bytes_to_read ) {
     if ( const auto* resource = find_image( handle ) ) {
+        if ( resource->desc.samples != VK_SAMPLE_COUNT_1_BIT ) {
+            log_write( LogLevel::Error,
+                       "Can not read from {}, multisampled images must be resolved first",
+                       resource->desc.name );
+            return 0;
+        }
+
+        const auto read_size = mip_size( resource->desc, 0 );
+        if ( ( resource->desc.usage & VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT ) && device_.host_image_readback_enabled() &&
+             read_size != 0 && bytes_to_read == read_size ) {
+            wait_for_image_writes( device_, resource->desc );
+
+            const VkImageToMemoryCopyEXT region{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_TO_MEMORY_COPY_EXT,
+                .pHostPointer = out_data,
+                .imageSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                      .mipLevel = 0,
+                                      .baseArrayLayer = 0,
+                                      .layerCount = resource->desc.array_layers },
+                .imageExtent = resource->desc.extent,
+            };
+            const VkCopyImageToMemoryInfoEXT copy_info{
+                .sType = VK_STRUCTURE_TYPE_COPY_IMAGE_TO_MEMORY_INFO_EXT,
+                .srcImage = resource->resource,
+                .srcImageLayout = VK_IMAGE_LAYOUT_GENERAL,
+                .regionCount = 1,
+                .pRegions = &region,
+            };
+            if ( vkCopyImageToMemoryEXT( device_.device(), &copy_info ) != VK_SUCCESS ) {
+                log_write( LogLevel::Error, "Failed to copy from {} to the host", resource->desc.name );
+                return 0;
+            }
+            return bytes_to_read;
+        }
+
         // Create staging buffer
         BufferHandle staging_buffer = create_buffer( {
             .size = bytes_to_read,
             .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
             .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
             .name = "Image Download Staging Buffer",
+            .category = staging_category,
         } );
 
         const auto transfer_queues = device_.find_queues( VK_QUEUE_TRANSFER_BIT );
@@ -335,7 +3303,7 @@ VkDeviceSize ResourceManager::read_from_image( ImageHandle handle, void* out_dat
                 .imageSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
                                       .mipLevel = 0,
                                       .baseArrayLayer = 0,
-                                      .layerCount = 1 },
+                                      .layerCount = resource->desc.array_layers },
                 .imageOffset = { 0, 0, 0 },
                 .imageExtent = resource->desc.extent,
             };
@@ -348,8 +3316,6 @@ VkDeviceSize ResourceManager::read_from_image( ImageHandle handle, void* out_dat
                                     &region );
         } );
 
-        vkDeviceWaitIdle( device_.device() );
-
         // Read from staging buffer
         read_from_buffer( staging_buffer, out_data, bytes_to_read );
         free_buffer( staging_buffer );
@@ -370,12 +3336,10 @@ ResourceManager::find_buffer( BufferHandle handle ) const {
     if ( handle.raw == 0 ) { return report_error( "Invalid buffer handle: resource ID is 0" ); }
 
     // Validate buffer exists
-    const auto iter = buffers_.find( handle );
-    if ( iter == buffers_.end() ) {
-        return report_error( "Invalid buffer handle: buffer not found in active buffers" );
-    }
+    const auto* buffer = buffers_.find( handle );
+    if ( buffer == nullptr ) { return report_error( "Invalid buffer handle: buffer not found in active buffers" ); }
 
-    return &iter->second;
+    return buffer;
 }
 
 const ResourceManager::AllocatedResource<VkImage, ImageDesc>* ResourceManager::find_image( ImageHandle handle ) const {
@@ -388,15 +3352,30 @@ const ResourceManager::AllocatedResource<VkImage, ImageDesc>* ResourceManager::f
     if ( handle.raw == 0 ) { return report_error( "Invalid image handle: resource ID is 0" ); }
 
     // Validate image exists
-    const auto iter = images_.find( handle );
-    if ( iter == images_.end() ) { return report_error( "Invalid image handle: image not found in active images" ); }
+    const auto* image = images_.find( handle );
+    if ( image == nullptr ) { return report_error( "Invalid image handle: image not found in active images" ); }
 
-    return &iter->second;
+    return image;
 }
 
-VkImageView ResourceManager::create_view( ImageHandle handle, const ResourceUsage& usage ) const {
+VkImageView ResourceManager::create_view( ImageHandle handle,
+                                          const ResourceUsage& usage,
+                                          std::optional<uint32_t> first_resident_mip ) const {
     auto* resource = find_image( handle );
 
+    // Mip levels of a usage refer to the full chain of a streamed image, the view covers the resident part of them
+    auto base_mip_level = usage.base_mip_level;
+    auto mip_count = usage.mip_count;
+    if ( first_resident_mip ) {
+        const auto first = *first_resident_mip;
+        const auto begin = std::max( usage.base_mip_level, first );
+        base_mip_level = std::min( begin - first, resource->desc.mip_levels - 1 );
+        if ( usage.mip_count != VK_REMAINING_MIP_LEVELS ) {
+            const auto end = std::max( usage.base_mip_level + usage.mip_count, begin + 1 );
+            mip_count = std::min( end - first, resource->desc.mip_levels ) - base_mip_level;
+        }
+    }
+
     const VkImageViewCreateInfo view_info{
         .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
         .image = resource->resource,
@@ -410,8 +3389,8 @@ VkImageView ResourceManager::create_view( ImageHandle handle, const ResourceUsag
         },
         .subresourceRange = {
             .aspectMask = usage.aspect,
-            .baseMipLevel = usage.base_mip_level,
-            .levelCount = usage.mip_count,
+            .baseMipLevel = base_mip_level,
+            .levelCount = mip_count,
             .baseArrayLayer = usage.base_array_layer,
             .layerCount = usage.layer_count,
         }
@@ -446,9 +3425,30 @@ VkBuffer ResourceManager::get_buffer( BufferHandle handle ) const {
     return resource ? resource->resource : VK_NULL_HANDLE;
 }
 
+BufferRange ResourceManager::get_buffer_range( BufferHandle handle ) const {
+    const auto* resource = find_buffer( handle );
+    if ( !resource ) return {};
+
+    return { .buffer = resource->resource, .offset = resource->offset, .size = resource->desc.size };
+}
+
+VkDeviceAddress ResourceManager::get_buffer_address( BufferHandle handle ) const {
+    const auto* resource = find_buffer( handle );
+    if ( !resource ) return 0;
+
+    if ( resource->address == 0 ) {
+        log_write( LogLevel::Error,
+                   "Trying to get the address of buffer {}, but buffer device addresses are not enabled",
+                   resource->desc.name );
+        return 0;
+    }
+
+    return resource->address + resource->offset;
+}
+
 VkImage ResourceManager::get_image( ImageHandle handle ) const {
-    const auto iter = images_.find( handle );
-    return iter == images_.end() ? VK_NULL_HANDLE : iter->second.resource;
+    const auto* image = images_.find( handle );
+    return image == nullptr ? VK_NULL_HANDLE : image->resource;
 }
 
 VkImageView ResourceManager::get_image_view( const ResourceUsage& usage ) const {
@@ -457,50 +3457,153 @@ VkImageView ResourceManager::get_image_view( const ResourceUsage& usage ) const
     return img ? img->bound_resources.at( usage ).view : VK_NULL_HANDLE;
 }
 
+void ResourceManager::set_image_layout( ImageHandle handle, VkImageLayout layout ) {
+    auto* image = images_.find( handle );
+    if ( !image ) {
+        log_write( LogLevel::Error, "Can not set the layout of image {}, it does not exist", handle.raw );
+        return;
+    }
+
+    // The backing image of a streamed image is swapped (and its layout rewritten) under the streaming lock
+    std::scoped_lock lock( streaming_mutex_ );
+    image->layout = layout;
+}
+
+VkImageLayout ResourceManager::image_layout( ImageHandle handle ) const {
+    const auto* image = images_.find( handle );
+    if ( !image ) return VK_IMAGE_LAYOUT_UNDEFINED;
+
+    std::scoped_lock lock( streaming_mutex_ );
+    return image->layout;
+}
+
 void ResourceManager::free_buffer( BufferHandle handle ) {
-    const auto iter = buffers_.find( handle );
-    assert( iter != buffers_.end() );
-    if ( iter != buffers_.end() ) {
-        vmaDestroyBuffer( allocator_, iter->second.resource, iter->second.allocation );
+    const auto* buffer = buffers_.find( handle );
+    assert( buffer != nullptr );
+    if ( buffer == nullptr ) return;
+
+    // Shared buffers are only destroyed along with their last reference
+    if ( release_shared( handle ) ) return;
+
+    // Sub-allocations only return their range to the pool, the descriptor slot(s) they use belong to the pool.
+    if ( buffer->sub_allocation != VK_NULL_HANDLE ) {
+        {
+            std::scoped_lock lock( allocation_mutex_ );
+            vmaVirtualFree( buffer_pools_.at( buffer->desc.parent ), buffer->sub_allocation );
+        }
+        update_accounts( buffer->desc.name, buffer->desc.category, 0, -1 );
+        buffers_.erase( handle );
+        return;
+    }
 
-        for ( const auto& bound_resource : iter->second.bound_resources ) {
-            storage_buffer_allocator_.free_slot( bound_resource.second.slot );
+    // Freeing a pool frees every buffer which was sub-allocated from it.
+    VmaVirtualBlock pool = VK_NULL_HANDLE;
+    {
+        std::scoped_lock lock( allocation_mutex_ );
+        if ( const auto pool_iter = buffer_pools_.find( handle ); pool_iter != buffer_pools_.end() ) {
+            pool = pool_iter->second;
+            buffer_pools_.erase( pool_iter );
         }
+    }
+    if ( pool != VK_NULL_HANDLE ) {
+        buffers_.erase_if( [&]( BufferHandle, const auto& child ) {
+            if ( child.desc.parent != handle ) { return false; }
+            update_accounts( child.desc.name, child.desc.category, 0, -1 );
+            return true;
+        } );
+        vmaClearVirtualBlock( pool );
+        vmaDestroyVirtualBlock( pool );
+    }
+
+    destroy_buffer( *buffer );
 
-        buffers_.erase( iter );
+    for ( const auto& bound_resource : buffer->bound_resources ) {
+        storage_buffer_allocator_.free_slot( bound_resource.second.slot );
     }
+
+    update_accounts( buffer->desc.name, buffer->desc.category, -static_cast<int64_t>( buffer->accounted_bytes ), -1 );
+    buffers_.erase( handle );
 }
 
 void ResourceManager::free_image( ImageHandle handle ) {
-    const auto iter = images_.find( handle );
-    assert( iter != images_.end() );
-    if ( iter != images_.end() ) {
-        std::ranges::for_each( iter->second.bound_resources, [&]( const auto& bound_resource ) {
-            vkDestroyImageView( device_.device(), bound_resource.second.view, nullptr );
-        } );
-        vmaDestroyImage( allocator_, iter->second.resource, iter->second.allocation );
-
-        for ( const auto& bound_resource : iter->second.bound_resources ) {
-            storage_buffer_allocator_.free_slot( bound_resource.second.slot );
+    const auto* image = images_.find( handle );
+    assert( image != nullptr );
+    if ( image == nullptr ) return;
+
+    if ( release_shared( handle ) ) return;
+
+    // Streamed images stay locked until they are gone, so `update_streaming` can not swap their backing image meanwhile
+    std::unique_lock streaming_lock( streaming_mutex_ );
+    if ( const auto streamed_iter = streamed_images_.find( handle ); streamed_iter != streamed_images_.end() ) {
+        // Its backing image is being copied from, `resize_streamed_image` frees it once the copy has completed
+        if ( streamed_iter->second.resizing ) {
+            streamed_iter->second.free_pending = true;
+            return;
         }
 
-        images_.erase( iter );
+        const auto index = streamed_iter->second.index;
+        streaming_feedback_[index * 2] = no_streaming_request;
+        free_streaming_indices_.push_back( index );
+
+        streaming_statistics_.resident_bytes -= streamed_iter->second.resident_bytes;
+        streaming_statistics_.streamed_images--;
+        // Loads still in flight are dropped as they complete
+        streamed_images_.erase( streamed_iter );
+    } else {
+        streaming_lock.unlock();
+    }
+
+    std::ranges::for_each( image->bound_resources, [&]( const auto& bound_resource ) {
+        vkDestroyImageView( device_.device(), bound_resource.second.view, nullptr );
+    } );
+    destroy_image( *image );
+
+    for ( const auto& [usage, bound] : image->bound_resources ) {
+        if ( auto* slot_allocator = get_image_slot_allocator( usage ) ) { slot_allocator->free_slot( bound.slot ); }
     }
+
+    update_accounts( image->desc.name, image->desc.category, -static_cast<int64_t>( image->accounted_bytes ), -1 );
+    images_.erase( handle );
 }
+
 std::optional<uint64_t> ResourceManager::bind_buffer( BufferHandle handle, const ResourceUsage& usage ) {
     auto* resource = const_cast<AllocatedResource<VkBuffer, BufferDesc>*>( find_buffer( handle ) );
     if ( !resource ) return std::nullopt;
 
+    // Several holders of a shared buffer, or sub-allocations of the same pool, may bind it from different threads
+    std::unique_lock bindings_lock( bindings_mutex_ );
+
     // Check if we already have a valid binding
     if ( const auto binding_it = resource->bound_resources.find( usage );
          binding_it != resource->bound_resources.end() ) {
         const auto& bound_resource = binding_it->second;
         // Validate the slot is still valid
         if ( storage_buffer_allocator_.validate_slot( bound_resource.slot, bound_resource.version ) ) {
-            return handle.raw >> 32 | bound_resource.slot;
+            return handle.raw << 32 | bound_resource.slot;
         }
     }
 
+    // Sub-allocations share the descriptor of their pool, shaders apply the offset from the `GpuBufferHandle`.
+    if ( resource->sub_allocation != VK_NULL_HANDLE ) {
+        auto pool_usage = usage;
+        pool_usage.resource = resource->desc.parent;
+
+        // Binding the pool takes the lock itself
+        bindings_lock.unlock();
+        const auto pool_slot = bind_buffer( resource->desc.parent, pool_usage );
+        if ( !pool_slot ) return std::nullopt;
+        bindings_lock.lock();
+
+        const auto slot = static_cast<uint32_t>( *pool_slot & 0xFFFFFFFF );
+        resource->bound_resources[usage] = {
+            .view = VK_NULL_HANDLE,
+            .slot = slot,
+            .version = storage_buffer_allocator_.get_slot_version( slot ),
+        };
+
+        return handle.raw << 32 | slot;
+    }
+
     // Create a new descriptor binding
     VkDescriptorBufferInfo buffer_info{ .buffer = resource->resource, .offset = 0, .range = resource->desc.size };
 
@@ -517,26 +3620,99 @@ std::optional<uint64_t> ResourceManager::bind_buffer( BufferHandle handle, const
     return handle.raw << 32 | slot_version->first;
 }
 
+ResourceManager::DescriptorSlotAllocator* ResourceManager::get_image_slot_allocator( const ResourceUsage& usage ) {
+    if ( usage.access & VK_ACCESS_2_SHADER_SAMPLED_READ_BIT_KHR ) { return &sampled_image_allocator_; }
+    if ( usage.access & ( VK_ACCESS_2_SHADER_STORAGE_READ_BIT_KHR | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT_KHR ) ) {
+        return &storage_image_allocator_;
+    }
+    return nullptr;
+}
+
+SamplerHandle ResourceManager::create_sampler( const SamplerDesc& desc ) {
+    // Held throughout, so concurrent requests for the same description share one sampler
+    std::scoped_lock lock( allocation_mutex_ );
+    if ( const auto iter = samplers_.find( desc ); iter != samplers_.end() ) { return iter->second.second; }
+
+    const auto& features = device_.get_physical_device_features();
+    const auto max_anisotropy =
+        std::min( desc.max_anisotropy, device_.get_physical_device_limits().maxSamplerAnisotropy );
+
+    const VkSamplerCreateInfo sampler_info{
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter = desc.mag_filter,
+        .minFilter = desc.min_filter,
+        .mipmapMode = desc.mipmap_mode,
+        .addressModeU = desc.address_mode_u,
+        .addressModeV = desc.address_mode_v,
+        .addressModeW = desc.address_mode_w,
+        .mipLodBias = desc.mip_lod_bias,
+        .anisotropyEnable = features.samplerAnisotropy && max_anisotropy > 1.0f,
+        .maxAnisotropy = max_anisotropy,
+        .compareEnable = desc.compare_op != VK_COMPARE_OP_NEVER,
+        .compareOp = desc.compare_op,
+        .minLod = desc.min_lod,
+        .maxLod = desc.max_lod,
+        .borderColor = desc.border_color,
+        .unnormalizedCoordinates = VK_FALSE,
+    };
+
+    VkSampler sampler = VK_NULL_HANDLE;
+    if ( vkCreateSampler( device_.device(), &sampler_info, nullptr, &sampler ) != VK_SUCCESS ) {
+        log_write( LogLevel::Error, "Failed to create sampler" );
+        return {};
+    }
+
+    const auto slot_version = sampler_allocator_.allocate_slot( VkDescriptorImageInfo{ .sampler = sampler } );
+    if ( !slot_version ) {
+        log_write( LogLevel::Error, "No sampler slots left in the bindless sampler heap" );
+        vkDestroySampler( device_.device(), sampler, nullptr );
+        return {};
+    }
+
+    const auto handle = SamplerHandle{ static_cast<uint64_t>( current_resource_id_++ ) << 32 | slot_version->first };
+    samplers_.emplace( desc, std::make_pair( sampler, handle ) );
+    return handle;
+}
+
 std::optional<uint64_t> ResourceManager::bind_image( ImageHandle handle, const ResourceUsage& usage ) {
     auto* resource = const_cast<AllocatedResource<VkImage, ImageDesc>*>( find_image( handle ) );
     if ( !resource ) return std::nullopt;
 
+    // Streamed images stay locked while bound, so `update_streaming` can not swap their backing image meanwhile
+    std::unique_lock streaming_lock( streaming_mutex_ );
+    std::optional<uint32_t> first_resident_mip;
+    if ( const auto iter = streamed_images_.find( handle ); iter != streamed_images_.end() ) {
+        first_resident_mip = iter->second.first_resident_mip;
+    } else {
+        streaming_lock.unlock();
+    }
+
+    // Several holders of a shared image may bind it from different threads
+    std::scoped_lock bindings_lock( bindings_mutex_ );
+    auto* slot_allocator = get_image_slot_allocator( usage );
+
     // Check if we already have a valid binding
     if ( const auto view_it = resource->bound_resources.find( usage ); view_it != resource->bound_resources.end() ) {
         const auto& bound_view = view_it->second;
         // Ensure the slot is still valid
-        assert( storage_image_allocator_.validate_slot( bound_view.slot, bound_view.version ) );
-        return handle.raw >> 32 | bound_view.slot;
+        assert( !slot_allocator || slot_allocator->validate_slot( bound_view.slot, bound_view.version ) );
+        return handle.raw << 32 | bound_view.slot;
     }
 
     // Create or reuse view
-    const auto view = create_view( handle, usage );
+    const auto view = create_view( handle, usage, first_resident_mip );
     if ( view == VK_NULL_HANDLE ) return std::nullopt;
 
+    // Attachments & transfers only need the view, they are never accessed through the bindless heaps
+    if ( !slot_allocator ) {
+        resource->bound_resources[usage] = { .view = view, .slot = no_descriptor_slot, .version = 0 };
+        return handle.raw << 32 | no_descriptor_slot;
+    }
+
     // Bind to descriptor
     VkDescriptorImageInfo image_info{ .imageView = view, .imageLayout = usage.layout };
 
-    auto slot_version = storage_image_allocator_.allocate_slot( image_info );
+    auto slot_version = slot_allocator->allocate_slot( image_info );
     if ( slot_version == std::nullopt ) {
         vkDestroyImageView( device_.device(), view, nullptr );
         return std::nullopt;
@@ -563,9 +3739,91 @@ std::optional<uint64_t> ResourceManager::bind_resource( ResourceUsage usage ) {
         usage.resource );
 }
 
+bool ResourceManager::create_descriptor_buffer( VkDescriptorSetLayout layout ) {
+    assert( device_.descriptor_buffer_enabled() && descriptor_heap_.buffer == VK_NULL_HANDLE );
+
+    VkPhysicalDeviceDescriptorBufferPropertiesEXT descriptor_props{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT,
+    };
+    VkPhysicalDeviceProperties2 props{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &descriptor_props,
+    };
+    vkGetPhysicalDeviceProperties2( device_.physical_device(), &props );
+
+    VkDeviceSize layout_size = 0;
+    vkGetDescriptorSetLayoutSizeEXT( device_.device(), layout, &layout_size );
+
+    // The samplers share the buffer with every other descriptor, so the whole layout must be within the sampler range
+    const auto max_range =
+        std::min( descriptor_props.maxSamplerDescriptorBufferRange, descriptor_props.maxResourceDescriptorBufferRange );
+    if ( layout_size == 0 || layout_size > max_range ) {
+        log_write( LogLevel::Warn,
+                   "Bindless descriptor buffer of {} bytes exceeds the device limit of {} bytes",
+                   layout_size,
+                   max_range );
+        return false;
+    }
+
+    const VkBufferCreateInfo buffer_info{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = layout_size,
+        .usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT |
+            VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+    };
+    const VmaAllocationCreateInfo alloc_info{
+        .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_AUTO,
+    };
+
+    VmaAllocationInfo allocation_info{};
+    const auto result = vmaCreateBuffer( allocator_,
+                                         &buffer_info,
+                                         &alloc_info,
+                                         &descriptor_heap_.buffer,
+                                         &descriptor_heap_.allocation,
+                                         &allocation_info );
+    if ( result != VK_SUCCESS ) {
+        log_write( LogLevel::Warn, "Failed to create the bindless descriptor buffer, error: {}", result );
+        return false;
+    }
+    vmaSetAllocationName( allocator_, descriptor_heap_.allocation, "bindless descriptor buffer" );
+
+    const VkBufferDeviceAddressInfo address_info{
+        .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+        .buffer = descriptor_heap_.buffer,
+    };
+    descriptor_heap_.address = vkGetBufferDeviceAddress( device_.device(), &address_info );
+    descriptor_heap_.usage = buffer_info.usage;
+
+    auto* mapped = static_cast<uint8_t*>( allocation_info.pMappedData );
+    auto binding_data = [&]( VkDescriptorType type ) {
+        VkDeviceSize offset = 0;
+        vkGetDescriptorSetLayoutBindingOffsetEXT( device_.device(), layout, get_binding_slot( type ), &offset );
+        return mapped + offset;
+    };
+
+    storage_buffer_allocator_.set_descriptor_buffer( binding_data( VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ),
+                                                     descriptor_props.storageBufferDescriptorSize );
+    storage_image_allocator_.set_descriptor_buffer( binding_data( VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ),
+                                                    descriptor_props.storageImageDescriptorSize );
+    sampled_image_allocator_.set_descriptor_buffer( binding_data( VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ),
+                                                    descriptor_props.sampledImageDescriptorSize );
+    sampler_allocator_.set_descriptor_buffer( binding_data( VK_DESCRIPTOR_TYPE_SAMPLER ),
+                                              descriptor_props.samplerDescriptorSize );
+    return true;
+}
+
 void ResourceManager::bind_descriptors( VkDescriptorSet descriptor_set ) {
     storage_buffer_allocator_.bind_slots( device_.device(), descriptor_set );
     storage_image_allocator_.bind_slots( device_.device(), descriptor_set );
+    sampled_image_allocator_.bind_slots( device_.device(), descriptor_set );
+    sampler_allocator_.bind_slots( device_.device(), descriptor_set );
+
+    // No-op for host coherent memory
+    if ( descriptor_heap_.allocation != VK_NULL_HANDLE ) {
+        vmaFlushAllocation( allocator_, descriptor_heap_.allocation, 0, VK_WHOLE_SIZE );
+    }
 }
 
 }// namespace aloe
\ No newline at end of file
@@ -75,11 +75,11 @@ VkResult Swapchain::present( VkQueue queue, VkSemaphore wait_semaphore ) {
         .pImageIndices = &current_image_index_,
     };
 
-    return vkQueuePresentKHR( queue, &present_info );
+    return device_.present( queue, present_info );
 }
 
 void Swapchain::resize() {
-    vkDeviceWaitIdle( device_.device() );
+    device_.wait_idle();
     error_state_ = true;
 
     // They will have changed, when we receive this callback
@@ -138,7 +138,7 @@ VkResult Swapchain::load_surface_capabilities() {
 }
 
 VkResult Swapchain::build_swapchain() {
-    vkDeviceWaitIdle( device_.device() );
+    device_.wait_idle();
 
     auto old_swapchain = swapchain_;
 
@@ -32,6 +32,7 @@ void TaskGraph::validate_task( CommandList& cmd, const TaskDesc& task_desc ) con
 }
 
 TaskGraph::~TaskGraph() {
+    if ( fence_ != VK_NULL_HANDLE ) { vkDestroyFence( device_.device(), fence_, nullptr ); }
     if ( command_pool_ != VK_NULL_HANDLE ) { vkDestroyCommandPool( device_.device(), command_pool_, nullptr ); }
 }
 
@@ -47,6 +48,11 @@ void TaskGraph::clear() {
         vkDestroyCommandPool( device_.device(), command_pool_, nullptr );
         command_pool_ = VK_NULL_HANDLE;
     }
+
+    if ( fence_ != VK_NULL_HANDLE ) {
+        vkDestroyFence( device_.device(), fence_, nullptr );
+        fence_ = VK_NULL_HANDLE;
+    }
 }
 
 void TaskGraph::compile() {
@@ -102,6 +108,9 @@ void TaskGraph::compile() {
     };
 
     vkAllocateCommandBuffers( device_.device(), &alloc_info, &command_buffer_ );
+
+    const VkFenceCreateInfo fence_info{ .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+    vkCreateFence( device_.device(), &fence_info, nullptr, &fence_ );
 }
 
 void TaskGraph::execute() {
@@ -115,6 +124,9 @@ void TaskGraph::execute() {
     state_.delta_time = state_.time_since_epoch != 0us ? micros_since_epoch - state_.time_since_epoch : 0us;
     state_.time_since_epoch = micros_since_epoch;
 
+    // The previous frame has finished on the GPU, so pipelines recompiled in the background can be swapped in
+    pipeline_manager_.process_pending_compiles();
+
     VkCommandBufferBeginInfo begin_info{
         .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
         .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
@@ -133,6 +145,9 @@ void TaskGraph::execute() {
         }
     }
 
+    // Resources bound while recording (e.g. linear allocator frame slots) need their descriptors written before submit
+    pipeline_manager_.bind_slots();
+
     // Submit the command buffer
     {
         vkEndCommandBuffer( command_buffer_ );
@@ -143,9 +158,14 @@ void TaskGraph::execute() {
             .pCommandBuffers = &command_buffer_,
         };
 
-        vkQueueSubmit( queue_.queue, 1, &submit_info, VK_NULL_HANDLE );
-        vkQueueWaitIdle( queue_.queue );
+        // Only the submit holds the queue lock; waiting on our own fence lets other threads keep submitting
+        device_.submit( queue_, submit_info, fence_ );
+        vkWaitForFences( device_.device(), 1, &fence_, VK_TRUE, UINT64_MAX );
+        vkResetFences( device_.device(), 1, &fence_ );
     }
+
+    // The frame has retired, so transient allocations made for it can be recycled
+    resource_manager_.next_frame();
 }
 
 }// namespace aloe
\ No newline at end of file
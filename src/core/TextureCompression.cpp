@@ -0,0 +1,627 @@
+#include <aloe/core/TextureCompression.h>
+#include <aloe/util/log.h>
+#include <aloe/util/thread_pool.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <future>
+
+namespace aloe {
+
+// The texels of a 4x4 block, one channel after another so that 4 (or 8) texels of a channel fill an SSE (or AVX)
+// register.
+struct BlockTexels {
+    alignas( 32 ) int32_t channels[4][16] = {};
+};
+
+// The colours a block can decode to, laid out like `BlockTexels`.
+struct Palette {
+    int32_t channels[4][16] = {};
+    uint32_t size = 0;
+};
+
+// Appends fields to a zeroed block least significant bit first, the layout every BCn format uses.
+struct BitWriter {
+    uint8_t* out = nullptr;
+    uint32_t bit = 0;
+
+    void write( uint32_t value, uint32_t bits ) {
+        for ( uint32_t i = 0; i < bits; ++i, ++bit ) {
+            if ( ( value >> i ) & 1 ) { out[bit / 8] |= static_cast<uint8_t>( 1u << ( bit % 8 ) ); }
+        }
+    }
+};
+
+static uint32_t block_bytes( BlockFormat format ) {
+    return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Index selection, where encoding spends most of its time. Every texel picks the palette entry closest to it, the SIMD
+// variants compare 4 or 8 texels at once and break ties the same way as the scalar one, so all produce identical
+// blocks.
+
+static uint32_t fit_indices_scalar( const BlockTexels& block, const Palette& palette, uint8_t* indices ) {
+    uint32_t total_error = 0;
+    for ( uint32_t i = 0; i < 16; ++i ) {
+        uint32_t best_error = UINT32_MAX;
+        for ( uint32_t k = 0; k < palette.size; ++k ) {
+            uint32_t error = 0;
+            for ( uint32_t c = 0; c < 4; ++c ) {
+                const int32_t difference = block.channels[c][i] - palette.channels[c][k];
+                error += static_cast<uint32_t>( difference * difference );
+            }
+            if ( error < best_error ) {
+                best_error = error;
+                indices[i] = static_cast<uint8_t>( k );
+            }
+        }
+        total_error += best_error;
+    }
+    return total_error;
+}
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+__attribute__( ( target( "sse4.1" ) ) ) static uint32_t fit_indices_sse41( const BlockTexels& block,
+                                                                           const Palette& palette,
+                                                                           uint8_t* indices ) {
+    __m128i total_error = _mm_setzero_si128();
+    for ( uint32_t i = 0; i < 16; i += 4 ) {
+        __m128i texels[4];
+        for ( uint32_t c = 0; c < 4; ++c ) {
+            texels[c] = _mm_load_si128( reinterpret_cast<const __m128i*>( &block.channels[c][i] ) );
+        }
+
+        __m128i best_error = _mm_set1_epi32( INT_MAX );
+        __m128i best_index = _mm_setzero_si128();
+        for ( uint32_t k = 0; k < palette.size; ++k ) {
+            __m128i error = _mm_setzero_si128();
+            for ( uint32_t c = 0; c < 4; ++c ) {
+                const __m128i difference = _mm_sub_epi32( texels[c], _mm_set1_epi32( palette.channels[c][k] ) );
+                error = _mm_add_epi32( error, _mm_mullo_epi32( difference, difference ) );
+            }
+            const __m128i closer = _mm_cmplt_epi32( error, best_error );
+            best_error = _mm_min_epi32( error, best_error );
+            best_index = _mm_blendv_epi8( best_index, _mm_set1_epi32( static_cast<int32_t>( k ) ), closer );
+        }
+        total_error = _mm_add_epi32( total_error, best_error );
+
+        alignas( 16 ) int32_t lanes[4];
+        _mm_store_si128( reinterpret_cast<__m128i*>( lanes ), best_index );
+        for ( uint32_t lane = 0; lane < 4; ++lane ) { indices[i + lane] = static_cast<uint8_t>( lanes[lane] ); }
+    }
+
+    total_error = _mm_add_epi32( total_error, _mm_shuffle_epi32( total_error, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    total_error = _mm_add_epi32( total_error, _mm_shuffle_epi32( total_error, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+    return static_cast<uint32_t>( _mm_cvtsi128_si32( total_error ) );
+}
+
+__attribute__( ( target( "avx2" ) ) ) static uint32_t fit_indices_avx2( const BlockTexels& block,
+                                                                        const Palette& palette,
+                                                                        uint8_t* indices ) {
+    __m256i total_error = _mm256_setzero_si256();
+    for ( uint32_t i = 0; i < 16; i += 8 ) {
+        __m256i texels[4];
+        for ( uint32_t c = 0; c < 4; ++c ) {
+            texels[c] = _mm256_load_si256( reinterpret_cast<const __m256i*>( &block.channels[c][i] ) );
+        }
+
+        __m256i best_error = _mm256_set1_epi32( INT_MAX );
+        __m256i best_index = _mm256_setzero_si256();
+        for ( uint32_t k = 0; k < palette.size; ++k ) {
+            __m256i error = _mm256_setzero_si256();
+            for ( uint32_t c = 0; c < 4; ++c ) {
+                const __m256i difference = _mm256_sub_epi32( texels[c], _mm256_set1_epi32( palette.channels[c][k] ) );
+                error = _mm256_add_epi32( error, _mm256_mullo_epi32( difference, difference ) );
+            }
+            const __m256i closer = _mm256_cmpgt_epi32( best_error, error );
+            best_error = _mm256_min_epi32( error, best_error );
+            best_index = _mm256_blendv_epi8( best_index, _mm256_set1_epi32( static_cast<int32_t>( k ) ), closer );
+        }
+        total_error = _mm256_add_epi32( total_error, best_error );
+
+        alignas( 32 ) int32_t lanes[8];
+        _mm256_store_si256( reinterpret_cast<__m256i*>( lanes ), best_index );
+        for ( uint32_t lane = 0; lane < 8; ++lane ) { indices[i + lane] = static_cast<uint8_t>( lanes[lane] ); }
+    }
+
+    __m128i sum = _mm_add_epi32( _mm256_castsi256_si128( total_error ), _mm256_extracti128_si256( total_error, 1 ) );
+    sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+    sum = _mm_add_epi32( sum, _mm_shuffle_epi32( sum, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+    return static_cast<uint32_t>( _mm_cvtsi128_si32( sum ) );
+}
+#endif
+
+using FitIndicesFn = uint32_t ( * )( const BlockTexels&, const Palette&, uint8_t* );
+
+static FitIndicesFn select_fit_indices() {
+#if defined( __x86_64__ ) || defined( __i386__ )
+    if ( __builtin_cpu_supports( "avx2" ) ) { return fit_indices_avx2; }
+    if ( __builtin_cpu_supports( "sse4.1" ) ) { return fit_indices_sse41; }
+#endif
+    return fit_indices_scalar;
+}
+
+// Picks the closest palette entry for every texel, returning the summed squared error of the block
+static uint32_t fit_indices( const BlockTexels& block, const Palette& palette, uint8_t* indices ) {
+    // Chosen once, from the instruction sets of the CPU we are running on
+    static const FitIndicesFn fit = select_fit_indices();
+    return fit( block, palette, indices );
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Endpoint selection
+
+// The extremes of the texels along the axis they vary most on (found by power iteration on their covariance), only
+// the first `channels` channels are considered.
+static void principal_endpoints( const BlockTexels& block, uint32_t channels, float ( &lo )[4], float ( &hi )[4] ) {
+    float mean[4] = {};
+    float axis[4] = {};
+    for ( uint32_t c = 0; c < channels; ++c ) {
+        const auto [min, max] = std::minmax_element( block.channels[c], block.channels[c] + 16 );
+        for ( uint32_t i = 0; i < 16; ++i ) { mean[c] += static_cast<float>( block.channels[c][i] ) / 16.0f; }
+        axis[c] = static_cast<float>( *max - *min );
+    }
+
+    float covariance[4][4] = {};
+    for ( uint32_t i = 0; i < 16; ++i ) {
+        for ( uint32_t a = 0; a < channels; ++a ) {
+            for ( uint32_t b = 0; b < channels; ++b ) {
+                covariance[a][b] += ( static_cast<float>( block.channels[a][i] ) - mean[a] ) *
+                    ( static_cast<float>( block.channels[b][i] ) - mean[b] );
+            }
+        }
+    }
+
+    // Seeded with the diagonal of the bounding box, which is usually close already
+    for ( uint32_t iteration = 0; iteration < 8; ++iteration ) {
+        float next[4] = {};
+        float length = 0.0f;
+        for ( uint32_t a = 0; a < channels; ++a ) {
+            for ( uint32_t b = 0; b < channels; ++b ) { next[a] += covariance[a][b] * axis[b]; }
+            length = std::max( length, std::abs( next[a] ) );
+        }
+        if ( length == 0.0f ) { break; }
+        for ( uint32_t c = 0; c < channels; ++c ) { axis[c] = next[c] / length; }
+    }
+
+    float length_squared = 0.0f;
+    for ( uint32_t c = 0; c < channels; ++c ) { length_squared += axis[c] * axis[c]; }
+
+    float min_projection = 0.0f;
+    float max_projection = 0.0f;
+    if ( length_squared > 0.0f ) {
+        min_projection = FLT_MAX;
+        max_projection = -FLT_MAX;
+        for ( uint32_t i = 0; i < 16; ++i ) {
+            float projection = 0.0f;
+            for ( uint32_t c = 0; c < channels; ++c ) {
+                projection += ( static_cast<float>( block.channels[c][i] ) - mean[c] ) * axis[c];
+            }
+            min_projection = std::min( min_projection, projection / length_squared );
+            max_projection = std::max( max_projection, projection / length_squared );
+        }
+    }
+
+    for ( uint32_t c = 0; c < 4; ++c ) {
+        lo[c] = std::clamp( mean[c] + axis[c] * min_projection, 0.0f, 255.0f );
+        hi[c] = std::clamp( mean[c] + axis[c] * max_projection, 0.0f, 255.0f );
+    }
+}
+
+// The endpoints which minimise the squared error of texels reconstructed as `lo + ( hi - lo ) * weights[index]`, by
+// least squares. Returns false if the indices do not pin down both endpoints (e.g. every texel uses the same index).
+static bool refit_endpoints( const BlockTexels& block,
+                             uint32_t channels,
+                             const uint8_t* indices,
+                             const float* weights,
+                             float ( &lo )[4],
+                             float ( &hi )[4] ) {
+    float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+    for ( uint32_t i = 0; i < 16; ++i ) {
+        const float b = weights[indices[i]];
+        const float a = 1.0f - b;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for ( uint32_t c = 0; c < channels; ++c ) {
+            ax[c] += a * static_cast<float>( block.channels[c][i] );
+            bx[c] += b * static_cast<float>( block.channels[c][i] );
+        }
+    }
+
+    const float determinant = aa * bb - ab * ab;
+    if ( std::abs( determinant ) < 1e-6f ) { return false; }
+
+    for ( uint32_t c = 0; c < 4; ++c ) {
+        lo[c] = std::clamp( ( ax[c] * bb - bx[c] * ab ) / determinant, 0.0f, 255.0f );
+        hi[c] = std::clamp( ( bx[c] * aa - ax[c] * ab ) / determinant, 0.0f, 255.0f );
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// BC1: two RGB565 endpoints and 2 bit indices, always written in the 4 colour mode (`colour0 > colour1`)
+
+static uint16_t to_rgb565( const float ( &colour )[4] ) {
+    const auto r = static_cast<uint32_t>( std::lround( colour[0] * 31.0f / 255.0f ) );
+    const auto g = static_cast<uint32_t>( std::lround( colour[1] * 63.0f / 255.0f ) );
+    const auto b = static_cast<uint32_t>( std::lround( colour[2] * 31.0f / 255.0f ) );
+    return static_cast<uint16_t>( ( r << 11 ) | ( g << 5 ) | b );
+}
+
+static std::array<int32_t, 3> from_rgb565( uint16_t colour ) {
+    const int32_t r = ( colour >> 11 ) & 31;
+    const int32_t g = ( colour >> 5 ) & 63;
+    const int32_t b = colour & 31;
+    return { ( r << 3 ) | ( r >> 2 ), ( g << 2 ) | ( g >> 4 ), ( b << 3 ) | ( b >> 2 ) };
+}
+
+static Palette bc1_palette( uint16_t colour0, uint16_t colour1 ) {
+    const auto e0 = from_rgb565( colour0 );
+    const auto e1 = from_rgb565( colour1 );
+
+    Palette palette{ .size = 4 };
+    for ( uint32_t c = 0; c < 3; ++c ) {
+        palette.channels[c][0] = e0[c];
+        palette.channels[c][1] = e1[c];
+        palette.channels[c][2] = ( 2 * e0[c] + e1[c] ) / 3;
+        palette.channels[c][3] = ( e0[c] + 2 * e1[c] ) / 3;
+    }
+    return palette;
+}
+
+static void encode_bc1( const BlockTexels& texels, uint8_t* out ) {
+    // Alpha is not stored, so must not influence the fit
+    BlockTexels block = texels;
+    std::fill_n( block.channels[3], 16, 0 );
+
+    float lo[4], hi[4];
+    principal_endpoints( block, 3, lo, hi );
+
+    uint16_t colour0 = to_rgb565( hi );
+    uint16_t colour1 = to_rgb565( lo );
+    uint8_t indices[16] = {};
+    uint32_t error = fit_indices( block, bc1_palette( colour0, colour1 ), indices );
+
+    // One least squares pass over the chosen indices, kept if it lowers the error after quantisation
+    constexpr float weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    if ( refit_endpoints( block, 3, indices, weights, hi, lo ) ) {
+        const auto refit0 = to_rgb565( hi );
+        const auto refit1 = to_rgb565( lo );
+        uint8_t refit_indices[16] = {};
+        if ( fit_indices( block, bc1_palette( refit0, refit1 ), refit_indices ) < error ) {
+            colour0 = refit0;
+            colour1 = refit1;
+            std::copy_n( refit_indices, 16, indices );
+        }
+    }
+
+    // The 3 colour mode (`colour0 <= colour1`) would turn index 3 into transparent black
+    if ( colour0 < colour1 ) {
+        std::swap( colour0, colour1 );
+        for ( auto& index : indices ) { index ^= 1; }
+    } else if ( colour0 == colour1 ) {
+        std::fill_n( indices, 16, 0 );
+    }
+
+    BitWriter writer{ .out = out };
+    writer.write( colour0, 16 );
+    writer.write( colour1, 16 );
+    for ( const auto index : indices ) { writer.write( index, 2 ); }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// BC4: two 8 bit endpoints and 3 bit indices, always written in the 8 value mode (`value0 > value1`)
+
+static void encode_bc4( const BlockTexels& texels, uint32_t channel, uint8_t* out ) {
+    BlockTexels block;
+    std::copy_n( texels.channels[channel], 16, block.channels[0] );
+
+    const auto [min, max] = std::minmax_element( block.channels[0], block.channels[0] + 16 );
+    const int32_t value0 = *max;
+    const int32_t value1 = *min;
+
+    uint8_t indices[16] = {};
+    if ( value0 > value1 ) {
+        Palette palette{ .size = 8 };
+        palette.channels[0][0] = value0;
+        palette.channels[0][1] = value1;
+        for ( int32_t i = 2; i < 8; ++i ) {
+            palette.channels[0][i] = ( ( 8 - i ) * value0 + ( i - 1 ) * value1 + 3 ) / 7;
+        }
+        fit_indices( block, palette, indices );
+    }
+
+    BitWriter writer{ .out = out };
+    writer.write( static_cast<uint32_t>( value0 ), 8 );
+    writer.write( static_cast<uint32_t>( value1 ), 8 );
+    for ( const auto index : indices ) { writer.write( index, 3 ); }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// BC7 mode 6: one subset of two RGBA endpoints with 7 bits per channel and a shared low bit (p-bit) per endpoint, and
+// 4 bit indices. The other modes trade index precision for partitions, which pays off on blocks with several distinct
+// colours at a much higher search cost.
+
+constexpr static int32_t bc7_weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct Bc7Endpoint {
+    uint32_t channels[4] = {};// 7 bits each
+    uint32_t p_bit = 0;
+
+    int32_t value( uint32_t c ) const { return static_cast<int32_t>( ( channels[c] << 1 ) | p_bit ); }
+};
+
+static Bc7Endpoint to_bc7_endpoint( const float ( &colour )[4] ) {
+    Bc7Endpoint best;
+    float best_error = FLT_MAX;
+    for ( uint32_t p_bit = 0; p_bit < 2; ++p_bit ) {
+        Bc7Endpoint endpoint{ .p_bit = p_bit };
+        float error = 0.0f;
+        for ( uint32_t c = 0; c < 4; ++c ) {
+            const auto quantised = std::lround( ( colour[c] - static_cast<float>( p_bit ) ) / 2.0f );
+            endpoint.channels[c] = static_cast<uint32_t>( std::clamp( quantised, 0l, 127l ) );
+            const float difference = static_cast<float>( endpoint.value( c ) ) - colour[c];
+            error += difference * difference;
+        }
+        if ( error < best_error ) {
+            best_error = error;
+            best = endpoint;
+        }
+    }
+    return best;
+}
+
+static Palette bc7_palette( const Bc7Endpoint& endpoint0, const Bc7Endpoint& endpoint1 ) {
+    Palette palette{ .size = 16 };
+    for ( uint32_t c = 0; c < 4; ++c ) {
+        for ( uint32_t k = 0; k < 16; ++k ) {
+            palette.channels[c][k] =
+                ( ( 64 - bc7_weights[k] ) * endpoint0.value( c ) + bc7_weights[k] * endpoint1.value( c ) + 32 ) >> 6;
+        }
+    }
+    return palette;
+}
+
+static void encode_bc7( const BlockTexels& block, uint8_t* out ) {
+    float lo[4], hi[4];
+    principal_endpoints( block, 4, lo, hi );
+
+    auto endpoint0 = to_bc7_endpoint( lo );
+    auto endpoint1 = to_bc7_endpoint( hi );
+    uint8_t indices[16] = {};
+    const uint32_t error = fit_indices( block, bc7_palette( endpoint0, endpoint1 ), indices );
+
+    float weights[16];
+    for ( uint32_t k = 0; k < 16; ++k ) { weights[k] = static_cast<float>( bc7_weights[k] ) / 64.0f; }
+    if ( refit_endpoints( block, 4, indices, weights, lo, hi ) ) {
+        const auto refit0 = to_bc7_endpoint( lo );
+        const auto refit1 = to_bc7_endpoint( hi );
+        uint8_t refit_indices[16] = {};
+        if ( fit_indices( block, bc7_palette( refit0, refit1 ), refit_indices ) < error ) {
+            endpoint0 = refit0;
+            endpoint1 = refit1;
+            std::copy_n( refit_indices, 16, indices );
+        }
+    }
+
+    // The first index is stored without its top bit, so must be below 8
+    if ( indices[0] >= 8 ) {
+        std::swap( endpoint0, endpoint1 );
+        for ( auto& index : indices ) { index = static_cast<uint8_t>( 15 - index ); }
+    }
+
+    BitWriter writer{ .out = out };
+    writer.write( 1u << 6, 7 );
+    for ( uint32_t c = 0; c < 4; ++c ) {
+        writer.write( endpoint0.channels[c], 7 );
+        writer.write( endpoint1.channels[c], 7 );
+    }
+    writer.write( endpoint0.p_bit, 1 );
+    writer.write( endpoint1.p_bit, 1 );
+    writer.write( indices[0], 3 );
+    for ( uint32_t i = 1; i < 16; ++i ) { writer.write( indices[i], 4 ); }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Gathers the block at `( block_x, block_y )`, repeating the last row and column past the edges of the image
+static void load_block( const uint8_t* texels,
+                        uint32_t width,
+                        uint32_t height,
+                        uint32_t block_x,
+                        uint32_t block_y,
+                        BlockTexels& block ) {
+    for ( uint32_t y = 0; y < 4; ++y ) {
+        const auto row = std::min( block_y * 4 + y, height - 1 );
+        for ( uint32_t x = 0; x < 4; ++x ) {
+            const auto column = std::min( block_x * 4 + x, width - 1 );
+            const auto* texel = texels + ( static_cast<size_t>( row ) * width + column ) * 4;
+            for ( uint32_t c = 0; c < 4; ++c ) { block.channels[c][y * 4 + x] = texel[c]; }
+        }
+    }
+}
+
+static void encode_block_rows( const uint8_t* texels,
+                               uint32_t width,
+                               uint32_t height,
+                               BlockFormat format,
+                               uint32_t first_row,
+                               uint32_t last_row,
+                               uint8_t* out ) {
+    const uint32_t blocks_x = ( width + 3 ) / 4;
+    const uint32_t bytes = block_bytes( format );
+
+    BlockTexels block;
+    for ( uint32_t block_y = first_row; block_y < last_row; ++block_y ) {
+        for ( uint32_t block_x = 0; block_x < blocks_x; ++block_x ) {
+            load_block( texels, width, height, block_x, block_y, block );
+            auto* encoded = out + ( static_cast<size_t>( block_y ) * blocks_x + block_x ) * bytes;
+            switch ( format ) {
+                case BlockFormat::BC1: encode_bc1( block, encoded ); break;
+                case BlockFormat::BC3:
+                    encode_bc4( block, 3, encoded );
+                    encode_bc1( block, encoded + 8 );
+                    break;
+                case BlockFormat::BC4: encode_bc4( block, 0, encoded ); break;
+                case BlockFormat::BC5:
+                    encode_bc4( block, 0, encoded );
+                    encode_bc4( block, 1, encoded + 8 );
+                    break;
+                case BlockFormat::BC7: encode_bc7( block, encoded ); break;
+            }
+        }
+    }
+}
+
+// Halves both dimensions of every layer (down to 1), averaging each 2x2 quad of texels
+static std::vector<uint8_t> downsample_rgba8( std::span<const uint8_t> texels, VkExtent2D extent, uint32_t layers ) {
+    const VkExtent2D half = { std::max( 1u, extent.width / 2 ), std::max( 1u, extent.height / 2 ) };
+    std::vector<uint8_t> downsampled( static_cast<size_t>( half.width ) * half.height * 4 * layers );
+
+    for ( uint32_t layer = 0; layer < layers; ++layer ) {
+        const auto* source = texels.data() + static_cast<size_t>( extent.width ) * extent.height * 4 * layer;
+        auto* destination = downsampled.data() + static_cast<size_t>( half.width ) * half.height * 4 * layer;
+        for ( uint32_t y = 0; y < half.height; ++y ) {
+            const uint32_t rows[2] = { std::min( y * 2, extent.height - 1 ), std::min( y * 2 + 1, extent.height - 1 ) };
+            for ( uint32_t x = 0; x < half.width; ++x ) {
+                const uint32_t columns[2] = { std::min( x * 2, extent.width - 1 ),
+                                              std::min( x * 2 + 1, extent.width - 1 ) };
+                for ( uint32_t c = 0; c < 4; ++c ) {
+                    uint32_t sum = 2;// Rounds to nearest
+                    for ( const auto row : rows ) {
+                        for ( const auto column : columns ) {
+                            sum += source[( static_cast<size_t>( row ) * extent.width + column ) * 4 + c];
+                        }
+                    }
+                    const auto index = ( static_cast<size_t>( y ) * half.width + x ) * 4 + c;
+                    destination[index] = static_cast<uint8_t>( sum / 4 );
+                }
+            }
+        }
+    }
+    return downsampled;
+}
+
+VkFormat compressed_format( uint32_t channels, bool srgb ) {
+    switch ( channels ) {
+        case 1: return VK_FORMAT_BC4_UNORM_BLOCK;
+        case 2: return VK_FORMAT_BC5_UNORM_BLOCK;
+        case 3: return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        case 4: return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+        default: return VK_FORMAT_UNDEFINED;
+    }
+}
+
+std::optional<BlockFormat> block_format( VkFormat format ) {
+    switch ( format ) {
+        // Blocks are always opaque, which the RGBA variants decode just the same
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK: return BlockFormat::BC1;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK: return BlockFormat::BC3;
+        case VK_FORMAT_BC4_UNORM_BLOCK: return BlockFormat::BC4;
+        case VK_FORMAT_BC5_UNORM_BLOCK: return BlockFormat::BC5;
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK: return BlockFormat::BC7;
+        default: return std::nullopt;
+    }
+}
+
+uint64_t compressed_size( BlockFormat format, uint32_t width, uint32_t height ) {
+    return static_cast<uint64_t>( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * block_bytes( format );
+}
+
+std::vector<uint8_t> compress_rgba8( std::span<const uint8_t> texels,
+                                     uint32_t width,
+                                     uint32_t height,
+                                     BlockFormat format,
+                                     ThreadPool* workers ) {
+    if ( width == 0 || height == 0 || texels.size() != static_cast<size_t>( width ) * height * 4 ) {
+        log_write( LogLevel::Error,
+                   "Can not compress {} bytes of texels, expected {}x{} RGBA8 texels",
+                   texels.size(),
+                   width,
+                   height );
+        return {};
+    }
+
+    std::vector<uint8_t> blocks( compressed_size( format, width, height ) );
+    const uint32_t block_rows = ( height + 3 ) / 4;
+    if ( !workers || block_rows == 1 ) {
+        encode_block_rows( texels.data(), width, height, format, 0, block_rows, blocks.data() );
+        return blocks;
+    }
+
+    // A few jobs per worker, so that rows which take longer to encode even out
+    const auto job_count = static_cast<uint32_t>( std::min<size_t>( block_rows, workers->thread_count() * 4 ) );
+    std::vector<std::future<void>> jobs;
+    jobs.reserve( job_count );
+    for ( uint32_t job = 0; job < job_count; ++job ) {
+        const uint32_t first_row = block_rows * job / job_count;
+        const uint32_t last_row = block_rows * ( job + 1 ) / job_count;
+        jobs.push_back( workers->submit( [&, first_row, last_row]() {
+            encode_block_rows( texels.data(), width, height, format, first_row, last_row, blocks.data() );
+        } ) );
+    }
+    for ( auto& job : jobs ) { job.get(); }
+
+    return blocks;
+}
+
+std::vector<uint8_t> compress_rgba8_mips( std::span<const uint8_t> texels,
+                                          VkExtent2D extent,
+                                          uint32_t array_layers,
+                                          uint32_t mip_levels,
+                                          BlockFormat format,
+                                          std::vector<VkDeviceSize>& mip_offsets,
+                                          ThreadPool* workers ) {
+    const auto layer_size = static_cast<size_t>( extent.width ) * extent.height * 4;
+    if ( mip_levels == 0 || array_layers == 0 || texels.size() != layer_size * array_layers ) {
+        log_write( LogLevel::Error,
+                   "Can not compress {} bytes of texels, expected {} layers of {}x{} RGBA8 texels",
+                   texels.size(),
+                   array_layers,
+                   extent.width,
+                   extent.height );
+        return {};
+    }
+
+    std::vector<uint8_t> compressed;
+    mip_offsets.clear();
+
+    // Each mip is filtered from the one before, which is all that is kept around
+    std::vector<uint8_t> downsampled;
+    auto mip_texels = texels;
+    for ( uint32_t mip = 0; mip < mip_levels; ++mip ) {
+        mip_offsets.push_back( compressed.size() );
+
+        const auto mip_layer_size = static_cast<size_t>( extent.width ) * extent.height * 4;
+        for ( uint32_t layer = 0; layer < array_layers; ++layer ) {
+            const auto layer_texels = mip_texels.subspan( mip_layer_size * layer, mip_layer_size );
+            const auto blocks = compress_rgba8( layer_texels, extent.width, extent.height, format, workers );
+            compressed.insert( compressed.end(), blocks.begin(), blocks.end() );
+        }
+
+        if ( mip + 1 < mip_levels ) {
+            downsampled = downsample_rgba8( mip_texels, extent, array_layers );
+            mip_texels = downsampled;
+            extent = { std::max( 1u, extent.width / 2 ), std::max( 1u, extent.height / 2 ) };
+        }
+    }
+
+    return compressed;
+}
+
+}// namespace aloe
@@ -0,0 +1,197 @@
+#include <aloe/core/AssetPack.h>
+#include <aloe/core/Device.h>
+#include <aloe/core/ResourceManager.h>
+#include <aloe/util/log.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+
+class AssetPackTestFixture : public ::testing::Test {
+protected:
+    std::shared_ptr<aloe::MockLogger> mock_logger_;
+    std::unique_ptr<aloe::Device> device_;
+    std::shared_ptr<aloe::ResourceManager> resource_manager_;
+    std::filesystem::path pack_path_;
+
+    void SetUp() override {
+        mock_logger_ = std::make_shared<aloe::MockLogger>();
+        aloe::set_logger( mock_logger_ );
+        aloe::set_logger_level( aloe::LogLevel::Warn );
+
+        device_ = std::make_unique<aloe::Device>( aloe::DeviceSettings{ .enable_validation = true, .headless = true } );
+        resource_manager_ = device_->make_resource_manager();
+
+        const auto* test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+        pack_path_ = std::filesystem::temp_directory_path() / ( std::string( test_info->name() ) + ".alpk" );
+    }
+
+    void TearDown() override {
+        std::filesystem::remove( pack_path_ );
+
+        resource_manager_.reset();
+        device_.reset( nullptr );
+
+        auto& debug_info = aloe::Device::debug_info();
+
+        // No memory leaks
+        EXPECT_EQ( debug_info.memory_stats_.total.statistics.allocationCount, 0 );
+
+        // No validation errors
+        EXPECT_EQ( debug_info.num_warning, 0 );
+        EXPECT_EQ( debug_info.num_error, 0 );
+
+        if ( debug_info.num_warning > 0 || debug_info.num_error > 0 ) {
+            for ( const auto& [level, message] : mock_logger_->get_entries() ) { std::cerr << message << std::endl; }
+        }
+    }
+
+    static std::vector<uint8_t> make_bytes( size_t size, uint8_t first ) {
+        std::vector<uint8_t> bytes( size );
+        std::iota( bytes.begin(), bytes.end(), first );
+        return bytes;
+    }
+};
+
+TEST_F( AssetPackTestFixture, WriteAndOpen_RoundTripsEntriesAndData ) {
+    const auto buffer_data = make_bytes( 100, 0 );
+    const std::vector<std::vector<uint8_t>> mips = { make_bytes( 8 * 8 * 4, 1 ), make_bytes( 4 * 4 * 4, 2 ) };
+
+    aloe::AssetPackWriter writer;
+    ASSERT_TRUE( writer.add_image( "texture", { .format = VK_FORMAT_R8G8B8A8_UNORM, .extent = { 8, 8, 1 } }, mips ) );
+    ASSERT_TRUE( writer.add_buffer( "buffer", buffer_data ) );
+    ASSERT_TRUE( writer.write( pack_path_ ) );
+
+    const auto pack = aloe::AssetPack::open( pack_path_ );
+    ASSERT_NE( pack, nullptr );
+    ASSERT_EQ( pack->entries().size(), 2 );
+
+    // Entries are sorted by name
+    EXPECT_EQ( pack->name( pack->entries()[0] ), "buffer" );
+    EXPECT_EQ( pack->name( pack->entries()[1] ), "texture" );
+    EXPECT_EQ( pack->find( "missing" ), nullptr );
+
+    const auto* buffer = pack->find( "buffer" );
+    ASSERT_NE( buffer, nullptr );
+    EXPECT_EQ( buffer->kind, aloe::AssetKind::Buffer );
+    EXPECT_EQ( buffer->data_offset % aloe::asset_pack_alignment, 0 );
+    const auto buffer_bytes = pack->data( *buffer );
+    EXPECT_TRUE( std::ranges::equal( buffer_bytes, buffer_data ) );
+
+    const auto* texture = pack->find( "texture" );
+    ASSERT_NE( texture, nullptr );
+    EXPECT_EQ( texture->kind, aloe::AssetKind::Image );
+    EXPECT_EQ( texture->format, VK_FORMAT_R8G8B8A8_UNORM );
+    EXPECT_EQ( texture->mip_levels, 2 );
+    EXPECT_EQ( texture->array_layers, 1 );
+
+    const auto texture_bytes = pack->data( *texture );
+    for ( uint32_t mip = 0; mip < texture->mip_levels; ++mip ) {
+        EXPECT_EQ( texture->mip_offsets[mip] % aloe::asset_pack_mip_alignment, 0 );
+        EXPECT_TRUE( std::ranges::equal( texture_bytes.subspan( texture->mip_offsets[mip], mips[mip].size() ),
+                                         mips[mip] ) );
+    }
+}
+
+TEST_F( AssetPackTestFixture, Writer_RejectsDuplicateNames ) {
+    aloe::AssetPackWriter writer;
+    ASSERT_TRUE( writer.add_buffer( "buffer", make_bytes( 16, 0 ) ) );
+    EXPECT_FALSE( writer.add_buffer( "buffer", make_bytes( 16, 0 ) ) );
+
+    ASSERT_FALSE( mock_logger_->get_entries().empty() );
+    EXPECT_EQ( mock_logger_->get_entries().back().level, aloe::LogLevel::Error );
+}
+
+TEST_F( AssetPackTestFixture, Writer_RejectsMipsOfTheWrongSize ) {
+    aloe::AssetPackWriter writer;
+    const std::vector<std::vector<uint8_t>> mips = { make_bytes( 8 * 8 * 4, 0 ), make_bytes( 4 * 4 * 2, 0 ) };
+    EXPECT_FALSE( writer.add_image( "texture", { .format = VK_FORMAT_R8G8B8A8_UNORM, .extent = { 8, 8, 1 } }, mips ) );
+
+    ASSERT_FALSE( mock_logger_->get_entries().empty() );
+    EXPECT_EQ( mock_logger_->get_entries().back().level, aloe::LogLevel::Error );
+}
+
+TEST_F( AssetPackTestFixture, Open_RejectsMipsPastTheirData ) {
+    aloe::AssetPackWriter writer;
+    const std::vector<std::vector<uint8_t>> mips = { make_bytes( 8 * 8 * 4, 0 ), make_bytes( 4 * 4 * 4, 0 ) };
+    ASSERT_TRUE( writer.add_image( "texture", { .format = VK_FORMAT_R8G8B8A8_UNORM, .extent = { 8, 8, 1 } }, mips ) );
+    ASSERT_TRUE( writer.write( pack_path_ ) );
+
+    // Move mip 1 to the last aligned offset of the data, which is in bounds but too close to the end to hold it
+    {
+        const uint64_t truncated_offset = 8 * 8 * 4 + 4 * 4 * 4 - aloe::asset_pack_mip_alignment;
+        const auto mip_1_offset = offsetof( aloe::AssetPackEntry, mip_offsets ) + sizeof( uint64_t );
+        std::fstream file( pack_path_, std::ios::binary | std::ios::in | std::ios::out );
+        file.seekp( sizeof( aloe::AssetPackHeader ) + mip_1_offset );
+        file.write( reinterpret_cast<const char*>( &truncated_offset ), sizeof( truncated_offset ) );
+    }
+
+    EXPECT_EQ( aloe::AssetPack::open( pack_path_ ), nullptr );
+    ASSERT_FALSE( mock_logger_->get_entries().empty() );
+    EXPECT_TRUE( mock_logger_->get_entries().back().message.contains( "mip out of bounds" ) );
+}
+
+TEST_F( AssetPackTestFixture, Open_RejectsInvalidFiles ) {
+    {
+        std::ofstream file( pack_path_, std::ios::binary );
+        file << "definitely not an asset pack, but long enough to hold a header";
+    }
+
+    EXPECT_EQ( aloe::AssetPack::open( pack_path_ ), nullptr );
+    ASSERT_FALSE( mock_logger_->get_entries().empty() );
+    EXPECT_EQ( mock_logger_->get_entries().back().level, aloe::LogLevel::Error );
+
+    EXPECT_EQ( aloe::AssetPack::open( pack_path_.string() + ".missing" ), nullptr );
+}
+
+TEST_F( AssetPackTestFixture, LoadImage_UploadsEveryMip ) {
+    const std::vector<std::vector<uint8_t>> mips = {
+        make_bytes( 16 * 16 * 4, 0 ),
+        make_bytes( 8 * 8 * 4, 1 ),
+        make_bytes( 4 * 4 * 4, 2 ),
+    };
+
+    aloe::AssetPackWriter writer;
+    ASSERT_TRUE( writer.add_image( "texture", { .format = VK_FORMAT_R8G8B8A8_UNORM, .extent = { 16, 16, 1 } }, mips ) );
+    ASSERT_TRUE( writer.write( pack_path_ ) );
+
+    const auto pack = aloe::AssetPack::open( pack_path_ );
+    ASSERT_NE( pack, nullptr );
+
+    const auto image = pack->load_image( *resource_manager_, "texture", VK_IMAGE_USAGE_TRANSFER_SRC_BIT, "texture" );
+    ASSERT_NE( image.raw, 0 );
+
+    std::vector<uint8_t> readback( mips[0].size() );
+    ASSERT_EQ( resource_manager_->read_from_image( image, readback.data(), readback.size() ), readback.size() );
+    EXPECT_EQ( readback, mips[0] );
+
+    // Buffers and images are looked up separately
+    EXPECT_EQ( pack->load_buffer( *resource_manager_, "texture", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT ).raw, 0 );
+
+    resource_manager_->free_image( image );
+}
+
+TEST_F( AssetPackTestFixture, LoadBuffer_UploadsToDeviceLocalMemory ) {
+    const auto buffer_data = make_bytes( 4096, 0 );
+
+    aloe::AssetPackWriter writer;
+    ASSERT_TRUE( writer.add_buffer( "vertices", buffer_data ) );
+    ASSERT_TRUE( writer.write( pack_path_ ) );
+
+    const auto pack = aloe::AssetPack::open( pack_path_ );
+    ASSERT_NE( pack, nullptr );
+
+    // No host access requested, so the upload is staged
+    const auto buffer = pack->load_buffer( *resource_manager_, "vertices", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT );
+    ASSERT_NE( buffer.raw, 0 );
+
+    std::vector<uint8_t> readback( buffer_data.size() );
+    ASSERT_EQ( resource_manager_->read_from_buffer( buffer, readback.data(), readback.size() ), readback.size() );
+    EXPECT_EQ( readback, buffer_data );
+
+    resource_manager_->free_buffer( buffer );
+}
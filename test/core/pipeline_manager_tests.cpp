@@ -7,8 +7,12 @@
 #include <GLFW/glfw3.h>
 #include <gtest/gtest.h>
 
+#include <array>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <numeric>
+#include <thread>
 
 #include <spirv-tools/libspirv.hpp>
 
@@ -22,14 +26,19 @@ protected:
     std::shared_ptr<aloe::ResourceManager> resource_manager_;
     spvtools::SpirvTools spirv_tools_{ SPV_ENV_VULKAN_1_3 };
 
+    // Where the current test writes any caches, owned by the test alone and removed once it finishes
+    std::filesystem::path test_directory_;
+
     void SetUp() override {
         mock_logger_ = std::make_shared<aloe::MockLogger>();
         aloe::set_logger( mock_logger_ );
         aloe::set_logger_level( aloe::LogLevel::Warn );
 
-        device_ = std::make_unique<aloe::Device>( aloe::DeviceSettings{ .enable_validation = true, .headless = true } );
-        resource_manager_ = device_->make_resource_manager();
-        pipeline_manager_ = device_->make_pipeline_manager( { "resources" } );
+        const auto* test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+        test_directory_ = std::filesystem::temp_directory_path() / ( std::string( "aloe_" ) + test_info->name() );
+        std::filesystem::remove_all( test_directory_ );
+
+        recreate_device();
 
         spirv_tools_.SetMessageConsumer(
             [&]( spv_message_level_t level, const char* source, const spv_position_t& position, const char* message ) {
@@ -39,9 +48,8 @@ protected:
     }
 
     void TearDown() override {
-        resource_manager_.reset();
-        pipeline_manager_.reset();
-        device_.reset( nullptr );
+        destroy_device();
+        std::filesystem::remove_all( test_directory_ );
 
         auto& debug_info = aloe::Device::debug_info();
         EXPECT_EQ( debug_info.num_warning, 0 );
@@ -52,6 +60,28 @@ protected:
         }
     }
 
+    // Destroys the managers and then the device, which writes back any caches the pipeline manager was given
+    void destroy_device() {
+        resource_manager_.reset();
+        pipeline_manager_.reset();
+        device_.reset( nullptr );
+    }
+
+    // Replaces the device (and the managers made from it) with one made from `settings`, which is always headless and
+    // validated. The pipeline manager loads and saves its caches at the given paths, if any.
+    void recreate_device( aloe::DeviceSettings settings = {},
+                          const std::filesystem::path& pipeline_cache_path = {},
+                          const std::filesystem::path& shader_cache_directory = {} ) {
+        destroy_device();
+
+        settings.enable_validation = true;
+        settings.headless = true;
+        device_ = std::make_unique<aloe::Device>( settings );
+        resource_manager_ = device_->make_resource_manager();
+        pipeline_manager_ =
+            device_->make_pipeline_manager( { "resources" }, pipeline_cache_path, shader_cache_directory );
+    }
+
     // Helper to compile and validate SPIR-V
     std::expected<aloe::PipelineHandle, std::string> compile_and_validate( const aloe::ComputePipelineInfo& info ) {
         auto result = pipeline_manager_->compile_pipeline( info );
@@ -776,11 +806,330 @@ TEST_F( PipelineManagerTestFixture, MultiEntry_DifferentPipelineHandles ) {
     EXPECT_NE( first_spirv, second_spirv );
 }
 
+//------------------------------------------------------------------------------
+// Batch Compilation Tests
+//------------------------------------------------------------------------------
+
+TEST_F( PipelineManagerTestFixture, Batch_ResultsInInputOrder ) {
+    std::vector<aloe::PipelineInfo> infos;
+    for ( uint32_t i = 0; i < 8; ++i ) {
+        const auto name = std::format( "batch_{}.slang", i );
+        pipeline_manager_->set_virtual_file( name,
+                                             make_compute_shader( std::format( "float x = {} * scale;", i ),
+                                                                  "uniform float scale",
+                                                                  "main" ) );
+        infos.emplace_back( aloe::ComputePipelineInfo{ .compute_shader = { .name = name, .entry_point = "main" } } );
+    }
+
+    // A duplicate, and a pipeline which fails to compile, in the middle of the batch
+    const auto duplicate = infos[1];
+    const auto invalid = aloe::ComputePipelineInfo{ .compute_shader = { .name = "bad.slang", .entry_point = "main" } };
+    pipeline_manager_->set_virtual_file( "bad.slang", COMPUTE_ENTRY "void main(" );
+    infos.insert( infos.begin() + 3, duplicate );
+    infos.insert( infos.begin() + 5, invalid );
+
+    const auto results = pipeline_manager_->compile_pipelines( infos );
+    ASSERT_EQ( results.size(), infos.size() );
+
+    ASSERT_FALSE( results[5].has_value() );
+    EXPECT_TRUE( results[5].error().find( "bad.slang" ) != std::string::npos );
+    std::erase( infos, aloe::PipelineInfo{ invalid } );
+    auto handles = results;
+    handles.erase( handles.begin() + 5 );
+
+    // The duplicate shares its pipeline, which was only built once
+    EXPECT_EQ( handles[3], handles[1] );
+    for ( const auto& handle : handles ) {
+        ASSERT_TRUE( handle.has_value() ) << handle.error();
+        EXPECT_EQ( pipeline_manager_->get_pipeline_version( *handle ), 1 );
+        EXPECT_TRUE( spirv_tools_.Validate( pipeline_manager_->get_pipeline_spirv( *handle ) ) );
+    }
+
+    // Each handle is the pipeline's own, compiling it alone gives the same one
+    for ( size_t i = 0; i < infos.size(); ++i ) {
+        EXPECT_EQ( pipeline_manager_->compile_pipeline( std::get<aloe::ComputePipelineInfo>( infos[i] ) ), handles[i] );
+    }
+}
+
+TEST_F( PipelineManagerTestFixture, Batch_DefineChangesRebuildEveryPipeline ) {
+    std::vector<aloe::PipelineInfo> infos;
+    for ( uint32_t i = 0; i < 4; ++i ) {
+        const auto name = std::format( "batch_define_{}.slang", i );
+        pipeline_manager_->set_virtual_file( name,
+                                             "import aloe;" COMPUTE_ENTRY "[numthreads(BATCH_THREADS, 1, 1)] "
+                                             "void main() { }" );
+        infos.emplace_back( aloe::ComputePipelineInfo{ .compute_shader = { .name = name, .entry_point = "main" } } );
+    }
+    pipeline_manager_->set_define( "BATCH_THREADS", "32" );
+
+    const auto results = pipeline_manager_->compile_pipelines( infos );
+    std::vector<std::vector<uint32_t>> spirv;
+    for ( const auto& result : results ) {
+        ASSERT_TRUE( result.has_value() ) << result.error();
+        spirv.emplace_back( pipeline_manager_->get_pipeline_spirv( *result ) );
+    }
+
+    // Every pipeline is rebuilt with the new define, whichever worker (and Slang session) picks it up
+    pipeline_manager_->set_define( "BATCH_THREADS", "64" );
+    for ( size_t i = 0; i < results.size(); ++i ) {
+        EXPECT_EQ( pipeline_manager_->get_pipeline_version( *results[i] ), 2 );
+        EXPECT_NE( pipeline_manager_->get_pipeline_spirv( *results[i] ), spirv[i] );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Async Compilation Tests
+//------------------------------------------------------------------------------
+
+TEST_F( PipelineManagerTestFixture, Async_RecompileSwapsInOnceProcessed ) {
+    pipeline_manager_->set_virtual_file( "async.slang",
+                                         "import aloe;" COMPUTE_ENTRY "[numthreads(ASYNC_THREADS, 1, 1)] "
+                                         "void main() { }" );
+    pipeline_manager_->set_define( "ASYNC_THREADS", "32" );
+    const auto handle = compile_and_validate( { .compute_shader = { .name = "async.slang", .entry_point = "main" } } );
+    ASSERT_TRUE( handle.has_value() ) << handle.error();
+    const auto spirv = pipeline_manager_->get_pipeline_spirv( *handle );
+
+    // The previous version stays bound until the rebuild is processed, and only the newest rebuild is kept
+    pipeline_manager_->set_async_compilation( true );
+    pipeline_manager_->set_define( "ASYNC_THREADS", "64" );
+    pipeline_manager_->set_define( "ASYNC_THREADS", "128" );
+    EXPECT_EQ( pipeline_manager_->get_pipeline_version( *handle ), 1 );
+    EXPECT_EQ( pipeline_manager_->get_pipeline_spirv( *handle ), spirv );
+
+    const auto results = pipeline_manager_->process_pending_compiles( true );
+    ASSERT_EQ( results.size(), 1 );
+    EXPECT_EQ( results.front(), handle );
+    EXPECT_EQ( pipeline_manager_->get_pipeline_version( *handle ), 2 );
+    EXPECT_TRUE( spirv_tools_.Validate( pipeline_manager_->get_pipeline_spirv( *handle ) ) );
+
+    // Matches a synchronous compile with the same define
+    const auto async_spirv = pipeline_manager_->get_pipeline_spirv( *handle );
+    pipeline_manager_->set_async_compilation( false );
+    pipeline_manager_->set_define( "ASYNC_THREADS", "128" );
+    EXPECT_EQ( pipeline_manager_->get_pipeline_version( *handle ), 3 );
+    EXPECT_EQ( pipeline_manager_->get_pipeline_spirv( *handle ), async_spirv );
+    EXPECT_NE( async_spirv, spirv );
+}
+
+TEST_F( PipelineManagerTestFixture, Async_FailureKeepsPreviousPipeline ) {
+    pipeline_manager_->set_virtual_file( "async_failure.slang",
+                                         make_compute_shader( "float x = scale;", "uniform float scale", "main" ) );
+    const auto handle =
+        compile_and_validate( { .compute_shader = { .name = "async_failure.slang", .entry_point = "main" } } );
+    ASSERT_TRUE( handle.has_value() ) << handle.error();
+    const auto spirv = pipeline_manager_->get_pipeline_spirv( *handle );
+
+    pipeline_manager_->set_async_compilation( true );
+    pipeline_manager_->set_virtual_file( "async_failure.slang", COMPUTE_ENTRY "void main(" );
+
+    const auto results = pipeline_manager_->process_pending_compiles( true );
+    ASSERT_EQ( results.size(), 1 );
+    ASSERT_FALSE( results.front().has_value() );
+    EXPECT_TRUE( results.front().error().find( "async_failure.slang" ) != std::string::npos );
+
+    // Still usable, as it was before the edit
+    EXPECT_EQ( pipeline_manager_->get_pipeline_version( *handle ), 1 );
+    EXPECT_EQ( pipeline_manager_->get_pipeline_spirv( *handle ), spirv );
+    EXPECT_TRUE( std::ranges::any_of( mock_logger_->get_entries(), []( const auto& entry ) {
+        return entry.level == aloe::LogLevel::Error && entry.message.contains( "keeping the previous version" );
+    } ) );
+
+    // Fixing the file swaps in the new version
+    pipeline_manager_->set_virtual_file( "async_failure.slang",
+                                         make_compute_shader( "float x = scale * 2;", "uniform float scale", "main" ) );
+    EXPECT_TRUE( pipeline_manager_->process_pending_compiles( true ).front().has_value() );
+    EXPECT_EQ( pipeline_manager_->get_pipeline_version( *handle ), 2 );
+}
+
+TEST_F( PipelineManagerTestFixture, Async_SwapKeepsUniformValues ) {
+    const auto source = [&]( const std::string& scale ) {
+        return make_compute_shader( "RWByteAddressBuffer buf = outbuf_handle.get();"
+                                    "if (id.x == 0) { buf.Store<float>(0, time * " +
+                                        scale + "); }",
+                                    "uniform float time, uniform aloe::BufferHandle outbuf_handle",
+                                    "main",
+                                    1 );
+    };
+    const auto dispatch_and_read = [&]( aloe::PipelineHandle handle, aloe::BufferHandle outbuf ) {
+        pipeline_manager_->bind_slots();
+        execute_compute_shader( [&]( aloe::CommandList& cmd_list ) {
+            auto scope = cmd_list.bind_pipeline( handle );
+            EXPECT_EQ( scope.dispatch( 1, 1, 1 ), std::nullopt );
+        } );
+
+        float result = 0.0f;
+        resource_manager_->read_from_buffer( outbuf, &result, sizeof( result ) );
+        return result;
+    };
+
+    pipeline_manager_->set_virtual_file( "async_uniforms.slang", source( "1.0" ) );
+    const auto handle =
+        compile_and_validate( { .compute_shader = { .name = "async_uniforms.slang", .entry_point = "main" } } );
+    ASSERT_TRUE( handle.has_value() ) << handle.error();
+
+    const auto outbuf = create_and_upload_buffer( "AsyncUniformOut", { 0.0f } );
+    pipeline_manager_->set_uniform( pipeline_manager_->get_uniform_handle<float>( *handle, "time" ).set_value( 2.0f ) );
+    EXPECT_TRUE( pipeline_manager_->set_uniform(
+        pipeline_manager_->get_uniform_handle<aloe::BufferHandle>( *handle, "outbuf_handle" ).set_value( outbuf ),
+        aloe::usage( outbuf, aloe::ComputeStorageWrite ) ) );
+    EXPECT_FLOAT_EQ( dispatch_and_read( *handle, outbuf ), 2.0f );
+
+    // The swapped in version keeps the time and output buffer set on the previous one
+    pipeline_manager_->set_async_compilation( true );
+    pipeline_manager_->set_virtual_file( "async_uniforms.slang", source( "3.0" ) );
+    ASSERT_EQ( pipeline_manager_->process_pending_compiles( true ).size(), 1 );
+    EXPECT_EQ( pipeline_manager_->get_pipeline_version( *handle ), 2 );
+    EXPECT_FLOAT_EQ( dispatch_and_read( *handle, outbuf ), 6.0f );
+
+    // A synchronous recompile which fails leaves the previous version bound and usable
+    pipeline_manager_->set_async_compilation( false );
+    pipeline_manager_->set_virtual_file( "async_uniforms.slang", COMPUTE_ENTRY "void main(" );
+    EXPECT_EQ( pipeline_manager_->get_pipeline_version( *handle ), 2 );
+    EXPECT_FLOAT_EQ( dispatch_and_read( *handle, outbuf ), 6.0f );
+}
+
+TEST_F( PipelineManagerTestFixture, Async_EditsDuringCompileOnlyCacheTheNewestBuild ) {
+    const auto cache_directory = test_directory_ / "shader_cache";
+    const auto shader = aloe::ShaderCompileInfo{ .name = "async_cached.slang", .entry_point = "main" };
+    const auto source = [&]( const char* body ) { return make_compute_shader( body, "uniform float scale", "main" ); };
+
+    recreate_device( {}, {}, cache_directory );
+    pipeline_manager_->set_virtual_file( "async_cached.slang", source( "float x = scale;" ) );
+    const auto handle = compile_and_validate( { shader } );
+    ASSERT_TRUE( handle.has_value() ) << handle.error();
+
+    // The second edit lands while the rebuild for the first is in flight, which is then dropped without being cached
+    pipeline_manager_->set_async_compilation( true );
+    pipeline_manager_->set_virtual_file( "async_cached.slang", source( "float x = scale * 2;" ) );
+    pipeline_manager_->set_virtual_file( "async_cached.slang", source( "float x = scale * 3;" ) );
+    const auto results = pipeline_manager_->process_pending_compiles( true );
+    ASSERT_EQ( results.size(), 1 );
+    ASSERT_TRUE( results.front().has_value() ) << results.front().error();
+    const auto spirv = pipeline_manager_->get_pipeline_spirv( *handle );
+
+    // The next run is served the newest edit from the cache
+    recreate_device( {}, {}, cache_directory );
+    pipeline_manager_->set_virtual_file( "async_cached.slang", source( "float x = scale * 3;" ) );
+    const auto warm = compile_and_validate( { shader } );
+    ASSERT_TRUE( warm.has_value() ) << warm.error();
+    EXPECT_EQ( pipeline_manager_->get_shader_cache_hits(), 1 );
+    EXPECT_EQ( pipeline_manager_->get_pipeline_spirv( *warm ), spirv );
+
+    // While the dropped edit was never stored, so it still goes through Slang
+    recreate_device( {}, {}, cache_directory );
+    pipeline_manager_->set_virtual_file( "async_cached.slang", source( "float x = scale * 2;" ) );
+    ASSERT_TRUE( compile_and_validate( { shader } ).has_value() );
+    EXPECT_EQ( pipeline_manager_->get_shader_cache_hits(), 0 );
+}
+
+//------------------------------------------------------------------------------
+// Pipeline Cache Tests
+//------------------------------------------------------------------------------
+
+TEST_F( PipelineManagerTestFixture, PipelineCache_PersistsAcrossDevices ) {
+    const auto cache_path = test_directory_ / "pipeline_cache.bin";
+
+    const auto shader = aloe::ShaderCompileInfo{ .name = "cached.slang", .entry_point = "main" };
+    auto restart = [&]() {
+        recreate_device( {}, cache_path );
+        pipeline_manager_->set_virtual_file( "cached.slang", COMPUTE_ENTRY "void main() { }" );
+    };
+    auto count_cache_warnings = [&]() {
+        return std::ranges::count_if( mock_logger_->get_entries(), []( const auto& entry ) {
+            return entry.level == aloe::LogLevel::Warn && entry.message.find( "pipeline cache" ) != std::string::npos;
+        } );
+    };
+
+    // Without a cache path there is nothing to save to
+    EXPECT_FALSE( pipeline_manager_->save_pipeline_cache() );
+
+    // The first run starts from an empty cache, and writes it back on demand
+    restart();
+    ASSERT_TRUE( compile_and_validate( { shader } ).has_value() );
+    EXPECT_TRUE( pipeline_manager_->save_pipeline_cache() );
+    ASSERT_TRUE( std::filesystem::exists( cache_path ) );
+    EXPECT_EQ( std::ranges::distance( std::filesystem::directory_iterator( cache_path.parent_path() ) ), 1 );
+
+    // The next device loads the cache without complaint, and saves it again on shutdown
+    restart();
+    ASSERT_TRUE( compile_and_validate( { shader } ).has_value() );
+    EXPECT_EQ( count_cache_warnings(), 0 );
+    std::filesystem::remove( cache_path );
+    destroy_device();
+    ASSERT_TRUE( std::filesystem::exists( cache_path ) );
+
+    // A cache which fails validation is ignored, and compilation carries on regardless
+    {
+        std::fstream file( cache_path, std::ios::binary | std::ios::in | std::ios::out );
+        file.seekp( 12 );
+        file.put( 0x7f );
+    }
+    restart();
+    EXPECT_EQ( count_cache_warnings(), 1 );
+    ASSERT_TRUE( compile_and_validate( { shader } ).has_value() );
+}
+
+TEST_F( PipelineManagerTestFixture, ShaderCache_SkipsSlangWhenSourcesAreUnchanged ) {
+    const auto cache_directory = test_directory_ / "shader_cache";
+
+    const auto shader = aloe::ShaderCompileInfo{ .name = "cached.slang", .entry_point = "main" };
+    auto restart = [&]( const std::string& dependency ) {
+        recreate_device( {}, {}, cache_directory );
+        pipeline_manager_->set_virtual_file( "cached_dependency.slang", dependency );
+        pipeline_manager_->set_virtual_file( "cached.slang",
+                                             "import cached_dependency;" +
+                                                 make_compute_shader( "float x = value() * scale;",
+                                                                      "uniform float scale",
+                                                                      "main" ) );
+    };
+
+    // A cold start compiles through Slang and fills the cache
+    restart( "module cached_dependency; public float value() { return 1.0; }" );
+    const auto cold = compile_and_validate( { shader } );
+    ASSERT_TRUE( cold.has_value() ) << cold.error();
+    EXPECT_EQ( pipeline_manager_->get_shader_cache_hits(), 0 );
+    const auto cold_spirv = pipeline_manager_->get_pipeline_spirv( *cold );
+    const auto cold_offset = pipeline_manager_->get_uniform_handle<float>( *cold, "scale" ).offset;
+
+    // A warm start loads the same SPIR-V and reflection straight from the cache
+    restart( "module cached_dependency; public float value() { return 1.0; }" );
+    const auto warm = compile_and_validate( { shader } );
+    ASSERT_TRUE( warm.has_value() ) << warm.error();
+    EXPECT_EQ( pipeline_manager_->get_shader_cache_hits(), 1 );
+    EXPECT_EQ( pipeline_manager_->get_pipeline_spirv( *warm ), cold_spirv );
+    EXPECT_EQ( pipeline_manager_->get_uniform_handle<float>( *warm, "scale" ).offset, cold_offset );
+
+    // Dependencies are still tracked on a hit, so editing one rebuilds the shader (and misses the cache)
+    pipeline_manager_->set_virtual_file( "cached_dependency.slang",
+                                         "module cached_dependency; public float value() { return 2.0; }" );
+    EXPECT_EQ( pipeline_manager_->get_pipeline_version( *warm ), 2 );
+    EXPECT_EQ( pipeline_manager_->get_shader_cache_hits(), 1 );
+
+    // As do changes to the defines
+    pipeline_manager_->set_define( "CACHED_DEFINE", "1" );
+    EXPECT_EQ( pipeline_manager_->get_pipeline_version( *warm ), 3 );
+    EXPECT_EQ( pipeline_manager_->get_shader_cache_hits(), 1 );
+
+    // A dependency changing between runs makes the old entry stale
+    restart( "module cached_dependency; public float value() { return 3.0; }" );
+    ASSERT_TRUE( compile_and_validate( { shader } ).has_value() );
+    EXPECT_EQ( pipeline_manager_->get_shader_cache_hits(), 0 );
+}
+
 //------------------------------------------------------------------------------
 // End-to-End Tests
 //------------------------------------------------------------------------------
 
-TEST_F( PipelineManagerTestFixture, E2E_BufferDataModification ) {
+// Runs end-to-end tests with the bindless table in a descriptor buffer (where the device supports one), and in a
+// descriptor pool & set
+class BindlessTableTestFixture : public PipelineManagerTestFixture, public ::testing::WithParamInterface<bool> {};
+
+INSTANTIATE_TEST_SUITE_P( DescriptorBuffer, BindlessTableTestFixture, ::testing::Bool() );
+
+TEST_P( BindlessTableTestFixture, E2E_BufferDataModification ) {
+    recreate_device( { .descriptor_buffer = GetParam() } );
+
     constexpr size_t num_elements = 64;
     constexpr VkDeviceSize buffer_size = num_elements * sizeof( float );
 
@@ -898,6 +1247,112 @@ TEST_F( PipelineManagerTestFixture, E2E_ThreeBufferElementWiseMultiply ) {
     }
 }
 
+TEST_F( PipelineManagerTestFixture, E2E_SubAllocatedBuffers ) {
+    constexpr size_t num_elements = 64;
+    constexpr VkDeviceSize buffer_size = num_elements * sizeof( float );
+
+    const auto pool = resource_manager_->create_buffer_pool( {
+        .size = 4 * buffer_size,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .memory_usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+        .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
+        .name = "SubAllocationPool",
+    } );
+    const auto untouched = resource_manager_->create_buffer( { .size = buffer_size, .name = "A", .parent = pool } );
+    const auto target = resource_manager_->create_buffer( { .size = buffer_size, .name = "B", .parent = pool } );
+
+    std::vector<float> initial_data( num_elements );
+    std::iota( initial_data.begin(), initial_data.end(), 1.0f );
+    resource_manager_->upload_to_buffer( untouched, initial_data.data(), buffer_size );
+    resource_manager_->upload_to_buffer( target, initial_data.data(), buffer_size );
+
+    std::string shader_body = R"(
+        uint address = id.x * sizeof(float);
+        data_buffer.store<float>(address, data_buffer.load<float>(address) * 2.0f);
+    )";
+
+    pipeline_manager_->set_virtual_file(
+        "sub_allocated.slang",
+        make_compute_shader( shader_body, "uniform aloe::BufferHandle data_buffer", "compute_main", num_elements ) );
+
+    auto pipeline_handle = compile_and_validate( { { .name = "sub_allocated.slang", .entry_point = "compute_main" } } );
+    ASSERT_TRUE( pipeline_handle.has_value() ) << pipeline_handle.error();
+
+    auto h_data_buffer = pipeline_manager_->get_uniform_handle<aloe::BufferHandle>( *pipeline_handle, "data_buffer" );
+    ASSERT_TRUE( pipeline_manager_->set_uniform( h_data_buffer.set_value( target ),
+                                                 aloe::usage( target, aloe::ComputeStorageReadWrite ) ) );
+    pipeline_manager_->bind_slots();
+
+    execute_compute_shader( [&]( aloe::CommandList& cmd_list ) {
+        auto scope = cmd_list.bind_pipeline( *pipeline_handle );
+        EXPECT_FALSE( scope.dispatch( 1, 1, 1 ).has_value() );
+    } );
+
+    std::vector<float> target_data( num_elements );
+    std::vector<float> untouched_data( num_elements );
+    ASSERT_EQ( resource_manager_->read_from_buffer( target, target_data.data(), buffer_size ), buffer_size );
+    ASSERT_EQ( resource_manager_->read_from_buffer( untouched, untouched_data.data(), buffer_size ), buffer_size );
+
+    for ( size_t i = 0; i < num_elements; ++i ) {
+        EXPECT_FLOAT_EQ( target_data[i], initial_data[i] * 2.0f ) << "Mismatch at index " << i;
+        EXPECT_FLOAT_EQ( untouched_data[i], initial_data[i] ) << "Neighbouring buffer modified at index " << i;
+    }
+}
+
+TEST_F( PipelineManagerTestFixture, E2E_TransientInputBuffer ) {
+    constexpr size_t num_elements = 64;
+    constexpr VkDeviceSize buffer_size = num_elements * sizeof( float );
+
+    ASSERT_TRUE( resource_manager_->create_linear_allocator( { .size_per_frame = 4096, .frames_in_flight = 2 } ) );
+
+    // Offset the input so the shader has to respect the offset of the allocation
+    ASSERT_TRUE( resource_manager_->allocate_transient( 48 ).has_value() );
+    const auto input = resource_manager_->allocate_transient( buffer_size );
+    ASSERT_TRUE( input.has_value() );
+
+    std::vector<float> input_data( num_elements );
+    std::iota( input_data.begin(), input_data.end(), 1.0f );
+    std::memcpy( input->data, input_data.data(), buffer_size );
+
+    auto output_buffer = create_and_upload_buffer( "OutputBuffer", std::vector<float>( num_elements, 0.0f ) );
+
+    std::string shader_body = R"(
+        uint address = id.x * sizeof(float);
+        output_buffer.store<float>(address, input_buffer.load<float>(address) + 1.0f);
+    )";
+
+    pipeline_manager_->set_virtual_file(
+        "transient_input.slang",
+        make_compute_shader( shader_body,
+                             "uniform aloe::BufferHandle input_buffer, uniform aloe::BufferHandle output_buffer",
+                             "compute_main",
+                             num_elements ) );
+
+    auto pipeline_handle = compile_and_validate( { { .name = "transient_input.slang", .entry_point = "compute_main" } } );
+    ASSERT_TRUE( pipeline_handle.has_value() ) << pipeline_handle.error();
+
+    // Transient allocations are already bound, their handle is written as a plain uniform
+    auto h_input = pipeline_manager_->get_uniform_handle<aloe::GpuBufferHandle>( *pipeline_handle, "input_buffer" );
+    pipeline_manager_->set_uniform( h_input.set_value( input->gpu_handle ) );
+
+    auto h_output = pipeline_manager_->get_uniform_handle<aloe::BufferHandle>( *pipeline_handle, "output_buffer" );
+    ASSERT_TRUE( pipeline_manager_->set_uniform( h_output.set_value( output_buffer ),
+                                                 aloe::usage( output_buffer, aloe::ComputeStorageWrite ) ) );
+    pipeline_manager_->bind_slots();
+
+    execute_compute_shader( [&]( aloe::CommandList& cmd_list ) {
+        auto scope = cmd_list.bind_pipeline( *pipeline_handle );
+        EXPECT_FALSE( scope.dispatch( 1, 1, 1 ).has_value() );
+    } );
+
+    std::vector<float> output_data( num_elements );
+    ASSERT_EQ( resource_manager_->read_from_buffer( output_buffer, output_data.data(), buffer_size ), buffer_size );
+
+    for ( size_t i = 0; i < num_elements; ++i ) {
+        EXPECT_FLOAT_EQ( output_data[i], input_data[i] + 1.0f ) << "Mismatch at index " << i;
+    }
+}
+
 TEST_F( PipelineManagerTestFixture, E2E_ImageProcedural ) {
     constexpr uint32_t image_size = 8;
     constexpr uint32_t total_pixels = image_size * image_size;
@@ -994,3 +1449,381 @@ TEST_F( PipelineManagerTestFixture, E2E_ImageProcedural ) {
         }
     }
 }
+
+TEST_F( PipelineManagerTestFixture, E2E_ImageArrayLayers ) {
+    constexpr uint32_t image_size = 4;
+    constexpr uint32_t num_layers = 3;
+
+    auto image = resource_manager_->create_image( {
+        .extent = { image_size, image_size, 1 },
+        .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+        .usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        .array_layers = num_layers,
+        .name = "LayeredImage",
+    } );
+    ASSERT_NE( image.raw, 0 );
+
+    std::string shader_body = R"(
+        RWTexture2DArray<float4> output_tex = output_image.get_array();
+        output_tex[id] = float4(id.z, id.x, id.y, 1.0);
+    )";
+
+    pipeline_manager_->set_virtual_file(
+        "array_layers.slang",
+        make_compute_shader( shader_body, "uniform aloe::ImageHandle output_image", "compute_main", image_size ) );
+
+    auto pipeline_handle = compile_and_validate( { { .name = "array_layers.slang", .entry_point = "compute_main" } } );
+    ASSERT_TRUE( pipeline_handle.has_value() ) << pipeline_handle.error();
+
+    // The whole array is bound as a single 2D array view
+    auto array_usage = aloe::usage( image, aloe::ComputeStorageWrite );
+    array_usage.view_type = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    array_usage.layer_count = num_layers;
+
+    auto h_output = pipeline_manager_->get_uniform_handle<aloe::ImageHandle>( *pipeline_handle, "output_image" );
+    ASSERT_TRUE( pipeline_manager_->set_uniform( h_output.set_value( image ), array_usage ) );
+    pipeline_manager_->bind_slots();
+
+    execute_compute_shader( [&]( aloe::CommandList& cmd_list ) {
+        VkImageMemoryBarrier2KHR barrier{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
+                                          .srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+                                          .srcAccessMask = VK_ACCESS_2_NONE,
+                                          .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                          .dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                                          .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                                          .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+                                          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                          .image = resource_manager_->get_image( image ),
+                                          .subresourceRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                                                .baseMipLevel = 0,
+                                                                .levelCount = 1,
+                                                                .baseArrayLayer = 0,
+                                                                .layerCount = num_layers } };
+
+        VkDependencyInfo dependency_info{ .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                                          .imageMemoryBarrierCount = 1,
+                                          .pImageMemoryBarriers = &barrier };
+
+        cmd_list.pipeline_barrier( dependency_info );
+
+        auto scope = cmd_list.bind_pipeline( *pipeline_handle );
+        EXPECT_FALSE( scope.dispatch( 1, image_size, num_layers ).has_value() );
+
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        cmd_list.pipeline_barrier( dependency_info );
+    } );
+
+    // Layers are read back one after another
+    std::vector<float> readback_data( image_size * image_size * num_layers * 4 );
+    const auto readback_bytes = readback_data.size() * sizeof( float );
+    ASSERT_EQ( resource_manager_->read_from_image( image, readback_data.data(), readback_bytes ), readback_bytes );
+
+    for ( uint32_t layer = 0; layer < num_layers; ++layer ) {
+        for ( uint32_t y = 0; y < image_size; ++y ) {
+            for ( uint32_t x = 0; x < image_size; ++x ) {
+                const auto pixel_idx = ( ( layer * image_size + y ) * image_size + x ) * 4;
+                EXPECT_FLOAT_EQ( readback_data[pixel_idx + 0], static_cast<float>( layer ) );
+                EXPECT_FLOAT_EQ( readback_data[pixel_idx + 1], static_cast<float>( x ) );
+                EXPECT_FLOAT_EQ( readback_data[pixel_idx + 2], static_cast<float>( y ) );
+            }
+        }
+    }
+}
+
+TEST_F( PipelineManagerTestFixture, E2E_SampledTexture ) {
+    constexpr uint32_t image_size = 2;
+
+    auto image = resource_manager_->create_image( {
+        .extent = { image_size, image_size, 1 },
+        .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+        .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        .name = "SampledImage",
+    } );
+    ASSERT_NE( image.raw, 0 );
+
+    std::vector<float> texels( image_size * image_size * 4 );
+    std::iota( texels.begin(), texels.end(), 1.0f );
+    ASSERT_EQ( resource_manager_->upload_to_image( image, texels.data(), texels.size() * sizeof( float ) ),
+               texels.size() * sizeof( float ) );
+
+    // Nearest filtering, so sampling at each texel centre returns that texel exactly
+    const auto sampler = resource_manager_->create_sampler( {
+        .mag_filter = VK_FILTER_NEAREST,
+        .min_filter = VK_FILTER_NEAREST,
+        .mipmap_mode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+    } );
+    ASSERT_NE( sampler.raw, 0 );
+
+    std::string shader_body = R"(
+        uint2 texel = uint2(id.x % 2, id.x / 2);
+        float2 uv = (float2(texel) + 0.5) / 2.0;
+        out_buffer.store<float4>(id.x * sizeof(float4), tex.sample_level(samp, uv, 0));
+    )";
+
+    pipeline_manager_->set_virtual_file(
+        "sampled_texture.slang",
+        make_compute_shader(
+            shader_body,
+            "uniform aloe::TextureHandle tex, uniform aloe::SamplerHandle samp, "
+            "uniform aloe::BufferHandle out_buffer",
+            "compute_main",
+            image_size * image_size ) );
+
+    auto pipeline_handle =
+        compile_and_validate( { { .name = "sampled_texture.slang", .entry_point = "compute_main" } } );
+    ASSERT_TRUE( pipeline_handle.has_value() ) << pipeline_handle.error();
+
+    auto output = create_and_upload_buffer( "SampledOutput", std::vector<float>( texels.size(), 0.0f ) );
+
+    auto h_tex = pipeline_manager_->get_uniform_handle<aloe::ImageHandle>( *pipeline_handle, "tex" );
+    auto h_samp = pipeline_manager_->get_uniform_handle<aloe::SamplerHandle>( *pipeline_handle, "samp" );
+    auto h_output = pipeline_manager_->get_uniform_handle<aloe::BufferHandle>( *pipeline_handle, "out_buffer" );
+    ASSERT_TRUE(
+        pipeline_manager_->set_uniform( h_tex.set_value( image ), aloe::usage( image, aloe::ComputeSampledRead ) ) );
+    pipeline_manager_->set_uniform( h_samp.set_value( sampler ) );
+    ASSERT_TRUE( pipeline_manager_->set_uniform( h_output.set_value( output ),
+                                                 aloe::usage( output, aloe::ComputeStorageWrite ) ) );
+    pipeline_manager_->bind_slots();
+
+    execute_compute_shader( [&]( aloe::CommandList& cmd_list ) {
+        // Uploads leave images in `GENERAL`, sampled reads expect `SHADER_READ_ONLY_OPTIMAL`
+        VkImageMemoryBarrier2KHR barrier{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
+                                          .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                          .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                                          .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                          .dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                                          .oldLayout = VK_IMAGE_LAYOUT_GENERAL,
+                                          .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                          .image = resource_manager_->get_image( image ),
+                                          .subresourceRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                                                .baseMipLevel = 0,
+                                                                .levelCount = 1,
+                                                                .baseArrayLayer = 0,
+                                                                .layerCount = 1 } };
+
+        VkDependencyInfo dependency_info{ .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                                          .imageMemoryBarrierCount = 1,
+                                          .pImageMemoryBarriers = &barrier };
+
+        cmd_list.pipeline_barrier( dependency_info );
+
+        auto scope = cmd_list.bind_pipeline( *pipeline_handle );
+        EXPECT_FALSE( scope.dispatch( 1, 1, 1 ).has_value() );
+    } );
+    // So copies made by the manager (e.g. defragmentation) start from the layout the barrier left it in
+    resource_manager_->set_image_layout( image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+
+    std::vector<float> readback_data( texels.size() );
+    const auto readback_bytes = readback_data.size() * sizeof( float );
+    ASSERT_EQ( resource_manager_->read_from_buffer( output, readback_data.data(), readback_bytes ), readback_bytes );
+    EXPECT_EQ( readback_data, texels );
+}
+
+TEST_F( PipelineManagerTestFixture, E2E_BufferDeviceAddressLinkedList ) {
+    recreate_device( { .buffer_device_address = true } );
+
+    // Mirrors the layout of `Node` in the shader below
+    struct Node {
+        float value;
+        uint64_t next;
+    };
+    constexpr uint32_t num_nodes = 4;
+
+    // Nodes live in a sub-allocated buffer, so addresses must include the offset of the buffer within its pool
+    const auto pool = resource_manager_->create_buffer_pool( {
+        .size = 1024,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .memory_usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+        .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .name = "NodePool",
+    } );
+    const auto padding = resource_manager_->create_buffer( { .size = 48, .name = "Padding", .parent = pool } );
+    const auto nodes = resource_manager_->create_buffer( {
+        .size = sizeof( Node ) * num_nodes,
+        .name = "Nodes",
+        .parent = pool,
+    } );
+    ASSERT_NE( padding.raw, 0 );
+    ASSERT_NE( nodes.raw, 0 );
+
+    const auto nodes_address = resource_manager_->get_buffer_address( nodes );
+    ASSERT_NE( nodes_address, 0 );
+    EXPECT_EQ( nodes_address, resource_manager_->get_buffer_address( pool ) +
+                   resource_manager_->get_buffer_range( nodes ).offset );
+
+    // Link the nodes back to front, so the traversal visits them in reverse order of their layout
+    std::array<Node, num_nodes> node_data{};
+    for ( uint32_t i = 0; i < num_nodes; ++i ) {
+        node_data[i].value = static_cast<float>( 1u << i );
+        node_data[i].next = i == 0 ? 0 : nodes_address + ( i - 1 ) * sizeof( Node );
+    }
+    ASSERT_EQ( resource_manager_->upload_to_buffer( nodes, node_data.data(), sizeof( node_data ) ),
+               sizeof( node_data ) );
+
+    auto result = create_and_upload_buffer( "LinkedListResult", { 0.0f, 0.0f } );
+
+    std::string shader_body = R"(
+        float sum = 0.0;
+        uint count = 0;
+        for (Node* node = head; node != nullptr; node = node->next) {
+            sum += node->value;
+            count++;
+        }
+        result[0] = sum;
+        result[1] = float(count);
+    )";
+
+    pipeline_manager_->set_virtual_file(
+        "linked_list.slang",
+        make_compute_shader( shader_body, "uniform Node* head, uniform float* result", "compute_main", 1 ) +
+            "struct Node { float value; Node* next; };\n" );
+
+    auto pipeline_handle = compile_and_validate( { { .name = "linked_list.slang", .entry_point = "compute_main" } } );
+    ASSERT_TRUE( pipeline_handle.has_value() ) << pipeline_handle.error();
+
+    // Pointers are plain uniforms, nothing is bound into the descriptor heaps
+    auto h_head = pipeline_manager_->get_uniform_handle<VkDeviceAddress>( *pipeline_handle, "head" );
+    auto h_result = pipeline_manager_->get_uniform_handle<VkDeviceAddress>( *pipeline_handle, "result" );
+    pipeline_manager_->set_uniform( h_head.set_value( nodes_address + ( num_nodes - 1 ) * sizeof( Node ) ) );
+    pipeline_manager_->set_uniform( h_result.set_value( resource_manager_->get_buffer_address( result ) ) );
+
+    execute_compute_shader( [&]( aloe::CommandList& cmd_list ) {
+        auto scope = cmd_list.bind_pipeline( *pipeline_handle );
+        EXPECT_FALSE( scope.dispatch( 1, 1, 1 ).has_value() );
+    } );
+
+    std::array<float, 2> readback_data{};
+    ASSERT_EQ( resource_manager_->read_from_buffer( result, readback_data.data(), sizeof( readback_data ) ),
+               sizeof( readback_data ) );
+    EXPECT_FLOAT_EQ( readback_data[0], static_cast<float>( ( 1u << num_nodes ) - 1 ) );
+    EXPECT_FLOAT_EQ( readback_data[1], static_cast<float>( num_nodes ) );
+}
+
+TEST_F( PipelineManagerTestFixture, E2E_StreamingFeedbackRequestsMips ) {
+    constexpr uint32_t image_size = 8;
+    ASSERT_TRUE( resource_manager_->enable_streaming() );
+
+    const auto image = resource_manager_->create_streamed_image( {
+        .image = {
+            .extent = { image_size, image_size, 1 },
+            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+            .mip_levels = 4,
+            .name = "StreamedImage",
+        },
+        .load_mip = []( uint32_t mip ) {
+            const auto size = std::max( 1u, image_size >> mip );
+            return std::vector<uint8_t>( size * size * 4, static_cast<uint8_t>( mip ) );
+        },
+    } );
+    ASSERT_NE( image.raw, 0 );
+    ASSERT_EQ( resource_manager_->resident_mip( image ), 3u );
+
+    // Several threads request different mips, the most detailed request wins
+    pipeline_manager_->set_virtual_file(
+        "streaming_feedback.slang",
+        make_compute_shader( "aloe::request_streamed_mip(streaming, image_index, 1 + id.x);",
+                             "uniform aloe::BufferHandle streaming, uniform uint image_index",
+                             "compute_main",
+                             2 ) );
+
+    auto pipeline_handle =
+        compile_and_validate( { { .name = "streaming_feedback.slang", .entry_point = "compute_main" } } );
+    ASSERT_TRUE( pipeline_handle.has_value() ) << pipeline_handle.error();
+
+    const auto streaming = resource_manager_->streaming_buffer();
+    auto h_streaming = pipeline_manager_->get_uniform_handle<aloe::BufferHandle>( *pipeline_handle, "streaming" );
+    auto h_index = pipeline_manager_->get_uniform_handle<uint32_t>( *pipeline_handle, "image_index" );
+    ASSERT_TRUE( pipeline_manager_->set_uniform( h_streaming.set_value( streaming ),
+                                                 aloe::usage( streaming, aloe::ComputeStorageReadWrite ) ) );
+    pipeline_manager_->set_uniform( h_index.set_value( *resource_manager_->streaming_index( image ) ) );
+
+    // The image is sampled once its requested mips are resident, so its binding expects `SHADER_READ_ONLY_OPTIMAL`
+    pipeline_manager_->set_virtual_file(
+        "streaming_sample.slang",
+        make_compute_shader( "out_buffer.store<float4>(0, tex.sample_level(samp, float2(0.5, 0.5), 0));",
+                             "uniform aloe::TextureHandle tex, uniform aloe::SamplerHandle samp, "
+                             "uniform aloe::BufferHandle out_buffer",
+                             "compute_main",
+                             1 ) );
+
+    auto sample_handle =
+        compile_and_validate( { { .name = "streaming_sample.slang", .entry_point = "compute_main" } } );
+    ASSERT_TRUE( sample_handle.has_value() ) << sample_handle.error();
+
+    const auto sampler = resource_manager_->create_sampler( {
+        .mag_filter = VK_FILTER_NEAREST,
+        .min_filter = VK_FILTER_NEAREST,
+        .mipmap_mode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+    } );
+    auto output = create_and_upload_buffer( "StreamedSampleOutput", std::vector<float>( 4, 0.0f ) );
+
+    auto h_tex = pipeline_manager_->get_uniform_handle<aloe::ImageHandle>( *sample_handle, "tex" );
+    auto h_samp = pipeline_manager_->get_uniform_handle<aloe::SamplerHandle>( *sample_handle, "samp" );
+    auto h_output = pipeline_manager_->get_uniform_handle<aloe::BufferHandle>( *sample_handle, "out_buffer" );
+    ASSERT_TRUE(
+        pipeline_manager_->set_uniform( h_tex.set_value( image ), aloe::usage( image, aloe::ComputeSampledRead ) ) );
+    pipeline_manager_->set_uniform( h_samp.set_value( sampler ) );
+    ASSERT_TRUE( pipeline_manager_->set_uniform( h_output.set_value( output ),
+                                                 aloe::usage( output, aloe::ComputeStorageWrite ) ) );
+    pipeline_manager_->bind_slots();
+
+    execute_compute_shader( [&]( aloe::CommandList& cmd_list ) {
+        // The resident mips start out in `GENERAL`, where streaming leaves images which are not bound yet
+        VkImageMemoryBarrier2KHR barrier{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
+                                          .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                                          .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                                          .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                                          .dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT,
+                                          .oldLayout = VK_IMAGE_LAYOUT_GENERAL,
+                                          .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                          .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                          .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                          .image = resource_manager_->get_image( image ),
+                                          .subresourceRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                                                .baseMipLevel = 0,
+                                                                .levelCount = VK_REMAINING_MIP_LEVELS,
+                                                                .baseArrayLayer = 0,
+                                                                .layerCount = 1 } };
+
+        VkDependencyInfo dependency_info{ .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                                          .imageMemoryBarrierCount = 1,
+                                          .pImageMemoryBarriers = &barrier };
+
+        cmd_list.pipeline_barrier( dependency_info );
+
+        auto scope = cmd_list.bind_pipeline( *pipeline_handle );
+        EXPECT_FALSE( scope.dispatch( 1, 1, 1 ).has_value() );
+    } );
+    resource_manager_->set_image_layout( image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+
+    for ( int i = 0; i < 1000 && resource_manager_->resident_mip( image ) != 1u; ++i ) {
+        resource_manager_->update_streaming();
+        std::this_thread::sleep_for( 1ms );
+    }
+    EXPECT_EQ( resource_manager_->resident_mip( image ), 1u );
+    EXPECT_EQ( resource_manager_->streaming_statistics().mips_streamed_in, 2u );
+
+    // The new backing image is left in the layout of its binding, so it is sampled without another barrier, and its
+    // most detailed mip is the one which was streamed in (every texel of mip `n` holds `n`)
+    EXPECT_EQ( resource_manager_->image_layout( image ), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+    pipeline_manager_->bind_slots();
+    execute_compute_shader( [&]( aloe::CommandList& cmd_list ) {
+        auto scope = cmd_list.bind_pipeline( *sample_handle );
+        EXPECT_FALSE( scope.dispatch( 1, 1, 1 ).has_value() );
+    } );
+
+    std::array<float, 4> readback_data{};
+    ASSERT_EQ( resource_manager_->read_from_buffer( output, readback_data.data(), sizeof( readback_data ) ),
+               sizeof( readback_data ) );
+    for ( const auto channel : readback_data ) { EXPECT_FLOAT_EQ( channel, 1.0f / 255.0f ); }
+}
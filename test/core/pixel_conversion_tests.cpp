@@ -0,0 +1,272 @@
+#include <aloe/core/PixelConversion.h>
+#include <aloe/util/log.h>
+#include <aloe/util/thread_pool.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
+class PixelConversionTestFixture : public ::testing::Test {
+protected:
+    std::shared_ptr<aloe::MockLogger> mock_logger_;
+
+    void SetUp() override {
+        mock_logger_ = std::make_shared<aloe::MockLogger>();
+        aloe::set_logger( mock_logger_ );
+        aloe::set_logger_level( aloe::LogLevel::Warn );
+    }
+
+    // Every byte value, in an order which does not repeat with the texel size
+    static std::vector<uint8_t> make_bytes( size_t count ) {
+        std::vector<uint8_t> bytes( count );
+        for ( size_t i = 0; i < count; ++i ) { bytes[i] = static_cast<uint8_t>( i * 7 + i / 251 ); }
+        return bytes;
+    }
+
+    // Floats spanning the normal, subnormal and overflowing ranges of a half, of both signs
+    static std::vector<float> make_floats( size_t count ) {
+        std::vector<float> values( count );
+        for ( size_t i = 0; i < count; ++i ) {
+            const float magnitude = std::ldexp( 1.0f + static_cast<float>( i % 1000 ) / 1000.0f, i % 46 - 28 );
+            values[i] = i % 2 ? -magnitude : magnitude;
+        }
+        return values;
+    }
+
+    // Bitwise, so the comparison holds for infinities and signed zeroes
+    static bool same_bits( std::span<const float> a, std::span<const float> b ) {
+        return a.size() == b.size() && std::memcmp( a.data(), b.data(), a.size_bytes() ) == 0;
+    }
+};
+
+TEST_F( PixelConversionTestFixture, Rgb8ToRgba8_ExpandsWithOpaqueAlpha ) {
+    // Not a multiple of the 4 texels the SIMD path converts at a time
+    constexpr size_t texels = 1003;
+    const auto rgb = make_bytes( texels * 3 );
+
+    std::vector<uint8_t> rgba( texels * 4 );
+    ASSERT_TRUE( aloe::PixelConverter{}.rgb8_to_rgba8( rgb, rgba ) );
+    for ( size_t i = 0; i < texels; ++i ) {
+        EXPECT_EQ( rgba[i * 4 + 0], rgb[i * 3 + 0] );
+        EXPECT_EQ( rgba[i * 4 + 1], rgb[i * 3 + 1] );
+        EXPECT_EQ( rgba[i * 4 + 2], rgb[i * 3 + 2] );
+        EXPECT_EQ( rgba[i * 4 + 3], 255 );
+    }
+}
+
+TEST_F( PixelConversionTestFixture, FloatToHalf_RoundsToNearestEven ) {
+    const std::vector<float> values = { 0.0f,
+                                        -0.0f,
+                                        1.0f,
+                                        -2.5f,
+                                        65504.0f,
+                                        65520.0f,// Rounds up past the largest half
+                                        1.0f + std::ldexp( 1.0f, -11 ),// Halfway between two halves, rounds to even
+                                        std::ldexp( 1.0f, -24 ),// Smallest subnormal half
+                                        std::ldexp( 1.0f, -26 ),// Underflows to zero
+                                        std::numeric_limits<float>::infinity() };
+    const std::vector<uint16_t> expected = { 0x0000, 0x8000, 0x3c00, 0xc100, 0x7bff,
+                                             0x7c00, 0x3c00, 0x0001, 0x0000, 0x7c00 };
+
+    for ( const bool simd : { false, true } ) {
+        std::vector<uint16_t> halves( values.size() );
+        ASSERT_TRUE( aloe::PixelConverter( nullptr, simd ).float_to_half( values, halves ) );
+        EXPECT_EQ( halves, expected ) << simd;
+    }
+}
+
+TEST_F( PixelConversionTestFixture, HalfToFloat_RoundTripsEveryHalf ) {
+    std::vector<uint16_t> halves( 1 << 16 );
+    for ( size_t i = 0; i < halves.size(); ++i ) { halves[i] = static_cast<uint16_t>( i ); }
+
+    for ( const bool simd : { false, true } ) {
+        const aloe::PixelConverter converter( nullptr, simd );
+        std::vector<float> values( halves.size() );
+        ASSERT_TRUE( converter.half_to_float( halves, values ) );
+
+        std::vector<uint16_t> round_trip( halves.size() );
+        ASSERT_TRUE( converter.float_to_half( values, round_trip ) );
+        for ( size_t i = 0; i < halves.size(); ++i ) {
+            // NaNs come back quiet, with their payload dropped
+            if ( std::isnan( values[i] ) ) { continue; }
+            ASSERT_EQ( round_trip[i], halves[i] ) << i << " " << simd;
+        }
+    }
+}
+
+TEST_F( PixelConversionTestFixture, SrgbToLinear_RoundTripsAndLeavesAlpha ) {
+    std::vector<float> rgba = { 0.0f, 0.04f, 0.5f, 0.25f, 1.0f, 0.2f, 0.9f, 0.75f };
+    const auto original = rgba;
+
+    const aloe::PixelConverter converter;
+    converter.srgb_to_linear( rgba );
+    EXPECT_NEAR( rgba[2], 0.214041f, 1e-5f );
+    EXPECT_EQ( rgba[3], 0.25f );
+    EXPECT_EQ( rgba[4], 1.0f );
+
+    converter.linear_to_srgb( rgba );
+    for ( size_t i = 0; i < rgba.size(); ++i ) { EXPECT_NEAR( rgba[i], original[i], 1e-5f ); }
+}
+
+TEST_F( PixelConversionTestFixture, Conversions_SimdAndWorkersMatchScalar ) {
+    // Large enough to be split across the workers, and not a multiple of any SIMD width
+    constexpr size_t texels = 300007;
+    const auto bytes = make_bytes( texels * aloe::pixel_size( aloe::PixelLayout::RGBA16 ) );
+
+    aloe::ThreadPool workers( 4 );
+    const aloe::PixelConverter scalar( nullptr, false );
+    const aloe::PixelConverter simd( &workers );
+
+    for ( const auto layout : { aloe::PixelLayout::RGB8,
+                                aloe::PixelLayout::RGBA8,
+                                aloe::PixelLayout::RGB16,
+                                aloe::PixelLayout::RGBA16 } ) {
+        for ( const bool srgb : { false, true } ) {
+            const std::span<const uint8_t> source( bytes.data(), texels * aloe::pixel_size( layout ) );
+            std::vector<float> expected( texels * 4 );
+            std::vector<float> actual( texels * 4 );
+            ASSERT_TRUE( scalar.to_rgba32f( source, layout, srgb, expected ) );
+            ASSERT_TRUE( simd.to_rgba32f( source, layout, srgb, actual ) );
+            EXPECT_TRUE( same_bits( expected, actual ) ) << static_cast<uint32_t>( layout ) << " " << srgb;
+        }
+    }
+
+    std::vector<float> expected( texels * 4 );
+    ASSERT_TRUE( scalar.to_rgba32f( bytes, aloe::PixelLayout::RGBA16, false, expected ) );
+    auto actual = expected;
+    scalar.premultiply_alpha( expected );
+    simd.premultiply_alpha( actual );
+    EXPECT_TRUE( same_bits( expected, actual ) );
+
+    for ( const auto format : { VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_R16G16B16A16_SFLOAT } ) {
+        std::vector<uint8_t> expected_texels( bytes.size() );
+        std::vector<uint8_t> actual_texels( bytes.size() );
+        const auto size = format == VK_FORMAT_R16G16B16A16_SFLOAT ? bytes.size() : texels * 4;
+        ASSERT_TRUE( scalar.from_rgba32f( expected, format, std::span( expected_texels ).first( size ) ) );
+        ASSERT_TRUE( simd.from_rgba32f( expected, format, std::span( actual_texels ).first( size ) ) );
+        EXPECT_EQ( expected_texels, actual_texels ) << static_cast<uint32_t>( format );
+    }
+
+    const auto values = make_floats( texels );
+    std::vector<uint16_t> expected_halves( texels );
+    std::vector<uint16_t> actual_halves( texels );
+    ASSERT_TRUE( scalar.float_to_half( values, expected_halves ) );
+    ASSERT_TRUE( simd.float_to_half( values, actual_halves ) );
+    EXPECT_EQ( expected_halves, actual_halves );
+}
+
+TEST_F( PixelConversionTestFixture, FromRgba32f_QuantizesWithClamping ) {
+    const std::vector<float> rgba = { -1.0f, 0.5f, 1.0f, 2.0f, std::nanf( "" ), 0.2f, 0.0f, 1.0f };
+
+    for ( const bool simd : { false, true } ) {
+        std::vector<uint8_t> texels( rgba.size() );
+        ASSERT_TRUE( aloe::PixelConverter( nullptr, simd ).from_rgba32f( rgba, VK_FORMAT_R8G8B8A8_UNORM, texels ) );
+        EXPECT_EQ( texels, ( std::vector<uint8_t>{ 0, 128, 255, 255, 0, 51, 0, 255 } ) ) << simd;
+    }
+}
+
+TEST_F( PixelConversionTestFixture, Downsample_HalvesExtentAndKeepsFlatImages ) {
+    const aloe::PixelConverter converter;
+    const std::vector<float> flat( 13 * 7 * 4, 0.375f );
+
+    for ( const auto filter : { aloe::MipFilter::Box, aloe::MipFilter::Kaiser } ) {
+        const auto mip = converter.downsample( flat, { 13, 7 }, filter );
+        ASSERT_EQ( mip.size(), 6 * 3 * 4 );
+        for ( const auto value : mip ) { EXPECT_NEAR( value, 0.375f, 1e-6f ); }
+
+        // A single column only shrinks vertically
+        EXPECT_EQ( converter.downsample( std::span( flat ).first( 7 * 4 ), { 1, 7 }, filter ).size(), 3 * 4 );
+    }
+}
+
+TEST_F( PixelConversionTestFixture, Downsample_BoxAveragesQuads ) {
+    // 2x2 texels of a single channel, the other channels zero
+    std::vector<float> rgba( 4 * 4, 0.0f );
+    rgba[0] = 0.0f;
+    rgba[4] = 1.0f;
+    rgba[8] = 0.25f;
+    rgba[12] = 0.75f;
+
+    const auto mip = aloe::PixelConverter{}.downsample( rgba, { 2, 2 }, aloe::MipFilter::Box );
+    ASSERT_EQ( mip.size(), 4 );
+    EXPECT_FLOAT_EQ( mip[0], 0.5f );
+}
+
+TEST_F( PixelConversionTestFixture, Downsample_WorkersMatchSingleThreaded ) {
+    constexpr VkExtent2D extent = { 512, 384 };
+    std::vector<float> rgba( extent.width * extent.height * 4 );
+    ASSERT_TRUE( aloe::PixelConverter{}.to_rgba32f( make_bytes( rgba.size() ), aloe::PixelLayout::RGBA8, true, rgba ) );
+
+    aloe::ThreadPool workers( 4 );
+    for ( const auto filter : { aloe::MipFilter::Box, aloe::MipFilter::Kaiser } ) {
+        EXPECT_TRUE( same_bits( aloe::PixelConverter{}.downsample( rgba, extent, filter ),
+                                aloe::PixelConverter( &workers ).downsample( rgba, extent, filter ) ) );
+    }
+}
+
+TEST_F( PixelConversionTestFixture, Conversions_RejectMismatchedSizes ) {
+    const aloe::PixelConverter converter;
+    std::vector<uint8_t> bytes( 12 );
+    std::vector<float> floats( 12 );
+    std::vector<uint16_t> halves( 8 );
+
+    EXPECT_FALSE( converter.rgb8_to_rgba8( std::span( bytes ).first( 10 ), bytes ) );
+    EXPECT_FALSE( converter.float_to_half( floats, halves ) );
+    EXPECT_FALSE( converter.to_rgba32f( bytes, aloe::PixelLayout::RGBA8, false, std::span( floats ).first( 8 ) ) );
+    EXPECT_FALSE( converter.from_rgba32f( floats, VK_FORMAT_R8G8B8A8_UNORM, std::span( bytes ).first( 8 ) ) );
+    EXPECT_FALSE( converter.from_rgba32f( floats, VK_FORMAT_R8_UNORM, bytes ) );
+    EXPECT_TRUE( converter.downsample( floats, { 4, 4 }, aloe::MipFilter::Box ).empty() );
+
+    ASSERT_FALSE( mock_logger_->get_entries().empty() );
+    EXPECT_EQ( mock_logger_->get_entries().back().level, aloe::LogLevel::Error );
+}
+
+//------------------------------------------------------------------------------
+// Performance Tests
+//------------------------------------------------------------------------------
+
+// Times importing a 4K RGB8 sRGB image with a full mip chain, scalar on one thread against SIMD across workers. The
+// timings are recorded as test properties rather than asserted on, as they depend on the machine. Disabled so the unit
+// suite stays fast, run it with `--gtest_also_run_disabled_tests --gtest_filter=*Performance*`.
+TEST_F( PixelConversionTestFixture, DISABLED_Performance_SimdAndWorkersAgainstScalar ) {
+    constexpr VkExtent2D extent = { 4096, 2048 };
+    const auto rgb = make_bytes( static_cast<size_t>( extent.width ) * extent.height * 3 );
+
+    const auto import = []( const aloe::PixelConverter& converter, std::span<const uint8_t> texels, VkExtent2D size ) {
+        std::vector<float> rgba( static_cast<size_t>( size.width ) * size.height * 4 );
+        converter.to_rgba32f( texels, aloe::PixelLayout::RGB8, true, rgba );
+        converter.premultiply_alpha( rgba );
+
+        std::vector<uint16_t> packed;
+        while ( true ) {
+            std::vector<uint16_t> mip( rgba.size() );
+            converter.float_to_half( rgba, mip );
+            packed.insert( packed.end(), mip.begin(), mip.end() );
+            if ( size.width == 1 && size.height == 1 ) { return packed; }
+
+            rgba = converter.downsample( rgba, size, aloe::MipFilter::Box );
+            size = { std::max( 1u, size.width / 2 ), std::max( 1u, size.height / 2 ) };
+        }
+    };
+
+    const auto time = [&]( const aloe::PixelConverter& converter, std::vector<uint16_t>& packed ) {
+        const auto start = std::chrono::steady_clock::now();
+        packed = import( converter, rgb, extent );
+        return std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start );
+    };
+
+    aloe::ThreadPool workers( std::max( 1u, std::thread::hardware_concurrency() ) );
+    std::vector<uint16_t> scalar_packed;
+    std::vector<uint16_t> simd_packed;
+    const auto scalar_time = time( aloe::PixelConverter( nullptr, false ), scalar_packed );
+    const auto simd_time = time( aloe::PixelConverter( &workers ), simd_packed );
+
+    RecordProperty( "scalar_ms", static_cast<int>( scalar_time.count() ) );
+    RecordProperty( "simd_ms", static_cast<int>( simd_time.count() ) );
+    EXPECT_EQ( scalar_packed, simd_packed );
+}
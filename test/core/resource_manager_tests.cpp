@@ -1,10 +1,17 @@
 #include <aloe/core/Device.h>
 #include <aloe/core/ResourceManager.h>
+#include <aloe/core/TextureCompression.h>
 #include <aloe/util/log.h>
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
 #include <numeric>
+#include <set>
+#include <thread>
 
 class ResourceManagerTestFixture : public ::testing::Test {
 protected:
@@ -103,6 +110,117 @@ TEST_F( ResourceManagerTestFixture, CreateImage_HandlesAreUnique ) {
     EXPECT_NE( resource_manager_->get_image( second ), VK_NULL_HANDLE );
 }
 
+TEST_F( ResourceManagerTestFixture, CreateImage_ArraysCubesVolumesAndMultisampled ) {
+    const auto array_image = resource_manager_->create_image( {
+        .extent = { 64, 64, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+        .array_layers = 4,
+        .name = "ArrayImage",
+    } );
+    EXPECT_NE( array_image.raw, 0 );
+
+    const auto cube_image = resource_manager_->create_image( {
+        .extent = { 64, 64, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+        .array_layers = 6,
+        .flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT,
+        .name = "CubeImage",
+    } );
+    EXPECT_NE( cube_image.raw, 0 );
+
+    const auto volume_image = resource_manager_->create_image( {
+        .type = VK_IMAGE_TYPE_3D,
+        .extent = { 32, 32, 32 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+        .name = "VolumeImage",
+    } );
+    EXPECT_NE( volume_image.raw, 0 );
+
+    // 4x MSAA is guaranteed for colour attachments
+    const auto msaa_image = resource_manager_->create_image( {
+        .extent = { 64, 64, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        .samples = VK_SAMPLE_COUNT_4_BIT,
+        .name = "MultisampledImage",
+    } );
+    ASSERT_NE( msaa_image.raw, 0 );
+
+    // Multisampled images can not be uploaded to directly
+    std::vector<uint8_t> data( 64 * 64 * 4 );
+    EXPECT_EQ( resource_manager_->upload_to_image( msaa_image, data.data(), data.size() ), 0 );
+}
+
+TEST_F( ResourceManagerTestFixture, CreateImage_RejectsInvalidDescriptions ) {
+    // Cube maps must be square, with a multiple of 6 layers
+    EXPECT_EQ( resource_manager_->create_image( { .extent = { 64, 32, 1 },
+                                                  .format = VK_FORMAT_R8G8B8A8_UNORM,
+                                                  .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+                                                  .array_layers = 6,
+                                                  .flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT,
+                                                  .name = "NonSquareCube" } )
+                   .raw,
+               0 );
+    EXPECT_EQ( resource_manager_->create_image( { .extent = { 64, 64, 1 },
+                                                  .format = VK_FORMAT_R8G8B8A8_UNORM,
+                                                  .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+                                                  .array_layers = 4,
+                                                  .flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT,
+                                                  .name = "FourFacedCube" } )
+                   .raw,
+               0 );
+
+    // 3D images can not be arrays, and only 3D images have depth
+    EXPECT_EQ( resource_manager_->create_image( { .type = VK_IMAGE_TYPE_3D,
+                                                  .extent = { 16, 16, 16 },
+                                                  .format = VK_FORMAT_R8G8B8A8_UNORM,
+                                                  .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+                                                  .array_layers = 2,
+                                                  .name = "VolumeArray" } )
+                   .raw,
+               0 );
+    EXPECT_EQ( resource_manager_->create_image( { .extent = { 16, 16, 16 },
+                                                  .format = VK_FORMAT_R8G8B8A8_UNORM,
+                                                  .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+                                                  .name = "DeepImage" } )
+                   .raw,
+               0 );
+
+    // Multisampled images have a single mip
+    EXPECT_EQ( resource_manager_->create_image( { .extent = { 64, 64, 1 },
+                                                  .format = VK_FORMAT_R8G8B8A8_UNORM,
+                                                  .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                                                  .mip_levels = 2,
+                                                  .samples = VK_SAMPLE_COUNT_4_BIT,
+                                                  .name = "MippedMultisampled" } )
+                   .raw,
+               0 );
+}
+
+TEST_F( ResourceManagerTestFixture, UploadImage_ArrayLayersRoundTrip ) {
+    constexpr uint32_t image_size = 8;
+    constexpr uint32_t num_layers = 3;
+
+    std::vector<uint8_t> test_data( image_size * image_size * 4 * num_layers );
+    for ( size_t i = 0; i < test_data.size(); ++i ) { test_data[i] = static_cast<uint8_t>( ( i * 31 + 7 ) % 256 ); }
+
+    const auto image = resource_manager_->create_image( {
+        .extent = { image_size, image_size, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        .array_layers = num_layers,
+        .name = "LayeredImage",
+    } );
+
+    std::vector<uint8_t> read_back( test_data.size() );
+    EXPECT_EQ( resource_manager_->upload_to_image( image, test_data.data(), test_data.size() ), test_data.size() );
+    EXPECT_EQ( resource_manager_->read_from_image( image, read_back.data(), read_back.size() ), read_back.size() );
+    EXPECT_EQ( test_data, read_back );
+}
+
 TEST_F( ResourceManagerTestFixture, FreeBuffer_InvalidatesHandle ) {
     const auto handle = resource_manager_->create_buffer( {
         .size = 1024,
@@ -166,6 +284,80 @@ TEST_F( ResourceManagerTestFixture, UploadBuffer_HostOnlyMemory ) {
     EXPECT_EQ( resource_manager_->upload_to_buffer( buffer, data.data(), data.size() ), 0 );
 }
 
+TEST_F( ResourceManagerTestFixture, ReadBuffer_StagesDeviceLocalMemory ) {
+    std::array<uint32_t, 256> data{};
+    std::iota( data.begin(), data.end(), 0u );
+
+    const auto buffer = resource_manager_->create_buffer( {
+        .size = sizeof( data ),
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .memory_usage = VMA_MEMORY_USAGE_GPU_ONLY,
+        .name = "DeviceLocalBuffer",
+    } );
+    // Only `stage_to_buffer` writes to buffers without host access
+    EXPECT_EQ( resource_manager_->upload_to_buffer( buffer, data.data(), sizeof( data ) ), 0 );
+    ASSERT_EQ( resource_manager_->stage_to_buffer( buffer, data.data(), sizeof( data ) ), sizeof( data ) );
+
+    std::array<uint32_t, 256> read_back{};
+    EXPECT_EQ( resource_manager_->read_from_buffer( buffer, read_back.data(), sizeof( read_back ) ), sizeof( data ) );
+    EXPECT_EQ( read_back, data );
+
+    // A range from the middle of the buffer
+    std::array<uint32_t, 4> range{};
+    EXPECT_EQ( resource_manager_->read_from_buffer( buffer, range.data(), sizeof( range ), 100 * sizeof( uint32_t ) ),
+               sizeof( range ) );
+    EXPECT_EQ( range, ( std::array<uint32_t, 4>{ 100, 101, 102, 103 } ) );
+}
+
+TEST_F( ResourceManagerTestFixture, ReadBuffers_BatchesRanges ) {
+    const auto pool = resource_manager_->create_buffer_pool( {
+        .size = 4096,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .memory_usage = VMA_MEMORY_USAGE_GPU_ONLY,
+        .name = "DeviceLocalPool",
+    } );
+    const auto host_buffer = resource_manager_->create_buffer( {
+        .size = 64,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
+        .name = "HostBuffer",
+    } );
+
+    std::vector<aloe::BufferHandle> buffers = { host_buffer };
+    for ( uint32_t i = 0; i < 3; ++i ) {
+        buffers.push_back( resource_manager_->create_buffer( { .size = 64, .name = "SubBuffer", .parent = pool } ) );
+    }
+
+    for ( uint32_t i = 0; i < buffers.size(); ++i ) {
+        std::array<uint32_t, 16> data;
+        std::ranges::fill( data, i + 1 );
+        ASSERT_EQ( resource_manager_->stage_to_buffer( buffers[i], data.data(), sizeof( data ) ), sizeof( data ) );
+    }
+
+    // Host visible ranges are read directly, the rest share one staging copy
+    std::vector<std::array<uint32_t, 8>> read_back( buffers.size() );
+    std::vector<aloe::BufferReadback> reads;
+    for ( uint32_t i = 0; i < buffers.size(); ++i ) {
+        reads.push_back( { .buffer = buffers[i], .out_data = read_back[i].data(), .size = 32, .offset = 16 } );
+    }
+    // A freed buffer reads nothing, without failing the rest of the batch
+    resource_manager_->free_buffer( buffers.back() );
+
+    EXPECT_EQ( resource_manager_->read_from_buffers( reads ), 32 * ( buffers.size() - 1 ) );
+    for ( uint32_t i = 0; i + 1 < buffers.size(); ++i ) {
+        EXPECT_TRUE( std::ranges::all_of( read_back[i], [&]( uint32_t v ) { return v == i + 1; } ) );
+    }
+    EXPECT_TRUE( std::ranges::all_of( read_back.back(), []( uint32_t v ) { return v == 0; } ) );
+
+    // Empty ranges are skipped, rather than staging and copying no bytes
+    const auto entries = mock_logger_->get_entries().size();
+    const aloe::BufferReadback empty{ .buffer = buffers[1], .out_data = read_back[1].data(), .size = 0 };
+    EXPECT_EQ( resource_manager_->read_from_buffers( { &empty, 1 } ), 0 );
+    EXPECT_EQ( mock_logger_->get_entries().size(), entries );
+
+    resource_manager_->free_buffer( pool );
+}
+
 TEST_F( ResourceManagerTestFixture, UploadImage_WriteAndReadBack ) {
     // Create test pattern with non-zero data
     std::array<uint8_t, 16 * 16 * 4> test_data{};
@@ -188,6 +380,261 @@ TEST_F( ResourceManagerTestFixture, UploadImage_WriteAndReadBack ) {
     EXPECT_EQ( test_data, read_back_data );
 }
 
+TEST_F( ResourceManagerTestFixture, UploadImage_GeneratesMipChain ) {
+    constexpr uint32_t image_size = 16;
+    constexpr uint32_t mip_levels = 5;
+
+    // A 1px checkerboard averages to mid-grey at every level below the first
+    std::vector<uint8_t> test_data( image_size * image_size * 4 );
+    for ( uint32_t y = 0; y < image_size; ++y ) {
+        for ( uint32_t x = 0; x < image_size; ++x ) {
+            const uint8_t value = ( x + y ) % 2 == 0 ? 255 : 0;
+            std::fill_n( test_data.begin() + ( y * image_size + x ) * 4, 4, value );
+        }
+    }
+
+    const auto image = resource_manager_->create_image( {
+        .extent = { image_size, image_size, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .mip_levels = mip_levels,
+        .name = "MippedImage",
+    } );
+    ASSERT_EQ( resource_manager_->upload_to_image( image, test_data.data(), test_data.size() ), test_data.size() );
+
+    const auto readback = resource_manager_->create_buffer( {
+        .size = 4,
+        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
+        .name = "MipReadback",
+    } );
+
+    // Read back the single texel of the last level
+    const auto queue = device_->find_queues( VK_QUEUE_TRANSFER_BIT ).front();
+    device_->immediate_submit( queue, [&]( VkCommandBuffer cmd ) {
+        const VkBufferImageCopy region{
+            .imageSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                  .mipLevel = mip_levels - 1,
+                                  .baseArrayLayer = 0,
+                                  .layerCount = 1 },
+            .imageExtent = { 1, 1, 1 },
+        };
+        vkCmdCopyImageToBuffer( cmd,
+                                resource_manager_->get_image( image ),
+                                VK_IMAGE_LAYOUT_GENERAL,
+                                resource_manager_->get_buffer( readback ),
+                                1,
+                                &region );
+    } );
+
+    std::array<uint8_t, 4> texel{};
+    ASSERT_EQ( resource_manager_->read_from_buffer( readback, texel.data(), texel.size() ), texel.size() );
+    for ( const auto channel : texel ) { EXPECT_NEAR( channel, 128, 2 ); }
+}
+
+TEST_F( ResourceManagerTestFixture, GenerateMips_RequiresTransferSource ) {
+    const auto image = resource_manager_->create_image( {
+        .extent = { 16, 16, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .mip_levels = 5,
+        .name = "NoTransferSource",
+    } );
+
+    EXPECT_FALSE( resource_manager_->generate_mips( image ) );
+}
+
+TEST_F( ResourceManagerTestFixture, GenerateMips_UploadsWarnOnce ) {
+    const auto image = resource_manager_->create_image( {
+        .extent = { 16, 16, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .mip_levels = 5,
+        .name = "NoTransferSourceUploads",
+    } );
+
+    // Mip 0 is still uploaded, the rest of the chain is left alone
+    const std::vector<uint8_t> texels( 16 * 16 * 4, 0xff );
+    for ( int i = 0; i < 3; ++i ) {
+        EXPECT_EQ( resource_manager_->upload_to_image( image, texels.data(), texels.size() ), texels.size() );
+    }
+
+    const auto warnings = std::ranges::count_if( mock_logger_->get_entries(), []( const auto& entry ) {
+        return entry.level == aloe::LogLevel::Warn && entry.message.contains( "NoTransferSourceUploads" );
+    } );
+    EXPECT_EQ( warnings, 1 );
+}
+
+TEST_F( ResourceManagerTestFixture, UploadBuffer_AtOffset ) {
+    const auto buffer = resource_manager_->create_buffer( {
+        .size = 16,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
+        .name = "OffsetBuffer",
+    } );
+
+    const std::array<uint8_t, 16> zeroes{};
+    const std::array<uint8_t, 8> data = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    ASSERT_EQ( resource_manager_->upload_to_buffer( buffer, zeroes.data(), zeroes.size() ), zeroes.size() );
+
+    // Clamped to the end of the buffer
+    EXPECT_EQ( resource_manager_->upload_to_buffer( buffer, data.data(), data.size(), 12 ), 4 );
+
+    std::array<uint8_t, 8> read_back{};
+    EXPECT_EQ( resource_manager_->read_from_buffer( buffer, read_back.data(), read_back.size(), 8 ), 8 );
+    EXPECT_EQ( read_back, ( std::array<uint8_t, 8>{ 0, 0, 0, 0, 1, 2, 3, 4 } ) );
+
+    EXPECT_EQ( resource_manager_->upload_to_buffer( buffer, data.data(), data.size(), 16 ), 0 );
+    EXPECT_EQ( mock_logger_->get_entries().back().level, aloe::LogLevel::Error );
+}
+
+TEST_F( ResourceManagerTestFixture, UploadImageRegions_BatchesDirtyRects ) {
+    constexpr uint32_t image_size = 16;
+    const auto image = resource_manager_->create_image( {
+        .extent = { image_size, image_size, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        .name = "DirtyRectImage",
+    } );
+
+    const std::vector<uint32_t> cleared( image_size * image_size, 0 );
+    ASSERT_EQ( resource_manager_->upload_to_image( image, cleared.data(), cleared.size() * 4 ), cleared.size() * 4 );
+
+    // Two rects taken out of a full size copy of the texture, addressed with its row pitch
+    std::vector<uint32_t> source( image_size * image_size );
+    std::iota( source.begin(), source.end(), 1u );
+    auto rect = [&]( int32_t x, int32_t y, uint32_t width, uint32_t height ) {
+        return aloe::ImageRegion{
+            .offset = { x, y, 0 },
+            .extent = { width, height, 1 },
+            .data_offset = ( y * image_size + x ) * 4u,
+            .row_length = image_size,
+        };
+    };
+    const std::array regions = { rect( 1, 2, 4, 3 ), rect( 10, 8, 5, 6 ) };
+    ASSERT_EQ( resource_manager_->upload_image_regions( image, source.data(), source.size() * 4, regions ),
+               source.size() * 4 );
+
+    std::vector<uint32_t> read_back( image_size * image_size );
+    ASSERT_EQ( resource_manager_->read_from_image( image, read_back.data(), read_back.size() * 4 ),
+               read_back.size() * 4 );
+
+    for ( uint32_t y = 0; y < image_size; ++y ) {
+        for ( uint32_t x = 0; x < image_size; ++x ) {
+            const bool dirty = std::ranges::any_of( regions, [&]( const aloe::ImageRegion& region ) {
+                return x >= uint32_t( region.offset.x ) && x < region.offset.x + region.extent.width &&
+                    y >= uint32_t( region.offset.y ) && y < region.offset.y + region.extent.height;
+            } );
+            EXPECT_EQ( read_back[y * image_size + x], dirty ? source[y * image_size + x] : 0 );
+        }
+    }
+
+    // Reading the same rects back leaves the rest of the destination alone
+    std::vector<uint32_t> rects( image_size * image_size, 0xFFFFFFFF );
+    ASSERT_EQ( resource_manager_->read_image_regions( image, rects.data(), rects.size() * 4, regions ),
+               rects.size() * 4 );
+    EXPECT_EQ( rects[2 * image_size + 1], source[2 * image_size + 1] );
+    EXPECT_EQ( rects[13 * image_size + 14], source[13 * image_size + 14] );
+    EXPECT_EQ( rects[0], 0xFFFFFFFF );
+}
+
+TEST_F( ResourceManagerTestFixture, UploadImageRegions_TargetsMipAndLayer ) {
+    const auto image = resource_manager_->create_image( {
+        .extent = { 8, 8, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        .mip_levels = 2,
+        .array_layers = 2,
+        .name = "RegionMipLayerImage",
+    } );
+
+    const std::vector<uint32_t> cleared( 8 * 8 * 2, 0 );
+    ASSERT_EQ( resource_manager_->upload_to_image( image, cleared.data(), cleared.size() * 4 ), cleared.size() * 4 );
+
+    const std::array<uint32_t, 4> texels = { 1, 2, 3, 4 };
+    const aloe::ImageRegion region{
+        .offset = { 2, 2, 0 },
+        .extent = { 2, 2, 1 },
+        .mip_level = 1,
+        .base_array_layer = 1,
+    };
+    ASSERT_EQ( resource_manager_->upload_image_regions( image, texels.data(), sizeof( texels ), { &region, 1 } ),
+               sizeof( texels ) );
+
+    // The whole of mip 1, layer 1
+    std::array<uint32_t, 16> mip{};
+    const aloe::ImageRegion whole_mip{ .extent = { 4, 4, 1 }, .mip_level = 1, .base_array_layer = 1 };
+    ASSERT_EQ( resource_manager_->read_image_regions( image, mip.data(), sizeof( mip ), { &whole_mip, 1 } ),
+               sizeof( mip ) );
+    EXPECT_EQ( mip, ( std::array<uint32_t, 16>{ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 0, 0, 3, 4 } ) );
+}
+
+TEST_F( ResourceManagerTestFixture, UploadImageRegions_RejectsOutOfBounds ) {
+    const auto image = resource_manager_->create_image( {
+        .extent = { 8, 8, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        .name = "RegionBoundsImage",
+    } );
+
+    const std::array<uint32_t, 16> texels{};
+    const std::array regions = {
+        aloe::ImageRegion{ .offset = { 6, 6, 0 }, .extent = { 4, 4, 1 } },// Past the edge of the image
+        aloe::ImageRegion{ .extent = { 4, 4, 1 }, .mip_level = 1 },       // No such mip
+        aloe::ImageRegion{ .extent = { 4, 5, 1 } },                       // Past the end of the data
+        aloe::ImageRegion{ .extent = { 4, 4, 1 }, .row_length = 2 },      // Rows overlap
+    };
+    for ( const auto& region : regions ) {
+        EXPECT_EQ( resource_manager_->upload_image_regions( image, texels.data(), sizeof( texels ), { &region, 1 } ),
+                   0 );
+        EXPECT_EQ( mock_logger_->get_entries().back().level, aloe::LogLevel::Error );
+    }
+}
+
+TEST_F( ResourceManagerTestFixture, UploadImageRegions_RejectsDepthAndLayered3DRegions ) {
+    const auto depth = resource_manager_->create_image( {
+        .extent = { 4, 4, 1 },
+        .format = VK_FORMAT_D32_SFLOAT,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+        .name = "RegionDepthImage",
+    } );
+    const auto volume = resource_manager_->create_image( {
+        .type = VK_IMAGE_TYPE_3D,
+        .extent = { 4, 4, 4 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        .name = "RegionVolumeImage",
+    } );
+
+    const std::array<uint32_t, 64> texels{};
+    const aloe::ImageRegion whole{ .extent = { 4, 4, 1 } };
+    EXPECT_EQ( resource_manager_->upload_image_regions( depth, texels.data(), sizeof( texels ), { &whole, 1 } ),
+               0 );
+    EXPECT_EQ( mock_logger_->get_entries().back().level, aloe::LogLevel::Error );
+
+    // Slices of a 3D image are addressed by the region's depth, not by layers
+    const aloe::ImageRegion layered{ .extent = { 4, 4, 2 }, .layer_count = 2 };
+    EXPECT_EQ( resource_manager_->upload_image_regions( volume, texels.data(), sizeof( texels ), { &layered, 1 } ),
+               0 );
+    EXPECT_EQ( mock_logger_->get_entries().back().level, aloe::LogLevel::Error );
+}
+
+TEST_F( ResourceManagerTestFixture, UploadMips_RejectsMipsPastTheData ) {
+    const auto image = resource_manager_->create_image( {
+        .extent = { 8, 8, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        .mip_levels = 2,
+        .name = "TruncatedMipsImage",
+    } );
+
+    // Mip 1 starts within the data, but its 64 bytes run past the end of it
+    const std::vector<uint8_t> data( 8 * 8 * 4 + 32 );
+    const std::array<VkDeviceSize, 2> mip_offsets = { 0, 8 * 8 * 4 };
+    EXPECT_EQ( resource_manager_->upload_mips_to_image( image, data.data(), data.size(), mip_offsets ), 0 );
+    EXPECT_EQ( mock_logger_->get_entries().back().level, aloe::LogLevel::Error );
+}
+
 //------------------------------------------------------------------------------
 // Error Handling & Validation Tests
 //------------------------------------------------------------------------------
@@ -436,6 +883,1126 @@ TEST_F( ResourceManagerTestFixture, ImageHandle_ValidatesVersion ) {
     EXPECT_EQ( resource_manager_->read_from_image( handle_a, invalid_read_data.data(), data_size ), 0 );
 }
 
+//------------------------------------------------------------------------------
+// Sub-allocation Tests
+//------------------------------------------------------------------------------
+
+TEST_F( ResourceManagerTestFixture, SubAllocation_SharesBackingBuffer ) {
+    constexpr size_t num_buffers = 64;
+    constexpr VkDeviceSize buffer_size = 256;
+
+    const auto pool = resource_manager_->create_buffer_pool( {
+        .size = num_buffers * buffer_size,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+        .name = "TestPool",
+    } );
+    ASSERT_NE( pool.raw, 0 );
+
+    std::vector<aloe::BufferHandle> handles;
+    for ( size_t i = 0; i < num_buffers; ++i ) {
+        const auto handle = resource_manager_->create_buffer( {
+            .size = buffer_size,
+            .name = "SubBuffer",
+            .parent = pool,
+        } );
+        ASSERT_NE( handle.raw, 0 );
+        handles.push_back( handle );
+
+        const auto range = resource_manager_->get_buffer_range( handle );
+        EXPECT_EQ( range.buffer, resource_manager_->get_buffer( pool ) );
+        EXPECT_EQ( range.size, buffer_size );
+
+        std::array<uint32_t, buffer_size / sizeof( uint32_t )> data;
+        std::ranges::fill( data, static_cast<uint32_t>( i ) );
+        EXPECT_EQ( resource_manager_->upload_to_buffer( handle, data.data(), buffer_size ), buffer_size );
+    }
+
+    // Every buffer is backed by the one allocation of the pool
+    VmaTotalStatistics stats;
+    vmaCalculateStatistics( device_->allocator(), &stats );
+    EXPECT_EQ( stats.total.statistics.allocationCount, 1 );
+
+    // Writes to one sub-allocation must not have clobbered its neighbours
+    for ( size_t i = 0; i < num_buffers; ++i ) {
+        std::array<uint32_t, buffer_size / sizeof( uint32_t )> read_back{};
+        EXPECT_EQ( resource_manager_->read_from_buffer( handles[i], read_back.data(), buffer_size ), buffer_size );
+        EXPECT_TRUE( std::ranges::all_of( read_back, [&]( uint32_t v ) { return v == i; } ) );
+    }
+
+    // No space remains, so further sub-allocations fail
+    EXPECT_EQ( resource_manager_->create_buffer( { .size = buffer_size, .name = "Overflow", .parent = pool } ).raw, 0 );
+
+    // Returning a range makes it available again
+    resource_manager_->free_buffer( handles.back() );
+    EXPECT_NE( resource_manager_->create_buffer( { .size = buffer_size, .name = "Reused", .parent = pool } ).raw, 0 );
+}
+
+TEST_F( ResourceManagerTestFixture, SubAllocation_FreeingPoolFreesChildren ) {
+    const auto pool = resource_manager_->create_buffer_pool( {
+        .size = 4096,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .name = "TestPool",
+    } );
+    const auto child = resource_manager_->create_buffer( { .size = 1024, .name = "Child", .parent = pool } );
+    ASSERT_NE( child.raw, 0 );
+
+    resource_manager_->free_buffer( pool );
+    EXPECT_EQ( resource_manager_->get_buffer( pool ), VK_NULL_HANDLE );
+    EXPECT_EQ( resource_manager_->get_buffer( child ), VK_NULL_HANDLE );
+}
+
+TEST_F( ResourceManagerTestFixture, SubAllocation_FailsWithoutPool ) {
+    const auto buffer = resource_manager_->create_buffer( {
+        .size = 1024,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .name = "NotAPool",
+    } );
+
+    EXPECT_EQ( resource_manager_->create_buffer( { .size = 64, .name = "Child", .parent = buffer } ).raw, 0 );
+}
+
+TEST_F( ResourceManagerTestFixture, BufferAddress_RequiresDeviceOptIn ) {
+    const auto buffer = resource_manager_->create_buffer( {
+        .size = 1024,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .name = "NoAddressBuffer",
+    } );
+    ASSERT_NE( buffer.raw, 0 );
+
+    EXPECT_EQ( resource_manager_->get_buffer_address( buffer ), 0 );
+
+    const auto& entries = mock_logger_->get_entries();
+    ASSERT_FALSE( entries.empty() );
+    EXPECT_EQ( entries.back().level, aloe::LogLevel::Error );
+}
+
+//------------------------------------------------------------------------------
+// Linear Allocator Tests
+//------------------------------------------------------------------------------
+
+TEST_F( ResourceManagerTestFixture, LinearAllocator_AllocationsAreAlignedAndDisjoint ) {
+    ASSERT_TRUE( resource_manager_->create_linear_allocator( { .size_per_frame = 4096, .frames_in_flight = 2 } ) );
+
+    const auto first = resource_manager_->allocate_transient( 12 );
+    const auto second = resource_manager_->allocate_transient( 100, 64 );
+    ASSERT_TRUE( first.has_value() );
+    ASSERT_TRUE( second.has_value() );
+
+    EXPECT_EQ( first->buffer, second->buffer );
+    EXPECT_EQ( second->offset % 64, 0 );
+    EXPECT_GE( second->offset, first->offset + first->size );
+
+    // The shader handle addresses the same range as the host pointer
+    EXPECT_EQ( second->gpu_handle.offset, second->offset );
+    EXPECT_EQ( second->gpu_handle.size, 100 );
+    EXPECT_EQ( static_cast<uint8_t*>( second->data ) - static_cast<uint8_t*>( first->data ),
+               static_cast<std::ptrdiff_t>( second->offset - first->offset ) );
+
+    // Writes through the mapped pointer land in the frame buffer
+    std::array<uint32_t, 25> data;
+    std::iota( data.begin(), data.end(), 0 );
+    std::memcpy( second->data, data.data(), sizeof( data ) );
+
+    std::vector<uint32_t> read_back( second->offset / sizeof( uint32_t ) + data.size() );
+    resource_manager_->read_from_buffer( second->buffer, read_back.data(), read_back.size() * sizeof( uint32_t ) );
+    EXPECT_TRUE( std::equal( data.begin(), data.end(), read_back.end() - data.size() ) );
+}
+
+TEST_F( ResourceManagerTestFixture, LinearAllocator_ExhaustsAndRecyclesFrameSlots ) {
+    ASSERT_TRUE( resource_manager_->create_linear_allocator( { .size_per_frame = 1024, .frames_in_flight = 2 } ) );
+
+    const auto frame_0 = resource_manager_->allocate_transient( 1024 );
+    ASSERT_TRUE( frame_0.has_value() );
+    EXPECT_FALSE( resource_manager_->allocate_transient( 1 ).has_value() );
+
+    // The next frame uses a different slot
+    resource_manager_->next_frame();
+    const auto frame_1 = resource_manager_->allocate_transient( 512 );
+    ASSERT_TRUE( frame_1.has_value() );
+    EXPECT_NE( frame_1->buffer, frame_0->buffer );
+    EXPECT_EQ( frame_1->offset, 0 );
+
+    // After `frames_in_flight` frames the first slot is reset and reused
+    resource_manager_->next_frame();
+    const auto frame_2 = resource_manager_->allocate_transient( 1024 );
+    ASSERT_TRUE( frame_2.has_value() );
+    EXPECT_EQ( frame_2->buffer, frame_0->buffer );
+    EXPECT_EQ( frame_2->offset, 0 );
+}
+
+TEST_F( ResourceManagerTestFixture, LinearAllocator_FailsWithoutAllocator ) {
+    EXPECT_FALSE( resource_manager_->allocate_transient( 64 ).has_value() );
+    EXPECT_FALSE( resource_manager_->create_linear_allocator( { .frames_in_flight = 0 } ) );
+}
+
+TEST_F( ResourceManagerTestFixture, LinearAllocator_RangesFitInGpuBufferHandles ) {
+    // Offsets and sizes are handed to shaders as 32 bit fields, so larger slots are refused before allocating them
+    const VkDeviceSize too_large = VkDeviceSize{ std::numeric_limits<uint32_t>::max() } + 1;
+    EXPECT_FALSE( resource_manager_->create_linear_allocator( { .size_per_frame = too_large } ) );
+
+    ASSERT_TRUE( resource_manager_->create_linear_allocator( { .size_per_frame = 1024, .frames_in_flight = 2 } ) );
+    EXPECT_FALSE( resource_manager_->allocate_transient( too_large ).has_value() );
+    EXPECT_FALSE( resource_manager_->allocate_transient( 16, VkDeviceSize{ 1 } << 40 ).has_value() );
+
+    // Nothing was handed out by the failed allocations
+    const auto allocation = resource_manager_->allocate_transient( 1024 );
+    ASSERT_TRUE( allocation.has_value() );
+    EXPECT_EQ( allocation->gpu_handle.size, 1024 );
+}
+
+//------------------------------------------------------------------------------
+// Memory Statistics Tests
+//------------------------------------------------------------------------------
+
+TEST_F( ResourceManagerTestFixture, MemoryStatistics_TracksAllocations ) {
+    auto total_allocation_bytes = [&]() {
+        VkDeviceSize total = 0;
+        for ( const auto& heap : resource_manager_->memory_statistics().heaps ) { total += heap.allocation_bytes; }
+        return total;
+    };
+
+    const auto& initial = resource_manager_->memory_statistics();
+    ASSERT_FALSE( initial.heaps.empty() );
+    EXPECT_TRUE( std::ranges::all_of( initial.heaps, []( const auto& heap ) { return heap.budget > 0; } ) );
+    const auto initial_bytes = total_allocation_bytes();
+
+    constexpr VkDeviceSize buffer_size = 4 * 1024 * 1024;
+    const auto buffer = resource_manager_->create_buffer( {
+        .size = buffer_size,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .name = "BudgetedBuffer",
+    } );
+    ASSERT_NE( buffer.raw, 0 );
+
+    // Statistics are refreshed once per frame
+    resource_manager_->next_frame();
+    EXPECT_EQ( resource_manager_->memory_statistics().frame_index, resource_manager_->frame_index() );
+    EXPECT_GE( total_allocation_bytes(), initial_bytes + buffer_size );
+
+    resource_manager_->free_buffer( buffer );
+    resource_manager_->update_memory_statistics();
+    EXPECT_EQ( total_allocation_bytes(), initial_bytes );
+}
+
+TEST_F( ResourceManagerTestFixture, MemoryStatistics_WarnsOncePerThresholdCrossing ) {
+    const auto buffer = resource_manager_->create_buffer( {
+        .size = 1024 * 1024,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .name = "BudgetedBuffer",
+    } );
+
+    auto count_budget_warnings = [&]() {
+        return std::ranges::count_if( mock_logger_->get_entries(), []( const auto& entry ) {
+            return entry.level == aloe::LogLevel::Warn && entry.message.contains( "budget" );
+        } );
+    };
+
+    // Any usage crosses a zero threshold
+    resource_manager_->set_budget_warning_threshold( 0.0f );
+    resource_manager_->next_frame();
+    const auto warnings = count_budget_warnings();
+    EXPECT_GT( warnings, 0 );
+
+    // Staying above the threshold does not warn again
+    resource_manager_->next_frame();
+    EXPECT_EQ( count_budget_warnings(), warnings );
+
+    resource_manager_->free_buffer( buffer );
+}
+
+TEST_F( ResourceManagerTestFixture, MemoryPool_CapsMemoryAndReportsStatistics ) {
+    constexpr VkDeviceSize block_size = 1024 * 1024;
+    const auto pool = resource_manager_->create_memory_pool( {
+        .buffer_usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .block_size = block_size,
+        .max_block_count = 1,
+        .name = "CappedPool",
+    } );
+    ASSERT_NE( pool.raw, 0 );
+
+    std::vector<aloe::BufferHandle> buffers;
+    for ( int i = 0; i < 2; ++i ) {
+        buffers.push_back( resource_manager_->create_buffer( {
+            .size = block_size / 4,
+            .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            .memory_pool = pool,
+            .name = "PooledBuffer",
+        } ) );
+        ASSERT_NE( buffers.back().raw, 0 );
+    }
+
+    // The pool can not grow past its single block
+    EXPECT_EQ( resource_manager_->create_buffer( {
+                                                     .size = block_size * 3 / 4,
+                                                     .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                     .memory_pool = pool,
+                                                     .name = "OverflowBuffer",
+                                                 } )
+                   .raw,
+               0 );
+
+    resource_manager_->update_memory_statistics();
+    const auto& pools = resource_manager_->memory_statistics().pools;
+    ASSERT_EQ( pools.size(), 1 );
+    EXPECT_EQ( pools[0].pool, pool );
+    EXPECT_EQ( pools[0].block_count, 1 );
+    EXPECT_EQ( pools[0].block_bytes, block_size );
+    EXPECT_EQ( pools[0].allocation_count, 2 );
+
+    // Pools outlive the resources allocated from them
+    EXPECT_FALSE( resource_manager_->free_memory_pool( pool ) );
+    for ( const auto buffer : buffers ) { resource_manager_->free_buffer( buffer ); }
+    EXPECT_TRUE( resource_manager_->free_memory_pool( pool ) );
+}
+
+TEST_F( ResourceManagerTestFixture, MemoryPool_LinearImagePool ) {
+    const auto pool = resource_manager_->create_memory_pool( {
+        .image_usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        .block_size = 4 * 1024 * 1024,
+        .algorithm = aloe::MemoryPoolAlgorithm::Linear,
+        .name = "LinearImagePool",
+    } );
+    ASSERT_NE( pool.raw, 0 );
+
+    std::array<uint8_t, 16 * 16 * 4> data{};
+    std::iota( data.begin(), data.end(), 0 );
+    std::array<uint8_t, 16 * 16 * 4> read_back{};
+
+    const auto image = resource_manager_->create_image( {
+        .extent = { 16, 16, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        .memory_pool = pool,
+        .name = "PooledImage",
+    } );
+    ASSERT_NE( image.raw, 0 );
+
+    EXPECT_EQ( resource_manager_->upload_to_image( image, data.data(), data.size() ), data.size() );
+    EXPECT_EQ( resource_manager_->read_from_image( image, read_back.data(), read_back.size() ), read_back.size() );
+    EXPECT_EQ( data, read_back );
+
+    // A pool must be given a usage to pick its memory type
+    EXPECT_EQ( resource_manager_->create_memory_pool( { .name = "NoUsage" } ).raw, 0 );
+}
+
+TEST_F( ResourceManagerTestFixture, MemoryAccounts_TrackNamesAndCategories ) {
+    const auto find = []( const std::vector<aloe::MemoryAccount>& accounts, std::string_view key ) {
+        const auto iter = std::ranges::find( accounts, key, &aloe::MemoryAccount::key );
+        return iter != accounts.end() ? *iter : aloe::MemoryAccount{};
+    };
+
+    const aloe::BufferDesc desc = {
+        .size = 64 * 1024,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .name = "AccountedBuffer",
+        .category = "Terrain",
+    };
+    const auto first = resource_manager_->create_buffer( desc );
+    const auto second = resource_manager_->create_buffer( desc );
+    const auto image = resource_manager_->create_image( {
+        .extent = { 32, 32, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+        .name = "AccountedImage",
+        .category = "Terrain",
+    } );
+    ASSERT_NE( first.raw, 0 );
+    ASSERT_NE( second.raw, 0 );
+    ASSERT_NE( image.raw, 0 );
+
+    auto accounts = resource_manager_->memory_accounts();
+    const auto buffers = find( accounts.names, "AccountedBuffer" );
+    const auto images = find( accounts.names, "AccountedImage" );
+    EXPECT_EQ( buffers.live_resources, 2 );
+    EXPECT_GE( buffers.bytes, 2 * desc.size );
+    EXPECT_GE( images.bytes, 32 * 32 * 4 );
+
+    const auto terrain = find( accounts.categories, "Terrain" );
+    EXPECT_EQ( terrain.live_resources, 3 );
+    EXPECT_EQ( terrain.bytes, buffers.bytes + images.bytes );
+
+    // Freeing lowers the current bytes but not the peak
+    resource_manager_->free_buffer( first );
+    resource_manager_->free_image( image );
+    accounts = resource_manager_->memory_accounts();
+    EXPECT_EQ( find( accounts.names, "AccountedBuffer" ).bytes, buffers.bytes / 2 );
+    EXPECT_EQ( find( accounts.categories, "Terrain" ).live_resources, 1 );
+    EXPECT_EQ( find( accounts.categories, "Terrain" ).peak_bytes, terrain.bytes );
+    EXPECT_EQ( find( accounts.categories, "Terrain" ).total_resources, 3 );
+
+    resource_manager_->free_buffer( second );
+    EXPECT_EQ( find( resource_manager_->memory_accounts().categories, "Terrain" ).bytes, 0 );
+}
+
+TEST_F( ResourceManagerTestFixture, MemoryAccounts_ReportsLeaksOnDestruction ) {
+    const auto handle = resource_manager_->create_buffer( {
+        .size = 1024,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .name = "LeakedBuffer",
+        .category = "Leaks",
+    } );
+    ASSERT_NE( handle.raw, 0 );
+
+    resource_manager_.reset();
+    device_.reset();
+
+    const auto& entries = mock_logger_->get_entries();
+    EXPECT_TRUE( std::ranges::any_of( entries, []( const auto& entry ) {
+        return entry.level == aloe::LogLevel::Warn && entry.message.find( "LeakedBuffer (Leaks)" ) != std::string::npos;
+    } ) );
+}
+
+//------------------------------------------------------------------------------
+// Defragmentation Tests
+//------------------------------------------------------------------------------
+
+TEST_F( ResourceManagerTestFixture, Defragment_PreservesHandlesAndContents ) {
+    constexpr size_t num_buffers = 64;
+    constexpr VkDeviceSize buffer_size = 64 * 1024;
+
+    std::vector<aloe::BufferHandle> handles;
+    for ( size_t i = 0; i < num_buffers; ++i ) {
+        handles.push_back( resource_manager_->create_buffer( {
+            .size = buffer_size,
+            .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
+            .name = "FragmentedBuffer",
+        } ) );
+    }
+
+    // Free every other buffer to leave holes between the survivors
+    std::vector<aloe::BufferHandle> survivors;
+    std::vector<uint64_t> bindings;
+    for ( size_t i = 0; i < num_buffers; ++i ) {
+        if ( i % 2 == 0 ) {
+            resource_manager_->free_buffer( handles[i] );
+            continue;
+        }
+
+        std::vector<uint32_t> data( buffer_size / sizeof( uint32_t ), static_cast<uint32_t>( i ) );
+        resource_manager_->upload_to_buffer( handles[i], data.data(), buffer_size );
+
+        const auto binding = resource_manager_->bind_resource( aloe::usage( handles[i], aloe::ComputeStorageRead ) );
+        ASSERT_TRUE( binding.has_value() );
+
+        survivors.push_back( handles[i] );
+        bindings.push_back( *binding );
+    }
+
+    aloe::DefragmentationResult result;
+    for ( int step = 0; step < 100 && !result.complete; ++step ) {
+        result = resource_manager_->defragment( std::chrono::milliseconds( 1 ) );
+    }
+    EXPECT_TRUE( result.complete );
+
+    // Handles, descriptor slots and contents all survive any moves
+    for ( size_t i = 0; i < survivors.size(); ++i ) {
+        const auto binding = resource_manager_->bind_resource( aloe::usage( survivors[i], aloe::ComputeStorageRead ) );
+        ASSERT_TRUE( binding.has_value() );
+        EXPECT_EQ( *binding, bindings[i] );
+
+        std::vector<uint32_t> read_back( buffer_size / sizeof( uint32_t ) );
+        EXPECT_EQ( resource_manager_->read_from_buffer( survivors[i], read_back.data(), buffer_size ), buffer_size );
+        EXPECT_TRUE( std::ranges::all_of( read_back, [&]( uint32_t v ) { return v == 2 * i + 1; } ) );
+    }
+}
+
+TEST_F( ResourceManagerTestFixture, Defragment_KeepsImageLayouts ) {
+    constexpr uint32_t num_images = 32;
+    constexpr uint32_t image_size = 64;
+    const aloe::ImageDesc desc{
+        .extent = { image_size, image_size, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .name = "FragmentedImage",
+    };
+
+    std::vector<aloe::ImageHandle> handles;
+    for ( uint32_t i = 0; i < num_images; ++i ) { handles.push_back( resource_manager_->create_image( desc ) ); }
+
+    // Free every other image to leave holes between the survivors
+    std::vector<aloe::ImageHandle> survivors;
+    for ( uint32_t i = 0; i < num_images; ++i ) {
+        if ( i % 2 == 0 ) {
+            resource_manager_->free_image( handles[i] );
+            continue;
+        }
+
+        std::vector<uint8_t> texels( image_size * image_size * 4, static_cast<uint8_t>( i ) );
+        ASSERT_EQ( resource_manager_->upload_to_image( handles[i], texels.data(), texels.size() ), texels.size() );
+        survivors.push_back( handles[i] );
+    }
+    // Never written to, so it has no layout to carry over
+    const auto unwritten = resource_manager_->create_image( desc );
+    ASSERT_NE( unwritten.raw, 0 );
+
+    const auto queue = device_->find_queues( VK_QUEUE_TRANSFER_BIT ).front();
+    auto transition = [&]( aloe::ImageHandle image, VkImageLayout from, VkImageLayout to ) {
+        device_->immediate_submit( queue, [&]( VkCommandBuffer cmd ) {
+            const VkImageMemoryBarrier barrier{ .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                                                .srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+                                                .dstAccessMask = VK_ACCESS_MEMORY_READ_BIT,
+                                                .oldLayout = from,
+                                                .newLayout = to,
+                                                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                                .image = resource_manager_->get_image( image ),
+                                                .subresourceRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                                                      .baseMipLevel = 0,
+                                                                      .levelCount = 1,
+                                                                      .baseArrayLayer = 0,
+                                                                      .layerCount = 1 } };
+            vkCmdPipelineBarrier( cmd,
+                                  VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                  VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                  0,
+                                  0,
+                                  nullptr,
+                                  0,
+                                  nullptr,
+                                  1,
+                                  &barrier );
+        } );
+        resource_manager_->set_image_layout( image, to );
+    };
+
+    // Half of the survivors are left ready to be sampled, as a frame would leave them
+    for ( size_t i = 0; i < survivors.size(); i += 2 ) {
+        transition( survivors[i], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+    }
+
+    aloe::DefragmentationResult result;
+    for ( int step = 0; step < 100 && !result.complete; ++step ) {
+        result = resource_manager_->defragment( std::chrono::milliseconds( 1 ) );
+    }
+    EXPECT_TRUE( result.complete );
+    EXPECT_EQ( resource_manager_->image_layout( unwritten ), VK_IMAGE_LAYOUT_UNDEFINED );
+
+    // Moved images are left in the layout they rested in, with their contents intact
+    for ( size_t i = 0; i < survivors.size(); ++i ) {
+        const auto sampled = i % 2 == 0;
+        EXPECT_EQ( resource_manager_->image_layout( survivors[i] ),
+                   sampled ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL );
+        if ( sampled ) {
+            transition( survivors[i], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL );
+        }
+
+        std::vector<uint8_t> read_back( image_size * image_size * 4 );
+        EXPECT_EQ( resource_manager_->read_from_image( survivors[i], read_back.data(), read_back.size() ),
+                   read_back.size() );
+        const auto value = static_cast<uint8_t>( 2 * i + 1 );
+        EXPECT_TRUE( std::ranges::all_of( read_back, [&]( uint8_t v ) { return v == value; } ) );
+    }
+}
+
+TEST_F( ResourceManagerTestFixture, Defragment_NoOpWithoutFragmentation ) {
+    const auto buffer = resource_manager_->create_buffer( {
+        .size = 1024,
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .name = "LoneBuffer",
+    } );
+    ASSERT_NE( buffer.raw, 0 );
+
+    const auto result = resource_manager_->defragment( std::chrono::milliseconds( 10 ) );
+    EXPECT_TRUE( result.complete );
+    EXPECT_EQ( result.moved_allocations, 0 );
+}
+
+//------------------------------------------------------------------------------
+// Sampler & Sampled Image Tests
+//------------------------------------------------------------------------------
+
+TEST_F( ResourceManagerTestFixture, CreateSampler_DeduplicatesDescriptions ) {
+    const auto linear = resource_manager_->create_sampler( {} );
+    const auto linear_again = resource_manager_->create_sampler( {} );
+    const auto nearest = resource_manager_->create_sampler( {
+        .mag_filter = VK_FILTER_NEAREST,
+        .min_filter = VK_FILTER_NEAREST,
+        .mipmap_mode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+    } );
+
+    ASSERT_NE( linear.raw, 0 );
+    ASSERT_NE( nearest.raw, 0 );
+    EXPECT_EQ( linear, linear_again );
+    EXPECT_NE( linear, nearest );
+}
+
+TEST_F( ResourceManagerTestFixture, BindImage_RoutesUsagesToTheirHeaps ) {
+    const auto image = resource_manager_->create_image( {
+        .extent = { 16, 16, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+        .name = "MultiUseImage",
+    } );
+    ASSERT_NE( image.raw, 0 );
+
+    const auto sampled = resource_manager_->bind_resource( aloe::usage( image, aloe::ComputeSampledRead ) );
+    const auto storage = resource_manager_->bind_resource( aloe::usage( image, aloe::ComputeStorageRead ) );
+    const auto attachment = resource_manager_->bind_resource( aloe::usage( image, aloe::ColorAttachmentWrite ) );
+    ASSERT_TRUE( sampled.has_value() );
+    ASSERT_TRUE( storage.has_value() );
+    ASSERT_TRUE( attachment.has_value() );
+
+    // Rebinding the same usage returns the same slot
+    EXPECT_EQ( resource_manager_->bind_resource( aloe::usage( image, aloe::ComputeSampledRead ) ), sampled );
+
+    // Every usage still gets its own view, even the ones without a descriptor
+    EXPECT_NE( resource_manager_->get_image_view( aloe::usage( image, aloe::ColorAttachmentWrite ) ), VK_NULL_HANDLE );
+    EXPECT_NE( resource_manager_->get_image_view( aloe::usage( image, aloe::ComputeSampledRead ) ),
+               resource_manager_->get_image_view( aloe::usage( image, aloe::ComputeStorageRead ) ) );
+
+    // Freeing the image releases each slot back to the heap it came from, so a new image reuses them
+    resource_manager_->free_image( image );
+    const auto replacement = resource_manager_->create_image( {
+        .extent = { 16, 16, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+        .name = "ReplacementImage",
+    } );
+    const auto replacement_binding =
+        resource_manager_->bind_resource( aloe::usage( replacement, aloe::ComputeSampledRead ) );
+    ASSERT_TRUE( replacement_binding.has_value() );
+    EXPECT_EQ( *replacement_binding & 0xFFFFFFFF, *sampled & 0xFFFFFFFF );
+}
+
+//------------------------------------------------------------------------------
+// Batch Creation Tests
+//------------------------------------------------------------------------------
+
+TEST_F( ResourceManagerTestFixture, CreateBuffers_SharesAllocationsAndFreesIndividually ) {
+    auto total_allocations = [&]() {
+        resource_manager_->update_memory_statistics();
+        uint32_t total = 0;
+        for ( const auto& heap : resource_manager_->memory_statistics().heaps ) { total += heap.allocation_count; }
+        return total;
+    };
+
+    constexpr size_t num_buffers = 64;
+    constexpr VkDeviceSize buffer_size = 256;
+
+    std::vector<aloe::BufferDesc> descs( num_buffers,
+                                         {
+                                             .size = buffer_size,
+                                             .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                             .memory_flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT,
+                                             .name = "BatchedBuffer",
+                                         } );
+
+    const auto initial_allocations = total_allocations();
+    const auto handles = resource_manager_->create_buffers( descs );
+    ASSERT_EQ( handles.size(), num_buffers );
+    EXPECT_TRUE( std::ranges::all_of( handles, []( auto handle ) { return handle.raw != 0; } ) );
+
+    // All of the buffers fit in a single allocation
+    EXPECT_EQ( total_allocations(), initial_allocations + 1 );
+
+    for ( uint32_t i = 0; i < num_buffers; ++i ) {
+        std::vector<uint32_t> data( buffer_size / sizeof( uint32_t ), i );
+        EXPECT_EQ( resource_manager_->upload_to_buffer( handles[i], data.data(), buffer_size ), buffer_size );
+    }
+
+    // Freeing part of the batch keeps the allocation (and the contents of the remaining buffers) alive
+    for ( size_t i = 0; i < num_buffers; i += 2 ) { resource_manager_->free_buffer( handles[i] ); }
+    EXPECT_EQ( total_allocations(), initial_allocations + 1 );
+
+    for ( uint32_t i = 1; i < num_buffers; i += 2 ) {
+        std::vector<uint32_t> read_back( buffer_size / sizeof( uint32_t ) );
+        EXPECT_EQ( resource_manager_->read_from_buffer( handles[i], read_back.data(), buffer_size ), buffer_size );
+        EXPECT_TRUE( std::ranges::all_of( read_back, [&]( uint32_t v ) { return v == i; } ) );
+    }
+
+    for ( size_t i = 1; i < num_buffers; i += 2 ) { resource_manager_->free_buffer( handles[i] ); }
+    EXPECT_EQ( total_allocations(), initial_allocations );
+}
+
+TEST_F( ResourceManagerTestFixture, CreateImages_BatchedImagesRoundTrip ) {
+    constexpr uint32_t image_size = 16;
+    constexpr VkDeviceSize image_bytes = image_size * image_size * 4;
+
+    std::vector<aloe::ImageDesc> descs( 8,
+                                        {
+                                            .extent = { image_size, image_size, 1 },
+                                            .format = VK_FORMAT_R8G8B8A8_UNORM,
+                                            .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                                            .name = "BatchedImage",
+                                        } );
+    // An invalid description only fails its own handle
+    descs[3].mip_levels = 0;
+
+    const auto handles = resource_manager_->create_images( descs );
+    ASSERT_EQ( handles.size(), descs.size() );
+    EXPECT_EQ( handles[3].raw, 0 );
+
+    for ( uint32_t i = 0; i < handles.size(); ++i ) {
+        if ( i == 3 ) continue;
+        ASSERT_NE( handles[i].raw, 0 );
+
+        std::vector<uint8_t> data( image_bytes, static_cast<uint8_t>( i + 1 ) );
+        std::vector<uint8_t> read_back( image_bytes );
+        EXPECT_EQ( resource_manager_->upload_to_image( handles[i], data.data(), image_bytes ), image_bytes );
+        EXPECT_EQ( resource_manager_->read_from_image( handles[i], read_back.data(), image_bytes ), image_bytes );
+        EXPECT_EQ( data, read_back );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Texture Streaming Tests
+//------------------------------------------------------------------------------
+
+TEST_F( ResourceManagerTestFixture, Streaming_StreamsRequestedMipsAndEvictsOverBudget ) {
+    constexpr uint32_t image_size = 16;
+    constexpr uint32_t mip_levels = 5;
+    ASSERT_TRUE( resource_manager_->enable_streaming( { .budget = 1024 * 1024 * 1024 } ) );
+
+    // Every byte of a mip holds the index of that mip
+    const auto image = resource_manager_->create_streamed_image( {
+        .image = {
+            .extent = { image_size, image_size, 1 },
+            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+            .mip_levels = mip_levels,
+            .name = "StreamedImage",
+        },
+        .load_mip = []( uint32_t mip ) {
+            const auto size = std::max( 1u, image_size >> mip );
+            return std::vector<uint8_t>( size * size * 4, static_cast<uint8_t>( mip ) );
+        },
+    } );
+    ASSERT_NE( image.raw, 0 );
+    EXPECT_EQ( resource_manager_->resident_mip( image ), mip_levels - 1 );
+
+    const auto bound = resource_manager_->bind_resource( aloe::usage( image, aloe::ComputeSampledRead ) );
+    ASSERT_TRUE( bound.has_value() );
+
+    resource_manager_->request_image_mip( image, 0 );
+    for ( int i = 0; i < 1000 && resource_manager_->resident_mip( image ) != 0u; ++i ) {
+        resource_manager_->update_streaming();
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    ASSERT_EQ( resource_manager_->resident_mip( image ), 0u );
+    EXPECT_EQ( resource_manager_->streaming_statistics().mips_streamed_in, mip_levels - 1 );
+    EXPECT_EQ( resource_manager_->streaming_statistics().pending_loads, 0u );
+
+    std::vector<uint8_t> mip0( image_size * image_size * 4, 0xFF );
+    ASSERT_EQ( resource_manager_->read_from_image( image, mip0.data(), mip0.size() ), mip0.size() );
+    EXPECT_EQ( mip0, std::vector<uint8_t>( mip0.size(), 0 ) );
+
+    // Once no longer requested, everything but the least detailed mip is evicted to fit the budget
+    resource_manager_->set_streaming_budget( 1 );
+    resource_manager_->next_frame();
+    resource_manager_->next_frame();
+    EXPECT_EQ( resource_manager_->resident_mip( image ), mip_levels - 1 );
+    EXPECT_EQ( resource_manager_->streaming_statistics().mips_evicted, mip_levels - 1 );
+
+    uint8_t last_mip[4] = {};
+    ASSERT_EQ( resource_manager_->read_from_image( image, last_mip, sizeof( last_mip ) ), sizeof( last_mip ) );
+    EXPECT_EQ( last_mip[0], mip_levels - 1 );
+
+    // The handle and its descriptor slot survived every swap of the backing image
+    EXPECT_EQ( resource_manager_->bind_resource( aloe::usage( image, aloe::ComputeSampledRead ) ), bound );
+
+    resource_manager_->free_image( image );
+    EXPECT_EQ( resource_manager_->streaming_statistics().streamed_images, 0u );
+    EXPECT_EQ( resource_manager_->streaming_statistics().resident_bytes, 0u );
+}
+
+TEST_F( ResourceManagerTestFixture, Streaming_FreesImagesAlongsideUpdates ) {
+    constexpr uint32_t image_size = 16;
+    ASSERT_TRUE( resource_manager_->enable_streaming( { .budget = 1024 * 1024 * 1024 } ) );
+
+    std::vector<aloe::ImageHandle> images;
+    for ( uint32_t i = 0; i < 8; ++i ) {
+        const auto image = resource_manager_->create_streamed_image( {
+            .image = {
+                .extent = { image_size, image_size, 1 },
+                .format = VK_FORMAT_R8G8B8A8_UNORM,
+                .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+                .mip_levels = 5,
+                .name = "ConcurrentlyFreedImage",
+            },
+            .load_mip = []( uint32_t mip ) {
+                const auto size = std::max( 1u, image_size >> mip );
+                return std::vector<uint8_t>( size * size * 4, static_cast<uint8_t>( mip ) );
+            },
+        } );
+        ASSERT_NE( image.raw, 0 );
+        resource_manager_->request_image_mip( image, 0 );
+        images.push_back( image );
+    }
+
+    // Images are freed on another thread while their mips are being streamed in
+    std::atomic<bool> freeing = true;
+    std::thread freeing_thread( [&]() {
+        for ( const auto image : images ) {
+            resource_manager_->free_image( image );
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+        freeing = false;
+    } );
+    while ( freeing ) { resource_manager_->update_streaming(); }
+    freeing_thread.join();
+
+    const auto statistics = resource_manager_->streaming_statistics();
+    EXPECT_EQ( statistics.streamed_images, 0u );
+    EXPECT_EQ( statistics.resident_bytes, 0u );
+}
+
+TEST_F( ResourceManagerTestFixture, Streaming_RequiresStreamingToBeEnabled ) {
+    const auto image = resource_manager_->create_streamed_image( {
+        .image = {
+            .extent = { 4, 4, 1 },
+            .format = VK_FORMAT_R8G8B8A8_UNORM,
+            .usage = VK_IMAGE_USAGE_SAMPLED_BIT,
+            .mip_levels = 3,
+            .name = "StreamedImage",
+        },
+        .load_mip = []( uint32_t ) { return std::vector<uint8_t>( 4, 0 ); },
+    } );
+
+    EXPECT_EQ( image.raw, 0 );
+    const auto& entries = mock_logger_->get_entries();
+    ASSERT_FALSE( entries.empty() );
+    EXPECT_EQ( entries.back().level, aloe::LogLevel::Error );
+}
+
+//------------------------------------------------------------------------------
+// Host Image Copy Tests
+//------------------------------------------------------------------------------
+
+// Uploads a 2 layer mipped image and reads back its first mip
+static void expect_image_round_trip( aloe::ResourceManager& resource_manager ) {
+    std::vector<uint8_t> test_data( 8 * 8 * 4 * 2 );
+    for ( size_t i = 0; i < test_data.size(); ++i ) { test_data[i] = static_cast<uint8_t>( ( i * 13 + 7 ) % 256 ); }
+
+    const auto image = resource_manager.create_image( {
+        .extent = { 8, 8, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .mip_levels = 4,
+        .array_layers = 2,
+        .name = "HostCopyImage",
+    } );
+    ASSERT_NE( image.raw, 0 );
+
+    std::vector<uint8_t> read_back( test_data.size() );
+    EXPECT_EQ( resource_manager.upload_to_image( image, test_data.data(), test_data.size() ), test_data.size() );
+    EXPECT_EQ( resource_manager.read_from_image( image, read_back.data(), read_back.size() ), read_back.size() );
+    EXPECT_EQ( read_back, test_data );
+
+    resource_manager.free_image( image );
+}
+
+TEST_F( ResourceManagerTestFixture, HostImageCopy_UploadAndReadBack ) {
+    if ( !device_->host_image_copy_enabled() ) { GTEST_SKIP() << "VK_EXT_host_image_copy is not supported"; }
+
+    expect_image_round_trip( *resource_manager_ );
+}
+
+TEST_F( ResourceManagerTestFixture, HostImageCopy_DisabledFallsBackToStaging ) {
+    resource_manager_.reset();
+    device_.reset( nullptr );
+    device_ = std::make_unique<aloe::Device>( aloe::DeviceSettings{
+        .enable_validation = true,
+        .headless = true,
+        .host_image_copy = false,
+    } );
+    resource_manager_ = device_->make_resource_manager();
+    ASSERT_FALSE( device_->host_image_copy_enabled() );
+
+    expect_image_round_trip( *resource_manager_ );
+}
+
+//------------------------------------------------------------------------------
+// Texture Compression Tests
+//------------------------------------------------------------------------------
+
+TEST_F( ResourceManagerTestFixture, CompressedImage_EncodesUploadsFromChannelCount ) {
+    VkFormatProperties properties{};
+    vkGetPhysicalDeviceFormatProperties( device_->physical_device(), VK_FORMAT_BC7_UNORM_BLOCK, &properties );
+    if ( !device_->get_physical_device_features().textureCompressionBC ||
+         ( properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT ) == 0 ) {
+        GTEST_SKIP() << "BC7 is not supported";
+    }
+
+    constexpr uint32_t width = 20;
+    constexpr uint32_t height = 12;
+    std::vector<uint8_t> texels( width * height * 4 * 2 );
+    for ( size_t i = 0; i < texels.size(); ++i ) { texels[i] = static_cast<uint8_t>( ( i * 7 + i / 80 * 3 ) % 256 ); }
+
+    const auto image = resource_manager_->create_image( {
+        .extent = { width, height, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .mip_levels = 3,
+        .array_layers = 2,
+        .compress_channels = 4,
+        .name = "CompressedImage",
+    } );
+    ASSERT_NE( image.raw, 0 );
+
+    // Only the RGBA8 texels of every layer are accepted
+    EXPECT_EQ( resource_manager_->upload_to_image( image, texels.data(), texels.size() / 2 ), 0 );
+    EXPECT_EQ( resource_manager_->upload_to_image( image, texels.data(), texels.size() ), texels.size() );
+
+    // Mip 0 is read back as BC7 blocks, a quarter of the uncompressed size
+    const auto layer_size = texels.size() / 2;
+    std::vector<uint8_t> expected;
+    for ( size_t layer = 0; layer < 2; ++layer ) {
+        const auto blocks = aloe::compress_rgba8( std::span( texels ).subspan( layer * layer_size, layer_size ),
+                                                  width,
+                                                  height,
+                                                  aloe::BlockFormat::BC7 );
+        expected.insert( expected.end(), blocks.begin(), blocks.end() );
+    }
+    ASSERT_EQ( expected.size(), texels.size() / 4 );
+
+    std::vector<uint8_t> read_back( expected.size() );
+    EXPECT_EQ( resource_manager_->read_from_image( image, read_back.data(), read_back.size() ), read_back.size() );
+    EXPECT_EQ( read_back, expected );
+
+    resource_manager_->free_image( image );
+}
+
+TEST_F( ResourceManagerTestFixture, CompressedImage_RejectsInvalidDescriptions ) {
+    const aloe::ImageDesc desc{
+        .extent = { 16, 16, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .name = "InvalidCompressedImage",
+    };
+
+    auto too_many_channels = desc;
+    too_many_channels.compress_channels = 5;
+    EXPECT_EQ( resource_manager_->create_image( too_many_channels ).raw, 0 );
+
+    // Only 8 bit RGBA texels are encoded
+    auto float_texels = desc;
+    float_texels.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    float_texels.compress_channels = 4;
+    EXPECT_EQ( resource_manager_->create_image( float_texels ).raw, 0 );
+
+    ASSERT_FALSE( mock_logger_->get_entries().empty() );
+    EXPECT_EQ( mock_logger_->get_entries().back().level, aloe::LogLevel::Error );
+}
+
+TEST_F( ResourceManagerTestFixture, CompressedImage_NeedsTextureCompressionBC ) {
+    const auto image = resource_manager_->create_image( {
+        .extent = { 16, 16, 1 },
+        .format = VK_FORMAT_BC1_RGB_UNORM_BLOCK,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .name = "BlockCompressedImage",
+    } );
+
+    // The feature is enabled whenever the device has it, and BC images are refused without it
+    if ( device_->get_physical_device_features().textureCompressionBC ) {
+        EXPECT_NE( image.raw, 0 );
+        resource_manager_->free_image( image );
+    } else {
+        EXPECT_EQ( image.raw, 0 );
+        EXPECT_EQ( mock_logger_->get_entries().back().level, aloe::LogLevel::Error );
+    }
+}
+
+//------------------------------------------------------------------------------
+// Image Import Tests
+//------------------------------------------------------------------------------
+
+TEST_F( ResourceManagerTestFixture, ImportImage_ConvertsRgb8ToHalfFloats ) {
+    constexpr uint32_t width = 24;
+    constexpr uint32_t height = 10;
+    std::vector<uint8_t> rgb( width * height * 3 );
+    for ( size_t i = 0; i < rgb.size(); ++i ) { rgb[i] = static_cast<uint8_t>( i * 5 % 256 ); }
+
+    const auto image = resource_manager_->create_image( {
+        .extent = { width, height, 1 },
+        .format = VK_FORMAT_R16G16B16A16_SFLOAT,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .mip_levels = 4,
+        .name = "ImportedImage",
+    } );
+    ASSERT_NE( image.raw, 0 );
+
+    const aloe::ImageImportDesc import = { .layout = aloe::PixelLayout::RGB8, .srgb = true };
+    EXPECT_EQ( resource_manager_->import_to_image( image, rgb.data(), rgb.size() - 3, import ), 0 );
+    EXPECT_EQ( resource_manager_->import_to_image( image, rgb.data(), rgb.size(), import ), rgb.size() );
+
+    // Mip 0 holds the linearized texels, with opaque alpha
+    const aloe::PixelConverter converter;
+    std::vector<float> rgba( width * height * 4 );
+    ASSERT_TRUE( converter.to_rgba32f( rgb, aloe::PixelLayout::RGB8, true, rgba ) );
+    std::vector<uint16_t> expected( rgba.size() );
+    ASSERT_TRUE( converter.float_to_half( rgba, expected ) );
+
+    std::vector<uint16_t> read_back( expected.size() );
+    const auto read_size = read_back.size() * sizeof( uint16_t );
+    EXPECT_EQ( resource_manager_->read_from_image( image, read_back.data(), read_size ), read_size );
+    EXPECT_EQ( read_back, expected );
+
+    resource_manager_->free_image( image );
+}
+
+TEST_F( ResourceManagerTestFixture, ImportImage_RejectsUnsupportedFormats ) {
+    const auto image = resource_manager_->create_image( {
+        .extent = { 8, 8, 1 },
+        .format = VK_FORMAT_R8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .name = "UnsupportedImportImage",
+    } );
+    ASSERT_NE( image.raw, 0 );
+
+    const std::vector<uint8_t> texels( 8 * 8 * 4 );
+    EXPECT_EQ( resource_manager_->import_to_image( image, texels.data(), texels.size(), {} ), 0 );
+    ASSERT_FALSE( mock_logger_->get_entries().empty() );
+    EXPECT_EQ( mock_logger_->get_entries().back().level, aloe::LogLevel::Error );
+
+    resource_manager_->free_image( image );
+}
+
+//------------------------------------------------------------------------------
+// Shared Resource Tests
+//------------------------------------------------------------------------------
+
+TEST_F( ResourceManagerTestFixture, SharedBuffer_DeduplicatesIdenticalContents ) {
+    std::array<uint32_t, 64> data;
+    std::iota( data.begin(), data.end(), 0 );
+    const aloe::BufferDesc desc = {
+        .size = sizeof( data ),
+        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        .name = "SharedBuffer",
+    };
+
+    // The name does not take part in matching contents
+    auto renamed = desc;
+    renamed.name = "RenamedSharedBuffer";
+    const auto first = resource_manager_->create_shared_buffer( desc, data.data(), sizeof( data ) );
+    const auto second = resource_manager_->create_shared_buffer( renamed, data.data(), sizeof( data ) );
+    ASSERT_NE( first.raw, 0 );
+    EXPECT_EQ( first, second );
+
+    // The category does, so memory is accounted against the subsystem which created it
+    auto recategorised = desc;
+    recategorised.category = "OtherSubsystem";
+    const auto other_category = resource_manager_->create_shared_buffer( recategorised, data.data(), sizeof( data ) );
+    EXPECT_NE( other_category, first );
+    resource_manager_->free_buffer( other_category );
+
+    data[0] = 100;
+    const auto different = resource_manager_->create_shared_buffer( desc, data.data(), sizeof( data ) );
+    EXPECT_NE( different, first );
+
+    std::array<uint32_t, 64> read_back{};
+    EXPECT_EQ( resource_manager_->read_from_buffer( different, read_back.data(), sizeof( read_back ) ),
+               sizeof( read_back ) );
+    EXPECT_EQ( read_back, data );
+
+    // Destroyed along with the last reference
+    resource_manager_->free_buffer( first );
+    EXPECT_NE( resource_manager_->get_buffer( second ), VK_NULL_HANDLE );
+    resource_manager_->free_buffer( second );
+    EXPECT_EQ( resource_manager_->get_buffer( second ), VK_NULL_HANDLE );
+
+    resource_manager_->free_buffer( different );
+}
+
+TEST_F( ResourceManagerTestFixture, SharedImage_DeduplicatesIdenticalContents ) {
+    std::vector<uint8_t> texels( 16 * 16 * 4 );
+    for ( size_t i = 0; i < texels.size(); ++i ) { texels[i] = static_cast<uint8_t>( i % 251 ); }
+    const aloe::ImageDesc desc = {
+        .extent = { 16, 16, 1 },
+        .format = VK_FORMAT_R8G8B8A8_UNORM,
+        .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        .name = "SharedImage",
+    };
+
+    const auto first = resource_manager_->create_shared_image( desc, texels.data(), texels.size() );
+    const auto second = resource_manager_->create_shared_image( desc, texels.data(), texels.size() );
+    ASSERT_NE( first.raw, 0 );
+    EXPECT_EQ( first, second );
+
+    // The same bytes in a different format are a different image
+    auto srgb = desc;
+    srgb.format = VK_FORMAT_R8G8B8A8_SRGB;
+    const auto different = resource_manager_->create_shared_image( srgb, texels.data(), texels.size() );
+    EXPECT_NE( different, first );
+
+    resource_manager_->free_image( first );
+    resource_manager_->free_image( second );
+    EXPECT_EQ( resource_manager_->get_image( first ), VK_NULL_HANDLE );
+
+    // Once destroyed, identical contents create a new image
+    const auto recreated = resource_manager_->create_shared_image( desc, texels.data(), texels.size() );
+    EXPECT_NE( recreated.raw, 0 );
+    EXPECT_NE( recreated, first );
+
+    resource_manager_->free_image( recreated );
+    resource_manager_->free_image( different );
+}
+
+//------------------------------------------------------------------------------
+// Thread Safety Tests
+//------------------------------------------------------------------------------
+
+TEST_F( ResourceManagerTestFixture, Concurrent_CreateBindAndFree ) {
+    constexpr uint32_t num_threads = 4;
+    constexpr uint32_t resources_per_thread = 64;
+
+    std::vector<std::vector<aloe::BufferHandle>> buffers( num_threads );
+    std::vector<std::vector<aloe::ImageHandle>> images( num_threads );
+    {
+        std::vector<std::jthread> threads;
+        for ( uint32_t t = 0; t < num_threads; ++t ) {
+            threads.emplace_back( [&, t]() {
+                for ( uint32_t i = 0; i < resources_per_thread; ++i ) {
+                    const auto buffer = resource_manager_->create_buffer( {
+                        .size = 256,
+                        .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                        .name = "ConcurrentBuffer",
+                    } );
+                    const auto image = resource_manager_->create_image( {
+                        .extent = { 16, 16, 1 },
+                        .format = VK_FORMAT_R8G8B8A8_UNORM,
+                        .usage = VK_IMAGE_USAGE_STORAGE_BIT,
+                        .name = "ConcurrentImage",
+                    } );
+                    ASSERT_NE( buffer.raw, 0 );
+                    ASSERT_NE( image.raw, 0 );
+
+                    // Each thread only binds & frees its own resources, while the others create and free theirs
+                    const auto buffer_usage = aloe::usage( buffer, aloe::ComputeStorageRead );
+                    const auto image_usage = aloe::usage( image, aloe::ComputeStorageRead );
+                    EXPECT_TRUE( resource_manager_->bind_resource( buffer_usage ).has_value() );
+                    EXPECT_TRUE( resource_manager_->bind_resource( image_usage ).has_value() );
+
+                    if ( i % 2 == 0 ) {
+                        resource_manager_->free_buffer( buffer );
+                        resource_manager_->free_image( image );
+                    } else {
+                        buffers[t].push_back( buffer );
+                        images[t].push_back( image );
+                    }
+                }
+            } );
+        }
+    }
+
+    // Every surviving resource has a unique handle and is still live
+    std::set<uint64_t> ids;
+    for ( uint32_t t = 0; t < num_threads; ++t ) {
+        for ( const auto buffer : buffers[t] ) {
+            EXPECT_NE( resource_manager_->get_buffer( buffer ), VK_NULL_HANDLE );
+            ids.insert( buffer.raw );
+            resource_manager_->free_buffer( buffer );
+        }
+        for ( const auto image : images[t] ) {
+            EXPECT_NE( resource_manager_->get_image( image ), VK_NULL_HANDLE );
+            ids.insert( image.raw );
+            resource_manager_->free_image( image );
+        }
+    }
+    EXPECT_EQ( ids.size(), num_threads * resources_per_thread );
+}
+
 //------------------------------------------------------------------------------
 // Performance & Stress Tests
 //------------------------------------------------------------------------------
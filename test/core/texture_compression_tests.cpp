@@ -0,0 +1,234 @@
+#include <aloe/core/TextureCompression.h>
+#include <aloe/util/log.h>
+#include <aloe/util/thread_pool.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+class TextureCompressionTestFixture : public ::testing::Test {
+protected:
+    std::shared_ptr<aloe::MockLogger> mock_logger_;
+
+    void SetUp() override {
+        mock_logger_ = std::make_shared<aloe::MockLogger>();
+        aloe::set_logger( mock_logger_ );
+        aloe::set_logger_level( aloe::LogLevel::Warn );
+    }
+
+    // Smooth gradients in every channel, with alpha running against the colour
+    static std::vector<uint8_t> make_texels( uint32_t width, uint32_t height ) {
+        std::vector<uint8_t> texels( width * height * 4 );
+        for ( uint32_t y = 0; y < height; ++y ) {
+            for ( uint32_t x = 0; x < width; ++x ) {
+                auto* texel = &texels[( y * width + x ) * 4];
+                texel[0] = static_cast<uint8_t>( x * 255 / width );
+                texel[1] = static_cast<uint8_t>( y * 255 / height );
+                texel[2] = static_cast<uint8_t>( ( x + y ) * 127 / ( width + height ) );
+                texel[3] = static_cast<uint8_t>( 255 - x * 255 / width );
+            }
+        }
+        return texels;
+    }
+
+    static uint32_t read_bits( const uint8_t* block, uint32_t first_bit, uint32_t bits ) {
+        uint32_t value = 0;
+        for ( uint32_t i = 0; i < bits; ++i ) {
+            const auto bit = first_bit + i;
+            value |= ( ( block[bit / 8] >> ( bit % 8 ) ) & 1u ) << i;
+        }
+        return value;
+    }
+
+    // Reference decoders for the blocks the encoder writes, into channel `channel` of 16 RGBA texels
+    static void decode_bc4( const uint8_t* block, uint8_t* texels, uint32_t channel ) {
+        const int32_t value0 = block[0];
+        const int32_t value1 = block[1];
+        std::array<int32_t, 8> palette = { value0, value1 };
+        for ( int32_t i = 2; i < 8; ++i ) { palette[i] = ( ( 8 - i ) * value0 + ( i - 1 ) * value1 + 3 ) / 7; }
+        for ( uint32_t i = 0; i < 16; ++i ) {
+            texels[i * 4 + channel] = static_cast<uint8_t>( palette[read_bits( block, 16 + i * 3, 3 )] );
+        }
+    }
+
+    static void decode_bc1( const uint8_t* block, uint8_t* texels ) {
+        const auto expand = []( uint32_t colour ) {
+            const uint32_t r = ( colour >> 11 ) & 31, g = ( colour >> 5 ) & 63, b = colour & 31;
+            return std::array<int32_t, 3>{ static_cast<int32_t>( ( r << 3 ) | ( r >> 2 ) ),
+                                           static_cast<int32_t>( ( g << 2 ) | ( g >> 4 ) ),
+                                           static_cast<int32_t>( ( b << 3 ) | ( b >> 2 ) ) };
+        };
+        const auto colour0 = read_bits( block, 0, 16 );
+        const auto colour1 = read_bits( block, 16, 16 );
+        ASSERT_TRUE( colour0 > colour1 || read_bits( block, 32, 32 ) == 0 );
+
+        const auto e0 = expand( colour0 );
+        const auto e1 = expand( colour1 );
+        for ( uint32_t i = 0; i < 16; ++i ) {
+            const auto index = read_bits( block, 32 + i * 2, 2 );
+            for ( uint32_t c = 0; c < 3; ++c ) {
+                const std::array<int32_t, 4> palette = {
+                    e0[c], e1[c], ( 2 * e0[c] + e1[c] ) / 3, ( e0[c] + 2 * e1[c] ) / 3 };
+                texels[i * 4 + c] = static_cast<uint8_t>( palette[index] );
+            }
+        }
+    }
+
+    static void decode_bc7( const uint8_t* block, uint8_t* texels ) {
+        constexpr std::array<int32_t, 16> weights = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+        ASSERT_EQ( read_bits( block, 0, 7 ), 1u << 6 );// Mode 6
+
+        const auto p_bit0 = read_bits( block, 63, 1 );
+        const auto p_bit1 = read_bits( block, 64, 1 );
+        for ( uint32_t i = 0; i < 16; ++i ) {
+            const auto index = i == 0 ? read_bits( block, 65, 3 ) : read_bits( block, 68 + ( i - 1 ) * 4, 4 );
+            for ( uint32_t c = 0; c < 4; ++c ) {
+                const auto e0 = static_cast<int32_t>( ( read_bits( block, 7 + c * 14, 7 ) << 1 ) | p_bit0 );
+                const auto e1 = static_cast<int32_t>( ( read_bits( block, 14 + c * 14, 7 ) << 1 ) | p_bit1 );
+                const auto value = ( ( 64 - weights[index] ) * e0 + weights[index] * e1 + 32 ) >> 6;
+                texels[i * 4 + c] = static_cast<uint8_t>( value );
+            }
+        }
+    }
+
+    // Peak signal to noise ratio of the channels `format` stores, after decoding `blocks`
+    static double decoded_psnr( const std::vector<uint8_t>& texels,
+                                const std::vector<uint8_t>& blocks,
+                                uint32_t width,
+                                uint32_t height,
+                                aloe::BlockFormat format ) {
+        const uint32_t blocks_x = ( width + 3 ) / 4;
+        const uint32_t block_size = format == aloe::BlockFormat::BC1 || format == aloe::BlockFormat::BC4 ? 8 : 16;
+        const uint32_t channels = format == aloe::BlockFormat::BC4 ? 1
+            : format == aloe::BlockFormat::BC5                    ? 2
+            : format == aloe::BlockFormat::BC1                    ? 3
+                                                                  : 4;
+
+        double squared_error = 0.0;
+        uint64_t samples = 0;
+        for ( uint32_t block_y = 0; block_y < ( height + 3 ) / 4; ++block_y ) {
+            for ( uint32_t block_x = 0; block_x < blocks_x; ++block_x ) {
+                const auto* block = &blocks[( block_y * blocks_x + block_x ) * block_size];
+                std::array<uint8_t, 64> decoded{};
+                switch ( format ) {
+                    case aloe::BlockFormat::BC1: decode_bc1( block, decoded.data() ); break;
+                    case aloe::BlockFormat::BC3:
+                        decode_bc4( block, decoded.data(), 3 );
+                        decode_bc1( block + 8, decoded.data() );
+                        break;
+                    case aloe::BlockFormat::BC4: decode_bc4( block, decoded.data(), 0 ); break;
+                    case aloe::BlockFormat::BC5:
+                        decode_bc4( block, decoded.data(), 0 );
+                        decode_bc4( block + 8, decoded.data(), 1 );
+                        break;
+                    case aloe::BlockFormat::BC7: decode_bc7( block, decoded.data() ); break;
+                }
+
+                for ( uint32_t i = 0; i < 16; ++i ) {
+                    const auto x = block_x * 4 + i % 4;
+                    const auto y = block_y * 4 + i / 4;
+                    if ( x >= width || y >= height ) { continue; }
+                    for ( uint32_t c = 0; c < channels; ++c ) {
+                        const double difference = decoded[i * 4 + c] - texels[( y * width + x ) * 4 + c];
+                        squared_error += difference * difference;
+                        ++samples;
+                    }
+                }
+            }
+        }
+
+        if ( squared_error == 0.0 ) { return INFINITY; }
+        return 10.0 * std::log10( 255.0 * 255.0 / ( squared_error / static_cast<double>( samples ) ) );
+    }
+};
+
+TEST_F( TextureCompressionTestFixture, CompressedFormat_PicksFormatFromChannelCount ) {
+    EXPECT_EQ( aloe::compressed_format( 1, false ), VK_FORMAT_BC4_UNORM_BLOCK );
+    EXPECT_EQ( aloe::compressed_format( 2, true ), VK_FORMAT_BC5_UNORM_BLOCK );
+    EXPECT_EQ( aloe::compressed_format( 3, false ), VK_FORMAT_BC1_RGB_UNORM_BLOCK );
+    EXPECT_EQ( aloe::compressed_format( 3, true ), VK_FORMAT_BC1_RGB_SRGB_BLOCK );
+    EXPECT_EQ( aloe::compressed_format( 4, false ), VK_FORMAT_BC7_UNORM_BLOCK );
+    EXPECT_EQ( aloe::compressed_format( 4, true ), VK_FORMAT_BC7_SRGB_BLOCK );
+    EXPECT_EQ( aloe::compressed_format( 0, false ), VK_FORMAT_UNDEFINED );
+    EXPECT_EQ( aloe::compressed_format( 5, false ), VK_FORMAT_UNDEFINED );
+
+    EXPECT_EQ( aloe::block_format( VK_FORMAT_BC3_SRGB_BLOCK ), aloe::BlockFormat::BC3 );
+    EXPECT_EQ( aloe::block_format( VK_FORMAT_R8G8B8A8_UNORM ), std::nullopt );
+    EXPECT_EQ( aloe::block_format( VK_FORMAT_BC6H_UFLOAT_BLOCK ), std::nullopt );
+}
+
+TEST_F( TextureCompressionTestFixture, CompressedSize_RoundsUpToWholeBlocks ) {
+    EXPECT_EQ( aloe::compressed_size( aloe::BlockFormat::BC1, 4, 4 ), 8 );
+    EXPECT_EQ( aloe::compressed_size( aloe::BlockFormat::BC1, 5, 4 ), 16 );
+    EXPECT_EQ( aloe::compressed_size( aloe::BlockFormat::BC7, 1, 1 ), 16 );
+    EXPECT_EQ( aloe::compressed_size( aloe::BlockFormat::BC5, 64, 32 ), 16 * 8 * 16 );
+}
+
+TEST_F( TextureCompressionTestFixture, CompressRgba8_DecodesCloseToSource ) {
+    // Not a multiple of the block size, so the edge blocks are padded
+    constexpr uint32_t width = 61;
+    constexpr uint32_t height = 37;
+    const auto texels = make_texels( width, height );
+
+    for ( const auto format : { aloe::BlockFormat::BC1,
+                                aloe::BlockFormat::BC3,
+                                aloe::BlockFormat::BC4,
+                                aloe::BlockFormat::BC5,
+                                aloe::BlockFormat::BC7 } ) {
+        const auto blocks = aloe::compress_rgba8( texels, width, height, format );
+        ASSERT_EQ( blocks.size(), aloe::compressed_size( format, width, height ) );
+        EXPECT_GT( decoded_psnr( texels, blocks, width, height, format ), 35.0 ) << static_cast<uint32_t>( format );
+    }
+}
+
+TEST_F( TextureCompressionTestFixture, CompressRgba8_SolidBlocksAreExact ) {
+    std::vector<uint8_t> texels( 8 * 8 * 4 );
+    for ( size_t i = 0; i < texels.size(); ++i ) { texels[i] = static_cast<uint8_t>( 40 + i % 4 * 50 ); }
+
+    for ( const auto format : { aloe::BlockFormat::BC4, aloe::BlockFormat::BC5, aloe::BlockFormat::BC7 } ) {
+        const auto blocks = aloe::compress_rgba8( texels, 8, 8, format );
+        EXPECT_EQ( decoded_psnr( texels, blocks, 8, 8, format ), INFINITY ) << static_cast<uint32_t>( format );
+    }
+}
+
+TEST_F( TextureCompressionTestFixture, CompressRgba8_WorkersMatchSingleThreaded ) {
+    constexpr uint32_t width = 256;
+    constexpr uint32_t height = 128;
+    const auto texels = make_texels( width, height );
+
+    aloe::ThreadPool workers( 4 );
+    for ( const auto format : { aloe::BlockFormat::BC1, aloe::BlockFormat::BC5, aloe::BlockFormat::BC7 } ) {
+        EXPECT_EQ( aloe::compress_rgba8( texels, width, height, format, &workers ),
+                   aloe::compress_rgba8( texels, width, height, format ) );
+    }
+}
+
+TEST_F( TextureCompressionTestFixture, CompressRgba8Mips_LaysOutEveryLayerOfEveryMip ) {
+    constexpr uint32_t layers = 2;
+    auto texels = make_texels( 16, 8 );
+    texels.insert( texels.end(), texels.begin(), texels.end() );
+
+    std::vector<VkDeviceSize> mip_offsets;
+    const auto blocks =
+        aloe::compress_rgba8_mips( texels, { 16, 8 }, layers, 5, aloe::BlockFormat::BC1, mip_offsets );
+
+    // 16x8, 8x4, 4x2, 2x1 and 1x1 texels, every mip holds at least one block per layer
+    const std::vector<VkDeviceSize> expected_offsets = { 0, 128, 160, 176, 192 };
+    EXPECT_EQ( mip_offsets, expected_offsets );
+    EXPECT_EQ( blocks.size(), 208 );
+
+    // Both layers hold the same texels, so encode to the same blocks
+    EXPECT_TRUE( std::equal( blocks.begin(), blocks.begin() + 64, blocks.begin() + 64 ) );
+}
+
+TEST_F( TextureCompressionTestFixture, CompressRgba8_RejectsMismatchedSizes ) {
+    const auto texels = make_texels( 8, 8 );
+    EXPECT_TRUE( aloe::compress_rgba8( texels, 8, 4, aloe::BlockFormat::BC7 ).empty() );
+    EXPECT_TRUE( aloe::compress_rgba8( texels, 0, 0, aloe::BlockFormat::BC7 ).empty() );
+
+    ASSERT_FALSE( mock_logger_->get_entries().empty() );
+    EXPECT_EQ( mock_logger_->get_entries().back().level, aloe::LogLevel::Error );
+}
@@ -0,0 +1,90 @@
+#include <aloe/core/AssetPack.h>
+#include <aloe/util/log.h>
+
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// Packs raw files into an aloe asset pack:
+//
+//   aloe_pack <output>
+//       [buffer <name> <file>]...
+//       [image <name> <vk format> <width> <height> <layers> <mip 0 file> [<mip 1 file>...]]...
+//
+// Image mip files hold every array layer of that mip tightly packed, the tool does not convert or generate mips.
+
+static std::optional<std::vector<uint8_t>> read_file( const std::filesystem::path& path ) {
+    std::ifstream file( path, std::ios::binary );
+    if ( !file ) {
+        aloe::log_write( aloe::LogLevel::Error, "Failed to open {}", path.string() );
+        return std::nullopt;
+    }
+    return std::vector<uint8_t>( std::istreambuf_iterator<char>( file ), {} );
+}
+
+static std::optional<uint32_t> parse_uint( std::string_view text ) {
+    uint32_t value = 0;
+    const auto [end, error] = std::from_chars( text.data(), text.data() + text.size(), value );
+    if ( error != std::errc{} || end != text.data() + text.size() ) {
+        aloe::log_write( aloe::LogLevel::Error, "Expected an unsigned integer, got {}", text );
+        return std::nullopt;
+    }
+    return value;
+}
+
+static bool is_command( std::string_view arg ) { return arg == "buffer" || arg == "image"; }
+
+int main( int argc, char** argv ) {
+    const std::vector<std::string_view> args( argv + 1, argv + argc );
+    if ( args.empty() ) {
+        aloe::log_write( aloe::LogLevel::Error,
+                         "Usage: aloe_pack <output> [buffer <name> <file>]... "
+                         "[image <name> <vk format> <width> <height> <layers> <mip files>...]..." );
+        return 1;
+    }
+
+    aloe::AssetPackWriter writer;
+    size_t arg = 1;
+    while ( arg < args.size() ) {
+        const auto command = args[arg];
+        if ( command == "buffer" && arg + 2 < args.size() ) {
+            const auto data = read_file( args[arg + 2] );
+            if ( !data || !writer.add_buffer( args[arg + 1], *data ) ) { return 1; }
+            arg += 3;
+        } else if ( command == "image" && arg + 6 < args.size() ) {
+            const auto name = args[arg + 1];
+            const auto format = parse_uint( args[arg + 2] );
+            const auto width = parse_uint( args[arg + 3] );
+            const auto height = parse_uint( args[arg + 4] );
+            const auto layers = parse_uint( args[arg + 5] );
+            if ( !format || !width || !height || !layers ) { return 1; }
+
+            std::vector<std::vector<uint8_t>> mips;
+            for ( arg += 6; arg < args.size() && !is_command( args[arg] ); ++arg ) {
+                auto mip = read_file( args[arg] );
+                if ( !mip ) { return 1; }
+                mips.push_back( std::move( *mip ) );
+            }
+
+            const aloe::AssetImageDesc desc{
+                .format = static_cast<VkFormat>( *format ),
+                .extent = { *width, *height, 1 },
+                .array_layers = *layers,
+            };
+            if ( !writer.add_image( name, desc, mips ) ) { return 1; }
+        } else {
+            aloe::log_write( aloe::LogLevel::Error, "Unknown or incomplete command starting at {}", command );
+            return 1;
+        }
+    }
+
+    if ( !writer.write( args[0] ) ) { return 1; }
+
+    aloe::log_write( aloe::LogLevel::Info, "Wrote {}", args[0] );
+    return 0;
+}